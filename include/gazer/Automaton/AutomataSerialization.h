@@ -0,0 +1,53 @@
+//==- AutomataSerialization.h - Binary format for automata ------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares a compact binary format for automata systems.
+///
+/// A serialized system consists of a type table, a variable table, the
+/// interfaces of the automata, an expression table and the bodies of the
+/// automata. Expressions are stored as a DAG: each node is written once
+/// into the expression table, after its operands, and referred to by its
+/// index. All integers are LEB128-encoded.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_AUTOMATASERIALIZATION_H
+#define GAZER_AUTOMATON_AUTOMATASERIALIZATION_H
+
+#include "gazer/Automaton/Cfa.h"
+
+namespace gazer
+{
+
+/// The version of the binary format, which must be bumped on each change
+/// of the layout.
+constexpr unsigned AutomataFormatVersion = 1;
+
+/// Writes \p system into \p os in gazer's binary automata format.
+/// Disconnected transitions are not written, locations are renumbered in
+/// their order within their automaton.
+void WriteAutomataSystem(AutomataSystem& system, llvm::raw_ostream& os);
+
+/// Reads an automata system written by WriteAutomataSystem and rebuilds it
+/// in \p context, which should be a fresh context without variables.
+/// Returns nullptr if \p buffer is not a well-formed automata system of the
+/// current format version.
+std::unique_ptr<AutomataSystem> ReadAutomataSystem(llvm::StringRef buffer, GazerContext& context);
+
+} // end namespace gazer
+
+#endif
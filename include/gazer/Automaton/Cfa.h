@@ -27,6 +27,7 @@
 
 #include <llvm/ADT/GraphTraits.h>
 #include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include <boost/iterator/indirect_iterator.hpp>
 
 namespace gazer
@@ -39,6 +40,31 @@ class Location
 {
     friend class Cfa;
     using EdgeVectorTy = std::vector<Transition*>;
+
+    /// A contiguous adjacency list. Each edge stores its position within the
+    /// lists of its source and target, thus removals need no search. The gap
+    /// left by a removed edge is closed by the removal itself, which preserves
+    /// the order of edges and keeps the list read-only for its readers.
+    class EdgeList
+    {
+    public:
+        explicit EdgeList(bool incoming)
+            : mIncoming(incoming)
+        {}
+
+        void add(Transition* edge);
+        void remove(Transition* edge);
+        void clear();
+
+        size_t size() const { return mEdges.size(); }
+
+        EdgeVectorTy& edges() { return mEdges; }
+        const EdgeVectorTy& edges() const { return mEdges; }
+
+    private:
+        bool mIncoming;
+        EdgeVectorTy mEdges;
+    };
 public:
     enum LocationKind
     {
@@ -48,7 +74,7 @@ public:
 
 private:
     explicit Location(unsigned id, Cfa* parent, LocationKind kind = State)
-        : mID(id), mCfa(parent), mKind(kind)
+        : mID(id), mCfa(parent), mKind(kind), mIncoming(true), mOutgoing(false)
     {}
     
 public:
@@ -68,26 +94,26 @@ public:
     using edge_iterator = EdgeVectorTy::iterator;
     using const_edge_iterator = EdgeVectorTy::const_iterator;
 
-    edge_iterator incoming_begin() { return mIncoming.begin(); }
-    edge_iterator incoming_end() { return mIncoming.end(); }
+    edge_iterator incoming_begin() { return mIncoming.edges().begin(); }
+    edge_iterator incoming_end() { return mIncoming.edges().end(); }
     llvm::iterator_range<edge_iterator> incoming() {
         return llvm::make_range(incoming_begin(), incoming_end());
     }
 
-    edge_iterator outgoing_begin() { return mOutgoing.begin(); }
-    edge_iterator outgoing_end() { return mOutgoing.end(); }
+    edge_iterator outgoing_begin() { return mOutgoing.edges().begin(); }
+    edge_iterator outgoing_end() { return mOutgoing.edges().end(); }
     llvm::iterator_range<edge_iterator> outgoing() {
         return llvm::make_range(outgoing_begin(), outgoing_end());
     }
 
-    const_edge_iterator incoming_begin() const { return mIncoming.begin(); }
-    const_edge_iterator incoming_end() const { return mIncoming.end(); }
+    const_edge_iterator incoming_begin() const { return mIncoming.edges().begin(); }
+    const_edge_iterator incoming_end() const { return mIncoming.edges().end(); }
     llvm::iterator_range<const_edge_iterator> incoming() const {
         return llvm::make_range(incoming_begin(), incoming_end());
     }
 
-    const_edge_iterator outgoing_begin() const { return mOutgoing.begin(); }
-    const_edge_iterator outgoing_end() const { return mOutgoing.end(); }
+    const_edge_iterator outgoing_begin() const { return mOutgoing.edges().begin(); }
+    const_edge_iterator outgoing_end() const { return mOutgoing.edges().end(); }
     llvm::iterator_range<const_edge_iterator> outgoing() const {
         return llvm::make_range(outgoing_begin(), outgoing_end());
     }
@@ -103,14 +129,15 @@ private:
     unsigned mID;
     Cfa* mCfa;
     LocationKind mKind;
-    EdgeVectorTy mIncoming;
-    EdgeVectorTy mOutgoing;
+    EdgeList mIncoming;
+    EdgeList mOutgoing;
 };
 
 /// A simple transition with a guard or summary expression.
 class Transition
 {
     friend class Cfa;
+    friend class Location;
 public:
     enum EdgeKind
     {
@@ -138,6 +165,12 @@ public:
     ExprPtr getGuard() const { return mExpr; }
     EdgeKind getKind() const { return mEdgeKind; }
 
+    void setGuard(ExprPtr guard)
+    {
+        assert(guard->getType().isBoolType() && "Transition guards can only be booleans!");
+        mExpr = std::move(guard);
+    }
+
     bool isAssign() const { return mEdgeKind == Edge_Assign; }
     bool isCall() const { return mEdgeKind == Edge_Call; }
 
@@ -150,9 +183,20 @@ private:
     Location* mTarget;
     ExprPtr mExpr;
     EdgeKind mEdgeKind;
+
+    // The positions of this edge in the adjacency lists of its source and target.
+    uint32_t mSourceIdx = 0;
+    uint32_t mTargetIdx = 0;
 };
 
 /// Represents a (potentially guared) transition with variable assignments.
+///
+/// The guard is evaluated before the assignments, which are executed in order:
+/// each right-hand side observes the values assigned before it on the same
+/// transition. The exception are the transitions entering a loop header of a
+/// cyclic automaton (see TransformRecursiveToCyclic), which bind the loop-carried
+/// variables like the arguments of a call. All of their right-hand sides are
+/// evaluated over the values preceding the transition.
 class AssignTransition final : public Transition
 {
     friend class Cfa;
@@ -169,6 +213,11 @@ public:
         mAssignments.push_back(assignment);
     }
 
+    template<class Predicate>
+    void removeAssignmentsIf(Predicate p) {
+        mAssignments.erase(std::remove_if(mAssignments.begin(), mAssignments.end(), p), mAssignments.end());
+    }
+
     static bool classof(const Transition* edge) {
         return edge->getKind() == Edge_Assign;
     }
@@ -193,6 +242,11 @@ protected:
 public:
     Cfa* getCalledAutomaton() const { return mCallee; }
 
+    /// Redirects this call to \p callee, which must have the same interface
+    /// as the current callee. The arguments are rebound to the inputs and
+    /// outputs of \p callee with the same indices.
+    void setCalledAutomaton(Cfa* callee);
+
     //-------------------------- Iterator support ---------------------------//
     using input_arg_iterator  = std::vector<VariableAssignment>::const_iterator;
     using output_arg_iterator = std::vector<VariableAssignment>::const_iterator;
@@ -369,6 +423,7 @@ public:
 
     Location* findLocationById(unsigned id);
 
+    bool isInput(Variable* variable) const;
     bool isOutput(Variable* variable) const;
 
     /// View the graph representation of this CFA with the
@@ -389,16 +444,42 @@ public:
     template<class Predicate>
     void removeLocalsIf(Predicate p) {
         mLocals.erase(
-            std::remove_if(mLocals.begin(), mLocals.end(), p),
+            std::remove_if(mLocals.begin(), mLocals.end(), [this, &p](Variable* variable) {
+                if (p(variable)) {
+                    mLocalSet.erase(variable);
+                    return true;
+                }
+                return false;
+            }),
             mLocals.end()
         );
     }
 
+    /// Removes the inputs for which \p p returns true. Note that the call
+    /// transitions calling this automaton must be updated by the caller.
+    template<class Predicate>
+    void removeInputsIf(Predicate p) {
+        mInputs.erase(std::remove_if(mInputs.begin(), mInputs.end(), p), mInputs.end());
+        renumberVariables(mInputs, mInputNumbers);
+    }
+
+    /// Removes the outputs for which \p p returns true. Note that the call
+    /// transitions calling this automaton must be updated by the caller.
+    template<class Predicate>
+    void removeOutputsIf(Predicate p) {
+        mOutputs.erase(std::remove_if(mOutputs.begin(), mOutputs.end(), p), mOutputs.end());
+        renumberVariables(mOutputs, mOutputNumbers);
+    }
+
     ~Cfa();
 
 private:
     Variable* createMemberVariable(const std::string& name, Type& type);
-    Variable* findVariableByName(const std::vector<Variable*>& vec, llvm::StringRef name) const;
+    static void renumberVariables(
+        const std::vector<Variable*>& variables, llvm::DenseMap<Variable*, unsigned>& numbers
+    );
+    template<class ContainerT>
+    Variable* findVariableByName(const ContainerT& variables, llvm::StringRef name) const;
 
 private:
     std::string mName;
@@ -415,6 +496,11 @@ private:
     std::vector<Variable*> mOutputs;
     std::vector<Variable*> mLocals;
 
+    // Index maps for constant-time variable queries.
+    llvm::DenseMap<Variable*, unsigned> mInputNumbers;
+    llvm::DenseMap<Variable*, unsigned> mOutputNumbers;
+    llvm::DenseSet<Variable*> mLocalSet;
+
     Location* mEntry;
     Location* mExit;
 
@@ -456,12 +542,29 @@ public:
     Cfa* getMainAutomaton() const { return mMainAutomaton; }
     void setMainAutomaton(Cfa* cfa);
 
+    /// Removes the automata for which \p p returns true. The removed automata
+    /// must not be the main automaton, nor be called by the remaining ones.
+    template<class Predicate>
+    void removeAutomataIf(Predicate p)
+    {
+        mAutomata.erase(
+            std::remove_if(mAutomata.begin(), mAutomata.end(), [this, &p](std::unique_ptr<Cfa>& cfa) {
+                if (p(cfa.get())) {
+                    assert(cfa.get() != mMainAutomaton && "Cannot remove the main automaton!");
+                    return true;
+                }
+                return false;
+            }),
+            mAutomata.end()
+        );
+    }
+
     void print(llvm::raw_ostream& os) const;
 
 private:
     GazerContext& mContext;
     std::vector<std::unique_ptr<Cfa>> mAutomata;
-    Cfa* mMainAutomaton;
+    Cfa* mMainAutomaton = nullptr;
 };
 
 inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os, const Transition& transition)
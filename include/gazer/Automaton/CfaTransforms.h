@@ -27,6 +27,8 @@
 #include <llvm/ADT/StringRef.h>
 #include <llvm/ADT/DenseMap.h>
 
+#include <functional>
+
 namespace gazer
 {
 
@@ -52,6 +54,110 @@ struct RecursiveToCyclicResult
 /// transformed into the input format of a different verifier.
 RecursiveToCyclicResult TransformRecursiveToCyclic(Cfa* cfa);
 
+//===----------------------------------------------------------------------===//
+struct LargeBlockEncodingResult
+{
+    unsigned NumMergedLocations = 0;
+    unsigned NumFoldedEdges = 0;
+};
+
+/// Applies large-block encoding to the given CFA. Locations with a single
+/// incoming and a single outgoing assign transition are eliminated by merging
+/// the two transitions, and parallel assign transitions with complementary
+/// guards are folded into a single transition with conditional assignments.
+/// Locations for which \p keep returns true are never eliminated, allowing
+/// clients to preserve the locations referenced by traceability information.
+/// The entry, exit and error locations are always kept.
+/// The automaton must be acyclic, i.e. it may not be transformed by
+/// TransformRecursiveToCyclic before.
+LargeBlockEncodingResult TransformLargeBlockEncoding(
+    Cfa* cfa, std::function<bool(Location*)> keep = nullptr
+);
+
+//===----------------------------------------------------------------------===//
+struct ConeOfInfluenceResult
+{
+    unsigned NumRemovedAssignments = 0;
+    unsigned NumRemovedVariables = 0;
+};
+
+/// Removes the variables of the given system which cannot influence the
+/// guards of the transitions or the error codes of the error locations.
+/// Assignments to such variables are deleted, along with their call arguments
+/// and the locals, inputs and outputs they occupied. The interface of the
+/// main automaton is left intact.
+ConeOfInfluenceResult TransformConeOfInfluence(AutomataSystem& system);
+
+//===----------------------------------------------------------------------===//
+struct DeadAssignmentResult
+{
+    unsigned NumRemovedAssignments = 0;
+    unsigned NumRemovedVariables = 0;
+};
+
+/// Removes the assignments whose value is never read afterwards, according
+/// to a backward liveness analysis of the given CFA, and the locals which are
+/// not used anymore. The outputs of the automaton are live on its exit, the
+/// error codes on the error locations. Variables for which \p keep returns
+/// true are always considered live.
+DeadAssignmentResult TransformDeadAssignmentElimination(
+    Cfa* cfa, std::function<bool(Variable*)> keep = nullptr
+);
+
+//===----------------------------------------------------------------------===//
+struct IntervalSimplificationResult
+{
+    unsigned NumRemovedTransitions = 0;
+    unsigned NumRemovedLocations = 0;
+    unsigned NumSimplifiedGuards = 0;
+    unsigned NumInvariants = 0;
+};
+
+/// Simplifies the automata of \p system using the variable ranges calculated
+/// by an interval analysis. Transitions which can never be taken are removed
+/// along with the locations becoming unreachable, and guards which always
+/// hold are replaced by true. If \p addInvariants is set, the invariants of
+/// the loop heads are conjoined to the guards of their outgoing transitions,
+/// so that the verifiers may use them as assumptions.
+IntervalSimplificationResult TransformIntervalSimplification(
+    AutomataSystem& system, bool addInvariants = false
+);
+
+//===----------------------------------------------------------------------===//
+struct LoopAccelerationResult
+{
+    unsigned NumAcceleratedLoops = 0;
+};
+
+/// Accelerates the simple loops of the given cyclic CFA. A loop is accelerated
+/// if it is a single path of assign transitions, entered through one location
+/// and left from one location, which increments or decrements variables by
+/// loop-invariant values. The guards of the cycle must be linear comparisons
+/// over the incremented variables. Integer loops are replaced by a transition
+/// choosing a nondeterministic iteration count and assigning the closed-form
+/// values of the variables; the values entering the loop are renamed to new
+/// variables, so that the automaton stays in SSA form. On bit-vectors, the
+/// accelerated transition leads back to the loop entry and requires the
+/// comparisons to be free of overflows, while the original cycle is kept for
+/// the executions which overflow.
+LoopAccelerationResult TransformLoopAcceleration(Cfa* cfa);
+
+//===----------------------------------------------------------------------===//
+struct AutomataDeduplicationResult
+{
+    unsigned NumMergedAutomata = 0;
+    unsigned NumRedirectedCalls = 0;
+};
+
+/// Merges the structurally equivalent automata of \p system. Two automata
+/// are equivalent if they only differ in the names of their variables and
+/// locations: their interfaces have the same types, and their transitions,
+/// guards, assignments and error codes are equal over the variables in the
+/// same positions. Calls to a merged automaton are redirected to the kept
+/// one, which is the main automaton if it is in the class, otherwise the
+/// first one in the system.
+AutomataDeduplicationResult TransformAutomataDeduplication(AutomataSystem& system);
+
 //===----------------------------------------------------------------------===//
 struct InlineResult
 {
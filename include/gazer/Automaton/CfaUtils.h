@@ -21,39 +21,95 @@
 #include "gazer/Automaton/Cfa.h"
 
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/ArrayRef.h>
 
 namespace gazer
 {
 
 class ExprBuilder;
+class Valuation;
+
+/// The selector of a location on an encoded path, along with the information
+/// needed to decode it from a model.
+struct PredecessorSelector
+{
+    /// Evaluates to the identifier of the selected predecessor location under a model.
+    ExprPtr expr;
+
+    /// The incoming edges of the location within the encoded region, in selector order.
+    llvm::SmallVector<Transition*, 4> edges;
+
+    /// The variables of the selector: either an ordered one-hot set of booleans,
+    /// or a single bit-vector. Empty if the location has a single predecessor.
+    llvm::SmallVector<Variable*, 4> variables;
+
+    /// Returns the incoming edge selected by \p model, without evaluating \p expr.
+    /// Selector variables missing from the model are treated as false or zero.
+    Transition* decode(const Valuation& model) const;
+};
 
 /// Class for calculating verification path conditions.
+///
+/// If a predecessor callback is given, every location with multiple incoming
+/// edges receives a selector which identifies the predecessor taken on a path.
+/// Selectors are created once per location and reused on subsequent encodes.
+/// Locations with a small fan-in are encoded using an ordered one-hot set of
+/// boolean variables, others use a single bit-vector in binary encoding, thus
+/// no integer-sorted variables are introduced.
 class PathConditionCalculator
 {
+    /// The maximum fan-in for which one-hot selector encoding is used.
+    static constexpr size_t OneHotSelectorLimit = 4;
+
+    struct SelectorVariables
+    {
+        llvm::SmallVector<Variable*, 4> oneHot;
+        Variable* binary = nullptr;
+    };
+
 public:
     PathConditionCalculator(
         const std::vector<Location*>& topo,
         ExprBuilder& builder,
         std::function<size_t(Location*)> index,
         std::function<ExprPtr(CallTransition*)> calls,
-        std::function<void(Location*, Variable*, ExprPtr)> preds = nullptr
+        std::function<void(Location*, const PredecessorSelector&)> preds = nullptr
     );
 
 public:
     ExprPtr encode(Location* source, Location* target);
 
 private:
-    void insertPredecessor(Location* location, Variable* variable, ExprPtr expr);
+    /// Fills \p identifications with the formulas selecting each predecessor of \p loc,
+    /// and \p variables with the selector variables used by these formulas.
+    /// Returns the expression which evaluates to the identifier of the selected
+    /// predecessor location under a model.
+    ExprPtr encodeSelector(
+        Location* loc,
+        llvm::ArrayRef<std::pair<Transition*, size_t>> preds,
+        ExprVector& identifications,
+        llvm::SmallVectorImpl<Variable*>& variables
+    );
+
+    Variable* createSelectorVariable(Type& type);
 
 private:
     const std::vector<Location*>& mTopo;
     ExprBuilder& mExprBuilder;
     std::function<size_t(Location*)> mIndex;
     std::function<ExprPtr(CallTransition*)> mCalls;
-    std::function<void(Location*, Variable*, ExprPtr)> mPredecessors;
+    std::function<void(Location*, const PredecessorSelector&)> mPredecessors;
+    llvm::DenseMap<Location*, SelectorVariables> mSelectors;
     unsigned mPredIdx = 0;
 };
 
+/// Calculates a topological sort of the locations of \p cfa into \p topo.
+/// Locations which are not reachable from the entry are placed before it.
+/// Returns false if the automaton has a cycle.
+bool createTopologicalSort(Cfa* cfa, std::vector<Location*>& topo);
+
 /// Returns the lowest common dominator of each transition in \p targets.
 ///
 /// \param targets A set of target locations.
@@ -0,0 +1,184 @@
+//==- IntervalAnalysis.h - Interval abstract interpretation -----*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares an abstract interpreter calculating the possible
+/// ranges of integer, bit-vector and boolean variables in each location of
+/// an automata system.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_INTERVALANALYSIS_H
+#define GAZER_AUTOMATON_INTERVALANALYSIS_H
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+
+#include <limits>
+
+namespace gazer
+{
+
+class ExprBuilder;
+
+/// A closed interval of integers. Booleans are represented by the interval
+/// [0, 1], bit-vectors by their signed values. For mathematical integers,
+/// the minimum and maximum of int64_t stand for the infinite bounds.
+class Interval
+{
+public:
+    static constexpr int64_t Min = std::numeric_limits<int64_t>::min();
+    static constexpr int64_t Max = std::numeric_limits<int64_t>::max();
+
+    Interval()
+        : mLower(Min), mUpper(Max)
+    {}
+
+    Interval(int64_t lower, int64_t upper)
+        : mLower(lower), mUpper(upper)
+    {}
+
+    static Interval Constant(int64_t value) { return Interval(value, value); }
+    static Interval Empty() { return Interval(Max, Min); }
+
+    /// Returns true if the interval analysis tracks the values of \p type.
+    static bool isTracked(Type& type);
+
+    /// Returns the range of values of \p type, which must be tracked.
+    static Interval ForType(Type& type);
+
+    int64_t getLower() const { return mLower; }
+    int64_t getUpper() const { return mUpper; }
+
+    bool isEmpty() const { return mLower > mUpper; }
+    bool isConstant() const { return mLower == mUpper; }
+    bool contains(int64_t value) const { return mLower <= value && value <= mUpper; }
+
+    Interval join(const Interval& other) const;
+    Interval meet(const Interval& other) const;
+
+    /// Extrapolates the bounds which grew in \p next to infinity.
+    Interval widen(const Interval& next) const;
+
+    bool operator==(const Interval& other) const {
+        return mLower == other.mLower && mUpper == other.mUpper;
+    }
+    bool operator!=(const Interval& other) const { return !operator==(other); }
+
+    void print(llvm::raw_ostream& os) const;
+
+private:
+    int64_t mLower;
+    int64_t mUpper;
+};
+
+inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os, const Interval& interval)
+{
+    interval.print(os);
+    return os;
+}
+
+/// The abstract state of a location: the intervals of the tracked variables.
+/// Variables without an interval may take any value of their type.
+class IntervalState
+{
+public:
+    /// Returns the state in which no variable is constrained.
+    static IntervalState Top() { return IntervalState(true); }
+
+    /// Returns the state of unreachable locations.
+    static IntervalState Bottom() { return IntervalState(false); }
+
+    bool isBottom() const { return !mReachable; }
+
+    /// Returns the interval of \p variable, which must be of a tracked type.
+    Interval get(Variable* variable) const;
+
+    /// Sets the interval of \p variable. Assigning an empty interval turns
+    /// the whole state into bottom.
+    void set(Variable* variable, const Interval& interval);
+
+    void join(const IntervalState& other);
+
+    /// Widens the intervals of this state with the ones of \p next. The
+    /// bounds which are not stable are extrapolated to the type bounds.
+    void widen(const IntervalState& next);
+
+    bool operator==(const IntervalState& other) const;
+    bool operator!=(const IntervalState& other) const { return !operator==(other); }
+
+    using iterator = llvm::DenseMap<Variable*, Interval>::const_iterator;
+    iterator begin() const { return mIntervals.begin(); }
+    iterator end() const { return mIntervals.end(); }
+
+private:
+    explicit IntervalState(bool reachable)
+        : mReachable(reachable)
+    {}
+
+private:
+    bool mReachable;
+    llvm::DenseMap<Variable*, Interval> mIntervals;
+};
+
+/// Calculates the intervals of variables in each location of an automata
+/// system by abstract interpretation. Loops are handled by widening in their
+/// head locations, followed by a few descending iterations. Procedures are
+/// analyzed bottom-up in the call graph: a call transition assigns the
+/// intervals of the callee outputs, calculated without assumptions on the
+/// inputs. Calls within recursive procedures may return any value.
+///
+/// Each iteration of the analysis is linear in the size of the automaton.
+class IntervalAnalysis
+{
+public:
+    explicit IntervalAnalysis(AutomataSystem& system);
+
+    IntervalAnalysis(const IntervalAnalysis&) = delete;
+    IntervalAnalysis& operator=(const IntervalAnalysis&) = delete;
+
+    const IntervalState& getState(Location* location) const;
+
+    bool isReachable(Location* location) const { return !getState(location).isBottom(); }
+
+    /// Returns false if \p edge cannot be taken in any execution.
+    bool isFeasible(Transition* edge) const;
+
+    /// Returns true if the guard of \p edge holds whenever its source
+    /// location is reached.
+    bool isGuardValid(Transition* edge) const;
+
+    /// Returns true if widening was applied in \p location.
+    bool isLoopHead(Location* location) const { return mLoopHeads.count(location) != 0; }
+
+    /// Returns the conjunction of the non-trivial variable bounds holding in
+    /// \p location.
+    ExprPtr getInvariant(Location* location, ExprBuilder& builder) const;
+
+private:
+    void analyze(Cfa* cfa, const llvm::DenseSet<Cfa*>& recursive);
+
+private:
+    llvm::DenseMap<Location*, IntervalState> mStates;
+    llvm::DenseMap<Cfa*, IntervalState> mSummaries;
+    llvm::DenseSet<Location*> mLoopHeads;
+};
+
+} // end namespace gazer
+
+#endif
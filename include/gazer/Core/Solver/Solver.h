@@ -60,6 +60,23 @@ public:
     virtual SolverStatus run() = 0;
     virtual Valuation getModel() = 0;
 
+    /// Checks the satisfiability of the current constraints along with the
+    /// given boolean assumptions. The assumptions only hold for this query.
+    virtual SolverStatus run(const ExprVector& assumptions) = 0;
+
+    /// Returns a subset of the assumptions of the last run(assumptions) call
+    /// which is sufficient to prove unsatisfiability. The result is only
+    /// meaningful if that call returned UNSAT.
+    virtual ExprVector getUnsatCore() = 0;
+
+    /// Interrupts a query running on another thread. The interrupted query returns UNKNOWN.
+    /// The interrupt stays in effect until clearInterrupt() is called: queries started
+    /// in the meantime return UNKNOWN immediately.
+    virtual void interrupt() = 0;
+
+    /// Clears a previous interrupt, allowing new queries to run.
+    virtual void clearInterrupt() = 0;
+
     virtual void reset() = 0;
 
     virtual void push() = 0;
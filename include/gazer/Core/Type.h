@@ -286,13 +286,12 @@ public:
         return TupleType::Get(subtypeList);
     }
 
+    static TupleType& Get(std::vector<Type*> subtypes);
+
     static bool classof(const Type* type) {
         return type->getTypeID() == TupleTypeID;
     }
 
-private:
-    static TupleType& Get(std::vector<Type*> subtypes);
-
 private:
     std::vector<Type*> mSubtypeList;
 };
@@ -0,0 +1,74 @@
+//==- AutomataCache.h - On-disk cache of translated automata ----*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_LLVM_AUTOMATON_AUTOMATACACHE_H
+#define GAZER_LLVM_AUTOMATON_AUTOMATACACHE_H
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/LLVM/LLVMFrontendSettings.h"
+
+#include <llvm/ADT/DenseMap.h>
+
+namespace llvm
+{
+    class Module;
+}
+
+namespace gazer
+{
+
+class CheckRegistry;
+
+/// An on-disk cache of the automata systems translated from LLVM modules.
+/// Entries are keyed on the hash of the input module bitcode and the
+/// translation settings. As a cached run skips the instrumentation, the
+/// messages of the checks are stored along with the system.
+///
+/// The CfaToLLVMTrace mapping of the system refers to the values of the
+/// transformed LLVM module, which is not available in a cached run. Thus
+/// the cache must not be used if error traces or test harnesses are needed.
+class AutomataCache
+{
+public:
+    /// Creates a cache entry for \p module in \p directory. The entry key
+    /// is calculated from the current state of the module, thus the cache
+    /// must be created before running the transformation pipeline.
+    AutomataCache(llvm::StringRef directory, const llvm::Module& module, const LLVMFrontendSettings& settings);
+
+    AutomataCache(const AutomataCache&) = delete;
+    AutomataCache& operator=(const AutomataCache&) = delete;
+
+    llvm::StringRef getPath() const { return mPath; }
+
+    /// Loads the cached automata system into \p context, and the messages
+    /// of its error codes into \p messages.
+    /// \return The cached system, or nullptr on a cache miss.
+    std::unique_ptr<AutomataSystem> load(
+        GazerContext& context, llvm::DenseMap<unsigned, std::string>& messages) const;
+
+    /// Writes \p system and the messages of \p checks into the cache.
+    /// \return True if the entry was written successfully.
+    bool store(AutomataSystem& system, const CheckRegistry& checks) const;
+
+private:
+    std::string mDirectory;
+    std::string mPath;
+};
+
+} // end namespace gazer
+
+#endif
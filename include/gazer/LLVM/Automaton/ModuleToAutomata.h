@@ -24,8 +24,10 @@
 #include "gazer/LLVM/LLVMFrontendSettings.h"
 #include "gazer/LLVM/LLVMTraceBuilder.h"
 
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Pass.h>
 
+#include <chrono>
 #include <variant>
 
 namespace llvm
@@ -160,6 +162,21 @@ private:
     llvm::DenseMap<const Cfa*, ValueMappingInfo> mValueMaps;
 };
 
+// Profiling
+//==------------------------------------------------------------------------==//
+
+/// Time spent in the phases of the module to automata translation.
+struct CfaTranslationTimings
+{
+    using Duration = std::chrono::microseconds;
+
+    /// The phases of the translation, in the order of their execution.
+    std::vector<std::pair<std::string, Duration>> Phases;
+
+    /// The encoding time of each automaton, keyed by the automaton names.
+    llvm::StringMap<Duration> Encoding;
+};
+
 // LLVM pass
 //==------------------------------------------------------------------------==//
 
@@ -184,11 +201,13 @@ public:
     AutomataSystem& getSystem() { return *mSystem; }
     llvm::DenseMap<llvm::Value*, Variable*>& getVariableMap() { return mVariables; }
     CfaToLLVMTrace& getTraceInfo() { return mTraceInfo; }
+    const CfaTranslationTimings& getTimings() const { return mTimings; }
 
 private:
     std::unique_ptr<AutomataSystem> mSystem;
     llvm::DenseMap<llvm::Value*, Variable*> mVariables;
     CfaToLLVMTrace mTraceInfo;
+    CfaTranslationTimings mTimings;
     GazerContext& mContext;
     LLVMFrontendSettings mSettings;
 };
@@ -200,13 +219,19 @@ std::unique_ptr<AutomataSystem> translateModuleToAutomata(
     GazerContext& context,
     MemoryModel& memoryModel,
     llvm::DenseMap<llvm::Value*, Variable*>& variables,
-    CfaToLLVMTrace& blockEntries
+    CfaToLLVMTrace& blockEntries,
+    CfaTranslationTimings* timings = nullptr
 );
 
 llvm::Pass* createCfaPrinterPass();
 
 llvm::Pass* createCfaViewerPass();
 
+/// Creates a pass which prints the size metrics of each automaton and the
+/// time spent in the translation phases as JSON. The automata are also ranked
+/// by each cost metric, listing the \p topN most expensive ones.
+llvm::Pass* createCfaStatisticsPass(unsigned topN);
+
 }
 
 #endif //GAZER_MODULETOAUTOMATA_H
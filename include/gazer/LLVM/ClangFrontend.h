@@ -30,8 +30,13 @@ namespace llvm
 namespace gazer
 {
 
-/// Compiles a set of C and/or LLVM bitcode files using clang, links them
-/// together with llvm-link and parses the resulting module.
+/// Compiles a set of C and/or LLVM bitcode files and links them together.
+///
+/// If gazer was built with the clang libraries, C files are compiled
+/// in-process, otherwise by a clang process. The modules are linked in
+/// memory. With the -clang-subprocess option, the inputs are compiled and
+/// linked by clang and llvm-link processes through temporary files instead.
+/// The -j option sets the number of input files compiled concurrently.
 std::unique_ptr<llvm::Module> ClangCompileAndLink(
     llvm::ArrayRef<std::string> files,
     llvm::LLVMContext& llvmContext
@@ -121,6 +121,9 @@ public:
     llvm::Value* createCheckViolation(Check* check, llvm::DebugLoc loc);
 
     std::string messageForCode(unsigned ec) const;
+
+    /// Returns the error codes of all check violations created so far.
+    std::vector<unsigned> getErrorCodes() const;
 private:
     llvm::LLVMContext& mLlvmContext;
     std::vector<Check*> mChecks;
@@ -18,6 +18,7 @@
 #ifndef GAZER_LLVM_LLVMFRONTEND_H
 #define GAZER_LLVM_LLVMFRONTEND_H
 
+#include "gazer/LLVM/Automaton/AutomataCache.h"
 #include "gazer/LLVM/Instrumentation/Check.h"
 #include "gazer/LLVM/LLVMFrontendSettings.h"
 #include "gazer/Verifier/VerificationAlgorithm.h"
@@ -68,20 +69,44 @@ public:
         mBackendAlgorithm.reset(backend);
     }
 
-    /// Runs the registered LLVM pass pipeline.
+    /// Runs the registered LLVM pass pipeline. If the automata cache is
+    /// enabled and holds the translation of the input module, the backend
+    /// is executed on the cached system instead.
     void run();
 
     GazerContext& getContext() const { return mContext; }
     const CheckRegistry& getChecks() const { return mChecks; }
     llvm::Module& getModule() const { return *mModule; }
 
+    /// Returns the result of the verification backend,
+    /// or nullptr if no backend was executed.
+    VerificationResult* getResult() const { return mResult.get(); }
+
 private:
     //---------------------- Individual pipeline steps ---------------------//
     void registerEnabledChecks();
     void registerEarlyOptimizations();
-    void registerLateOptimizations();
+    void registerLateOptimizations(llvm::legacy::PassManager& pm);
     void registerInlining();
 
+    bool isSplitChecksEnabled() const {
+        return mSettings.splitChecks && mBackendAlgorithm != nullptr;
+    }
+
+    /// Verifies each check in a separate worker process, running the
+    /// check-specific part of the pipeline on a slice of the module.
+    /// The results of the workers are merged into a single report.
+    void runCheckWorkers();
+
+    bool isCacheEnabled() const {
+        return !mSettings.cfaCacheDirectory.empty() && mBackendAlgorithm != nullptr
+            && !mSettings.trace && mSettings.testHarnessFile.empty() && !isSplitChecksEnabled();
+    }
+
+    /// Runs the backend on the cached automata system of the input module.
+    /// \return False on a cache miss.
+    bool runFromCache();
+
 private:
     GazerContext& mContext;
     std::unique_ptr<llvm::Module> mModule;
@@ -89,8 +114,16 @@ private:
     CheckRegistry mChecks;
     llvm::legacy::PassManager mPassManager;
 
+    // In split-checks mode, this pass manager holds the part of the pipeline
+    // which is executed separately for each check.
+    llvm::legacy::PassManager mCheckPassManager;
+    std::unique_ptr<VerificationResult> mResult = nullptr;
+
     LLVMFrontendSettings mSettings;
     std::unique_ptr<VerificationAlgorithm> mBackendAlgorithm = nullptr; 
+
+    std::unique_ptr<AutomataCache> mCache = nullptr;
+    std::unique_ptr<AutomataSystem> mCachedSystem = nullptr;
 };
 
 }
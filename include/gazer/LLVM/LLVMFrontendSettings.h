@@ -89,12 +89,26 @@ public:
     bool liftAsserts = true;
     bool slicing = true;
 
+    // Check splitting
+    bool splitChecks = false;
+    unsigned checkWorkers = 0;
+
+    // Directory of the translated automata cache, empty if disabled.
+    std::string cfaCacheDirectory;
+
     // IR translation
     ElimVarsLevel elimVars = ElimVarsLevel::Off;
     LoopRepresentation loops = LoopRepresentation::Recursion;
     IntRepresentation ints = IntRepresentation::BitVectors;
     FloatRepresentation floats = FloatRepresentation::Fpa;
     bool simplifyExpr = true;
+    bool coneOfInfluence = false;
+    bool deadAssignments = false;
+    bool largeBlockEncoding = false;
+    bool dedupAutomata = false;
+    bool loopAcceleration = false;
+    bool intervalSimplification = false;
+    bool intervalInvariants = false;
 
     // Memory models
     bool debugDumpMemorySSA = false;
@@ -55,6 +55,11 @@ private:
 
 llvm::Pass* createBackwardSlicerPass(std::function<bool(llvm::Instruction*)> criteria);
 
+/// Removes all check violations from the module, except the ones with the error
+/// code \p errorCode, then slices each procedure which may reach the remaining
+/// violations with respect to them.
+llvm::Pass* createCheckSlicerPass(unsigned errorCode);
+
 } // end namespace gazer
 
 #endif
\ No newline at end of file
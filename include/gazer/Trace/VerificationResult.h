@@ -20,6 +20,7 @@
 
 #include "gazer/Trace/Trace.h"
 #include <llvm/ADT/Twine.h>
+#include <llvm/ADT/iterator_range.h>
 
 namespace gazer
 {
@@ -61,27 +62,54 @@ private:
     std::string mMessage;
 };
 
+/// Represents a failed verification run. A fail result contains one or more
+/// violated checks, each identified by its error code and an optional trace.
 class FailResult final : public VerificationResult
 {
 public:
+    struct Violation
+    {
+        unsigned errorCode;
+        std::unique_ptr<Trace> trace;
+    };
+
     explicit FailResult(
         unsigned errorCode,
         std::unique_ptr<Trace> trace = nullptr
-    ) : VerificationResult(VerificationResult::Fail), mErrorID(errorCode),
-        mTrace(std::move(trace))
-    {}
+    ) : VerificationResult(VerificationResult::Fail)
+    {
+        mViolations.push_back({errorCode, std::move(trace)});
+    }
+
+    explicit FailResult(std::vector<Violation> violations)
+        : VerificationResult(VerificationResult::Fail), mViolations(std::move(violations))
+    {
+        assert(!mViolations.empty() && "A fail result must contain at least one violation!");
+    }
 
-    [[nodiscard]] bool hasTrace() const { return mTrace != nullptr; }
-    [[nodiscard]] Trace& getTrace() const { return *mTrace; }
-    [[nodiscard]] unsigned getErrorID() const { return mErrorID; }
+    // The functions below refer to the first violation found.
+    [[nodiscard]] bool hasTrace() const { return mViolations.front().trace != nullptr; }
+    [[nodiscard]] Trace& getTrace() const { return *mViolations.front().trace; }
+    [[nodiscard]] unsigned getErrorID() const { return mViolations.front().errorCode; }
+
+    /// Releases the ownership of the first violation's trace.
+    std::unique_ptr<Trace> takeTrace() { return std::move(mViolations.front().trace); }
+
+    [[nodiscard]] size_t getNumViolations() const { return mViolations.size(); }
+
+    using violation_iterator = std::vector<Violation>::const_iterator;
+    violation_iterator violation_begin() const { return mViolations.begin(); }
+    violation_iterator violation_end() const { return mViolations.end(); }
+    llvm::iterator_range<violation_iterator> violations() const {
+        return llvm::make_range(violation_begin(), violation_end());
+    }
 
     static bool classof(const VerificationResult* result) {
         return result->getStatus() == VerificationResult::Fail;
     }
 
 private:
-    unsigned mErrorID;
-    std::unique_ptr<Trace> mTrace;
+    std::vector<Violation> mViolations;
 };
 
 } // end namespace gazer
@@ -31,6 +31,15 @@ namespace gazer
 class Location;
 class SolverFactory;
 class AutomataSystem;
+class CallTransition;
+
+/// Describes how the bound of the model checker grows between iterations.
+enum class BoundStrategy
+{
+    Linear,     ///< Increase the bound by one.
+    Geometric,  ///< Double the bound.
+    Adaptive    ///< Take larger steps while iterations are cheap and many calls stay open.
+};
 
 struct BmcSettings
 {
@@ -49,8 +58,78 @@ struct BmcSettings
     unsigned maxBound;
     unsigned eagerUnroll;
     bool simplifyExpr;
+
+    /// The bound growth strategy. With non-linear strategies, counterexamples
+    /// found by a large step are minimized in a backoff phase.
+    BoundStrategy boundStrategy;
+
+    /// With the adaptive strategy, iterations faster than this (in milliseconds)
+    /// are considered too shallow and are followed by a larger step.
+    unsigned adaptiveRoundTime;
+
+    /// Continue the search after finding a violation, reporting
+    /// every violated check instead of only the first one.
+    bool allErrors;
+
+    /// Over-approximate open calls with inferred procedure summaries
+    /// instead of havocing their outputs.
+    bool procedureSummaries;
+
+    /// Prove procedures error-free bottom-up before the analysis. The error
+    /// locations of such procedures are not connected when they are inlined.
+    bool proveErrorFreedom;
+
+    /// The maximum number of calls inlined in a single iteration, 0 if unlimited.
+    unsigned inlineTopK;
+
+    /// Solve the under- and over-approximation of an iteration concurrently,
+    /// using two solver instances.
+    bool concurrentApprox;
+
+    /// Split each query into 2^cubeDepth cubes over the path selectors, and solve
+    /// them in parallel worker processes. Disabled if zero.
+    unsigned cubeDepth;
+
+    /// The maximum number of concurrent cube workers, 0 to use all cores.
+    unsigned cubeWorkers;
+
+    /// Remove dead assignments from the main automaton at the start of each
+    /// bound, if calls were inlined since the previous one.
+    bool eliminateDeadAssignments;
 };
 
+/// Describes a call which is a candidate for inlining.
+struct InliningCandidate
+{
+    CallTransition* call;
+
+    /// The number of locations in the called automaton.
+    size_t calleeSize;
+
+    /// The number of times the called automaton occurs in the call chain of this call.
+    unsigned recursionDepth;
+
+    /// The number of over-approximated counterexamples which contained a call to the same automaton.
+    unsigned cexCount;
+
+    /// The estimated number of new terms in the verification condition after inlining.
+    size_t estimatedGrowth;
+};
+
+/// Ranks the calls which may be inlined by the bounded model checker.
+class InliningPolicy
+{
+public:
+    /// Returns the priority of \p candidate. Calls with a higher priority are inlined first.
+    virtual double getPriority(const InliningCandidate& candidate) = 0;
+
+    virtual ~InliningPolicy() = default;
+};
+
+/// Returns the default inlining policy, which prefers small callees with a shallow
+/// recursion depth, which frequently occur in counterexamples.
+std::unique_ptr<InliningPolicy> createDefaultInliningPolicy();
+
 class BoundedModelChecker : public VerificationAlgorithm
 {
 public:
@@ -58,6 +137,10 @@ public:
         : mSolverFactory(solverFactory), mSettings(settings)
     {}
 
+    void setInliningPolicy(std::unique_ptr<InliningPolicy> policy) {
+        mInliningPolicy = std::move(policy);
+    }
+
     std::unique_ptr<VerificationResult> check(
         AutomataSystem& system,
         CfaTraceBuilder& traceBuilder
@@ -66,6 +149,7 @@ public:
 private:
     SolverFactory& mSolverFactory;
     BmcSettings mSettings;
+    std::unique_ptr<InliningPolicy> mInliningPolicy;
 };
 
 }
@@ -0,0 +1,75 @@
+//==- ErrorFreedom.h - Procedure error-freedom proofs -----------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a bottom-up analysis which proves that some
+/// procedures of an automata system can never reach an error location.
+///
+/// Procedures are visited in callee-first order. A procedure is error-free
+/// if each of its callees is error-free, and none of its own error locations
+/// are reachable with each call over-approximated by a havoc of its outputs.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_ERRORFREEDOM_H
+#define GAZER_VERIFIER_ERRORFREEDOM_H
+
+#include <llvm/ADT/DenseSet.h>
+
+namespace gazer
+{
+
+class AutomataSystem;
+class Cfa;
+class ExprBuilder;
+class SolverFactory;
+
+class ErrorFreedomAnalysis
+{
+public:
+    ErrorFreedomAnalysis(AutomataSystem& system, ExprBuilder& builder, SolverFactory& solverFactory)
+        : mSystem(system), mExprBuilder(builder), mSolverFactory(solverFactory)
+    {}
+
+    /// Returns true if no error location is reachable in \p cfa, including
+    /// the ones of the procedures it calls. The proofs are calculated for the
+    /// procedures reachable from the main automaton on the first request.
+    bool isErrorFree(Cfa* cfa);
+
+    unsigned getNumChecked() const { return mNumChecked; }
+    unsigned getNumErrorFree() const { return mErrorFree.size(); }
+
+private:
+    void calculate();
+
+    /// Checks the error locations of \p cfa, assuming that the procedures
+    /// currently marked as error-free are indeed so.
+    bool check(Cfa* cfa);
+
+private:
+    AutomataSystem& mSystem;
+    ExprBuilder& mExprBuilder;
+    SolverFactory& mSolverFactory;
+
+    bool mCalculated = false;
+    llvm::DenseSet<Cfa*> mErrorFree;
+
+    unsigned mNumChecked = 0;
+};
+
+} // end namespace gazer
+
+#endif
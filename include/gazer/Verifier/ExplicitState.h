@@ -0,0 +1,90 @@
+//==- ExplicitState.h - Explicit-state model checking -----------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares an explicit-state reachability engine for
+/// automata over small finite domains.
+///
+/// The engine enumerates the reachable states of the main automaton in its
+/// cyclic form, without calling a solver. A state is the current location
+/// and the values of all variables, packed into a compact bit vector, and
+/// the visited states are stored in a hash set. Nondeterministic values are
+/// enumerated, thus they must be booleans or narrow bit-vectors.
+///
+/// The automaton is executed with the semantics of the cut point system
+/// used by the k-induction and PDR engines: loop-carried variables are read
+/// from the state before the transition entering a loop head, other
+/// variables keep their values until they are assigned again.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_EXPLICITSTATE_H
+#define GAZER_VERIFIER_EXPLICITSTATE_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+enum class SearchOrder
+{
+    BreadthFirst,   ///< Finds the shortest counterexamples.
+    DepthFirst      ///< Usually needs less memory.
+};
+
+struct ExplicitStateSettings
+{
+    // Environment
+    bool trace = false;
+
+    // Algorithm settings
+    SearchOrder searchOrder = SearchOrder::BreadthFirst;
+
+    /// The widest bit-vector whose nondeterministic values are enumerated.
+    unsigned maxNondetWidth = 8;
+
+    /// The memory available for the visited states, in megabytes.
+    unsigned memoryLimit = 1024;
+};
+
+/// Explicit-state reachability checking for automata over small domains.
+///
+/// If the automaton is not supported (it has calls, unsupported expressions,
+/// or nondeterministic values of large domains), or the visited states do
+/// not fit into the memory limit, the check is delegated to the fallback
+/// algorithm. Without a fallback, the result is unknown.
+class ExplicitStateChecker : public VerificationAlgorithm
+{
+public:
+    explicit ExplicitStateChecker(
+        ExplicitStateSettings settings,
+        std::unique_ptr<VerificationAlgorithm> fallback = nullptr
+    ) : mSettings(settings), mFallback(std::move(fallback))
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    ExplicitStateSettings mSettings;
+    std::unique_ptr<VerificationAlgorithm> mFallback;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,86 @@
+//==- KInduction.h - K-induction engine interface ---------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares the k-induction verification backend.
+///
+/// The engine works on the main automaton in its cyclic form (see
+/// TransformRecursiveToCyclic). Locations which are targets of a back-edge
+/// (loop heads) and the entry location are used as cut points: a single step
+/// of the induction is a loop-free path between two cut points, or between
+/// a cut point and an error location.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_KINDUCTION_H
+#define GAZER_VERIFIER_KINDUCTION_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+#include <functional>
+
+namespace gazer
+{
+
+class Location;
+class SolverFactory;
+
+struct KInductionSettings
+{
+    // Debug
+    bool dumpFormula = false;
+    bool printSolverStats = false;
+
+    // Algorithm settings
+    unsigned maxBound = 100;
+    bool trace = false;
+    bool simplifyExpr = true;
+
+    /// Require the states of the inductive step to be pairwise distinct.
+    bool simplePath = true;
+};
+
+class KInductionChecker : public VerificationAlgorithm
+{
+public:
+    /// Returns the candidate invariants of a given loop head. Candidates are
+    /// expressions over the variables of the main automaton. They are checked
+    /// before they are used to strengthen the inductive step, candidates which
+    /// are not inductive are discarded.
+    using InvariantGenerator = std::function<ExprVector(Location*)>;
+
+    KInductionChecker(SolverFactory& solverFactory, KInductionSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    void setInvariantGenerator(InvariantGenerator generator) {
+        mInvariants = std::move(generator);
+    }
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    SolverFactory& mSolverFactory;
+    KInductionSettings mSettings;
+    InvariantGenerator mInvariants;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,72 @@
+//==- Pdr.h - Property-directed reachability engine -------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares the property-directed reachability (IC3/PDR)
+/// verification backend.
+///
+/// Similarly to k-induction, the engine works on the cut point transition
+/// system of the cyclic main automaton. Frames are location-indexed: each
+/// lemma of a frame is a clause which holds in a particular cut point.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_PDR_H
+#define GAZER_VERIFIER_PDR_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+class SolverFactory;
+
+struct PdrSettings
+{
+    // Debug
+    bool dumpInvariant = false;
+    bool printSolverStats = false;
+
+    // Algorithm settings
+    unsigned maxFrames = 100;
+    bool simplifyExpr = true;
+    bool trace = false;
+
+    /// Try to drop literals from blocked cubes one-by-one, in addition to
+    /// the generalization given by unsat cores.
+    bool dropLiterals = true;
+};
+
+class PdrChecker : public VerificationAlgorithm
+{
+public:
+    PdrChecker(SolverFactory& solverFactory, PdrSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    SolverFactory& mSolverFactory;
+    PdrSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
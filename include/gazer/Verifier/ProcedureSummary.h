@@ -0,0 +1,103 @@
+//==- ProcedureSummary.h - Procedure summary inference ----------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a cache of procedure summaries. A summary of an
+/// automaton is a relation between its inputs and outputs, which holds for
+/// each execution reaching its exit location. Summaries are inferred from a
+/// fixed set of candidate relations in a Houdini-style fixpoint: candidates
+/// which do not hold for the body of the automaton (assuming the current
+/// summaries of its callees) are dropped, until the remaining ones are
+/// inductive for the whole system.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_PROCEDURESUMMARY_H
+#define GAZER_VERIFIER_PROCEDURESUMMARY_H
+
+#include "gazer/Core/Expr.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+
+#include <vector>
+
+namespace gazer
+{
+
+class AutomataSystem;
+class Cfa;
+class CallTransition;
+class ExprBuilder;
+class Location;
+class SolverFactory;
+
+class ProcedureSummaryCache
+{
+public:
+    ProcedureSummaryCache(AutomataSystem& system, ExprBuilder& builder, SolverFactory& solverFactory)
+        : mSystem(system), mExprBuilder(builder), mSolverFactory(solverFactory)
+    {}
+
+    /// Returns the summary of \p cfa as an expression over its inputs and outputs.
+    /// Summaries of the whole system are calculated on the first request.
+    ExprPtr getSummary(Cfa* cfa);
+
+    /// Returns the summary of the automaton called by \p call, instantiated
+    /// with the arguments of the call.
+    ExprPtr getSummaryForCall(CallTransition* call);
+
+    unsigned getNumSummarized() const { return mNumSummarized; }
+    unsigned getNumCandidates() const { return mNumCandidates; }
+    unsigned getNumLemmas() const { return mNumLemmas; }
+
+private:
+    void calculate();
+
+    /// Returns the candidate relations of an automaton.
+    ExprVector createCandidates(Cfa* cfa);
+
+    /// Encodes the paths between the entry and exit locations of an automaton,
+    /// with each call replaced by the current summary of the callee.
+    ExprPtr encodeBody(Cfa* cfa);
+
+    ExprPtr conjunction(const ExprVector& ops);
+
+private:
+    AutomataSystem& mSystem;
+    ExprBuilder& mExprBuilder;
+    SolverFactory& mSolverFactory;
+
+    bool mCalculated = false;
+
+    /// The procedures we calculate summaries for.
+    std::vector<Cfa*> mProcedures;
+    llvm::DenseMap<Cfa*, std::vector<Location*>> mTopoSorts;
+
+    /// The candidates of each procedure which still may be a part of its summary.
+    llvm::DenseMap<Cfa*, ExprVector> mCandidates;
+
+    /// Procedures whose exit location is not reachable from their entry.
+    llvm::DenseSet<Cfa*> mNoReturn;
+
+    unsigned mNumSummarized = 0;
+    unsigned mNumCandidates = 0;
+    unsigned mNumLemmas = 0;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,70 @@
+//==- UnrollingBmc.h - Transition relation unrolling ------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a bounded model checker which works directly on
+/// the cyclic representation of the main automaton, without the call-based
+/// loop representation used by BoundedModelChecker.
+///
+/// A single step of the transition system is a loop-free segment of the cut
+/// point system (see KInduction.h). The transition relation is encoded once,
+/// then instantiated for each new time frame over a fresh copy of the state
+/// variables. Frames are added incrementally to the same solver instance.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_UNROLLINGBMC_H
+#define GAZER_VERIFIER_UNROLLINGBMC_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+class SolverFactory;
+
+struct UnrollingSettings
+{
+    // Debug
+    bool dumpFormula = false;
+    bool printSolverStats = false;
+
+    // Algorithm settings
+    unsigned maxBound = 100;
+    bool trace = false;
+    bool simplifyExpr = true;
+};
+
+class UnrollingChecker : public VerificationAlgorithm
+{
+public:
+    UnrollingChecker(SolverFactory& solverFactory, UnrollingSettings settings)
+        : mSolverFactory(solverFactory), mSettings(settings)
+    {}
+
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    ) override;
+
+private:
+    SolverFactory& mSolverFactory;
+    UnrollingSettings mSettings;
+};
+
+} // end namespace gazer
+
+#endif
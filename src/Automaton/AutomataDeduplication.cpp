@@ -0,0 +1,363 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Each automaton is summarized by a canonical signature: a sequence of
+// integers describing its interface, locations and transitions. Member
+// variables are identified by their positions in the input and local lists,
+// and locations by their positions in the location list, so the signature
+// does not depend on the names of either. Expressions are interned into a
+// table shared by all automata, thus structurally equal expressions over
+// equally positioned variables get the same identifier.
+//
+// Automata with equal signatures are merged. As merging redirects calls to
+// the representatives, the callers of merged automata may become equal as
+// well, thus the signatures are recalculated until no more merges happen.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/ExprTypes.h"
+
+#include <llvm/ADT/Hashing.h>
+
+#include <unordered_map>
+
+using namespace gazer;
+
+namespace
+{
+
+using Signature = std::vector<uint64_t>;
+
+struct SignatureHash
+{
+    size_t operator()(const Signature& signature) const
+    {
+        return llvm::hash_combine_range(signature.begin(), signature.end());
+    }
+};
+
+enum CallTarget : uint64_t
+{
+    Call_Self = 0,
+    Call_Other = 1
+};
+
+bool hasRoundingMode(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::FCast:
+        case Expr::SignedToFp:
+        case Expr::UnsignedToFp:
+        case Expr::FpToSigned:
+        case Expr::FpToUnsigned:
+        case Expr::FAdd:
+        case Expr::FSub:
+        case Expr::FMul:
+        case Expr::FDiv:
+            return true;
+        default:
+            return false;
+    }
+}
+
+llvm::APFloat::roundingMode getRoundingMode(const Expr* expr)
+{
+    switch (expr->getKind()) {
+        case Expr::FCast: return llvm::cast<FCastExpr>(expr)->getRoundingMode();
+        case Expr::SignedToFp: return llvm::cast<SignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::UnsignedToFp: return llvm::cast<UnsignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::FpToSigned: return llvm::cast<FpToSignedExpr>(expr)->getRoundingMode();
+        case Expr::FpToUnsigned: return llvm::cast<FpToUnsignedExpr>(expr)->getRoundingMode();
+        case Expr::FAdd: return llvm::cast<FAddExpr>(expr)->getRoundingMode();
+        case Expr::FSub: return llvm::cast<FSubExpr>(expr)->getRoundingMode();
+        case Expr::FMul: return llvm::cast<FMulExpr>(expr)->getRoundingMode();
+        case Expr::FDiv: return llvm::cast<FDivExpr>(expr)->getRoundingMode();
+        default:
+            break;
+    }
+
+    llvm_unreachable("Expression has no rounding mode!");
+}
+
+class AutomataDeduplication
+{
+public:
+    explicit AutomataDeduplication(AutomataSystem& system)
+        : mSystem(system)
+    {}
+
+    AutomataDeduplicationResult transform();
+
+private:
+    bool mergeEquivalentAutomata();
+    Signature computeSignature(Cfa& cfa);
+
+    uint64_t getExprId(const ExprPtr& root);
+    void addVariable(Signature& signature, Variable* variable);
+    void addAssignments(
+        Signature& signature,
+        llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns);
+
+private:
+    AutomataSystem& mSystem;
+    llvm::DenseMap<Cfa*, Cfa*> mMerged;
+
+    /// Structural expression nodes, shared by all automata.
+    std::unordered_map<Signature, uint64_t, SignatureHash> mNodeIds;
+
+    // The numbering of the automaton currently being summarized.
+    llvm::DenseMap<Variable*, uint64_t> mVariableIds;
+    llvm::DenseMap<Expr*, uint64_t> mExprIds;
+
+    AutomataDeduplicationResult mResult;
+};
+
+} // end anonymous namespace
+
+AutomataDeduplicationResult AutomataDeduplication::transform()
+{
+    while (this->mergeEquivalentAutomata()) {
+        // Merging may have made the callers of the merged automata equal.
+    }
+
+    if (!mMerged.empty()) {
+        mSystem.removeAutomataIf([this](Cfa* cfa) {
+            return mMerged.count(cfa) != 0;
+        });
+    }
+
+    return mResult;
+}
+
+bool AutomataDeduplication::mergeEquivalentAutomata()
+{
+    // The main automaton comes first, so it is always a representative.
+    std::vector<Cfa*> worklist;
+    if (mSystem.getMainAutomaton() != nullptr) {
+        worklist.push_back(mSystem.getMainAutomaton());
+    }
+
+    for (Cfa& cfa : mSystem) {
+        if (&cfa != mSystem.getMainAutomaton() && mMerged.count(&cfa) == 0) {
+            worklist.push_back(&cfa);
+        }
+    }
+
+    std::unordered_map<Signature, Cfa*, SignatureHash> classes;
+    bool changed = false;
+
+    for (Cfa* cfa : worklist) {
+        auto [it, inserted] = classes.try_emplace(this->computeSignature(*cfa), cfa);
+        if (!inserted) {
+            mMerged[cfa] = it->second;
+            ++mResult.NumMergedAutomata;
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return false;
+    }
+
+    for (Cfa* cfa : worklist) {
+        if (mMerged.count(cfa) != 0) {
+            continue;
+        }
+
+        for (auto& edge : cfa->edges()) {
+            auto call = llvm::dyn_cast<CallTransition>(edge.get());
+            if (call == nullptr || call->getSource() == nullptr) {
+                continue;
+            }
+
+            Cfa* representative = mMerged.lookup(call->getCalledAutomaton());
+            if (representative != nullptr) {
+                call->setCalledAutomaton(representative);
+                ++mResult.NumRedirectedCalls;
+            }
+        }
+    }
+
+    return true;
+}
+
+Signature AutomataDeduplication::computeSignature(Cfa& cfa)
+{
+    mVariableIds.clear();
+    mExprIds.clear();
+
+    Signature signature;
+    uint64_t numVariables = 0;
+
+    // Interface
+    signature.push_back(cfa.getNumInputs());
+    for (Variable& input : cfa.inputs()) {
+        mVariableIds[&input] = numVariables++;
+        signature.push_back(reinterpret_cast<uintptr_t>(&input.getType()));
+    }
+
+    signature.push_back(cfa.getNumLocals());
+    for (Variable& local : cfa.locals()) {
+        mVariableIds[&local] = numVariables++;
+        signature.push_back(reinterpret_cast<uintptr_t>(&local.getType()));
+    }
+
+    signature.push_back(cfa.getNumOutputs());
+    for (Variable& output : cfa.outputs()) {
+        this->addVariable(signature, &output);
+    }
+
+    // Locations
+    llvm::DenseMap<Location*, uint64_t> locationIds;
+    for (auto& location : cfa.nodes()) {
+        uint64_t id = locationIds.size();
+        locationIds[location.get()] = id;
+    }
+
+    signature.push_back(cfa.getNumLocations());
+    signature.push_back(locationIds[cfa.getEntry()]);
+    signature.push_back(locationIds[cfa.getExit()]);
+
+    for (auto& location : cfa.nodes()) {
+        signature.push_back(location->isError());
+        if (location->isError()) {
+            ExprPtr errorCode = cfa.getErrorFieldExpr(location.get());
+            signature.push_back(errorCode == nullptr ? 0 : this->getExprId(errorCode) + 1);
+        }
+
+        // Transitions are summarized in the order of the outgoing lists.
+        signature.push_back(location->getNumOutgoing());
+        for (Transition* edge : location->outgoing()) {
+            signature.push_back(locationIds[edge->getTarget()]);
+            signature.push_back(edge->getKind());
+            signature.push_back(this->getExprId(edge->getGuard()));
+
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                signature.push_back(assign->getNumAssignments());
+                this->addAssignments(signature, llvm::make_range(assign->begin(), assign->end()));
+            } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+                // Self-calls are compared regardless of the caller, so that
+                // equal recursive automata can be merged as well.
+                Cfa* callee = call->getCalledAutomaton();
+                if (callee == &cfa) {
+                    signature.push_back(Call_Self);
+                } else {
+                    signature.push_back(Call_Other);
+                    signature.push_back(reinterpret_cast<uintptr_t>(callee));
+                }
+
+                signature.push_back(call->getNumInputs());
+                for (const VariableAssignment& assign : call->inputs()) {
+                    signature.push_back(callee->getInputNumber(assign.getVariable()));
+                    signature.push_back(this->getExprId(assign.getValue()));
+                }
+
+                signature.push_back(call->getNumOutputs());
+                for (const VariableAssignment& assign : call->outputs()) {
+                    this->addVariable(signature, assign.getVariable());
+                    signature.push_back(this->getExprId(assign.getValue()));
+                }
+            }
+        }
+    }
+
+    return signature;
+}
+
+void AutomataDeduplication::addVariable(Signature& signature, Variable* variable)
+{
+    auto it = mVariableIds.find(variable);
+    if (it != mVariableIds.end()) {
+        signature.push_back(0);
+        signature.push_back(it->second);
+    } else {
+        // Variables which are not members of the automaton are kept as-is.
+        signature.push_back(1);
+        signature.push_back(reinterpret_cast<uintptr_t>(variable));
+    }
+}
+
+void AutomataDeduplication::addAssignments(
+    Signature& signature,
+    llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns)
+{
+    for (const VariableAssignment& assign : assigns) {
+        this->addVariable(signature, assign.getVariable());
+        signature.push_back(this->getExprId(assign.getValue()));
+    }
+}
+
+uint64_t AutomataDeduplication::getExprId(const ExprPtr& root)
+{
+    // Expressions may be deep, thus they are numbered in post-order
+    // using an explicit stack.
+    llvm::SmallVector<std::pair<Expr*, bool>, 16> worklist;
+    worklist.emplace_back(root.get(), false);
+
+    while (!worklist.empty()) {
+        auto [expr, expanded] = worklist.pop_back_val();
+        if (mExprIds.count(expr) != 0) {
+            continue;
+        }
+
+        auto nn = llvm::dyn_cast<NonNullaryExpr>(expr);
+        if (!expanded && nn != nullptr) {
+            worklist.emplace_back(expr, true);
+            for (const ExprPtr& op : nn->operands()) {
+                worklist.emplace_back(op.get(), false);
+            }
+            continue;
+        }
+
+        Signature node;
+        node.push_back(expr->getKind());
+        node.push_back(reinterpret_cast<uintptr_t>(&expr->getType()));
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+            this->addVariable(node, &varRef->getVariable());
+        } else if (nn == nullptr) {
+            // Literals and undefs are unique within their context.
+            node.push_back(reinterpret_cast<uintptr_t>(expr));
+        } else {
+            if (auto extract = llvm::dyn_cast<ExtractExpr>(expr)) {
+                node.push_back(extract->getOffset());
+                node.push_back(extract->getWidth());
+            } else if (auto tupleSel = llvm::dyn_cast<TupleSelectExpr>(expr)) {
+                node.push_back(tupleSel->getIndex());
+            } else if (hasRoundingMode(expr->getKind())) {
+                node.push_back(static_cast<uint64_t>(getRoundingMode(expr)));
+            }
+
+            for (const ExprPtr& op : nn->operands()) {
+                node.push_back(mExprIds[op.get()]);
+            }
+        }
+
+        uint64_t id = mNodeIds.size();
+        mExprIds[expr] = mNodeIds.try_emplace(std::move(node), id).first->second;
+    }
+
+    return mExprIds[root.get()];
+}
+
+AutomataDeduplicationResult gazer::TransformAutomataDeduplication(AutomataSystem& system)
+{
+    AutomataDeduplication dedup(system);
+    return dedup.transform();
+}
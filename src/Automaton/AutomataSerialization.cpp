@@ -0,0 +1,1262 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/AutomataSerialization.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+
+using namespace gazer;
+
+namespace
+{
+
+constexpr char Magic[] = { 'G', 'Z', 'A', 'S' };
+constexpr uint64_t MaxBvWidth = 1u << 24;
+
+enum LocationTag : uint8_t
+{
+    Tag_State = 0,
+    Tag_Error = 1
+};
+
+/// Returns the number of operands of a non-nullary expression kind,
+/// or zero for variadic kinds.
+unsigned getFixedNumOperands(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Not:
+        case Expr::ZExt:
+        case Expr::SExt:
+        case Expr::Extract:
+        case Expr::FIsNan:
+        case Expr::FIsInf:
+        case Expr::FCast:
+        case Expr::SignedToFp:
+        case Expr::UnsignedToFp:
+        case Expr::FpToSigned:
+        case Expr::FpToUnsigned:
+        case Expr::TupleSelect:
+            return 1;
+        case Expr::Select:
+        case Expr::ArrayWrite:
+            return 3;
+        case Expr::And:
+        case Expr::Or:
+        case Expr::TupleConstruct:
+            return 0;
+        default:
+            return 2;
+    }
+}
+
+bool hasRoundingMode(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::FCast:
+        case Expr::SignedToFp:
+        case Expr::UnsignedToFp:
+        case Expr::FpToSigned:
+        case Expr::FpToUnsigned:
+        case Expr::FAdd:
+        case Expr::FSub:
+        case Expr::FMul:
+        case Expr::FDiv:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Returns true if the operands (and the target type of casts) of a
+/// non-nullary expression satisfy the typing rules of the given kind,
+/// i.e. the expression factories can be invoked without tripping their
+/// assertions.
+bool hasValidOperandTypes(Expr::ExprKind kind, const ExprVector& ops, Type& type)
+{
+    auto bvWidth = [](const Type& ty) {
+        return llvm::cast<BvType>(ty).getWidth();
+    };
+
+    switch (kind) {
+        case Expr::Not:
+        case Expr::Xor:
+        case Expr::Imply:
+        case Expr::And:
+        case Expr::Or:
+            return std::all_of(ops.begin(), ops.end(), [](const ExprPtr& op) {
+                return op->getType().isBoolType();
+            });
+        case Expr::ZExt:
+        case Expr::SExt:
+            return ops[0]->getType().isBvType() && type.isBvType()
+                && bvWidth(type) > bvWidth(ops[0]->getType());
+        case Expr::Extract:
+        case Expr::TupleSelect:
+            // The attributes of these kinds are checked by the reader.
+            return true;
+        case Expr::Add:
+        case Expr::Sub:
+        case Expr::Mul:
+        case Expr::Mod:
+        case Expr::Rem: {
+            auto& opTy = ops[0]->getType();
+            return opTy == ops[1]->getType()
+                && (opTy.isBvType() || opTy.isIntType() || opTy.isRealType());
+        }
+        case Expr::Div:
+            return ops[0]->getType() == ops[1]->getType() && ops[0]->getType().isArithmetic();
+        case Expr::BvSDiv:
+        case Expr::BvUDiv:
+        case Expr::BvSRem:
+        case Expr::BvURem:
+        case Expr::Shl:
+        case Expr::LShr:
+        case Expr::AShr:
+        case Expr::BvAnd:
+        case Expr::BvOr:
+        case Expr::BvXor:
+        case Expr::BvSLt:
+        case Expr::BvSLtEq:
+        case Expr::BvSGt:
+        case Expr::BvSGtEq:
+        case Expr::BvULt:
+        case Expr::BvULtEq:
+        case Expr::BvUGt:
+        case Expr::BvUGtEq:
+            return ops[0]->getType() == ops[1]->getType() && ops[0]->getType().isBvType();
+        case Expr::BvConcat:
+            return ops[0]->getType().isBvType() && ops[1]->getType().isBvType();
+        case Expr::Eq:
+        case Expr::NotEq:
+        case Expr::Lt:
+        case Expr::LtEq:
+        case Expr::Gt:
+        case Expr::GtEq:
+            return ops[0]->getType() == ops[1]->getType();
+        case Expr::FIsNan:
+        case Expr::FIsInf:
+            return ops[0]->getType().isFloatType();
+        case Expr::FCast:
+            return ops[0]->getType().isFloatType() && type.isFloatType()
+                && ops[0]->getType() != type;
+        case Expr::SignedToFp:
+        case Expr::UnsignedToFp:
+            return ops[0]->getType().isBvType() && type.isFloatType();
+        case Expr::FpToSigned:
+        case Expr::FpToUnsigned:
+            return ops[0]->getType().isFloatType() && type.isBvType();
+        case Expr::FAdd:
+        case Expr::FSub:
+        case Expr::FMul:
+        case Expr::FDiv:
+            return ops[0]->getType().isFloatType() && ops[0]->getType() == ops[1]->getType();
+        case Expr::FEq:
+        case Expr::FGt:
+        case Expr::FGtEq:
+        case Expr::FLt:
+        case Expr::FLtEq:
+            return ops[0]->getType().isFloatType() && ops[1]->getType().isFloatType();
+        case Expr::Select:
+            return ops[0]->getType().isBoolType() && ops[1]->getType() == ops[2]->getType();
+        case Expr::ArrayRead:
+        case Expr::ArrayWrite: {
+            auto arrTy = llvm::dyn_cast<ArrayType>(&ops[0]->getType());
+            if (arrTy == nullptr || arrTy->getIndexType() != ops[1]->getType()) {
+                return false;
+            }
+            return kind == Expr::ArrayRead || arrTy->getElementType() == ops[2]->getType();
+        }
+        case Expr::TupleConstruct: {
+            auto tupTy = llvm::dyn_cast<TupleType>(&type);
+            if (tupTy == nullptr || tupTy->getNumSubtypes() != ops.size()) {
+                return false;
+            }
+            for (unsigned i = 0; i < ops.size(); ++i) {
+                if (tupTy->getTypeAtIndex(i) != ops[i]->getType()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case Expr::Undef:
+        case Expr::Literal:
+        case Expr::VarRef:
+            break;
+    }
+
+    return false;
+}
+
+llvm::APFloat::roundingMode getRoundingMode(const Expr* expr)
+{
+    switch (expr->getKind()) {
+        case Expr::FCast: return llvm::cast<FCastExpr>(expr)->getRoundingMode();
+        case Expr::SignedToFp: return llvm::cast<SignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::UnsignedToFp: return llvm::cast<UnsignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::FpToSigned: return llvm::cast<FpToSignedExpr>(expr)->getRoundingMode();
+        case Expr::FpToUnsigned: return llvm::cast<FpToUnsignedExpr>(expr)->getRoundingMode();
+        case Expr::FAdd: return llvm::cast<FAddExpr>(expr)->getRoundingMode();
+        case Expr::FSub: return llvm::cast<FSubExpr>(expr)->getRoundingMode();
+        case Expr::FMul: return llvm::cast<FMulExpr>(expr)->getRoundingMode();
+        case Expr::FDiv: return llvm::cast<FDivExpr>(expr)->getRoundingMode();
+        default:
+            break;
+    }
+
+    llvm_unreachable("Expression has no rounding mode!");
+}
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+class AutomataWriter
+{
+public:
+    AutomataWriter(AutomataSystem& system, llvm::raw_ostream& os)
+        : mSystem(system), mOS(os)
+    {}
+
+    void write();
+
+private:
+    void collect();
+    void addType(Type& type);
+    void addVariable(Variable* variable);
+    void addExpr(const ExprPtr& root);
+    void addAssignments(llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns);
+
+    void writeType(Type& type);
+    void writeExpr(Expr* expr);
+    void writeBody(Cfa& cfa);
+    void writeAssignments(llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns);
+
+    void writeNumber(uint64_t value) { llvm::encodeULEB128(value, mOS); }
+    void writeSigned(int64_t value) { llvm::encodeSLEB128(value, mOS); }
+    void writeString(llvm::StringRef str)
+    {
+        writeNumber(str.size());
+        mOS << str;
+    }
+    void writeAPInt(const llvm::APInt& value)
+    {
+        for (unsigned i = 0; i < value.getNumWords(); ++i) {
+            writeNumber(value.getRawData()[i]);
+        }
+    }
+
+private:
+    AutomataSystem& mSystem;
+    llvm::raw_ostream& mOS;
+
+    std::vector<Type*> mTypes;
+    llvm::DenseMap<Type*, unsigned> mTypeIds;
+    std::vector<Variable*> mVariables;
+    llvm::DenseMap<Variable*, unsigned> mVariableIds;
+    std::vector<Expr*> mExprs;
+    llvm::DenseMap<Expr*, unsigned> mExprIds;
+    llvm::DenseMap<Cfa*, unsigned> mAutomatonIds;
+};
+
+} // end anonymous namespace
+
+void AutomataWriter::addType(Type& type)
+{
+    if (mTypeIds.count(&type) != 0) {
+        return;
+    }
+
+    // Component types must precede their composite types in the table.
+    if (auto arrTy = llvm::dyn_cast<ArrayType>(&type)) {
+        addType(arrTy->getIndexType());
+        addType(arrTy->getElementType());
+    } else if (auto tupTy = llvm::dyn_cast<TupleType>(&type)) {
+        for (unsigned i = 0; i < tupTy->getNumSubtypes(); ++i) {
+            addType(tupTy->getTypeAtIndex(i));
+        }
+    }
+
+    mTypeIds[&type] = mTypes.size();
+    mTypes.push_back(&type);
+}
+
+void AutomataWriter::addVariable(Variable* variable)
+{
+    if (mVariableIds.count(variable) != 0) {
+        return;
+    }
+
+    addType(variable->getType());
+    mVariableIds[variable] = mVariables.size();
+    mVariables.push_back(variable);
+}
+
+void AutomataWriter::addExpr(const ExprPtr& root)
+{
+    // Expressions may be deep, thus they are numbered in post-order
+    // using an explicit stack.
+    llvm::SmallVector<std::pair<Expr*, bool>, 16> worklist;
+    worklist.emplace_back(root.get(), false);
+
+    while (!worklist.empty()) {
+        auto [expr, expanded] = worklist.pop_back_val();
+        if (mExprIds.count(expr) != 0) {
+            continue;
+        }
+
+        if (expanded) {
+            addType(expr->getType());
+            if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+                addVariable(&varRef->getVariable());
+            }
+
+            mExprIds[expr] = mExprs.size();
+            mExprs.push_back(expr);
+            continue;
+        }
+
+        worklist.emplace_back(expr, true);
+        if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+            for (const ExprPtr& op : nn->operands()) {
+                worklist.emplace_back(op.get(), false);
+            }
+        } else if (auto arrayLit = llvm::dyn_cast<ArrayLiteralExpr>(expr)) {
+            for (auto& [index, elem] : arrayLit->getMap()) {
+                worklist.emplace_back(index.get(), false);
+                worklist.emplace_back(elem.get(), false);
+            }
+            if (arrayLit->hasDefault()) {
+                worklist.emplace_back(arrayLit->getDefault().get(), false);
+            }
+        }
+    }
+}
+
+void AutomataWriter::addAssignments(
+    llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns)
+{
+    for (const VariableAssignment& assign : assigns) {
+        addVariable(assign.getVariable());
+        addExpr(assign.getValue());
+    }
+}
+
+void AutomataWriter::collect()
+{
+    // Member variables come first, so they are created by their automata.
+    for (Cfa& cfa : mSystem) {
+        unsigned id = mAutomatonIds.size();
+        mAutomatonIds[&cfa] = id;
+        for (Variable& input : cfa.inputs()) {
+            addVariable(&input);
+        }
+        for (Variable& local : cfa.locals()) {
+            addVariable(&local);
+        }
+    }
+
+    for (Cfa& cfa : mSystem) {
+        for (auto& [location, errorExpr] : cfa.errors()) {
+            addExpr(errorExpr);
+        }
+
+        for (auto& edge : cfa.edges()) {
+            if (edge->getSource() == nullptr) {
+                continue;
+            }
+
+            addExpr(edge->getGuard());
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge.get())) {
+                addAssignments(llvm::make_range(assign->begin(), assign->end()));
+            } else if (auto call = llvm::dyn_cast<CallTransition>(edge.get())) {
+                addAssignments(call->inputs());
+                addAssignments(call->outputs());
+            }
+        }
+    }
+}
+
+void AutomataWriter::writeType(Type& type)
+{
+    writeNumber(type.getTypeID());
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+        case Type::IntTypeID:
+        case Type::RealTypeID:
+            break;
+        case Type::BvTypeID:
+            writeNumber(llvm::cast<BvType>(type).getWidth());
+            break;
+        case Type::FloatTypeID:
+            writeNumber(llvm::cast<FloatType>(type).getPrecision());
+            break;
+        case Type::ArrayTypeID: {
+            auto& arrTy = llvm::cast<ArrayType>(type);
+            writeNumber(mTypeIds[&arrTy.getIndexType()]);
+            writeNumber(mTypeIds[&arrTy.getElementType()]);
+            break;
+        }
+        case Type::TupleTypeID: {
+            auto& tupTy = llvm::cast<TupleType>(type);
+            writeNumber(tupTy.getNumSubtypes());
+            for (unsigned i = 0; i < tupTy.getNumSubtypes(); ++i) {
+                writeNumber(mTypeIds[&tupTy.getTypeAtIndex(i)]);
+            }
+            break;
+        }
+    }
+}
+
+void AutomataWriter::writeExpr(Expr* expr)
+{
+    writeNumber(expr->getKind());
+    writeNumber(mTypeIds[&expr->getType()]);
+
+    switch (expr->getKind()) {
+        case Expr::Undef:
+            return;
+        case Expr::VarRef:
+            writeNumber(mVariableIds[&llvm::cast<VarRefExpr>(expr)->getVariable()]);
+            return;
+        case Expr::Literal:
+            switch (expr->getType().getTypeID()) {
+                case Type::BoolTypeID:
+                    writeNumber(llvm::cast<BoolLiteralExpr>(expr)->getValue());
+                    return;
+                case Type::IntTypeID:
+                    writeSigned(llvm::cast<IntLiteralExpr>(expr)->getValue());
+                    return;
+                case Type::RealTypeID: {
+                    auto value = llvm::cast<RealLiteralExpr>(expr)->getValue();
+                    writeSigned(value.numerator());
+                    writeSigned(value.denominator());
+                    return;
+                }
+                case Type::BvTypeID:
+                    writeAPInt(llvm::cast<BvLiteralExpr>(expr)->getValue());
+                    return;
+                case Type::FloatTypeID:
+                    writeAPInt(llvm::cast<FloatLiteralExpr>(expr)->getValue().bitcastToAPInt());
+                    return;
+                case Type::ArrayTypeID: {
+                    auto arrayLit = llvm::cast<ArrayLiteralExpr>(expr);
+                    writeNumber(arrayLit->getMap().size());
+                    for (auto& [index, elem] : arrayLit->getMap()) {
+                        writeNumber(mExprIds[index.get()]);
+                        writeNumber(mExprIds[elem.get()]);
+                    }
+                    writeNumber(arrayLit->hasDefault() ? mExprIds[arrayLit->getDefault().get()] + 1 : 0);
+                    return;
+                }
+                case Type::TupleTypeID:
+                    break;
+            }
+            llvm_unreachable("Unknown literal expression type!");
+        default:
+            break;
+    }
+
+    auto nn = llvm::cast<NonNullaryExpr>(expr);
+    if (getFixedNumOperands(expr->getKind()) == 0) {
+        writeNumber(nn->getNumOperands());
+    }
+    for (const ExprPtr& op : nn->operands()) {
+        writeNumber(mExprIds[op.get()]);
+    }
+
+    if (auto extract = llvm::dyn_cast<ExtractExpr>(expr)) {
+        writeNumber(extract->getOffset());
+        writeNumber(extract->getExtractedWidth());
+    } else if (auto select = llvm::dyn_cast<TupleSelectExpr>(expr)) {
+        writeNumber(select->getIndex());
+    } else if (hasRoundingMode(expr->getKind())) {
+        writeNumber(static_cast<uint64_t>(getRoundingMode(expr)));
+    }
+}
+
+void AutomataWriter::writeAssignments(
+    llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns)
+{
+    writeNumber(std::distance(assigns.begin(), assigns.end()));
+    for (const VariableAssignment& assign : assigns) {
+        writeNumber(mVariableIds[assign.getVariable()]);
+        writeNumber(mExprIds[assign.getValue().get()]);
+    }
+}
+
+void AutomataWriter::writeBody(Cfa& cfa)
+{
+    // The entry and exit locations are always the first two ones.
+    llvm::DenseMap<Location*, unsigned> locationIds;
+    locationIds[cfa.getEntry()] = 0;
+    locationIds[cfa.getExit()] = 1;
+
+    std::vector<Location*> locations;
+    for (auto& loc : cfa.nodes()) {
+        if (loc.get() != cfa.getEntry() && loc.get() != cfa.getExit()) {
+            locationIds[loc.get()] = locations.size() + 2;
+            locations.push_back(loc.get());
+        }
+    }
+
+    writeNumber(locations.size());
+    for (Location* loc : locations) {
+        writeNumber(loc->isError() ? Tag_Error : Tag_State);
+    }
+
+    writeNumber(cfa.getNumErrors());
+    for (auto& [location, errorExpr] : cfa.errors()) {
+        writeNumber(locationIds[location]);
+        writeNumber(mExprIds[errorExpr.get()]);
+    }
+
+    std::vector<Transition*> edges;
+    for (auto& edge : cfa.edges()) {
+        if (edge->getSource() != nullptr) {
+            edges.push_back(edge.get());
+        }
+    }
+
+    writeNumber(edges.size());
+    for (Transition* edge : edges) {
+        writeNumber(edge->getKind());
+        writeNumber(locationIds[edge->getSource()]);
+        writeNumber(locationIds[edge->getTarget()]);
+        writeNumber(mExprIds[edge->getGuard().get()]);
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            writeAssignments(llvm::make_range(assign->begin(), assign->end()));
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            writeNumber(mAutomatonIds[call->getCalledAutomaton()]);
+            writeAssignments(call->inputs());
+            writeAssignments(call->outputs());
+        }
+    }
+}
+
+void AutomataWriter::write()
+{
+    this->collect();
+
+    mOS.write(Magic, sizeof(Magic));
+    writeNumber(AutomataFormatVersion);
+
+    writeNumber(mTypes.size());
+    for (Type* type : mTypes) {
+        writeType(*type);
+    }
+
+    writeNumber(mVariables.size());
+    for (Variable* variable : mVariables) {
+        writeString(variable->getName());
+        writeNumber(mTypeIds[&variable->getType()]);
+    }
+
+    writeNumber(mSystem.getNumAutomata());
+    for (Cfa& cfa : mSystem) {
+        writeString(cfa.getName());
+
+        writeNumber(cfa.getNumInputs());
+        for (Variable& input : cfa.inputs()) {
+            writeNumber(mVariableIds[&input]);
+        }
+        writeNumber(cfa.getNumLocals());
+        for (Variable& local : cfa.locals()) {
+            writeNumber(mVariableIds[&local]);
+        }
+        writeNumber(cfa.getNumOutputs());
+        for (Variable& output : cfa.outputs()) {
+            writeNumber(mVariableIds[&output]);
+        }
+    }
+
+    writeNumber(mExprs.size());
+    for (Expr* expr : mExprs) {
+        writeExpr(expr);
+    }
+
+    for (Cfa& cfa : mSystem) {
+        writeBody(cfa);
+    }
+
+    Cfa* main = mSystem.getMainAutomaton();
+    writeNumber(main != nullptr ? mAutomatonIds[main] + 1 : 0);
+}
+
+void gazer::WriteAutomataSystem(AutomataSystem& system, llvm::raw_ostream& os)
+{
+    AutomataWriter writer(system, os);
+    writer.write();
+}
+
+//===----------------------------------------------------------------------===//
+// Reader
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+
+class AutomataReader
+{
+public:
+    AutomataReader(llvm::StringRef buffer, GazerContext& context)
+        : mCurrent(buffer.bytes_begin()), mEnd(buffer.bytes_end()),
+        mContext(context), mBuilder(CreateExprBuilder(context))
+    {}
+
+    std::unique_ptr<AutomataSystem> read();
+
+private:
+    bool readHeader();
+    bool readTypes();
+    bool readVariables();
+    bool readInterfaces(AutomataSystem& system);
+    bool readExprs();
+    bool readBody(Cfa* cfa);
+
+    Type* readType();
+    ExprPtr readExpr();
+    ExprPtr readLiteral(Type& type);
+    ExprPtr readNonNullary(Expr::ExprKind kind, Type& type);
+    bool readAssignments(std::vector<VariableAssignment>& assigns);
+
+    // Primitive readers. On failure, they set the failure flag and return
+    // a default value, so the callers only need to check the flag.
+    uint64_t readNumber();
+    int64_t readSigned();
+    uint64_t readCount();
+    llvm::StringRef readString();
+    llvm::APInt readAPInt(unsigned width);
+
+    template<class T>
+    T* readRef(const std::vector<T*>& table)
+    {
+        uint64_t idx = readNumber();
+        if (idx >= table.size() || table[idx] == nullptr) {
+            mFailed = true;
+            return nullptr;
+        }
+        return table[idx];
+    }
+
+    ExprPtr readExprRef()
+    {
+        uint64_t idx = readNumber();
+        if (idx >= mExprs.size()) {
+            mFailed = true;
+            return nullptr;
+        }
+        return mExprs[idx];
+    }
+
+private:
+    const uint8_t* mCurrent;
+    const uint8_t* mEnd;
+    bool mFailed = false;
+
+    GazerContext& mContext;
+    std::unique_ptr<ExprBuilder> mBuilder;
+
+    std::vector<Type*> mTypes;
+    std::vector<std::pair<std::string, Type*>> mVariableDecls;
+    std::vector<Variable*> mVariables;
+    std::vector<Cfa*> mVariableOwners;
+    std::vector<ExprPtr> mExprs;
+    std::vector<Cfa*> mAutomata;
+};
+
+} // end anonymous namespace
+
+uint64_t AutomataReader::readNumber()
+{
+    if (mFailed) {
+        return 0;
+    }
+
+    unsigned length;
+    const char* error = nullptr;
+    uint64_t value = llvm::decodeULEB128(mCurrent, &length, mEnd, &error);
+    if (error != nullptr) {
+        mFailed = true;
+        return 0;
+    }
+
+    mCurrent += length;
+    return value;
+}
+
+int64_t AutomataReader::readSigned()
+{
+    if (mFailed) {
+        return 0;
+    }
+
+    unsigned length;
+    const char* error = nullptr;
+    int64_t value = llvm::decodeSLEB128(mCurrent, &length, mEnd, &error);
+    if (error != nullptr) {
+        mFailed = true;
+        return 0;
+    }
+
+    mCurrent += length;
+    return value;
+}
+
+uint64_t AutomataReader::readCount()
+{
+    // Each element takes at least one byte, which bounds the allocations
+    // made for corrupted inputs.
+    uint64_t count = readNumber();
+    if (count > static_cast<uint64_t>(mEnd - mCurrent)) {
+        mFailed = true;
+        return 0;
+    }
+
+    return count;
+}
+
+llvm::StringRef AutomataReader::readString()
+{
+    uint64_t length = readCount();
+    if (mFailed) {
+        return "";
+    }
+
+    llvm::StringRef result(reinterpret_cast<const char*>(mCurrent), length);
+    mCurrent += length;
+
+    return result;
+}
+
+llvm::APInt AutomataReader::readAPInt(unsigned width)
+{
+    llvm::SmallVector<uint64_t, 2> words;
+    for (unsigned i = 0; i < llvm::APInt::getNumWords(width); ++i) {
+        words.push_back(readNumber());
+    }
+
+    return llvm::APInt(width, words);
+}
+
+bool AutomataReader::readHeader()
+{
+    if (static_cast<size_t>(mEnd - mCurrent) < sizeof(Magic)
+        || !std::equal(std::begin(Magic), std::end(Magic), mCurrent)
+    ) {
+        return false;
+    }
+    mCurrent += sizeof(Magic);
+
+    return readNumber() == AutomataFormatVersion && !mFailed;
+}
+
+Type* AutomataReader::readType()
+{
+    switch (readNumber()) {
+        case Type::BoolTypeID: return &BoolType::Get(mContext);
+        case Type::IntTypeID: return &IntType::Get(mContext);
+        case Type::RealTypeID: return &RealType::Get(mContext);
+        case Type::BvTypeID: {
+            uint64_t width = readNumber();
+            if (width == 0 || width > MaxBvWidth) {
+                return nullptr;
+            }
+            return &BvType::Get(mContext, width);
+        }
+        case Type::FloatTypeID:
+            switch (readNumber()) {
+                case FloatType::Half: return &FloatType::Get(mContext, FloatType::Half);
+                case FloatType::Single: return &FloatType::Get(mContext, FloatType::Single);
+                case FloatType::Double: return &FloatType::Get(mContext, FloatType::Double);
+                case FloatType::Quad: return &FloatType::Get(mContext, FloatType::Quad);
+                default:
+                    return nullptr;
+            }
+        case Type::ArrayTypeID: {
+            Type* indexTy = readRef(mTypes);
+            Type* elemTy = readRef(mTypes);
+            if (mFailed) {
+                return nullptr;
+            }
+            return &ArrayType::Get(*indexTy, *elemTy);
+        }
+        case Type::TupleTypeID: {
+            std::vector<Type*> subtypes(readCount());
+            for (Type*& subtype : subtypes) {
+                subtype = readRef(mTypes);
+                if (mFailed || subtype->isTupleType()) {
+                    return nullptr;
+                }
+            }
+            if (subtypes.size() < 2) {
+                return nullptr;
+            }
+            return &TupleType::Get(subtypes);
+        }
+        default:
+            return nullptr;
+    }
+}
+
+bool AutomataReader::readTypes()
+{
+    uint64_t numTypes = readCount();
+    for (uint64_t i = 0; i < numTypes && !mFailed; ++i) {
+        Type* type = readType();
+        if (type == nullptr) {
+            return false;
+        }
+        mTypes.push_back(type);
+    }
+
+    return !mFailed;
+}
+
+bool AutomataReader::readVariables()
+{
+    uint64_t numVariables = readCount();
+    for (uint64_t i = 0; i < numVariables && !mFailed; ++i) {
+        std::string name = readString().str();
+        Type* type = readRef(mTypes);
+        mVariableDecls.emplace_back(std::move(name), type);
+    }
+
+    mVariables.resize(mVariableDecls.size(), nullptr);
+    mVariableOwners.resize(mVariableDecls.size(), nullptr);
+
+    return !mFailed;
+}
+
+bool AutomataReader::readInterfaces(AutomataSystem& system)
+{
+    uint64_t numAutomata = readCount();
+    for (uint64_t i = 0; i < numAutomata && !mFailed; ++i) {
+        std::string name = readString().str();
+        if (mFailed || system.getAutomatonByName(name) != nullptr) {
+            return false;
+        }
+
+        Cfa* cfa = system.createCfa(name);
+        mAutomata.push_back(cfa);
+
+        // Member variables are created through their automaton, which
+        // prefixes them with its name again.
+        auto createMember = [this, cfa](bool input) {
+            uint64_t idx = readNumber();
+            if (mFailed || idx >= mVariables.size() || mVariables[idx] != nullptr) {
+                mFailed = true;
+                return;
+            }
+
+            auto& [fullName, type] = mVariableDecls[idx];
+            std::string prefix = cfa->getName().str() + "/";
+            llvm::StringRef symbolName = fullName;
+            symbolName.consume_front(prefix);
+
+            mVariables[idx] = input
+                ? cfa->createInput(symbolName.str(), *type)
+                : cfa->createLocal(symbolName.str(), *type);
+            mVariableOwners[idx] = cfa;
+        };
+
+        for (uint64_t j = 0, e = readCount(); j < e && !mFailed; ++j) {
+            createMember(true);
+        }
+        for (uint64_t j = 0, e = readCount(); j < e && !mFailed; ++j) {
+            createMember(false);
+        }
+        for (uint64_t j = 0, e = readCount(); j < e && !mFailed; ++j) {
+            uint64_t idx = readNumber();
+            if (idx >= mVariables.size() || mVariableOwners[idx] != cfa) {
+                return false;
+            }
+            cfa->addOutput(mVariables[idx]);
+        }
+    }
+
+    if (mFailed) {
+        return false;
+    }
+
+    // The remaining variables do not belong to any automaton.
+    for (size_t i = 0; i < mVariables.size(); ++i) {
+        if (mVariables[i] == nullptr) {
+            auto& [name, type] = mVariableDecls[i];
+            if (mContext.getVariable(name) != nullptr) {
+                return false;
+            }
+            mVariables[i] = mContext.createVariable(name, *type);
+        }
+    }
+
+    return true;
+}
+
+ExprPtr AutomataReader::readLiteral(Type& type)
+{
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return mBuilder->BoolLit(readNumber() != 0);
+        case Type::IntTypeID:
+            return mBuilder->IntLit(readSigned());
+        case Type::RealTypeID: {
+            int64_t num = readSigned();
+            int64_t denom = readSigned();
+            if (denom <= 0) {
+                return nullptr;
+            }
+            return RealLiteralExpr::Get(llvm::cast<RealType>(type), num, denom);
+        }
+        case Type::BvTypeID:
+            return mBuilder->BvLit(readAPInt(llvm::cast<BvType>(type).getWidth()));
+        case Type::FloatTypeID: {
+            auto& fltTy = llvm::cast<FloatType>(type);
+            return mBuilder->FloatLit(llvm::APFloat(fltTy.getLLVMSemantics(), readAPInt(fltTy.getWidth())));
+        }
+        case Type::ArrayTypeID: {
+            auto& arrTy = llvm::cast<ArrayType>(type);
+            ArrayLiteralExpr::MappingT values;
+            for (uint64_t i = 0, e = readCount(); i < e && !mFailed; ++i) {
+                ExprPtr index = readExprRef();
+                ExprPtr elem = readExprRef();
+                if (mFailed || !llvm::isa<LiteralExpr>(index.get()) || !llvm::isa<LiteralExpr>(elem.get())) {
+                    return nullptr;
+                }
+                values[expr_cast<LiteralExpr>(index)] = expr_cast<LiteralExpr>(elem);
+            }
+
+            ExprRef<LiteralExpr> elze = nullptr;
+            if (uint64_t defaultIdx = readNumber(); defaultIdx != 0) {
+                if (defaultIdx > mExprs.size() || !llvm::isa<LiteralExpr>(mExprs[defaultIdx - 1].get())) {
+                    return nullptr;
+                }
+                elze = expr_cast<LiteralExpr>(mExprs[defaultIdx - 1]);
+            }
+
+            return ArrayLiteralExpr::Get(arrTy, values, elze);
+        }
+        case Type::TupleTypeID:
+            break;
+    }
+
+    return nullptr;
+}
+
+ExprPtr AutomataReader::readNonNullary(Expr::ExprKind kind, Type& type)
+{
+    uint64_t numOps = getFixedNumOperands(kind);
+    if (numOps == 0) {
+        uint64_t minOps = kind == Expr::TupleConstruct ? 2 : 1;
+        numOps = readCount();
+        if (numOps < minOps) {
+            return nullptr;
+        }
+    }
+
+    ExprVector ops;
+    for (uint64_t i = 0; i < numOps && !mFailed; ++i) {
+        ops.push_back(readExprRef());
+    }
+
+    uint64_t offset = 0, width = 0;
+    if (kind == Expr::Extract || kind == Expr::TupleSelect) {
+        offset = readNumber();
+        width = kind == Expr::Extract ? readNumber() : 0;
+    }
+
+    llvm::APFloat::roundingMode rm = llvm::APFloat::rmNearestTiesToEven;
+    if (hasRoundingMode(kind)) {
+        uint64_t rmValue = readNumber();
+        if (rmValue > static_cast<uint64_t>(llvm::APFloat::rmNearestTiesToAway)) {
+            return nullptr;
+        }
+        rm = static_cast<llvm::APFloat::roundingMode>(rmValue);
+    }
+
+    if (mFailed) {
+        return nullptr;
+    }
+
+    // Check the operand types and attributes which would otherwise trip the
+    // assertions of the expression factories.
+    if (!hasValidOperandTypes(kind, ops, type)) {
+        return nullptr;
+    }
+
+    if (kind == Expr::Extract) {
+        auto opTy = llvm::dyn_cast<BvType>(&ops[0]->getType());
+        if (opTy == nullptr || width == 0 || offset + width > opTy->getWidth()) {
+            return nullptr;
+        }
+    } else if (kind == Expr::TupleSelect) {
+        auto opTy = llvm::dyn_cast<TupleType>(&ops[0]->getType());
+        if (opTy == nullptr || offset >= opTy->getNumSubtypes()) {
+            return nullptr;
+        }
+    }
+
+    auto bvTy = llvm::dyn_cast<BvType>(&type);
+    auto fltTy = llvm::dyn_cast<FloatType>(&type);
+
+    switch (kind) {
+        case Expr::Not: return mBuilder->Not(ops[0]);
+        case Expr::ZExt: return bvTy ? mBuilder->ZExt(ops[0], *bvTy) : nullptr;
+        case Expr::SExt: return bvTy ? mBuilder->SExt(ops[0], *bvTy) : nullptr;
+        case Expr::Extract: return mBuilder->Extract(ops[0], offset, width);
+        case Expr::Add: return mBuilder->Add(ops[0], ops[1]);
+        case Expr::Sub: return mBuilder->Sub(ops[0], ops[1]);
+        case Expr::Mul: return mBuilder->Mul(ops[0], ops[1]);
+        case Expr::Div: return mBuilder->Div(ops[0], ops[1]);
+        case Expr::Mod: return mBuilder->Mod(ops[0], ops[1]);
+        case Expr::Rem: return mBuilder->Rem(ops[0], ops[1]);
+        case Expr::BvSDiv: return mBuilder->BvSDiv(ops[0], ops[1]);
+        case Expr::BvUDiv: return mBuilder->BvUDiv(ops[0], ops[1]);
+        case Expr::BvSRem: return mBuilder->BvSRem(ops[0], ops[1]);
+        case Expr::BvURem: return mBuilder->BvURem(ops[0], ops[1]);
+        case Expr::Shl: return mBuilder->Shl(ops[0], ops[1]);
+        case Expr::LShr: return mBuilder->LShr(ops[0], ops[1]);
+        case Expr::AShr: return mBuilder->AShr(ops[0], ops[1]);
+        case Expr::BvAnd: return mBuilder->BvAnd(ops[0], ops[1]);
+        case Expr::BvOr: return mBuilder->BvOr(ops[0], ops[1]);
+        case Expr::BvXor: return mBuilder->BvXor(ops[0], ops[1]);
+        case Expr::BvConcat: return mBuilder->BvConcat(ops[0], ops[1]);
+        case Expr::And: return mBuilder->And(ops);
+        case Expr::Or: return mBuilder->Or(ops);
+        case Expr::Xor: return mBuilder->Xor(ops[0], ops[1]);
+        case Expr::Imply: return mBuilder->Imply(ops[0], ops[1]);
+        case Expr::Eq: return mBuilder->Eq(ops[0], ops[1]);
+        case Expr::NotEq: return mBuilder->NotEq(ops[0], ops[1]);
+        case Expr::Lt: return mBuilder->Lt(ops[0], ops[1]);
+        case Expr::LtEq: return mBuilder->LtEq(ops[0], ops[1]);
+        case Expr::Gt: return mBuilder->Gt(ops[0], ops[1]);
+        case Expr::GtEq: return mBuilder->GtEq(ops[0], ops[1]);
+        case Expr::BvSLt: return mBuilder->BvSLt(ops[0], ops[1]);
+        case Expr::BvSLtEq: return mBuilder->BvSLtEq(ops[0], ops[1]);
+        case Expr::BvSGt: return mBuilder->BvSGt(ops[0], ops[1]);
+        case Expr::BvSGtEq: return mBuilder->BvSGtEq(ops[0], ops[1]);
+        case Expr::BvULt: return mBuilder->BvULt(ops[0], ops[1]);
+        case Expr::BvULtEq: return mBuilder->BvULtEq(ops[0], ops[1]);
+        case Expr::BvUGt: return mBuilder->BvUGt(ops[0], ops[1]);
+        case Expr::BvUGtEq: return mBuilder->BvUGtEq(ops[0], ops[1]);
+        case Expr::FIsNan: return mBuilder->FIsNan(ops[0]);
+        case Expr::FIsInf: return mBuilder->FIsInf(ops[0]);
+        case Expr::FCast: return fltTy ? mBuilder->FCast(ops[0], *fltTy, rm) : nullptr;
+        case Expr::SignedToFp: return fltTy ? mBuilder->SignedToFp(ops[0], *fltTy, rm) : nullptr;
+        case Expr::UnsignedToFp: return fltTy ? mBuilder->UnsignedToFp(ops[0], *fltTy, rm) : nullptr;
+        case Expr::FpToSigned: return bvTy ? mBuilder->FpToSigned(ops[0], *bvTy, rm) : nullptr;
+        case Expr::FpToUnsigned: return bvTy ? mBuilder->FpToUnsigned(ops[0], *bvTy, rm) : nullptr;
+        case Expr::FAdd: return mBuilder->FAdd(ops[0], ops[1], rm);
+        case Expr::FSub: return mBuilder->FSub(ops[0], ops[1], rm);
+        case Expr::FMul: return mBuilder->FMul(ops[0], ops[1], rm);
+        case Expr::FDiv: return mBuilder->FDiv(ops[0], ops[1], rm);
+        case Expr::FEq: return mBuilder->FEq(ops[0], ops[1]);
+        case Expr::FGt: return mBuilder->FGt(ops[0], ops[1]);
+        case Expr::FGtEq: return mBuilder->FGtEq(ops[0], ops[1]);
+        case Expr::FLt: return mBuilder->FLt(ops[0], ops[1]);
+        case Expr::FLtEq: return mBuilder->FLtEq(ops[0], ops[1]);
+        case Expr::Select: return mBuilder->Select(ops[0], ops[1], ops[2]);
+        case Expr::ArrayRead: return mBuilder->Read(ops[0], ops[1]);
+        case Expr::ArrayWrite: return mBuilder->Write(ops[0], ops[1], ops[2]);
+        case Expr::TupleSelect: return TupleSelectExpr::Create(ops[0], offset);
+        case Expr::TupleConstruct: {
+            auto tupTy = llvm::dyn_cast<TupleType>(&type);
+            return tupTy ? TupleConstructExpr::Create(*tupTy, ops) : nullptr;
+        }
+        case Expr::Undef:
+        case Expr::Literal:
+        case Expr::VarRef:
+            break;
+    }
+
+    llvm_unreachable("Invalid non-nullary expression kind.");
+}
+
+ExprPtr AutomataReader::readExpr()
+{
+    uint64_t kind = readNumber();
+    Type* type = readRef(mTypes);
+    if (mFailed || kind > Expr::TupleConstruct) {
+        return nullptr;
+    }
+
+    ExprPtr result;
+    switch (kind) {
+        case Expr::Undef:
+            result = mBuilder->Undef(*type);
+            break;
+        case Expr::VarRef:
+            if (Variable* variable = readRef(mVariables)) {
+                result = variable->getRefExpr();
+            }
+            break;
+        case Expr::Literal:
+            result = readLiteral(*type);
+            break;
+        default:
+            result = readNonNullary(static_cast<Expr::ExprKind>(kind), *type);
+            break;
+    }
+
+    // The builder is not folding, thus the expressions must be rebuilt
+    // exactly in their recorded form.
+    if (mFailed || result == nullptr || &result->getType() != type || result->getKind() != kind) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+bool AutomataReader::readExprs()
+{
+    uint64_t numExprs = readCount();
+    for (uint64_t i = 0; i < numExprs && !mFailed; ++i) {
+        ExprPtr expr = readExpr();
+        if (expr == nullptr) {
+            return false;
+        }
+        mExprs.push_back(expr);
+    }
+
+    return !mFailed;
+}
+
+bool AutomataReader::readAssignments(std::vector<VariableAssignment>& assigns)
+{
+    for (uint64_t i = 0, e = readCount(); i < e && !mFailed; ++i) {
+        Variable* variable = readRef(mVariables);
+        ExprPtr value = readExprRef();
+        if (mFailed || &variable->getType() != &value->getType()) {
+            return false;
+        }
+        assigns.emplace_back(variable, value);
+    }
+
+    return !mFailed;
+}
+
+bool AutomataReader::readBody(Cfa* cfa)
+{
+    std::vector<Location*> locations = { cfa->getEntry(), cfa->getExit() };
+    for (uint64_t i = 0, e = readCount(); i < e && !mFailed; ++i) {
+        switch (readNumber()) {
+            case Tag_State: locations.push_back(cfa->createLocation()); break;
+            case Tag_Error: locations.push_back(cfa->createErrorLocation()); break;
+            default:
+                return false;
+        }
+    }
+
+    for (uint64_t i = 0, e = readCount(); i < e && !mFailed; ++i) {
+        Location* location = readRef(locations);
+        ExprPtr errorExpr = readExprRef();
+        if (mFailed || !location->isError()) {
+            return false;
+        }
+        cfa->addErrorCode(location, errorExpr);
+    }
+
+    for (uint64_t i = 0, e = readCount(); i < e && !mFailed; ++i) {
+        uint64_t kind = readNumber();
+        Location* source = readRef(locations);
+        Location* target = readRef(locations);
+        ExprPtr guard = readExprRef();
+        if (mFailed || !guard->getType().isBoolType()) {
+            return false;
+        }
+
+        std::vector<VariableAssignment> assigns;
+        switch (kind) {
+            case Transition::Edge_Assign:
+                if (!readAssignments(assigns)) {
+                    return false;
+                }
+                cfa->createAssignTransition(source, target, guard, assigns);
+                break;
+            case Transition::Edge_Call: {
+                Cfa* callee = readRef(mAutomata);
+                std::vector<VariableAssignment> outputs;
+                if (mFailed || !readAssignments(assigns) || !readAssignments(outputs)) {
+                    return false;
+                }
+                // The arguments must match the interface of the callee.
+                if (assigns.size() != callee->getNumInputs() || outputs.size() != callee->getNumOutputs()) {
+                    return false;
+                }
+                llvm::SmallPtrSet<Variable*, 8> bound;
+                for (const VariableAssignment& assign : assigns) {
+                    if (!callee->isInput(assign.getVariable()) || !bound.insert(assign.getVariable()).second) {
+                        return false;
+                    }
+                }
+                for (const VariableAssignment& assign : outputs) {
+                    auto varRef = llvm::dyn_cast<VarRefExpr>(assign.getValue().get());
+                    if (varRef == nullptr || !callee->isOutput(&varRef->getVariable())
+                        || !bound.insert(&varRef->getVariable()).second) {
+                        return false;
+                    }
+                }
+                cfa->createCallTransition(source, target, guard, callee, assigns, outputs);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return !mFailed;
+}
+
+std::unique_ptr<AutomataSystem> AutomataReader::read()
+{
+    auto system = std::make_unique<AutomataSystem>(mContext);
+
+    if (!readHeader() || !readTypes() || !readVariables()
+        || !readInterfaces(*system) || !readExprs()
+    ) {
+        return nullptr;
+    }
+
+    for (Cfa* cfa : mAutomata) {
+        if (!readBody(cfa)) {
+            return nullptr;
+        }
+    }
+
+    uint64_t mainIdx = readNumber();
+    if (mFailed || mainIdx > mAutomata.size() || mCurrent != mEnd) {
+        return nullptr;
+    }
+
+    if (mainIdx != 0) {
+        system->setMainAutomaton(mAutomata[mainIdx - 1]);
+    }
+
+    return system;
+}
+
+std::unique_ptr<AutomataSystem> gazer::ReadAutomataSystem(llvm::StringRef buffer, GazerContext& context)
+{
+    AutomataReader reader(buffer, context);
+    return reader.read();
+}
@@ -133,6 +133,7 @@ ExprPtr Cfa::getErrorFieldExpr(Location* location)
 Variable *Cfa::createInput(const std::string& name, Type& type)
 {
     Variable* variable = this->createMemberVariable(name, type);
+    mInputNumbers[variable] = mInputs.size();
     mInputs.push_back(variable);
 
     return variable;
@@ -140,6 +141,7 @@ Variable *Cfa::createInput(const std::string& name, Type& type)
 
 void Cfa::addOutput(Variable* variable)
 {
+    mOutputNumbers[variable] = mOutputs.size();
     mOutputs.push_back(variable);
 }
 
@@ -147,6 +149,7 @@ Variable *Cfa::createLocal(const std::string& name, Type& type)
 {
     Variable* variable = this->createMemberVariable(name, type);
     mLocals.push_back(variable);
+    mLocalSet.insert(variable);
 
     return variable;
 }
@@ -166,28 +169,43 @@ Variable *Cfa::createMemberVariable(const std::string& name, Type &type)
     return variable;
 }
 
+void Cfa::renumberVariables(
+    const std::vector<Variable*>& variables, llvm::DenseMap<Variable*, unsigned>& numbers
+) {
+    numbers.clear();
+    for (unsigned i = 0; i < variables.size(); ++i) {
+        numbers[variables[i]] = i;
+    }
+}
+
 size_t Cfa::getInputNumber(gazer::Variable* variable) const
 {
-    auto it = std::find(mInputs.begin(), mInputs.end(), variable);
-    assert(it != mInputs.end() && "Variable must be present in the input list!");
+    auto it = mInputNumbers.find(variable);
+    assert(it != mInputNumbers.end() && "Variable must be present in the input list!");
 
-    return std::distance(mInputs.begin(), it);
+    return it->second;
 }
 
 size_t Cfa::getOutputNumber(gazer::Variable* variable) const
 {
-    auto it = std::find(mOutputs.begin(), mOutputs.end(), variable);
-    assert(it != mOutputs.end() && "Variable must be present in the output list!");
+    auto it = mOutputNumbers.find(variable);
+    assert(it != mOutputNumbers.end() && "Variable must be present in the output list!");
 
-    return std::distance(mOutputs.begin(), it);
+    return it->second;
+}
+
+bool Cfa::isInput(Variable* variable) const
+{
+    return mInputNumbers.count(variable) != 0;
 }
 
 bool Cfa::isOutput(Variable* variable) const
 {
-    return std::find(mOutputs.begin(), mOutputs.end(), variable) != mOutputs.end();
+    return mOutputNumbers.count(variable) != 0;
 }
 
-Variable* Cfa::findVariableByName(const std::vector<Variable*>& vec, llvm::StringRef name) const
+template<class ContainerT>
+Variable* Cfa::findVariableByName(const ContainerT& variables, llvm::StringRef name) const
 {
     auto variableName = (llvm::Twine(mName, "/") + name).str();
     Variable* variable = mContext.getVariable(variableName);
@@ -195,8 +213,8 @@ Variable* Cfa::findVariableByName(const std::vector<Variable*>& vec, llvm::Strin
         return nullptr;
     }
 
-    // We must also make sure that the required vector contains said variable.
-    if (std::find(vec.begin(), vec.end(), variable) == vec.end()) {
+    // We must also make sure that the required container contains said variable.
+    if (variables.count(variable) == 0) {
         return nullptr;
     }
 
@@ -205,17 +223,17 @@ Variable* Cfa::findVariableByName(const std::vector<Variable*>& vec, llvm::Strin
 
 Variable* Cfa::findInputByName(llvm::StringRef name) const
 {
-    return findVariableByName(mInputs, name);
+    return findVariableByName(mInputNumbers, name);
 }
 
 Variable* Cfa::findLocalByName(llvm::StringRef name) const
 {
-    return findVariableByName(mLocals, name);
+    return findVariableByName(mLocalSet, name);
 }
 
 Variable* Cfa::findOutputByName(llvm::StringRef name) const
 {
-    return findVariableByName(mOutputs, name);
+    return findVariableByName(mOutputNumbers, name);
 }
 
 // Transformations
@@ -268,8 +286,13 @@ void Cfa::removeUnreachableLocations()
 
 void Cfa::clearDisconnectedElements()
 {
-    mLocations.erase(std::remove_if(mLocations.begin(), mLocations.end(), [](auto& loc) {
-        return loc->mIncoming.empty() && loc->mOutgoing.empty();
+    mLocations.erase(std::remove_if(mLocations.begin(), mLocations.end(), [this](auto& loc) {
+        if (loc->mIncoming.size() == 0 && loc->mOutgoing.size() == 0) {
+            mLocationNumbers.erase(loc->getId());
+            mErrorFieldExprs.erase(loc.get());
+            return true;
+        }
+        return false;
     }), mLocations.end());
 
     mTransitions.erase(std::remove_if(mTransitions.begin(), mTransitions.end(), [](auto& edge) {
@@ -285,23 +308,51 @@ Cfa::~Cfa() {}
 void Location::addIncoming(Transition *edge)
 {
     assert(edge->getTarget() == this);
-    mIncoming.push_back(edge);
+    mIncoming.add(edge);
 }
 
 void Location::addOutgoing(Transition *edge)
 {
     assert(edge->getSource() == this);
-    mOutgoing.push_back(edge);
+    mOutgoing.add(edge);
 }
 
 void Location::removeIncoming(Transition *edge)
 {
-    mIncoming.erase(std::remove(mIncoming.begin(), mIncoming.end(), edge), mIncoming.end());
+    mIncoming.remove(edge);
 }
 
 void Location::removeOutgoing(Transition *edge)
 {
-    mOutgoing.erase(std::remove(mOutgoing.begin(), mOutgoing.end(), edge), mOutgoing.end());
+    mOutgoing.remove(edge);
+}
+
+void Location::EdgeList::add(Transition* edge)
+{
+    uint32_t& position = mIncoming ? edge->mTargetIdx : edge->mSourceIdx;
+    position = mEdges.size();
+    mEdges.push_back(edge);
+}
+
+void Location::EdgeList::remove(Transition* edge)
+{
+    uint32_t position = mIncoming ? edge->mTargetIdx : edge->mSourceIdx;
+    if (position >= mEdges.size() || mEdges[position] != edge) {
+        // The edge is not present in this list.
+        return;
+    }
+
+    // Only the edges after the removed one need to be renumbered.
+    mEdges.erase(mEdges.begin() + position);
+    for (size_t i = position; i < mEdges.size(); ++i) {
+        uint32_t& next = mIncoming ? mEdges[i]->mTargetIdx : mEdges[i]->mSourceIdx;
+        next = i;
+    }
+}
+
+void Location::EdgeList::clear()
+{
+    mEdges.clear();
 }
 
 // Transitions
@@ -325,6 +376,26 @@ CallTransition::CallTransition(
     assert(callee->getNumOutputs() == mOutputArgs.size());
 }
 
+void CallTransition::setCalledAutomaton(Cfa* callee)
+{
+    assert(callee != nullptr);
+    assert(callee->getNumInputs() == mCallee->getNumInputs());
+    assert(callee->getNumOutputs() == mCallee->getNumOutputs());
+
+    for (VariableAssignment& assign : mInputArgs) {
+        Variable* input = callee->getInput(mCallee->getInputNumber(assign.getVariable()));
+        assign = VariableAssignment(input, assign.getValue());
+    }
+
+    for (VariableAssignment& assign : mOutputArgs) {
+        auto& output = llvm::cast<VarRefExpr>(assign.getValue())->getVariable();
+        Variable* newOutput = callee->getOutput(mCallee->getOutputNumber(&output));
+        assign = VariableAssignment(assign.getVariable(), newOutput->getRefExpr());
+    }
+
+    mCallee = callee;
+}
+
 std::optional<VariableAssignment> CallTransition::getInputArgument(Variable& input) const
 {
     auto result = std::find_if(mInputArgs.begin(), mInputArgs.end(), [&input](auto& assign) {
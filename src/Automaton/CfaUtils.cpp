@@ -17,6 +17,9 @@
 //===----------------------------------------------------------------------===//
 #include "gazer/Automaton/CfaUtils.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Valuation.h"
+
+#include <llvm/Support/MathExtras.h>
 
 #include <boost/dynamic_bitset.hpp>
 
@@ -30,7 +33,7 @@ PathConditionCalculator::PathConditionCalculator(
     ExprBuilder& builder,
     std::function<size_t(Location*)> index,
     std::function<ExprPtr(CallTransition*)> calls,
-    std::function<void(Location*, Variable*, ExprPtr)> preds
+    std::function<void(Location*, const PredecessorSelector&)> preds
 ) : mTopo(topo), mExprBuilder(builder), mIndex(index), mCalls(calls), mPredecessors(preds)
 {}
 
@@ -43,7 +46,6 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
     size_t startIdx = mIndex(source);
     size_t targetIdx = mIndex(target);
 
-    auto& ctx = mExprBuilder.getContext();
     assert(startIdx < targetIdx && "The source location must be before the target in a topological sort!");
     assert(targetIdx < mTopo.size() && "The target index is out of range in the VC array!");
 
@@ -71,57 +73,24 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
             }
         }
 
-        Variable* predVar = nullptr;
-
-        if (mPredecessors != nullptr) {
+        ExprVector identifications;
+        if (mPredecessors != nullptr && !preds.empty()) {
             // Add predecessor identifications, if requested.
-            ExprPtr predExpr = nullptr;
-
-            if (preds.empty()) {
-                predExpr = nullptr;
-                predVar = nullptr;
-            } else if (preds.size() == 1) {
-                predExpr = mExprBuilder.IntLit(preds[0].first->getSource()->getId());
-                mPredecessors(loc, predVar, predExpr);
-            } else if (preds.size() == 2) {
-                predVar = ctx.createVariable(
-                    "__gazer_pred_" + std::to_string(mPredIdx++),
-                    BoolType::Get(ctx)
-                );
-
-                unsigned first =  preds[0].first->getSource()->getId();
-                unsigned second = preds[1].first->getSource()->getId();
-                
-                predExpr = mExprBuilder.Select(
-                    predVar->getRefExpr(), mExprBuilder.IntLit(first), mExprBuilder.IntLit(second)
-                );
-                mPredecessors(loc, predVar, predExpr);
-            } else {
-                predVar = ctx.createVariable(
-                    "__gazer_pred_" + std::to_string(mPredIdx++),
-                    IntType::Get(ctx)
-                );
-                predExpr = predVar->getRefExpr();
-                mPredecessors(loc, predVar, predExpr);
+            PredecessorSelector selector;
+            selector.expr = this->encodeSelector(loc, preds, identifications, selector.variables);
+            for (auto& [edge, predIdx] : preds) {
+                selector.edges.push_back(edge);
             }
+
+            mPredecessors(loc, selector);
         }
-        
+
         for (size_t j = 0; j < preds.size(); ++j) {
             Transition* edge = preds[j].first;
             size_t predIdx = preds[j].second;
 
-            ExprPtr predIdentification;
-            if (predVar == nullptr) {
-                predIdentification = mExprBuilder.True();
-            } else if (predVar->getType().isBoolType()) {
-                predIdentification =
-                    (j == 0 ? predVar->getRefExpr() : mExprBuilder.Not(predVar->getRefExpr()));
-            } else {
-                predIdentification = mExprBuilder.Eq(
-                    predVar->getRefExpr(),
-                    mExprBuilder.IntLit(preds[j].first->getSource()->getId())
-                );
-            }
+            ExprPtr predIdentification = identifications.empty()
+                ? mExprBuilder.True() : identifications[j];
 
             ExprPtr formula = mExprBuilder.And({
                 dp[predIdx - startIdx],
@@ -160,6 +129,120 @@ ExprPtr PathConditionCalculator::encode(Location* source, Location* target)
     return dp.back();
 }
 
+ExprPtr PathConditionCalculator::encodeSelector(
+    Location* loc,
+    llvm::ArrayRef<std::pair<Transition*, size_t>> preds,
+    ExprVector& identifications,
+    llvm::SmallVectorImpl<Variable*>& variables)
+{
+    assert(!preds.empty() && "Cannot encode a selector without predecessors!");
+    auto& ctx = mExprBuilder.getContext();
+
+    auto sourceId = [this, &preds](size_t j) -> ExprPtr {
+        return mExprBuilder.IntLit(preds[j].first->getSource()->getId());
+    };
+
+    if (preds.size() == 1) {
+        identifications.push_back(mExprBuilder.True());
+        return sourceId(0);
+    }
+
+    SelectorVariables& selector = mSelectors[loc];
+    ExprVector conditions;
+
+    if (preds.size() <= OneHotSelectorLimit) {
+        // Ordered one-hot encoding: the j-th predecessor is selected if the j-th
+        // selector bit is the first one set. The last predecessor is selected if
+        // none of the bits are set, thus we need N - 1 variables for N predecessors.
+        while (selector.oneHot.size() < preds.size() - 1) {
+            selector.oneHot.push_back(this->createSelectorVariable(BoolType::Get(ctx)));
+        }
+
+        auto conjunction = [this](const ExprVector& ops) {
+            return ops.size() == 1 ? ops[0] : mExprBuilder.And(ops);
+        };
+
+        ExprVector previousUnset;
+        for (size_t j = 0; j < preds.size() - 1; ++j) {
+            ExprPtr bit = selector.oneHot[j]->getRefExpr();
+            ExprVector conjuncts(previousUnset);
+            conjuncts.push_back(bit);
+
+            identifications.push_back(conjunction(conjuncts));
+            conditions.push_back(bit);
+            variables.push_back(selector.oneHot[j]);
+            previousUnset.push_back(mExprBuilder.Not(bit));
+        }
+        identifications.push_back(conjunction(previousUnset));
+    } else {
+        // Binary encoding: the selector is a bit-vector wide enough to hold
+        // the index of each predecessor. Wider selectors from earlier encodes
+        // are reused as-is.
+        unsigned width = llvm::Log2_64_Ceil(preds.size());
+        if (selector.binary == nullptr
+            || llvm::cast<BvType>(selector.binary->getType()).getWidth() < width
+        ) {
+            selector.binary = this->createSelectorVariable(BvType::Get(ctx, width));
+        }
+
+        Variable* variable = selector.binary;
+        variables.push_back(variable);
+        unsigned actualWidth = llvm::cast<BvType>(variable->getType()).getWidth();
+
+        for (size_t j = 0; j < preds.size(); ++j) {
+            ExprPtr eq = mExprBuilder.Eq(variable->getRefExpr(), mExprBuilder.BvLit(j, actualWidth));
+            identifications.push_back(eq);
+            conditions.push_back(eq);
+        }
+    }
+
+    // Build the decoding expression, which evaluates to the identifier
+    // of the selected predecessor under a model.
+    ExprPtr predExpr = sourceId(preds.size() - 1);
+    for (size_t j = preds.size() - 1; j > 0; --j) {
+        predExpr = mExprBuilder.Select(conditions[j - 1], sourceId(j - 1), predExpr);
+    }
+
+    return predExpr;
+}
+
+Transition* PredecessorSelector::decode(const Valuation& model) const
+{
+    assert(!edges.empty() && "A selector must have at least one edge!");
+
+    if (variables.empty()) {
+        return edges.front();
+    }
+
+    if (variables.front()->getType().isBvType()) {
+        auto it = model.find(variables.front());
+        if (it == model.end()) {
+            return edges.front();
+        }
+
+        auto value = llvm::cast<BvLiteralExpr>(it->second)->getValue().getLimitedValue();
+        return edges[std::min<uint64_t>(value, edges.size() - 1)];
+    }
+
+    // The first set bit of a one-hot selector identifies the edge, the last
+    // edge is selected if none of them is set.
+    for (size_t j = 0; j < variables.size(); ++j) {
+        auto it = model.find(variables[j]);
+        if (it != model.end() && llvm::cast<BoolLiteralExpr>(it->second)->getValue()) {
+            return edges[j];
+        }
+    }
+
+    return edges.back();
+}
+
+Variable* PathConditionCalculator::createSelectorVariable(Type& type)
+{
+    return mExprBuilder.getContext().createVariable(
+        "__gazer_pred_" + std::to_string(mPredIdx++), type
+    );
+}
+
 // Lowest common dominators
 //===----------------------------------------------------------------------===//
 
@@ -329,4 +412,55 @@ Location* gazer::findHighestCommonPostDominator(
     }
 
     return topo[startIdx - commonDominatorIndex];
+}
+
+// Topological sorts
+//===----------------------------------------------------------------------===//
+
+bool gazer::createTopologicalSort(Cfa* cfa, std::vector<Location*>& topo)
+{
+    llvm::DenseSet<Location*> visited;
+    llvm::DenseSet<Location*> onStack;
+
+    // Start with the entry location, so that unreachable locations are placed
+    // before it in the reverse post-order.
+    std::vector<Location*> roots = { cfa->getEntry() };
+    for (auto& loc : cfa->nodes()) {
+        roots.push_back(loc.get());
+    }
+
+    for (Location* root : roots) {
+        if (!visited.insert(root).second) {
+            continue;
+        }
+
+        std::vector<std::pair<Location*, size_t>> stack;
+        stack.emplace_back(root, 0);
+        onStack.insert(root);
+
+        while (!stack.empty()) {
+            Location* loc = stack.back().first;
+            size_t idx = stack.back().second++;
+
+            if (idx >= loc->getNumOutgoing()) {
+                topo.push_back(loc);
+                onStack.erase(loc);
+                stack.pop_back();
+                continue;
+            }
+
+            Location* target = (*std::next(loc->outgoing_begin(), idx))->getTarget();
+            if (onStack.count(target) != 0) {
+                return false;
+            }
+
+            if (visited.insert(target).second) {
+                onStack.insert(target);
+                stack.emplace_back(target, 0);
+            }
+        }
+    }
+
+    std::reverse(topo.begin(), topo.end());
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,255 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The reachability of error locations depends on the guards of the
+// transitions, while the reported error depends on the error codes. Every
+// variable occurring in these expressions is relevant, and so is every
+// variable occurring in a value assigned to a relevant variable. Variables of
+// different automata are distinct, thus the fixpoint is calculated over the
+// whole system at once: call transitions bind the inputs of the callee to the
+// argument values, and the output arguments of the caller to the outputs of
+// the callee.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+
+#include <llvm/ADT/DenseSet.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class ConeOfInfluence
+{
+public:
+    explicit ConeOfInfluence(AutomataSystem& system)
+        : mSystem(system)
+    {}
+
+    ConeOfInfluenceResult transform();
+
+private:
+    void collectDependencies(Cfa& cfa);
+    void markRelevant(const ExprPtr& expr);
+
+    bool isRelevant(Variable* variable) const { return mRelevant.count(variable) != 0; }
+
+    void sliceInterface(Cfa& cfa);
+    void sliceTransitions(Cfa& cfa);
+
+private:
+    AutomataSystem& mSystem;
+
+    /// The expressions which the value of each variable depends on.
+    llvm::DenseMap<Variable*, ExprVector> mDependencies;
+
+    llvm::DenseSet<Variable*> mRelevant;
+    llvm::DenseSet<Expr*> mVisitedExprs;
+    std::vector<Variable*> mWorklist;
+
+    ConeOfInfluenceResult mResult;
+};
+
+} // end anonymous namespace
+
+ConeOfInfluenceResult ConeOfInfluence::transform()
+{
+    for (Cfa& cfa : mSystem) {
+        this->collectDependencies(cfa);
+    }
+
+    while (!mWorklist.empty()) {
+        Variable* variable = mWorklist.back();
+        mWorklist.pop_back();
+
+        auto it = mDependencies.find(variable);
+        if (it == mDependencies.end()) {
+            continue;
+        }
+
+        for (const ExprPtr& expr : it->second) {
+            this->markRelevant(expr);
+        }
+    }
+
+    // The interfaces must be updated first, as call transitions are
+    // recreated with the new argument lists.
+    for (Cfa& cfa : mSystem) {
+        if (&cfa != mSystem.getMainAutomaton()) {
+            this->sliceInterface(cfa);
+        }
+    }
+
+    for (Cfa& cfa : mSystem) {
+        this->sliceTransitions(cfa);
+    }
+
+    return mResult;
+}
+
+void ConeOfInfluence::collectDependencies(Cfa& cfa)
+{
+    for (auto& [location, errorCode] : cfa.errors()) {
+        this->markRelevant(errorCode);
+    }
+
+    for (auto& edge : cfa.edges()) {
+        this->markRelevant(edge->getGuard());
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge.get())) {
+            for (const VariableAssignment& assignment : *assign) {
+                mDependencies[assignment.getVariable()].push_back(assignment.getValue());
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge.get())) {
+            for (const VariableAssignment& input : call->inputs()) {
+                mDependencies[input.getVariable()].push_back(input.getValue());
+            }
+
+            for (const VariableAssignment& output : call->outputs()) {
+                mDependencies[output.getVariable()].push_back(output.getValue());
+            }
+        }
+    }
+}
+
+void ConeOfInfluence::markRelevant(const ExprPtr& expr)
+{
+    llvm::SmallVector<Expr*, 16> worklist;
+    worklist.push_back(expr.get());
+
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!mVisitedExprs.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            Variable* variable = &varRef->getVariable();
+            if (mRelevant.insert(variable).second) {
+                mWorklist.push_back(variable);
+            }
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& op : nonNullary->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+}
+
+void ConeOfInfluence::sliceInterface(Cfa& cfa)
+{
+    auto irrelevant = [this](Variable* variable) {
+        if (!this->isRelevant(variable)) {
+            ++mResult.NumRemovedVariables;
+            return true;
+        }
+        return false;
+    };
+
+    cfa.removeInputsIf(irrelevant);
+    // Outputs are also locals or inputs, they are counted when removed from those lists.
+    cfa.removeOutputsIf([this](Variable* variable) {
+        return !this->isRelevant(variable);
+    });
+}
+
+void ConeOfInfluence::sliceTransitions(Cfa& cfa)
+{
+    // Locals which receive the value of a kept output must be kept as well.
+    llvm::DenseSet<Variable*> bound;
+
+    std::vector<Transition*> edges;
+    for (auto& edge : cfa.edges()) {
+        edges.push_back(edge.get());
+    }
+
+    bool changed = false;
+
+    for (Transition* edge : edges) {
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            std::vector<VariableAssignment> assignments;
+            std::copy_if(assign->begin(), assign->end(), std::back_inserter(assignments),
+                [this](const VariableAssignment& assignment) {
+                    return this->isRelevant(assignment.getVariable());
+                });
+
+            if (assignments.size() == assign->getNumAssignments()) {
+                continue;
+            }
+
+            mResult.NumRemovedAssignments += assign->getNumAssignments() - assignments.size();
+            cfa.createAssignTransition(assign->getSource(), assign->getTarget(), assign->getGuard(), assignments);
+            cfa.disconnectEdge(assign);
+            changed = true;
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            Cfa* callee = call->getCalledAutomaton();
+
+            std::vector<VariableAssignment> inputs;
+            for (const VariableAssignment& input : call->inputs()) {
+                if (this->isRelevant(input.getVariable())) {
+                    inputs.push_back(input);
+                }
+            }
+
+            std::vector<VariableAssignment> outputs;
+            for (const VariableAssignment& output : call->outputs()) {
+                auto outputRef = llvm::cast<VarRefExpr>(output.getValue());
+                if (this->isRelevant(&outputRef->getVariable())) {
+                    outputs.push_back(output);
+                    bound.insert(output.getVariable());
+                }
+            }
+
+            if (inputs.size() == call->getNumInputs() && outputs.size() == call->getNumOutputs()) {
+                continue;
+            }
+
+            assert(inputs.size() == callee->getNumInputs() && outputs.size() == callee->getNumOutputs()
+                && "The interface of the callee must match the new call arguments!");
+
+            mResult.NumRemovedAssignments += (call->getNumInputs() - inputs.size())
+                + (call->getNumOutputs() - outputs.size());
+            cfa.createCallTransition(
+                call->getSource(), call->getTarget(), call->getGuard(), callee, inputs, outputs
+            );
+            cfa.disconnectEdge(call);
+            changed = true;
+        }
+    }
+
+    cfa.removeLocalsIf([this, &cfa, &bound](Variable* variable) {
+        if (this->isRelevant(variable) || bound.count(variable) != 0 || cfa.isOutput(variable)) {
+            return false;
+        }
+
+        ++mResult.NumRemovedVariables;
+        return true;
+    });
+
+    if (changed) {
+        cfa.clearDisconnectedElements();
+    }
+}
+
+ConeOfInfluenceResult gazer::TransformConeOfInfluence(AutomataSystem& system)
+{
+    ConeOfInfluence coi(system);
+    return coi.transform();
+}
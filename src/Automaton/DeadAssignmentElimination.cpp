@@ -0,0 +1,321 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Liveness is calculated sparsely, one variable at a time: the locations in
+// which a variable is live are found by a backward search from its uses,
+// which stops at the transitions overwriting it. An assignment is dead if the
+// variable is not live in the target of its transition.
+//
+// Transitions are treated conservatively, so that the result is sound for
+// both the sequential reading of their assignments and the SSA encoding used
+// by the verifiers: a transition reading a variable anywhere (in its guard or
+// in any of its values) makes it live in its source and does not kill it,
+// and call transitions never kill their output variables.
+//
+// In SSA-formed automata each variable has a single definition, thus the
+// search is only needed for variables assigned on multiple transitions.
+// Otherwise, a variable is considered live if it has any use at all.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
+
+using namespace gazer;
+
+namespace
+{
+
+template<class Callback>
+void forEachVariable(const ExprPtr& expr, Callback callback)
+{
+    llvm::SmallVector<Expr*, 16> worklist;
+    llvm::SmallPtrSet<Expr*, 16> visited;
+
+    worklist.push_back(expr.get());
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            callback(&varRef->getVariable());
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& op : nonNullary->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+}
+
+bool referencesVariable(const ExprPtr& expr, Variable* variable)
+{
+    bool found = false;
+    forEachVariable(expr, [&found, variable](Variable* v) {
+        found |= (v == variable);
+    });
+
+    return found;
+}
+
+bool transitionReads(Transition* edge, Variable* variable)
+{
+    if (referencesVariable(edge->getGuard(), variable)) {
+        return true;
+    }
+
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        return std::any_of(assign->begin(), assign->end(), [variable](const VariableAssignment& assignment) {
+            return referencesVariable(assignment.getValue(), variable);
+        });
+    }
+
+    auto call = llvm::cast<CallTransition>(edge);
+    return std::any_of(call->input_begin(), call->input_end(), [variable](const VariableAssignment& input) {
+        return referencesVariable(input.getValue(), variable);
+    });
+}
+
+class DeadAssignmentEliminator
+{
+    /// A location reading a variable, either through one of its outgoing
+    /// transitions or as an exit or error location.
+    struct Use
+    {
+        Location* location;
+        Transition* edge;
+    };
+
+public:
+    DeadAssignmentEliminator(Cfa* cfa, std::function<bool(Variable*)> keep)
+        : mCfa(cfa), mKeep(std::move(keep))
+    {}
+
+    DeadAssignmentResult transform();
+
+private:
+    void collectDefsAndUses();
+    void processVariable(Variable* variable);
+
+    /// Returns the locations in which \p variable is live.
+    llvm::DenseSet<Location*> findLiveLocations(
+        Variable* variable, llvm::ArrayRef<Use> uses, llvm::ArrayRef<AssignTransition*> defs
+    );
+
+    void removeUnusedLocals();
+
+private:
+    Cfa* mCfa;
+    std::function<bool(Variable*)> mKeep;
+
+    llvm::DenseMap<Variable*, llvm::SmallVector<AssignTransition*, 2>> mDefs;
+    llvm::DenseMap<Variable*, llvm::SmallVector<Use, 4>> mUses;
+
+    llvm::SetVector<Variable*> mWorklist;
+
+    DeadAssignmentResult mResult;
+};
+
+} // end anonymous namespace
+
+DeadAssignmentResult DeadAssignmentEliminator::transform()
+{
+    this->collectDefsAndUses();
+
+    while (!mWorklist.empty()) {
+        Variable* variable = mWorklist.pop_back_val();
+        this->processVariable(variable);
+    }
+
+    this->removeUnusedLocals();
+
+    return mResult;
+}
+
+void DeadAssignmentEliminator::collectDefsAndUses()
+{
+    for (auto& edge : mCfa->edges()) {
+        Transition* transition = edge.get();
+        Location* source = transition->getSource();
+
+        auto addUses = [this, transition, source](const ExprPtr& expr) {
+            forEachVariable(expr, [this, transition, source](Variable* variable) {
+                auto& uses = mUses[variable];
+                if (uses.empty() || uses.back().edge != transition) {
+                    uses.push_back({ source, transition });
+                }
+            });
+        };
+
+        addUses(transition->getGuard());
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(transition)) {
+            for (const VariableAssignment& assignment : *assign) {
+                auto& defs = mDefs[assignment.getVariable()];
+                if (defs.empty() || defs.back() != assign) {
+                    defs.push_back(assign);
+                }
+                mWorklist.insert(assignment.getVariable());
+                addUses(assignment.getValue());
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(transition)) {
+            for (const VariableAssignment& input : call->inputs()) {
+                addUses(input.getValue());
+            }
+        }
+    }
+
+    for (auto& [location, errorCode] : mCfa->errors()) {
+        Location* errorLoc = location;
+        forEachVariable(errorCode, [this, errorLoc](Variable* variable) {
+            mUses[variable].push_back({ errorLoc, nullptr });
+        });
+    }
+
+    for (Variable& output : mCfa->outputs()) {
+        mUses[&output].push_back({ mCfa->getExit(), nullptr });
+    }
+}
+
+void DeadAssignmentEliminator::processVariable(Variable* variable)
+{
+    if (mKeep && mKeep(variable)) {
+        return;
+    }
+
+    // Removed assignments may have made some of the uses obsolete.
+    llvm::SmallVector<Use, 4> uses;
+    for (const Use& use : mUses.lookup(variable)) {
+        if (use.edge == nullptr || transitionReads(use.edge, variable)) {
+            uses.push_back(use);
+        }
+    }
+    mUses[variable] = uses;
+
+    auto& defs = mDefs[variable];
+    llvm::SmallVector<AssignTransition*, 2> deadDefs;
+
+    if (uses.empty()) {
+        deadDefs.assign(defs.begin(), defs.end());
+    } else if (defs.size() > 1) {
+        auto live = this->findLiveLocations(variable, uses, defs);
+        for (AssignTransition* def : defs) {
+            if (live.count(def->getTarget()) == 0 && !transitionReads(def, variable)) {
+                deadDefs.push_back(def);
+            }
+        }
+    }
+
+    for (AssignTransition* def : deadDefs) {
+        def->removeAssignmentsIf([this, variable](const VariableAssignment& assignment) {
+            if (assignment.getVariable() != variable) {
+                return false;
+            }
+
+            // The variables read by the removed value may have become dead as well.
+            forEachVariable(assignment.getValue(), [this](Variable* operand) {
+                if (mDefs.count(operand) != 0) {
+                    mWorklist.insert(operand);
+                }
+            });
+            ++mResult.NumRemovedAssignments;
+            return true;
+        });
+    }
+
+    defs.erase(std::remove_if(defs.begin(), defs.end(), [&deadDefs](AssignTransition* def) {
+        return std::find(deadDefs.begin(), deadDefs.end(), def) != deadDefs.end();
+    }), defs.end());
+}
+
+llvm::DenseSet<Location*> DeadAssignmentEliminator::findLiveLocations(
+    Variable* variable, llvm::ArrayRef<Use> uses, llvm::ArrayRef<AssignTransition*> defs
+) {
+    llvm::DenseSet<Location*> live;
+    llvm::SmallVector<Location*, 16> worklist;
+
+    for (const Use& use : uses) {
+        if (live.insert(use.location).second) {
+            worklist.push_back(use.location);
+        }
+    }
+
+    while (!worklist.empty()) {
+        Location* loc = worklist.pop_back_val();
+        for (Transition* edge : loc->incoming()) {
+            auto assign = llvm::dyn_cast<AssignTransition>(edge);
+            bool kills = assign != nullptr
+                && std::find(defs.begin(), defs.end(), assign) != defs.end()
+                && !transitionReads(assign, variable);
+
+            if (!kills && live.insert(edge->getSource()).second) {
+                worklist.push_back(edge->getSource());
+            }
+        }
+    }
+
+    return live;
+}
+
+void DeadAssignmentEliminator::removeUnusedLocals()
+{
+    llvm::DenseSet<Variable*> used;
+    auto addUses = [&used](const ExprPtr& expr) {
+        forEachVariable(expr, [&used](Variable* variable) { used.insert(variable); });
+    };
+
+    for (auto& edge : mCfa->edges()) {
+        addUses(edge->getGuard());
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge.get())) {
+            for (const VariableAssignment& assignment : *assign) {
+                used.insert(assignment.getVariable());
+                addUses(assignment.getValue());
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge.get())) {
+            for (const VariableAssignment& input : call->inputs()) {
+                addUses(input.getValue());
+            }
+            for (const VariableAssignment& output : call->outputs()) {
+                used.insert(output.getVariable());
+            }
+        }
+    }
+
+    for (auto& [location, errorCode] : mCfa->errors()) {
+        addUses(errorCode);
+    }
+
+    mCfa->removeLocalsIf([this, &used](Variable* variable) {
+        if (used.count(variable) != 0 || mCfa->isOutput(variable) || (mKeep && mKeep(variable))) {
+            return false;
+        }
+
+        ++mResult.NumRemovedVariables;
+        return true;
+    });
+}
+
+DeadAssignmentResult gazer::TransformDeadAssignmentElimination(Cfa* cfa, std::function<bool(Variable*)> keep)
+{
+    DeadAssignmentEliminator eliminator(cfa, std::move(keep));
+    return eliminator.transform();
+}
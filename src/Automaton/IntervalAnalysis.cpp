@@ -0,0 +1,1072 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The locations of each automaton are visited in reverse post-order, using a
+// worklist ordered by the same numbering. The state of a location is the join
+// of the post-states of its incoming transitions. The targets of retreating
+// edges are loop heads, where the states are widened after a few visits, so
+// that the iteration terminates. As the widened states are post-fixpoints,
+// recalculating them a few more times without widening is still sound and
+// recovers some of the bounds lost by the widening.
+//
+// Bit-vectors are represented by their signed values. Arithmetic which may
+// overflow yields the whole range of the type, as the result may wrap around.
+// Unsigned comparisons are only evaluated and refined when the order of the
+// operands is the same as their signed order.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/IntervalAnalysis.h"
+#include "gazer/Automaton/CallGraph.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/ADT/SCCIterator.h>
+
+#include <set>
+
+using namespace gazer;
+
+namespace
+{
+
+/// The number of visits of a loop head before its state is widened.
+constexpr unsigned WideningDelay = 2;
+
+/// The number of descending iterations following the widened iteration.
+constexpr unsigned NarrowingIterations = 2;
+
+// Bound arithmetic. For integers, the bounds of int64_t are infinite and the
+// results which do not fit saturate to them. Bit-vector bounds are exact
+// values, thus the results which do not fit are reported through 'overflow'.
+//-----------------------------------------------------------------------------
+
+int64_t addBound(int64_t a, int64_t b, bool isInt, bool& overflow)
+{
+    if (isInt) {
+        if (a == Interval::Min || b == Interval::Min) {
+            return Interval::Min;
+        }
+        if (a == Interval::Max || b == Interval::Max) {
+            return Interval::Max;
+        }
+    }
+
+    int64_t result;
+    if (__builtin_add_overflow(a, b, &result)) {
+        overflow = true;
+        return a < 0 ? Interval::Min : Interval::Max;
+    }
+
+    return result;
+}
+
+int64_t subBound(int64_t a, int64_t b, bool isInt, bool& overflow)
+{
+    if (isInt) {
+        if (a == Interval::Min || b == Interval::Max) {
+            return Interval::Min;
+        }
+        if (a == Interval::Max || b == Interval::Min) {
+            return Interval::Max;
+        }
+    }
+
+    int64_t result;
+    if (__builtin_sub_overflow(a, b, &result)) {
+        overflow = true;
+        return a < 0 ? Interval::Min : Interval::Max;
+    }
+
+    return result;
+}
+
+int64_t mulBound(int64_t a, int64_t b, bool isInt, bool& overflow)
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+
+    bool isNegative = (a < 0) != (b < 0);
+    if (isInt && (a == Interval::Min || a == Interval::Max || b == Interval::Min || b == Interval::Max)) {
+        return isNegative ? Interval::Min : Interval::Max;
+    }
+
+    int64_t result;
+    if (__builtin_mul_overflow(a, b, &result)) {
+        overflow = true;
+        return isNegative ? Interval::Min : Interval::Max;
+    }
+
+    return result;
+}
+
+/// Returns \p interval if it is a valid result of an operation of the given
+/// type. Bit-vector results which do not fit the type wrap around, thus they
+/// may take any value.
+Interval fitToType(const Interval& interval, Type& type, bool overflow)
+{
+    if (!type.isBvType()) {
+        return interval;
+    }
+
+    Interval range = Interval::ForType(type);
+    if (overflow || interval.getLower() < range.getLower() || interval.getUpper() > range.getUpper()) {
+        return range;
+    }
+
+    return interval;
+}
+
+Interval makeBool(bool canBeFalse, bool canBeTrue)
+{
+    return Interval(canBeFalse ? 0 : 1, canBeTrue ? 1 : 0);
+}
+
+// Refinement bounds
+//-----------------------------------------------------------------------------
+
+/// Returns the values which are less than some value of \p interval.
+Interval lessThan(const Interval& interval, bool isInt)
+{
+    if (isInt && interval.getUpper() == Interval::Max) {
+        return Interval();
+    }
+    if (interval.getUpper() == Interval::Min) {
+        return Interval::Empty();
+    }
+
+    return Interval(Interval::Min, interval.getUpper() - 1);
+}
+
+/// Returns the values which are greater than some value of \p interval.
+Interval greaterThan(const Interval& interval, bool isInt)
+{
+    if (isInt && interval.getLower() == Interval::Min) {
+        return Interval();
+    }
+    if (interval.getLower() == Interval::Max) {
+        return Interval::Empty();
+    }
+
+    return Interval(interval.getLower() + 1, Interval::Max);
+}
+
+Interval lessOrEqual(const Interval& interval)
+{
+    return Interval(Interval::Min, interval.getUpper());
+}
+
+Interval greaterOrEqual(const Interval& interval)
+{
+    return Interval(interval.getLower(), Interval::Max);
+}
+
+Expr::ExprKind negateComparison(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq: return Expr::NotEq;
+        case Expr::NotEq: return Expr::Eq;
+        case Expr::Lt: return Expr::GtEq;
+        case Expr::LtEq: return Expr::Gt;
+        case Expr::Gt: return Expr::LtEq;
+        case Expr::GtEq: return Expr::Lt;
+        case Expr::BvSLt: return Expr::BvSGtEq;
+        case Expr::BvSLtEq: return Expr::BvSGt;
+        case Expr::BvSGt: return Expr::BvSLtEq;
+        case Expr::BvSGtEq: return Expr::BvSLt;
+        case Expr::BvULt: return Expr::BvUGtEq;
+        case Expr::BvULtEq: return Expr::BvUGt;
+        case Expr::BvUGt: return Expr::BvULtEq;
+        case Expr::BvUGtEq: return Expr::BvULt;
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+bool isComparison(Expr::ExprKind kind)
+{
+    return kind == Expr::Eq || kind == Expr::NotEq
+        || (Expr::Lt <= kind && kind <= Expr::BvUGtEq);
+}
+
+/// Evaluates expressions over an interval state.
+class IntervalEvaluator
+{
+public:
+    explicit IntervalEvaluator(const IntervalState& state)
+        : mState(state)
+    {}
+
+    /// Returns the interval of \p expr, which must be of a tracked type.
+    Interval eval(const ExprPtr& expr);
+
+private:
+    Interval visit(const ExprPtr& expr);
+    Interval visitComparison(Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right);
+
+private:
+    const IntervalState& mState;
+    llvm::DenseMap<Expr*, Interval> mCache;
+};
+
+/// Restricts \p state to the executions in which \p expr evaluates to
+/// \p positive.
+void assume(const ExprPtr& expr, bool positive, IntervalState& state);
+
+} // end anonymous namespace
+
+// Interval
+//-----------------------------------------------------------------------------
+
+bool Interval::isTracked(Type& type)
+{
+    if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+        return bvTy->getWidth() <= 64;
+    }
+
+    return type.isBoolType() || type.isIntType();
+}
+
+Interval Interval::ForType(Type& type)
+{
+    assert(isTracked(type) && "Interval of an untracked type!");
+
+    if (type.isBoolType()) {
+        return Interval(0, 1);
+    }
+
+    if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+        unsigned width = bvTy->getWidth();
+        if (width < 64) {
+            return Interval(-(int64_t{1} << (width - 1)), (int64_t{1} << (width - 1)) - 1);
+        }
+    }
+
+    return Interval();
+}
+
+Interval Interval::join(const Interval& other) const
+{
+    if (isEmpty()) {
+        return other;
+    }
+    if (other.isEmpty()) {
+        return *this;
+    }
+
+    return Interval(std::min(mLower, other.mLower), std::max(mUpper, other.mUpper));
+}
+
+Interval Interval::meet(const Interval& other) const
+{
+    return Interval(std::max(mLower, other.mLower), std::min(mUpper, other.mUpper));
+}
+
+Interval Interval::widen(const Interval& next) const
+{
+    if (isEmpty()) {
+        return next;
+    }
+
+    return Interval(
+        next.mLower < mLower ? Min : mLower,
+        next.mUpper > mUpper ? Max : mUpper
+    );
+}
+
+void Interval::print(llvm::raw_ostream& os) const
+{
+    if (isEmpty()) {
+        os << "[]";
+        return;
+    }
+
+    os << "[" << mLower << ", " << mUpper << "]";
+}
+
+// IntervalState
+//-----------------------------------------------------------------------------
+
+Interval IntervalState::get(Variable* variable) const
+{
+    auto it = mIntervals.find(variable);
+    if (it != mIntervals.end()) {
+        return it->second;
+    }
+
+    return Interval::ForType(variable->getType());
+}
+
+void IntervalState::set(Variable* variable, const Interval& interval)
+{
+    if (!mReachable) {
+        return;
+    }
+
+    if (interval.isEmpty()) {
+        mReachable = false;
+        mIntervals.clear();
+        return;
+    }
+
+    // Intervals covering the whole type are not stored, so that equal states
+    // have equal maps.
+    if (interval.meet(Interval::ForType(variable->getType())) == Interval::ForType(variable->getType())) {
+        mIntervals.erase(variable);
+        return;
+    }
+
+    mIntervals[variable] = interval;
+}
+
+void IntervalState::join(const IntervalState& other)
+{
+    if (other.isBottom()) {
+        return;
+    }
+
+    if (this->isBottom()) {
+        *this = other;
+        return;
+    }
+
+    llvm::SmallVector<std::pair<Variable*, Interval>, 16> joined;
+    for (auto& [variable, interval] : mIntervals) {
+        auto it = other.mIntervals.find(variable);
+        if (it != other.mIntervals.end()) {
+            joined.emplace_back(variable, interval.join(it->second));
+        }
+    }
+
+    mIntervals.clear();
+    for (auto& [variable, interval] : joined) {
+        this->set(variable, interval);
+    }
+}
+
+void IntervalState::widen(const IntervalState& next)
+{
+    if (next.isBottom()) {
+        return;
+    }
+
+    if (this->isBottom()) {
+        *this = next;
+        return;
+    }
+
+    llvm::SmallVector<std::pair<Variable*, Interval>, 16> widened;
+    for (auto& [variable, interval] : mIntervals) {
+        auto it = next.mIntervals.find(variable);
+        if (it != next.mIntervals.end()) {
+            Interval result = interval.widen(it->second).meet(Interval::ForType(variable->getType()));
+            widened.emplace_back(variable, result);
+        }
+    }
+
+    mIntervals.clear();
+    for (auto& [variable, interval] : widened) {
+        this->set(variable, interval);
+    }
+}
+
+bool IntervalState::operator==(const IntervalState& other) const
+{
+    if (mReachable != other.mReachable || mIntervals.size() != other.mIntervals.size()) {
+        return false;
+    }
+
+    for (auto& [variable, interval] : mIntervals) {
+        auto it = other.mIntervals.find(variable);
+        if (it == other.mIntervals.end() || it->second != interval) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Expression evaluation
+//-----------------------------------------------------------------------------
+
+Interval IntervalEvaluator::eval(const ExprPtr& expr)
+{
+    assert(Interval::isTracked(expr->getType()) && "Evaluating an untracked expression!");
+
+    auto it = mCache.find(expr.get());
+    if (it != mCache.end()) {
+        return it->second;
+    }
+
+    Interval result = this->visit(expr);
+    mCache[expr.get()] = result;
+
+    return result;
+}
+
+Interval IntervalEvaluator::visit(const ExprPtr& expr)
+{
+    Type& type = expr->getType();
+    bool isInt = type.isIntType();
+
+    if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(expr.get())) {
+        return Interval::Constant(boolLit->getValue() ? 1 : 0);
+    }
+
+    if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(expr.get())) {
+        int64_t value = intLit->getValue();
+        if (value == Interval::Min || value == Interval::Max) {
+            return Interval();
+        }
+        return Interval::Constant(value);
+    }
+
+    if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(expr.get())) {
+        return Interval::Constant(bvLit->getValue().getSExtValue());
+    }
+
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr.get())) {
+        return mState.get(&varRef->getVariable());
+    }
+
+    if (isComparison(expr->getKind())) {
+        auto cmp = llvm::cast<NonNullaryExpr>(expr.get());
+        if (!Interval::isTracked(cmp->getOperand(0)->getType())) {
+            return Interval::ForType(type);
+        }
+        return this->visitComparison(expr->getKind(), cmp->getOperand(0), cmp->getOperand(1));
+    }
+
+    switch (expr->getKind()) {
+        case Expr::Not: {
+            Interval op = this->eval(llvm::cast<NotExpr>(expr)->getOperand(0));
+            return Interval(1 - op.getUpper(), 1 - op.getLower());
+        }
+        case Expr::And:
+        case Expr::Or: {
+            // The result is decided by the first operand which has a fixed
+            // value equal to the absorbing element.
+            int64_t absorbing = expr->getKind() == Expr::And ? 0 : 1;
+            bool isDecided = true;
+            for (const ExprPtr& op : llvm::cast<NonNullaryExpr>(expr)->operands()) {
+                Interval value = this->eval(op);
+                if (value == Interval::Constant(absorbing)) {
+                    return value;
+                }
+                isDecided &= value.isConstant();
+            }
+            return isDecided ? Interval::Constant(1 - absorbing) : Interval(0, 1);
+        }
+        case Expr::Xor: {
+            auto binary = llvm::cast<NonNullaryExpr>(expr.get());
+            Interval left = this->eval(binary->getOperand(0));
+            Interval right = this->eval(binary->getOperand(1));
+            if (left.isConstant() && right.isConstant()) {
+                return Interval::Constant(left.getLower() != right.getLower() ? 1 : 0);
+            }
+            return Interval(0, 1);
+        }
+        case Expr::Imply: {
+            auto binary = llvm::cast<NonNullaryExpr>(expr.get());
+            Interval left = this->eval(binary->getOperand(0));
+            Interval right = this->eval(binary->getOperand(1));
+            return makeBool(left.contains(1) && right.contains(0), left.contains(0) || right.contains(1));
+        }
+        case Expr::Select: {
+            auto select = llvm::cast<SelectExpr>(expr.get());
+            if (!Interval::isTracked(type)) {
+                return Interval();
+            }
+            Interval cond = this->eval(select->getCondition());
+            if (cond == Interval::Constant(1)) {
+                return this->eval(select->getThen());
+            }
+            if (cond == Interval::Constant(0)) {
+                return this->eval(select->getElse());
+            }
+            return this->eval(select->getThen()).join(this->eval(select->getElse()));
+        }
+        case Expr::Add:
+        case Expr::Sub:
+        case Expr::Mul: {
+            auto binary = llvm::cast<NonNullaryExpr>(expr.get());
+            Interval left = this->eval(binary->getOperand(0));
+            Interval right = this->eval(binary->getOperand(1));
+            bool overflow = false;
+
+            if (expr->getKind() == Expr::Add) {
+                return fitToType(Interval(
+                    addBound(left.getLower(), right.getLower(), isInt, overflow),
+                    addBound(left.getUpper(), right.getUpper(), isInt, overflow)
+                ), type, overflow);
+            }
+
+            if (expr->getKind() == Expr::Sub) {
+                return fitToType(Interval(
+                    subBound(left.getLower(), right.getUpper(), isInt, overflow),
+                    subBound(left.getUpper(), right.getLower(), isInt, overflow)
+                ), type, overflow);
+            }
+
+            int64_t products[] = {
+                mulBound(left.getLower(), right.getLower(), isInt, overflow),
+                mulBound(left.getLower(), right.getUpper(), isInt, overflow),
+                mulBound(left.getUpper(), right.getLower(), isInt, overflow),
+                mulBound(left.getUpper(), right.getUpper(), isInt, overflow)
+            };
+            return fitToType(Interval(
+                *std::min_element(std::begin(products), std::end(products)),
+                *std::max_element(std::begin(products), std::end(products))
+            ), type, overflow);
+        }
+        case Expr::SExt: {
+            Interval op = this->eval(llvm::cast<SExtExpr>(expr)->getOperand(0));
+            return fitToType(op, type, false);
+        }
+        case Expr::ZExt: {
+            auto zext = llvm::cast<ZExtExpr>(expr.get());
+            Interval op = this->eval(zext->getOperand(0));
+            if (op.getLower() >= 0) {
+                return fitToType(op, type, false);
+            }
+
+            unsigned width = llvm::cast<BvType>(zext->getOperand(0)->getType()).getWidth();
+            if (width >= 63) {
+                return Interval::ForType(type);
+            }
+
+            int64_t modulus = int64_t{1} << width;
+            if (op.getUpper() < 0) {
+                return fitToType(Interval(op.getLower() + modulus, op.getUpper() + modulus), type, false);
+            }
+            return fitToType(Interval(0, modulus - 1), type, false);
+        }
+        case Expr::Extract: {
+            auto extract = llvm::cast<ExtractExpr>(expr.get());
+            if (extract->getOffset() != 0 || type.isBoolType()) {
+                return Interval::ForType(type);
+            }
+
+            // Truncation keeps the value if it fits the smaller type.
+            Interval op = this->eval(extract->getOperand(0));
+            return fitToType(op, type, false);
+        }
+        default:
+            return Interval::ForType(type);
+    }
+}
+
+Interval IntervalEvaluator::visitComparison(Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right)
+{
+    Interval l = this->eval(left);
+    Interval r = this->eval(right);
+
+    switch (kind) {
+        case Expr::Eq:
+            return makeBool(!(l.isConstant() && l == r), !l.meet(r).isEmpty());
+        case Expr::NotEq:
+            return makeBool(!l.meet(r).isEmpty(), !(l.isConstant() && l == r));
+        case Expr::BvULt: case Expr::BvULtEq: case Expr::BvUGt: case Expr::BvUGtEq: {
+            bool isLeftNegative = l.getUpper() < 0;
+            bool isRightNegative = r.getUpper() < 0;
+            bool isLeftPositive = l.getLower() >= 0;
+            bool isRightPositive = r.getLower() >= 0;
+
+            if ((isLeftNegative || isLeftPositive) && (isRightNegative || isRightPositive)
+                && isLeftNegative != isRightNegative) {
+                // Negative values are greater than the non-negative ones.
+                bool isGreater = isLeftNegative;
+                bool isGreaterKind = kind == Expr::BvUGt || kind == Expr::BvUGtEq;
+                return Interval::Constant(isGreater == isGreaterKind ? 1 : 0);
+            }
+
+            if ((isLeftNegative && isRightNegative) || (isLeftPositive && isRightPositive)) {
+                switch (kind) {
+                    case Expr::BvULt: return this->visitComparison(Expr::Lt, left, right);
+                    case Expr::BvULtEq: return this->visitComparison(Expr::LtEq, left, right);
+                    case Expr::BvUGt: return this->visitComparison(Expr::Gt, left, right);
+                    default: return this->visitComparison(Expr::GtEq, left, right);
+                }
+            }
+
+            return Interval(0, 1);
+        }
+        case Expr::Lt: case Expr::BvSLt:
+            return makeBool(l.getUpper() >= r.getLower(), l.getLower() < r.getUpper());
+        case Expr::LtEq: case Expr::BvSLtEq:
+            return makeBool(l.getUpper() > r.getLower(), l.getLower() <= r.getUpper());
+        case Expr::Gt: case Expr::BvSGt:
+            return makeBool(r.getUpper() >= l.getLower(), r.getLower() < l.getUpper());
+        case Expr::GtEq: case Expr::BvSGtEq:
+            return makeBool(r.getUpper() > l.getLower(), r.getLower() <= l.getUpper());
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+// Refinement
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+/// Restricts the value of \p term to \p interval in \p state.
+void refineTerm(const ExprPtr& term, const Interval& interval, IntervalState& state)
+{
+    if (state.isBottom()) {
+        return;
+    }
+
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(term.get())) {
+        Variable* variable = &varRef->getVariable();
+        state.set(variable, state.get(variable).meet(interval));
+        return;
+    }
+
+    switch (term->getKind()) {
+        case Expr::SExt:
+            refineTerm(llvm::cast<SExtExpr>(term)->getOperand(0), interval, state);
+            return;
+        case Expr::ZExt: {
+            // Zero extension keeps the non-negative values.
+            ExprPtr op = llvm::cast<ZExtExpr>(term)->getOperand(0);
+            if (IntervalEvaluator(state).eval(op).getLower() >= 0) {
+                refineTerm(op, interval, state);
+            }
+            return;
+        }
+        case Expr::Add:
+        case Expr::Sub: {
+            // Integer terms with a constant operand can be inverted.
+            if (!term->getType().isIntType()) {
+                return;
+            }
+
+            auto binary = llvm::cast<NonNullaryExpr>(term.get());
+            IntervalEvaluator eval(state);
+            Interval left = eval.eval(binary->getOperand(0));
+            Interval right = eval.eval(binary->getOperand(1));
+            bool overflow = false;
+
+            auto shift = [&overflow](const Interval& target, int64_t offset, bool negate) {
+                return negate
+                    ? Interval(
+                        subBound(target.getLower(), offset, true, overflow),
+                        subBound(target.getUpper(), offset, true, overflow))
+                    : Interval(
+                        addBound(target.getLower(), offset, true, overflow),
+                        addBound(target.getUpper(), offset, true, overflow));
+            };
+
+            bool isAdd = term->getKind() == Expr::Add;
+            if (right.isConstant()) {
+                // x + c in I => x in I - c, x - c in I => x in I + c
+                refineTerm(binary->getOperand(0), shift(interval, right.getLower(), isAdd), state);
+            } else if (left.isConstant() && isAdd) {
+                refineTerm(binary->getOperand(1), shift(interval, left.getLower(), true), state);
+            }
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+void refineComparison(Expr::ExprKind kind, const ExprPtr& left, const ExprPtr& right, IntervalState& state)
+{
+    bool isInt = left->getType().isIntType();
+
+    Interval l = IntervalEvaluator(state).eval(left);
+    Interval r = IntervalEvaluator(state).eval(right);
+
+    switch (kind) {
+        case Expr::Eq:
+            refineTerm(left, r, state);
+            refineTerm(right, l, state);
+            return;
+        case Expr::NotEq: {
+            // Only the bounds of an interval can be excluded.
+            auto exclude = [&state](const ExprPtr& term, const Interval& value, const Interval& other) {
+                if (!other.isConstant()) {
+                    return;
+                }
+                if (value.getLower() == other.getLower()) {
+                    refineTerm(term, greaterThan(other, false), state);
+                } else if (value.getUpper() == other.getUpper()) {
+                    refineTerm(term, lessThan(other, false), state);
+                }
+            };
+            exclude(left, l, r);
+            exclude(right, r, l);
+            return;
+        }
+        case Expr::Lt: case Expr::BvSLt:
+            refineTerm(left, lessThan(r, isInt), state);
+            refineTerm(right, greaterThan(l, isInt), state);
+            return;
+        case Expr::LtEq: case Expr::BvSLtEq:
+            refineTerm(left, lessOrEqual(r), state);
+            refineTerm(right, greaterOrEqual(l), state);
+            return;
+        case Expr::Gt: case Expr::BvSGt:
+            refineComparison(Expr::Lt, right, left, state);
+            return;
+        case Expr::GtEq: case Expr::BvSGtEq:
+            refineComparison(Expr::LtEq, right, left, state);
+            return;
+        case Expr::BvUGt:
+            refineComparison(Expr::BvULt, right, left, state);
+            return;
+        case Expr::BvUGtEq:
+            refineComparison(Expr::BvULtEq, right, left, state);
+            return;
+        case Expr::BvULt:
+        case Expr::BvULtEq: {
+            // If the right side is non-negative, so is the left one. If the
+            // left side is negative, so is the right one. In both cases, the
+            // unsigned order is the same as the signed one.
+            if (r.getLower() >= 0) {
+                refineTerm(left, Interval(0, Interval::Max), state);
+            } else if (l.getUpper() < 0) {
+                refineTerm(right, Interval(Interval::Min, -1), state);
+            } else {
+                return;
+            }
+
+            refineComparison(kind == Expr::BvULt ? Expr::BvSLt : Expr::BvSLtEq, left, right, state);
+            return;
+        }
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+void assume(const ExprPtr& expr, bool positive, IntervalState& state)
+{
+    if (state.isBottom()) {
+        return;
+    }
+
+    Expr::ExprKind kind = expr->getKind();
+
+    if (kind == Expr::Not) {
+        assume(llvm::cast<NotExpr>(expr)->getOperand(0), !positive, state);
+        return;
+    }
+
+    if (kind == Expr::And || kind == Expr::Or || kind == Expr::Imply) {
+        auto nary = llvm::cast<NonNullaryExpr>(expr.get());
+
+        // An implication A => B is treated as the disjunction (not A) or B.
+        llvm::SmallVector<std::pair<ExprPtr, bool>, 4> operands;
+        for (size_t i = 0; i < nary->getNumOperands(); ++i) {
+            bool isNegated = kind == Expr::Imply && i == 0;
+            operands.emplace_back(nary->getOperand(i), isNegated ? !positive : positive);
+        }
+
+        bool isConjunction = (kind == Expr::And) == positive;
+        if (isConjunction) {
+            for (auto& [op, value] : operands) {
+                assume(op, value, state);
+            }
+            return;
+        }
+
+        IntervalState result = IntervalState::Bottom();
+        for (auto& [op, value] : operands) {
+            IntervalState copy = state;
+            assume(op, value, copy);
+            result.join(copy);
+        }
+        state = result;
+        return;
+    }
+
+    if (llvm::isa<VarRefExpr>(expr.get())) {
+        // The variable may already be known to hold the other value.
+        refineTerm(expr, Interval::Constant(positive ? 1 : 0), state);
+        return;
+    }
+
+    if (isComparison(kind)) {
+        auto cmp = llvm::cast<NonNullaryExpr>(expr.get());
+        if (Interval::isTracked(cmp->getOperand(0)->getType())) {
+            refineComparison(positive ? kind : negateComparison(kind), cmp->getOperand(0), cmp->getOperand(1), state);
+        }
+    }
+
+    if (!state.isBottom() && !IntervalEvaluator(state).eval(expr).contains(positive ? 1 : 0)) {
+        state = IntervalState::Bottom();
+    }
+}
+
+/// Returns the state following \p edge, where the calls return one of the
+/// values described by \p getSummary. If \p entersLoopHead is set, the
+/// assignments of \p edge bind loop-carried variables.
+IntervalState post(
+    Transition* edge, const IntervalState& state,
+    llvm::function_ref<IntervalState(Cfa*)> getSummary,
+    bool entersLoopHead
+) {
+    IntervalState result = state;
+    assume(edge->getGuard(), true, result);
+
+    if (result.isBottom()) {
+        return result;
+    }
+
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        // The assignments are executed in order, so that chains of SSA values
+        // within a transition are evaluated precisely. The variables assigned on
+        // a transition entering a loop head are loop-carried, and all of them
+        // are read from the pre-state (see AssignTransition).
+        IntervalState pre = entersLoopHead ? result : IntervalState::Bottom();
+        IntervalEvaluator eval(entersLoopHead ? pre : result);
+        for (const VariableAssignment& assignment : *assign) {
+            Variable* variable = assignment.getVariable();
+            if (Interval::isTracked(variable->getType())) {
+                result.set(variable, eval.eval(assignment.getValue()));
+            }
+        }
+        return result;
+    }
+
+    auto call = llvm::cast<CallTransition>(edge);
+    IntervalState summary = getSummary(call->getCalledAutomaton());
+    if (summary.isBottom()) {
+        // The callee never returns.
+        return summary;
+    }
+
+    IntervalEvaluator calleeEval(summary);
+    for (const VariableAssignment& output : call->outputs()) {
+        Variable* variable = output.getVariable();
+        if (Interval::isTracked(variable->getType())) {
+            result.set(variable, calleeEval.eval(output.getValue()));
+        } else {
+            result.set(variable, Interval());
+        }
+    }
+
+    return result;
+}
+
+} // end anonymous namespace
+
+// IntervalAnalysis
+//-----------------------------------------------------------------------------
+
+IntervalAnalysis::IntervalAnalysis(AutomataSystem& system)
+{
+    CallGraph callGraph(system);
+    llvm::DenseSet<Cfa*> visited;
+
+    // Analyze the procedures bottom-up, so that the summaries of the callees
+    // are available.
+    for (Cfa& root : system) {
+        if (visited.count(&root) != 0) {
+            continue;
+        }
+
+        for (auto it = llvm::scc_begin(callGraph.lookupNode(&root)); !it.isAtEnd(); ++it) {
+            llvm::DenseSet<Cfa*> scc;
+            for (CallGraph::Node* node : *it) {
+                scc.insert(node->getCfa());
+            }
+
+            if (visited.count(*scc.begin()) != 0) {
+                continue;
+            }
+
+            bool isRecursive = scc.size() > 1 || llvm::any_of(*callGraph.lookupNode(*scc.begin()),
+                [&scc](const CallGraph::CallSite& call) { return scc.count(call.second->getCfa()) != 0; });
+
+            for (Cfa* cfa : scc) {
+                visited.insert(cfa);
+                this->analyze(cfa, isRecursive ? scc : llvm::DenseSet<Cfa*>());
+            }
+        }
+    }
+}
+
+void IntervalAnalysis::analyze(Cfa* cfa, const llvm::DenseSet<Cfa*>& recursive)
+{
+    // Number the reachable locations in reverse post-order.
+    std::vector<Location*> order;
+    llvm::DenseMap<Location*, size_t> index;
+
+    llvm::DenseSet<Location*> visited = { cfa->getEntry() };
+    std::vector<std::pair<Location*, size_t>> stack = { { cfa->getEntry(), 0 } };
+    while (!stack.empty()) {
+        Location* loc = stack.back().first;
+        size_t idx = stack.back().second++;
+
+        if (idx >= loc->getNumOutgoing()) {
+            order.push_back(loc);
+            stack.pop_back();
+            continue;
+        }
+
+        Location* target = (*std::next(loc->outgoing_begin(), idx))->getTarget();
+        if (visited.insert(target).second) {
+            stack.emplace_back(target, 0);
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); ++i) {
+        index[order[i]] = i;
+    }
+
+    for (Location* loc : order) {
+        for (Transition* edge : loc->outgoing()) {
+            if (index[edge->getTarget()] <= index[loc]) {
+                mLoopHeads.insert(edge->getTarget());
+            }
+        }
+    }
+
+    auto getSummary = [this, &recursive](Cfa* callee) {
+        if (recursive.count(callee) != 0) {
+            return IntervalState::Top();
+        }
+
+        auto it = mSummaries.find(callee);
+        return it != mSummaries.end() ? it->second : IntervalState::Top();
+    };
+
+    auto calculate = [this, cfa, &getSummary](Location* loc) {
+        IntervalState result = loc == cfa->getEntry() ? IntervalState::Top() : IntervalState::Bottom();
+        for (Transition* edge : loc->incoming()) {
+            auto it = mStates.find(edge->getSource());
+            if (it != mStates.end() && !it->second.isBottom()) {
+                result.join(post(edge, it->second, getSummary, this->isLoopHead(loc)));
+            }
+        }
+        return result;
+    };
+
+    for (Location* loc : order) {
+        mStates.try_emplace(loc, IntervalState::Bottom());
+    }
+
+    llvm::DenseMap<Location*, unsigned> visits;
+    std::set<size_t> worklist = { 0 };
+
+    while (!worklist.empty()) {
+        Location* loc = order[*worklist.begin()];
+        worklist.erase(worklist.begin());
+
+        IntervalState next = calculate(loc);
+        IntervalState& current = mStates.find(loc)->second;
+
+        if (this->isLoopHead(loc) && ++visits[loc] > WideningDelay) {
+            IntervalState widened = current;
+            widened.widen(next);
+            next = std::move(widened);
+        }
+
+        if (next == current) {
+            continue;
+        }
+
+        current = std::move(next);
+        for (Transition* edge : loc->outgoing()) {
+            worklist.insert(index[edge->getTarget()]);
+        }
+    }
+
+    for (unsigned i = 0; i < NarrowingIterations; ++i) {
+        for (Location* loc : order) {
+            mStates.find(loc)->second = calculate(loc);
+        }
+    }
+
+    mSummaries.try_emplace(cfa, this->getState(cfa->getExit()));
+}
+
+const IntervalState& IntervalAnalysis::getState(Location* location) const
+{
+    static const IntervalState Unreachable = IntervalState::Bottom();
+
+    auto it = mStates.find(location);
+    return it != mStates.end() ? it->second : Unreachable;
+}
+
+bool IntervalAnalysis::isFeasible(Transition* edge) const
+{
+    IntervalState state = this->getState(edge->getSource());
+    assume(edge->getGuard(), true, state);
+
+    return !state.isBottom();
+}
+
+bool IntervalAnalysis::isGuardValid(Transition* edge) const
+{
+    const IntervalState& state = this->getState(edge->getSource());
+    if (state.isBottom()) {
+        return false;
+    }
+
+    return IntervalEvaluator(state).eval(edge->getGuard()) == Interval::Constant(1);
+}
+
+ExprPtr IntervalAnalysis::getInvariant(Location* location, ExprBuilder& builder) const
+{
+    const IntervalState& state = this->getState(location);
+    if (state.isBottom()) {
+        return builder.False();
+    }
+
+    // Sort the variables by name, so that the result is deterministic.
+    std::vector<std::pair<Variable*, Interval>> intervals(state.begin(), state.end());
+    std::sort(intervals.begin(), intervals.end(), [](auto& left, auto& right) {
+        return left.first->getName() < right.first->getName();
+    });
+
+    ExprVector bounds;
+    for (auto& [variable, interval] : intervals) {
+        ExprPtr ref = variable->getRefExpr();
+        Interval range = Interval::ForType(variable->getType());
+
+        if (variable->getType().isBoolType()) {
+            bounds.push_back(interval.getLower() == 1 ? ref : builder.Not(ref));
+        } else if (variable->getType().isIntType()) {
+            if (interval.getLower() != Interval::Min) {
+                bounds.push_back(builder.GtEq(ref, builder.IntLit(interval.getLower())));
+            }
+            if (interval.getUpper() != Interval::Max) {
+                bounds.push_back(builder.LtEq(ref, builder.IntLit(interval.getUpper())));
+            }
+        } else {
+            unsigned width = llvm::cast<BvType>(variable->getType()).getWidth();
+            if (interval.getLower() != range.getLower()) {
+                bounds.push_back(builder.BvSGtEq(ref, builder.BvLit(llvm::APInt(width, interval.getLower(), true))));
+            }
+            if (interval.getUpper() != range.getUpper()) {
+                bounds.push_back(builder.BvSLtEq(ref, builder.BvLit(llvm::APInt(width, interval.getUpper(), true))));
+            }
+        }
+    }
+
+    if (bounds.empty()) {
+        return builder.True();
+    }
+
+    return bounds.size() == 1 ? bounds.front() : builder.And(bounds);
+}
@@ -0,0 +1,83 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/IntervalAnalysis.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+using namespace gazer;
+
+IntervalSimplificationResult gazer::TransformIntervalSimplification(AutomataSystem& system, bool addInvariants)
+{
+    IntervalAnalysis analysis(system);
+    auto builder = CreateFoldingExprBuilder(system.getContext());
+
+    IntervalSimplificationResult result;
+
+    for (Cfa& cfa : system) {
+        std::vector<Transition*> infeasible;
+        std::vector<Transition*> valid;
+
+        for (auto& edge : cfa.edges()) {
+            if (!analysis.isFeasible(edge.get())) {
+                infeasible.push_back(edge.get());
+            } else if (!llvm::isa<BoolLiteralExpr>(edge->getGuard()) && analysis.isGuardValid(edge.get())) {
+                valid.push_back(edge.get());
+            }
+        }
+
+        for (Transition* edge : valid) {
+            edge->setGuard(builder->True());
+            ++result.NumSimplifiedGuards;
+        }
+
+        if (addInvariants) {
+            for (auto& loc : cfa.nodes()) {
+                if (!analysis.isLoopHead(loc.get()) || !analysis.isReachable(loc.get())) {
+                    continue;
+                }
+
+                ExprPtr invariant = analysis.getInvariant(loc.get(), *builder);
+                if (invariant == builder->True()) {
+                    continue;
+                }
+
+                for (Transition* edge : loc->outgoing()) {
+                    edge->setGuard(builder->And(invariant, edge->getGuard()));
+                }
+                ++result.NumInvariants;
+            }
+        }
+
+        for (Transition* edge : infeasible) {
+            cfa.disconnectEdge(edge);
+            ++result.NumRemovedTransitions;
+        }
+
+        // The exit location must be kept, even if it became unreachable.
+        if (cfa.getExit()->getNumIncoming() == 0) {
+            cfa.createAssignTransition(cfa.getEntry(), cfa.getExit(), builder->False());
+        }
+
+        size_t numLocations = cfa.getNumLocations();
+        cfa.removeUnreachableLocations();
+        result.NumRemovedLocations += numLocations - cfa.getNumLocations();
+    }
+
+    return result;
+}
@@ -0,0 +1,336 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The encoding runs on the recursive form of the automata, before they are
+// made cyclic, thus it never sees the parallel assignments of transitions
+// entering a loop header (see AssignTransition). The assignments of every
+// transition are executed sequentially, after evaluating its guard. Merging
+// two consecutive transitions therefore keeps their assignments in order,
+// while the guard of the second one is rewritten to refer to the values
+// assigned by the first one.
+//
+// Folding two parallel transitions requires their guards to be complementary:
+// otherwise both of them could be enabled at once, and the folded transition
+// would lose one of the nondeterministic choices.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallPtrSet.h>
+
+using namespace gazer;
+
+namespace
+{
+
+using VariableSetT = llvm::SmallPtrSet<Variable*, 8>;
+
+/// Returns true if \p expr references any variable of \p variables.
+bool referencesAny(const ExprPtr& expr, const VariableSetT& variables)
+{
+    if (variables.empty()) {
+        return false;
+    }
+
+    llvm::SmallVector<Expr*, 16> worklist;
+    llvm::DenseSet<Expr*> visited;
+
+    worklist.push_back(expr.get());
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            if (variables.count(&varRef->getVariable()) != 0) {
+                return true;
+            }
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& op : nonNullary->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+
+    return false;
+}
+
+class LargeBlockEncoder
+{
+public:
+    LargeBlockEncoder(Cfa* cfa, std::function<bool(Location*)> keep)
+        : mCfa(cfa), mKeep(std::move(keep)),
+        mExprBuilder(CreateFoldingExprBuilder(cfa->getParent().getContext()))
+    {}
+
+    LargeBlockEncodingResult transform();
+
+private:
+    bool canEliminate(Location* loc);
+
+    /// Merges the incoming and outgoing transitions of \p loc.
+    bool mergeChain(Location* loc);
+
+    /// Folds a pair of parallel outgoing transitions of \p loc.
+    bool foldParallelEdges(Location* loc);
+    bool tryFold(AssignTransition* first, AssignTransition* second);
+
+    /// Rewrites the assignments of \p edge so that each value refers to the
+    /// values of the variables before taking the transition.
+    /// Returns false if the transition contains undefined values.
+    bool collectParallelValues(
+        AssignTransition* edge,
+        llvm::DenseMap<Variable*, ExprPtr>& values,
+        std::vector<Variable*>& order
+    );
+
+private:
+    Cfa* mCfa;
+    std::function<bool(Location*)> mKeep;
+    std::unique_ptr<ExprBuilder> mExprBuilder;
+    LargeBlockEncodingResult mResult;
+};
+
+} // end anonymous namespace
+
+LargeBlockEncodingResult LargeBlockEncoder::transform()
+{
+#ifndef NDEBUG
+    std::vector<Location*> topo;
+    assert(createTopologicalSort(mCfa, topo)
+        && "Large-block encoding requires an acyclic automaton with sequential assignments!");
+#endif
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        // Merged locations are only disconnected here, so the pointers
+        // of this list remain valid until the end of the transformation.
+        std::vector<Location*> locations;
+        for (auto& loc : mCfa->nodes()) {
+            locations.push_back(loc.get());
+        }
+
+        for (Location* loc : locations) {
+            if (this->mergeChain(loc)) {
+                ++mResult.NumMergedLocations;
+                changed = true;
+            }
+        }
+
+        for (Location* loc : locations) {
+            while (this->foldParallelEdges(loc)) {
+                ++mResult.NumFoldedEdges;
+                changed = true;
+            }
+        }
+    }
+
+    if (mResult.NumMergedLocations != 0 || mResult.NumFoldedEdges != 0) {
+        mCfa->clearDisconnectedElements();
+    }
+
+    return mResult;
+}
+
+bool LargeBlockEncoder::canEliminate(Location* loc)
+{
+    if (loc == mCfa->getEntry() || loc == mCfa->getExit() || loc->isError()) {
+        return false;
+    }
+
+    if (mKeep && mKeep(loc)) {
+        return false;
+    }
+
+    return loc->getNumIncoming() == 1 && loc->getNumOutgoing() == 1;
+}
+
+bool LargeBlockEncoder::mergeChain(Location* loc)
+{
+    if (!this->canEliminate(loc)) {
+        return false;
+    }
+
+    auto first = llvm::dyn_cast<AssignTransition>(*loc->incoming_begin());
+    auto second = llvm::dyn_cast<AssignTransition>(*loc->outgoing_begin());
+
+    if (first == nullptr || second == nullptr || first->getSource() == loc) {
+        return false;
+    }
+
+    // Calculate the values of the variables after the first transition,
+    // in terms of their values before it.
+    VariableExprRewrite rewrite(*mExprBuilder);
+    VariableSetT undefs;
+
+    for (const VariableAssignment& assign : *first) {
+        Variable* variable = assign.getVariable();
+        if (llvm::isa<UndefExpr>(assign.getValue())) {
+            rewrite[variable] = nullptr;
+            undefs.insert(variable);
+            continue;
+        }
+
+        ExprPtr value = rewrite.walk(assign.getValue());
+        rewrite[variable] = value;
+        undefs.erase(variable);
+    }
+
+    ExprPtr guard = rewrite.walk(second->getGuard());
+    if (referencesAny(guard, undefs)) {
+        // The guard depends on a nondeterministic value, which cannot be
+        // expressed before the first transition.
+        return false;
+    }
+
+    std::vector<VariableAssignment> assignments(first->begin(), first->end());
+    assignments.insert(assignments.end(), second->begin(), second->end());
+
+    mCfa->createAssignTransition(
+        first->getSource(), second->getTarget(),
+        mExprBuilder->And(first->getGuard(), guard),
+        std::move(assignments)
+    );
+    mCfa->disconnectLocation(loc);
+
+    return true;
+}
+
+bool LargeBlockEncoder::foldParallelEdges(Location* loc)
+{
+    if (loc->getNumOutgoing() < 2) {
+        return false;
+    }
+
+    llvm::SmallVector<AssignTransition*, 8> edges;
+    for (Transition* edge : loc->outgoing()) {
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            edges.push_back(assign);
+        }
+    }
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+        for (size_t j = i + 1; j < edges.size(); ++j) {
+            if (edges[i]->getTarget() == edges[j]->getTarget() && this->tryFold(edges[i], edges[j])) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool LargeBlockEncoder::tryFold(AssignTransition* first, AssignTransition* second)
+{
+    // The condition under which the first transition is taken.
+    ExprPtr condition;
+    if (mExprBuilder->Not(first->getGuard()) == second->getGuard()) {
+        condition = first->getGuard();
+    } else if (mExprBuilder->Not(second->getGuard()) == first->getGuard()) {
+        condition = mExprBuilder->Not(second->getGuard());
+    } else {
+        return false;
+    }
+
+    llvm::DenseMap<Variable*, ExprPtr> firstValues, secondValues;
+    std::vector<Variable*> order;
+
+    if (!this->collectParallelValues(first, firstValues, order)
+        || !this->collectParallelValues(second, secondValues, order)
+    ) {
+        return false;
+    }
+
+    // The folded assignments are parallel, thus they may only be emitted
+    // sequentially if none of them depends on a previously assigned variable.
+    VariableSetT assigned(order.begin(), order.end());
+    if (referencesAny(condition, assigned)) {
+        return false;
+    }
+
+    VariableSetT emitted;
+    std::vector<VariableAssignment> assignments;
+    for (Variable* variable : order) {
+        ExprPtr thenValue = firstValues.lookup(variable);
+        ExprPtr elseValue = secondValues.lookup(variable);
+
+        ExprPtr value = mExprBuilder->Select(
+            condition,
+            thenValue != nullptr ? thenValue : variable->getRefExpr(),
+            elseValue != nullptr ? elseValue : variable->getRefExpr()
+        );
+
+        if (referencesAny(value, emitted)) {
+            return false;
+        }
+
+        assignments.emplace_back(variable, value);
+        emitted.insert(variable);
+    }
+
+    mCfa->createAssignTransition(
+        first->getSource(), first->getTarget(),
+        mExprBuilder->Or(first->getGuard(), second->getGuard()),
+        std::move(assignments)
+    );
+    mCfa->disconnectEdge(first);
+    mCfa->disconnectEdge(second);
+
+    return true;
+}
+
+bool LargeBlockEncoder::collectParallelValues(
+    AssignTransition* edge,
+    llvm::DenseMap<Variable*, ExprPtr>& values,
+    std::vector<Variable*>& order
+) {
+    VariableExprRewrite rewrite(*mExprBuilder);
+
+    for (const VariableAssignment& assign : *edge) {
+        if (llvm::isa<UndefExpr>(assign.getValue())) {
+            return false;
+        }
+
+        Variable* variable = assign.getVariable();
+        ExprPtr value = rewrite.walk(assign.getValue());
+
+        rewrite[variable] = value;
+        values[variable] = value;
+
+        if (std::find(order.begin(), order.end(), variable) == order.end()) {
+            order.push_back(variable);
+        }
+    }
+
+    return true;
+}
+
+LargeBlockEncodingResult gazer::TransformLargeBlockEncoding(Cfa* cfa, std::function<bool(Location*)> keep)
+{
+    LargeBlockEncoder encoder(cfa, std::move(keep));
+    return encoder.transform();
+}
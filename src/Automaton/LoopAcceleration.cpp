@@ -0,0 +1,919 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// A loop is accelerated if it is a simple cycle of assign transitions, which
+// is entered through a single location and left from a single location.
+// Composing the transitions of the cycle, starting from the exiting location,
+// yields the guard G and the parallel updates of one iteration. Each updated
+// variable must either be an induction variable (X := X + D or X := X - D,
+// where D is not modified by the loop), or a derived variable, whose value
+// only depends on induction variables and unmodified ones.
+//
+// In iteration j, an induction variable holds X + j * D, while a derived
+// variable holds the value calculated from the induction variables of
+// iteration j - 1. The loop may be iterated n times if G holds in the first
+// n iterations. Beginning with the second iteration, G can be expressed over
+// the induction variables alone. If it is a conjunction of linear comparisons
+// over them, the iterations satisfying it form an interval, thus it is enough
+// to check the first, the second and the last iteration.
+//
+// The verifiers encode assignments as equalities, thus a variable may only be
+// assigned once along a path. Integer loops are replaced by the accelerated
+// transition, which assigns the final values of the modified variables, while
+// the assignments preceding it are renamed to new '_init' variables.
+//
+// Bit-vector operands are only linear as long as they do not overflow, which
+// is checked on a wider bit-vector type in the second and the last iteration.
+// The iterations following an overflow cannot be represented by the
+// accelerated transition, thus the original cycle is kept next to it. The
+// accelerated transition leads from the loop entry back to itself, assigning
+// only the variables which are also assigned by the transition closing the
+// cycle.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
+
+using namespace gazer;
+
+namespace
+{
+
+using VariableSetT = llvm::SmallPtrSet<Variable*, 8>;
+
+/// Returns true if \p expr references any variable of \p variables.
+bool referencesAny(const ExprPtr& expr, const VariableSetT& variables)
+{
+    if (variables.empty()) {
+        return false;
+    }
+
+    llvm::SmallVector<Expr*, 16> worklist;
+    llvm::DenseSet<Expr*> visited;
+
+    worklist.push_back(expr.get());
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            if (variables.count(&varRef->getVariable()) != 0) {
+                return true;
+            }
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& op : nonNullary->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+
+    return false;
+}
+
+bool isComparison(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq:
+        case Expr::Lt: case Expr::LtEq: case Expr::Gt: case Expr::GtEq:
+        case Expr::BvSLt: case Expr::BvSLtEq: case Expr::BvSGt: case Expr::BvSGtEq:
+        case Expr::BvULt: case Expr::BvULtEq: case Expr::BvUGt: case Expr::BvUGtEq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isUnsignedComparison(Expr::ExprKind kind)
+{
+    return kind == Expr::BvULt || kind == Expr::BvULtEq
+        || kind == Expr::BvUGt || kind == Expr::BvUGtEq;
+}
+
+/// A simple cycle, which can only be entered through its entry location and
+/// left from its exiting location.
+struct SimpleLoop
+{
+    Location* exiting = nullptr;
+    Location* entry = nullptr;
+
+    /// The transitions of the cycle, starting from the exiting location.
+    std::vector<AssignTransition*> edges;
+};
+
+struct InductionVariable
+{
+    ExprPtr step;
+    bool decrement;
+};
+
+class LoopAccelerator
+{
+public:
+    explicit LoopAccelerator(Cfa* cfa)
+        : mCfa(cfa), mContext(cfa->getParent().getContext()),
+        mExprBuilder(CreateFoldingExprBuilder(mContext))
+    {}
+
+    LoopAccelerationResult transform();
+
+private:
+    bool findLoop(Location* exiting, SimpleLoop& loop);
+    bool accelerate(const SimpleLoop& loop);
+
+    /// Summarizes the iterations of the cycle formed by \p edges, entering the
+    /// loop at \p header. Returns false if the cycle cannot be accelerated.
+    bool analyze(llvm::ArrayRef<AssignTransition*> edges, Location* header);
+
+    /// Calculates the guard and the parallel updates of a single iteration.
+    /// Returns false if the cycle contains undefined values.
+    bool summarize(llvm::ArrayRef<AssignTransition*> edges, Location* header);
+
+    /// Sorts the updated variables into induction and derived variables.
+    bool classifyUpdates();
+
+    /// Collects the comparisons of \p expr which depend on the induction
+    /// variables. Returns false if \p expr is not a conjunction of linear
+    /// comparisons and loop-invariant expressions.
+    bool collectLinearComparisons(const ExprPtr& expr);
+    bool isLinear(const ExprPtr& expr);
+
+    /// Replaces an integer loop with the accelerated transition.
+    bool replaceLoop(const SimpleLoop& loop);
+
+    /// Adds an accelerated transition from the entry of a bit-vector loop
+    /// back to the entry.
+    bool addShortcut(const SimpleLoop& loop);
+
+    Variable* createCounter();
+
+    /// Returns the condition of the loop being iterated \p count times.
+    ExprPtr buildAcceleratedGuard(const ExprPtr& count);
+
+    /// Returns the value of a modified variable after \p count iterations.
+    ExprPtr getClosedForm(Variable* variable, const ExprPtr& count);
+
+    /// Returns the value of an induction variable after \p count iterations.
+    ExprPtr iterate(Variable* variable, const ExprPtr& count);
+
+    /// Returns the guard of the loop in the given iteration, which must not
+    /// be the first one.
+    ExprPtr guardAt(const ExprPtr& iteration);
+
+    /// Returns the condition of the linear comparisons having no overflowing
+    /// operands in the given iteration.
+    ExprPtr noOverflowAt(const ExprPtr& iteration);
+    ExprPtr widen(const ExprPtr& term, const ExprPtr& iteration, BvType& type, bool isSigned);
+    unsigned getRequiredWidth(const ExprPtr& term);
+
+    ExprPtr countLit(unsigned value);
+    ExprPtr countGtEq(const ExprPtr& count, unsigned value);
+
+private:
+    Cfa* mCfa;
+    GazerContext& mContext;
+    std::unique_ptr<ExprBuilder> mExprBuilder;
+
+    // The summary of the loop being accelerated
+    ExprPtr mGuard;
+    llvm::MapVector<Variable*, ExprPtr> mUpdates;
+    llvm::MapVector<Variable*, InductionVariable> mInductions;
+    llvm::MapVector<Variable*, ExprPtr> mDerived;
+    VariableSetT mInductionSet;
+
+    /// The guard of an iteration, expressed over the induction variables.
+    ExprPtr mIterationGuard;
+    ExprVector mLinearComparisons;
+
+    /// The type of the iteration counter: integer if the induction variables
+    /// are integers, or a bit-vector wider than any of them.
+    Type* mCountType = nullptr;
+
+    LoopAccelerationResult mResult;
+};
+
+} // end anonymous namespace
+
+LoopAccelerationResult LoopAccelerator::transform()
+{
+    std::vector<Location*> candidates;
+    for (auto& loc : mCfa->nodes()) {
+        if (loc->getNumOutgoing() > 1 && !loc->isError()) {
+            candidates.push_back(loc.get());
+        }
+    }
+
+    for (Location* loc : candidates) {
+        SimpleLoop loop;
+        if (this->findLoop(loc, loop) && this->accelerate(loop)) {
+            ++mResult.NumAcceleratedLoops;
+        }
+    }
+
+    if (mResult.NumAcceleratedLoops != 0) {
+        mCfa->clearDisconnectedElements();
+    }
+
+    return mResult;
+}
+
+bool LoopAccelerator::findLoop(Location* exiting, SimpleLoop& loop)
+{
+    unsigned numCycles = 0;
+
+    for (Transition* edge : exiting->outgoing()) {
+        std::vector<AssignTransition*> path;
+        llvm::SmallPtrSet<Location*, 16> visited;
+        Location* entry = nullptr;
+        Transition* current = edge;
+
+        while (auto assign = llvm::dyn_cast<AssignTransition>(current)) {
+            path.push_back(assign);
+            Location* target = assign->getTarget();
+
+            if (target->getNumIncoming() > 1) {
+                if (entry != nullptr) {
+                    // The cycle has multiple entry locations.
+                    break;
+                }
+                entry = target;
+            }
+
+            if (target == exiting) {
+                ++numCycles;
+                loop.exiting = exiting;
+                loop.entry = entry;
+                loop.edges = std::move(path);
+                break;
+            }
+
+            if (target->getNumOutgoing() != 1 || !visited.insert(target).second) {
+                break;
+            }
+            current = *target->outgoing_begin();
+        }
+    }
+
+    // Unreachable cycles (without an entry) are left alone.
+    return numCycles == 1 && loop.entry != nullptr;
+}
+
+bool LoopAccelerator::accelerate(const SimpleLoop& loop)
+{
+    if (!this->analyze(loop.edges, loop.entry)) {
+        return false;
+    }
+
+    if (mCountType->isBvType()) {
+        return this->addShortcut(loop);
+    }
+
+    return this->replaceLoop(loop);
+}
+
+bool LoopAccelerator::analyze(llvm::ArrayRef<AssignTransition*> edges, Location* header)
+{
+    if (!this->summarize(edges, header) || !this->classifyUpdates()) {
+        return false;
+    }
+
+    // The derived variables hold the values calculated from the induction
+    // variables of the previous iteration.
+    VariableExprRewrite previous(*mExprBuilder);
+    for (auto& [variable, induction] : mInductions) {
+        previous[variable] = induction.decrement
+            ? mExprBuilder->Add(variable->getRefExpr(), induction.step)
+            : mExprBuilder->Sub(variable->getRefExpr(), induction.step);
+    }
+
+    VariableExprRewrite derived(*mExprBuilder);
+    for (auto& [variable, value] : mDerived) {
+        derived[variable] = previous.walk(value);
+    }
+
+    mIterationGuard = derived.walk(mGuard);
+    mLinearComparisons.clear();
+
+    return this->collectLinearComparisons(mIterationGuard);
+}
+
+bool LoopAccelerator::summarize(llvm::ArrayRef<AssignTransition*> edges, Location* header)
+{
+    VariableExprRewrite rewrite(*mExprBuilder);
+    ExprVector guards;
+    llvm::SmallVector<Variable*, 8> order;
+    VariableSetT assigned;
+
+    for (AssignTransition* edge : edges) {
+        guards.push_back(rewrite.walk(edge->getGuard()));
+
+        // The transition entering the header binds the loop-carried variables
+        // in parallel, the assignments of the others are executed in order.
+        bool isParallel = edge->getTarget() == header;
+        llvm::SmallVector<std::pair<Variable*, ExprPtr>, 8> values;
+        for (const VariableAssignment& assign : *edge) {
+            if (llvm::isa<UndefExpr>(assign.getValue())) {
+                return false;
+            }
+
+            ExprPtr value = rewrite.walk(assign.getValue());
+            if (!isParallel) {
+                rewrite[assign.getVariable()] = value;
+            }
+            values.emplace_back(assign.getVariable(), value);
+        }
+
+        for (auto& [variable, value] : values) {
+            rewrite[variable] = value;
+            if (assigned.insert(variable).second) {
+                order.push_back(variable);
+            }
+        }
+    }
+
+    mGuard = mExprBuilder->And(guards);
+    mUpdates.clear();
+    for (Variable* variable : order) {
+        ExprPtr value = rewrite.walk(variable->getRefExpr());
+        if (value != variable->getRefExpr()) {
+            mUpdates.insert({variable, value});
+        }
+    }
+
+    return !mUpdates.empty();
+}
+
+bool LoopAccelerator::classifyUpdates()
+{
+    VariableSetT modified;
+    for (auto& [variable, value] : mUpdates) {
+        modified.insert(variable);
+    }
+
+    mInductions.clear();
+    mDerived.clear();
+    mInductionSet.clear();
+
+    for (auto& [variable, value] : mUpdates) {
+        ExprPtr self = variable->getRefExpr();
+        ExprPtr step = nullptr;
+        bool decrement = false;
+
+        if (auto add = llvm::dyn_cast<AddExpr>(value.get())) {
+            if (add->getLeft() == self) {
+                step = add->getRight();
+            } else if (add->getRight() == self) {
+                step = add->getLeft();
+            }
+        } else if (auto sub = llvm::dyn_cast<SubExpr>(value.get())) {
+            if (sub->getLeft() == self) {
+                step = sub->getRight();
+                decrement = true;
+            }
+        }
+
+        if (step != nullptr && !referencesAny(step, modified)) {
+            mInductions.insert({variable, { step, decrement }});
+            mInductionSet.insert(variable);
+        } else {
+            mDerived.insert({variable, value});
+        }
+    }
+
+    if (mInductions.empty()) {
+        return false;
+    }
+
+    // Anything but counters and values calculated from the counters and
+    // unmodified variables (e.g. swaps or other self-dependent updates)
+    // has no closed form here.
+    VariableSetT derived;
+    for (auto& [variable, value] : mDerived) {
+        derived.insert(variable);
+    }
+
+    for (auto& [variable, value] : mDerived) {
+        if (referencesAny(value, derived)) {
+            return false;
+        }
+    }
+
+    unsigned numInts = 0;
+    unsigned maxWidth = 0;
+    for (auto& [variable, induction] : mInductions) {
+        Type& type = variable->getType();
+        if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+            maxWidth = std::max(maxWidth, bvTy->getWidth());
+        } else if (type.isIntType()) {
+            ++numInts;
+        } else {
+            return false;
+        }
+    }
+
+    if (numInts == mInductions.size()) {
+        mCountType = &IntType::Get(mContext);
+        return true;
+    }
+
+    if (numInts == 0) {
+        // The counter must be able to represent 2^w iterations, after which
+        // the induction variables return to their initial values.
+        mCountType = &BvType::Get(mContext, maxWidth + 1);
+        return true;
+    }
+
+    return false;
+}
+
+bool LoopAccelerator::collectLinearComparisons(const ExprPtr& expr)
+{
+    if (!referencesAny(expr, mInductionSet)) {
+        return true;
+    }
+
+    if (auto andExpr = llvm::dyn_cast<AndExpr>(expr.get())) {
+        return std::all_of(andExpr->op_begin(), andExpr->op_end(), [this](const ExprPtr& op) {
+            return this->collectLinearComparisons(op);
+        });
+    }
+
+    if (isComparison(expr->getKind())) {
+        auto cmp = llvm::cast<NonNullaryExpr>(expr.get());
+        if (this->isLinear(cmp->getOperand(0)) && this->isLinear(cmp->getOperand(1))) {
+            mLinearComparisons.push_back(expr);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool LoopAccelerator::isLinear(const ExprPtr& expr)
+{
+    if (!referencesAny(expr, mInductionSet)) {
+        return true;
+    }
+
+    switch (expr->getKind()) {
+        case Expr::VarRef:
+            return true;
+        case Expr::Add:
+        case Expr::Sub: {
+            auto binary = llvm::cast<NonNullaryExpr>(expr.get());
+            return this->isLinear(binary->getOperand(0)) && this->isLinear(binary->getOperand(1));
+        }
+        case Expr::Mul: {
+            auto mul = llvm::cast<NonNullaryExpr>(expr.get());
+            ExprPtr left = mul->getOperand(0);
+            ExprPtr right = mul->getOperand(1);
+            return (this->isLinear(left) && !referencesAny(right, mInductionSet))
+                || (!referencesAny(left, mInductionSet) && this->isLinear(right));
+        }
+        default:
+            return false;
+    }
+}
+
+bool LoopAccelerator::replaceLoop(const SimpleLoop& loop)
+{
+    auto entryIt = llvm::find_if(loop.edges, [&loop](AssignTransition* edge) {
+        return edge->getTarget() == loop.entry;
+    });
+
+    std::vector<AssignTransition*> initEdges;
+    for (Transition* edge : loop.entry->incoming()) {
+        if (edge == *entryIt) {
+            continue;
+        }
+
+        auto assign = llvm::dyn_cast<AssignTransition>(edge);
+        if (assign == nullptr) {
+            return false;
+        }
+        initEdges.push_back(assign);
+    }
+
+    // Each modified variable must be defined on the way into the loop, either
+    // on all of the entering transitions or between the entry and the exit.
+    auto isAssignedOn = [](AssignTransition* edge, Variable* variable) {
+        return std::any_of(edge->begin(), edge->end(), [variable](const VariableAssignment& assign) {
+            return assign.getVariable() == variable;
+        });
+    };
+
+    for (auto& [variable, value] : mUpdates) {
+        Variable* current = variable;
+        bool isDefined = std::all_of(initEdges.begin(), initEdges.end(), [&](AssignTransition* edge) {
+            return isAssignedOn(edge, current);
+        }) || std::any_of(std::next(entryIt), loop.edges.end(), [&](AssignTransition* edge) {
+            return isAssignedOn(edge, current);
+        });
+
+        if (!isDefined) {
+            return false;
+        }
+    }
+
+    // The accelerated transition assigns the final values of the modified
+    // variables. In order to keep the automaton in SSA form, their values
+    // before the accelerated transition are moved into new variables.
+    VariableExprRewrite toInitial(*mExprBuilder);
+    llvm::DenseMap<Variable*, Variable*> initialVariables;
+    for (auto& [variable, value] : mUpdates) {
+        std::string name = variable->getName();
+        std::string prefix = mCfa->getName().str() + "/";
+        if (llvm::StringRef(name).startswith(prefix)) {
+            name = name.substr(prefix.size());
+        }
+
+        Variable* initial = mCfa->createLocal(name + "_init", variable->getType());
+        initialVariables[variable] = initial;
+        toInitial[variable] = initial->getRefExpr();
+    }
+
+    auto getTarget = [&initialVariables](Variable* variable) {
+        Variable* initial = initialVariables.lookup(variable);
+        return initial != nullptr ? initial : variable;
+    };
+
+    Variable* counter = this->createCounter();
+    ExprPtr count = counter->getRefExpr();
+
+    std::vector<VariableAssignment> assignments;
+    for (auto& [variable, value] : mUpdates) {
+        assignments.push_back({ variable, toInitial.walk(this->getClosedForm(variable, count)) });
+    }
+
+    std::vector<Transition*> exits;
+    for (Transition* edge : loop.exiting->outgoing()) {
+        if (edge != loop.edges.front()) {
+            exits.push_back(edge);
+        }
+    }
+
+    Location* chosen = mCfa->createLocation();
+    Location* after = mCfa->createLocation();
+
+    mCfa->createAssignTransition(loop.exiting, chosen, mExprBuilder->True(), {
+        { counter, mExprBuilder->Undef(*mCountType) }
+    });
+    mCfa->createAssignTransition(
+        chosen, after, toInitial.walk(this->buildAcceleratedGuard(count)), assignments
+    );
+
+    // The exits read the final values of the variables, they can be moved
+    // without changes.
+    for (Transition* edge : exits) {
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            mCfa->createAssignTransition(
+                after, edge->getTarget(), edge->getGuard(),
+                std::vector<VariableAssignment>(assign->begin(), assign->end())
+            );
+        } else {
+            auto call = llvm::cast<CallTransition>(edge);
+            mCfa->createCallTransition(
+                after, edge->getTarget(), edge->getGuard(), call->getCalledAutomaton(),
+                std::vector<VariableAssignment>(call->input_begin(), call->input_end()),
+                std::vector<VariableAssignment>(call->output_begin(), call->output_end())
+            );
+        }
+        mCfa->disconnectEdge(edge);
+    }
+
+    for (AssignTransition* edge : initEdges) {
+        std::vector<VariableAssignment> assigns;
+        for (const VariableAssignment& assign : *edge) {
+            assigns.push_back({ getTarget(assign.getVariable()), assign.getValue() });
+        }
+
+        mCfa->createAssignTransition(edge->getSource(), edge->getTarget(), edge->getGuard(), assigns);
+        mCfa->disconnectEdge(edge);
+    }
+
+    // The transitions from the entry to the exiting location are only taken
+    // before the first iteration.
+    for (auto it = std::next(entryIt); it != loop.edges.end(); ++it) {
+        AssignTransition* edge = *it;
+
+        std::vector<VariableAssignment> assigns;
+        for (const VariableAssignment& assign : *edge) {
+            assigns.push_back({ getTarget(assign.getVariable()), toInitial.walk(assign.getValue()) });
+        }
+
+        mCfa->createAssignTransition(
+            edge->getSource(), edge->getTarget(), toInitial.walk(edge->getGuard()), assigns
+        );
+        mCfa->disconnectEdge(edge);
+    }
+
+    for (auto it = loop.edges.begin(); it != std::next(entryIt); ++it) {
+        mCfa->disconnectEdge(*it);
+    }
+
+    return true;
+}
+
+bool LoopAccelerator::addShortcut(const SimpleLoop& loop)
+{
+    // The shortcut leads back to the entry, thus the iterations are counted
+    // from there.
+    auto entryIt = llvm::find_if(loop.edges, [&loop](AssignTransition* edge) {
+        return edge->getTarget() == loop.entry;
+    });
+
+    std::vector<AssignTransition*> edges(std::next(entryIt), loop.edges.end());
+    edges.insert(edges.end(), loop.edges.begin(), std::next(entryIt));
+
+    if (!this->analyze(edges, loop.entry)) {
+        return false;
+    }
+
+    // In SSA form, only the variables assigned on the transition entering
+    // the loop may be assigned by the shortcut. The other variables must be
+    // assigned in each iteration before reaching the exiting location, and
+    // before being read.
+    VariableSetT carried;
+    for (const VariableAssignment& assign : *edges.back()) {
+        carried.insert(assign.getVariable());
+    }
+
+    for (auto& [variable, value] : mUpdates) {
+        if (carried.count(variable) != 0) {
+            continue;
+        }
+
+        VariableSetT single;
+        single.insert(variable);
+
+        bool isAssignedFirst = false;
+        for (AssignTransition* edge : edges) {
+            if (edge->getSource() == loop.exiting || referencesAny(edge->getGuard(), single)) {
+                break;
+            }
+
+            auto it = std::find_if(edge->begin(), edge->end(), [&single](const VariableAssignment& assign) {
+                return referencesAny(assign.getValue(), single) || single.count(assign.getVariable()) != 0;
+            });
+            if (it != edge->end()) {
+                isAssignedFirst = !referencesAny(it->getValue(), single);
+                break;
+            }
+        }
+
+        if (!isAssignedFirst) {
+            return false;
+        }
+    }
+
+    Variable* counter = this->createCounter();
+    ExprPtr count = counter->getRefExpr();
+
+    std::vector<VariableAssignment> assignments;
+    for (auto& [variable, value] : mUpdates) {
+        if (carried.count(variable) != 0) {
+            assignments.push_back({ variable, this->getClosedForm(variable, count) });
+        }
+    }
+
+    Location* chosen = mCfa->createLocation();
+    mCfa->createAssignTransition(loop.entry, chosen, mExprBuilder->True(), {
+        { counter, mExprBuilder->Undef(*mCountType) }
+    });
+    mCfa->createAssignTransition(chosen, loop.entry, this->buildAcceleratedGuard(count), assignments);
+
+    return true;
+}
+
+Variable* LoopAccelerator::createCounter()
+{
+    return mCfa->createLocal("__gazer_loop_iterations", *mCountType);
+}
+
+ExprPtr LoopAccelerator::buildAcceleratedGuard(const ExprPtr& count)
+{
+    ExprPtr last = mExprBuilder->Sub(count, this->countLit(1));
+    ExprPtr nextIterations = mExprBuilder->And(this->guardAt(this->countLit(1)), this->guardAt(last));
+
+    if (mCountType->isBvType()) {
+        // The original cycle is kept, the shortcut only has to cover the
+        // non-empty sequences of iterations.
+        return mExprBuilder->And({
+            this->countGtEq(count, 1),
+            mGuard,
+            mExprBuilder->Imply(this->countGtEq(count, 2), mExprBuilder->And({
+                nextIterations, this->noOverflowAt(this->countLit(1)), this->noOverflowAt(last)
+            }))
+        });
+    }
+
+    return mExprBuilder->And({
+        this->countGtEq(count, 0),
+        mExprBuilder->Imply(this->countGtEq(count, 1), mGuard),
+        mExprBuilder->Imply(this->countGtEq(count, 2), nextIterations)
+    });
+}
+
+ExprPtr LoopAccelerator::getClosedForm(Variable* variable, const ExprPtr& count)
+{
+    if (mInductions.count(variable) != 0) {
+        return this->iterate(variable, count);
+    }
+
+    // Derived variables are calculated from the values of the last iteration.
+    VariableExprRewrite last(*mExprBuilder);
+    for (auto& [induction, info] : mInductions) {
+        last[induction] = this->iterate(induction, mExprBuilder->Sub(count, this->countLit(1)));
+    }
+
+    ExprPtr value = last.walk(mDerived.lookup(variable));
+    if (!mCountType->isBvType()) {
+        value = mExprBuilder->Select(
+            mExprBuilder->Eq(count, this->countLit(0)), variable->getRefExpr(), value
+        );
+    }
+
+    return value;
+}
+
+ExprPtr LoopAccelerator::iterate(Variable* variable, const ExprPtr& count)
+{
+    const InductionVariable& induction = mInductions.find(variable)->second;
+
+    ExprPtr delta = induction.step;
+    if (count != this->countLit(1)) {
+        ExprPtr scaled = count;
+        if (auto bvTy = llvm::dyn_cast<BvType>(&variable->getType())) {
+            scaled = mExprBuilder->Trunc(count, *bvTy);
+        }
+        delta = mExprBuilder->Mul(scaled, induction.step);
+    }
+
+    return induction.decrement
+        ? mExprBuilder->Sub(variable->getRefExpr(), delta)
+        : mExprBuilder->Add(variable->getRefExpr(), delta);
+}
+
+ExprPtr LoopAccelerator::guardAt(const ExprPtr& iteration)
+{
+    VariableExprRewrite rewrite(*mExprBuilder);
+    for (auto& [variable, induction] : mInductions) {
+        rewrite[variable] = this->iterate(variable, iteration);
+    }
+
+    return rewrite.walk(mIterationGuard);
+}
+
+ExprPtr LoopAccelerator::noOverflowAt(const ExprPtr& iteration)
+{
+    ExprVector conditions;
+
+    for (const ExprPtr& cmp : mLinearComparisons) {
+        auto binary = llvm::cast<NonNullaryExpr>(cmp.get());
+        ExprPtr left = binary->getOperand(0);
+        ExprPtr right = binary->getOperand(1);
+
+        bool isSigned = !isUnsignedComparison(cmp->getKind());
+        unsigned width = std::max(this->getRequiredWidth(left), this->getRequiredWidth(right));
+        auto& wideTy = BvType::Get(mContext, width);
+        ExprPtr wideIteration = mExprBuilder->ZExt(iteration, wideTy);
+
+        for (const ExprPtr& operand : { left, right }) {
+            if (!referencesAny(operand, mInductionSet)) {
+                continue;
+            }
+
+            unsigned opWidth = llvm::cast<BvType>(operand->getType()).getWidth();
+            llvm::APInt min = isSigned
+                ? llvm::APInt::getSignedMinValue(opWidth).sext(width)
+                : llvm::APInt::getMinValue(opWidth).zext(width);
+            llvm::APInt max = isSigned
+                ? llvm::APInt::getSignedMaxValue(opWidth).sext(width)
+                : llvm::APInt::getMaxValue(opWidth).zext(width);
+
+            // The wide values are exact, thus they are always compared as signed numbers.
+            ExprPtr value = this->widen(operand, wideIteration, wideTy, isSigned);
+            conditions.push_back(mExprBuilder->BvSGtEq(value, mExprBuilder->BvLit(min)));
+            conditions.push_back(mExprBuilder->BvSLtEq(value, mExprBuilder->BvLit(max)));
+        }
+    }
+
+    return mExprBuilder->And(conditions);
+}
+
+ExprPtr LoopAccelerator::widen(const ExprPtr& term, const ExprPtr& iteration, BvType& type, bool isSigned)
+{
+    auto extend = [this, &type, isSigned](const ExprPtr& expr) {
+        return isSigned ? mExprBuilder->SExt(expr, type) : mExprBuilder->ZExt(expr, type);
+    };
+
+    if (!referencesAny(term, mInductionSet)) {
+        return extend(term);
+    }
+
+    auto binary = llvm::dyn_cast<NonNullaryExpr>(term.get());
+    switch (term->getKind()) {
+        case Expr::VarRef: {
+            const InductionVariable& induction =
+                mInductions.find(&llvm::cast<VarRefExpr>(term)->getVariable())->second;
+            ExprPtr delta = mExprBuilder->Mul(iteration, extend(induction.step));
+            return induction.decrement
+                ? mExprBuilder->Sub(extend(term), delta)
+                : mExprBuilder->Add(extend(term), delta);
+        }
+        case Expr::Add:
+            return mExprBuilder->Add(
+                this->widen(binary->getOperand(0), iteration, type, isSigned),
+                this->widen(binary->getOperand(1), iteration, type, isSigned)
+            );
+        case Expr::Sub:
+            return mExprBuilder->Sub(
+                this->widen(binary->getOperand(0), iteration, type, isSigned),
+                this->widen(binary->getOperand(1), iteration, type, isSigned)
+            );
+        case Expr::Mul:
+            return mExprBuilder->Mul(
+                this->widen(binary->getOperand(0), iteration, type, isSigned),
+                this->widen(binary->getOperand(1), iteration, type, isSigned)
+            );
+        default:
+            llvm_unreachable("Only linear terms may be widened!");
+    }
+}
+
+unsigned LoopAccelerator::getRequiredWidth(const ExprPtr& term)
+{
+    // The number of bits needed to represent the value of the term as a
+    // signed number, when its operands are extended by one bit.
+    unsigned width = llvm::cast<BvType>(term->getType()).getWidth();
+    if (!referencesAny(term, mInductionSet)) {
+        return width + 1;
+    }
+
+    auto binary = llvm::dyn_cast<NonNullaryExpr>(term.get());
+    switch (term->getKind()) {
+        case Expr::VarRef: {
+            // X + j * D, where the iteration counter j is unsigned.
+            unsigned countWidth = llvm::cast<BvType>(mCountType)->getWidth();
+            return width + countWidth + 3;
+        }
+        case Expr::Add:
+        case Expr::Sub:
+            return std::max(
+                this->getRequiredWidth(binary->getOperand(0)),
+                this->getRequiredWidth(binary->getOperand(1))
+            ) + 1;
+        case Expr::Mul:
+            return this->getRequiredWidth(binary->getOperand(0))
+                + this->getRequiredWidth(binary->getOperand(1));
+        default:
+            llvm_unreachable("Only linear terms may be widened!");
+    }
+}
+
+ExprPtr LoopAccelerator::countLit(unsigned value)
+{
+    if (auto bvTy = llvm::dyn_cast<BvType>(mCountType)) {
+        return mExprBuilder->BvLit(value, bvTy->getWidth());
+    }
+
+    return mExprBuilder->IntLit(value);
+}
+
+ExprPtr LoopAccelerator::countGtEq(const ExprPtr& count, unsigned value)
+{
+    if (mCountType->isBvType()) {
+        return mExprBuilder->BvUGtEq(count, this->countLit(value));
+    }
+
+    return mExprBuilder->GtEq(count, this->countLit(value));
+}
+
+LoopAccelerationResult gazer::TransformLoopAcceleration(Cfa* cfa)
+{
+    LoopAccelerator accelerator(cfa);
+    return accelerator.transform();
+}
@@ -232,3 +232,9 @@ TupleType& TupleType::Get(std::vector<Type*> subtypes)
 
     return *result->second;
 }
+
+Type& TupleType::getTypeAtIndex(unsigned idx) const
+{
+    assert(idx < mSubtypeList.size() && "Tuple index out of range!");
+    return *mSubtypeList[idx];
+}
@@ -0,0 +1,137 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Automaton/AutomataCache.h"
+#include "gazer/Automaton/AutomataSerialization.h"
+#include "gazer/LLVM/Instrumentation/Check.h"
+
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace gazer;
+
+AutomataCache::AutomataCache(
+    llvm::StringRef directory, const llvm::Module& module, const LLVMFrontendSettings& settings
+) : mDirectory(directory.str())
+{
+    llvm::SmallString<0> bitcode;
+    llvm::raw_svector_ostream bitcodeOS(bitcode);
+    llvm::WriteBitcodeToFile(module, bitcodeOS);
+
+    llvm::MD5 hash;
+    hash.update(bitcode.str());
+    hash.update(settings.toString());
+    hash.update(std::to_string(AutomataFormatVersion));
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+
+    llvm::SmallString<128> path(directory);
+    llvm::sys::path::append(path, result.digest().str() + ".gcfa");
+    mPath = path.str().str();
+}
+
+std::unique_ptr<AutomataSystem> AutomataCache::load(
+    GazerContext& context, llvm::DenseMap<unsigned, std::string>& messages) const
+{
+    auto buffer = llvm::MemoryBuffer::getFile(mPath);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    // The entry starts with the table of check messages, followed by the
+    // serialized automata system.
+    llvm::StringRef data = (*buffer)->getBuffer();
+    const uint8_t* current = data.bytes_begin();
+    const uint8_t* end = data.bytes_end();
+    const char* error = nullptr;
+
+    auto readNumber = [&current, end, &error]() -> uint64_t {
+        unsigned length = 0;
+        uint64_t value = error == nullptr ? llvm::decodeULEB128(current, &length, end, &error) : 0;
+        current += length;
+        return value;
+    };
+
+    uint64_t numMessages = readNumber();
+    for (uint64_t i = 0; i < numMessages && error == nullptr; ++i) {
+        uint64_t ec = readNumber();
+        uint64_t length = readNumber();
+        if (error != nullptr || length > static_cast<uint64_t>(end - current)) {
+            return nullptr;
+        }
+
+        messages[ec] = std::string(reinterpret_cast<const char*>(current), length);
+        current += length;
+    }
+
+    if (error != nullptr) {
+        return nullptr;
+    }
+
+    return ReadAutomataSystem(data.substr(current - data.bytes_begin()), context);
+}
+
+bool AutomataCache::store(AutomataSystem& system, const CheckRegistry& checks) const
+{
+    if (llvm::sys::fs::create_directories(mDirectory)) {
+        return false;
+    }
+
+    // Write into a temporary file first, so concurrent runs never observe
+    // partially written entries.
+    int fd;
+    llvm::SmallString<128> tmpPath;
+    if (llvm::sys::fs::createUniqueFile(mPath + "-%%%%%%.tmp", fd, tmpPath)) {
+        return false;
+    }
+
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+
+        std::vector<unsigned> errorCodes = checks.getErrorCodes();
+        llvm::encodeULEB128(errorCodes.size(), os);
+        for (unsigned ec : errorCodes) {
+            std::string msg = checks.messageForCode(ec);
+            llvm::encodeULEB128(ec, os);
+            llvm::encodeULEB128(msg.size(), os);
+            os << msg;
+        }
+
+        WriteAutomataSystem(system, os);
+
+        os.close();
+        if (os.has_error()) {
+            os.clear_error();
+            llvm::sys::fs::remove(tmpPath);
+            return false;
+        }
+    }
+
+    if (llvm::sys::fs::rename(tmpPath, mPath)) {
+        llvm::sys::fs::remove(tmpPath);
+        return false;
+    }
+
+    return true;
+}
@@ -25,6 +25,10 @@
 #include "gazer/Automaton/CfaTransforms.h"
 #include "gazer/LLVM/Automaton/ModuleToAutomata.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
 
 using namespace gazer;
 using namespace gazer::llvm2cfa;
@@ -36,10 +40,11 @@ std::unique_ptr<AutomataSystem> gazer::translateModuleToAutomata(
     GazerContext& context,
     MemoryModel& memoryModel,
     llvm::DenseMap<llvm::Value*, Variable*>& variables,
-    CfaToLLVMTrace& blockEntries
+    CfaToLLVMTrace& blockEntries,
+    CfaTranslationTimings* timings
 ) {
     ModuleToCfa transformer(module, loopInfos, context, memoryModel, settings);
-    return transformer.generate(variables, blockEntries);
+    return transformer.generate(variables, blockEntries, timings);
 }
 
 // LLVM pass implementation
@@ -55,6 +60,18 @@ void ModuleToAutomataPass::getAnalysisUsage(llvm::AnalysisUsage& au) const
 
 bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
 {
+    mTimings = CfaTranslationTimings();
+
+    Stopwatch<CfaTranslationTimings::Duration> timer;
+    auto recordPhase = [this, &timer](const char* phase) {
+        timer.stop();
+        mTimings.Phases.emplace_back(phase, timer.elapsed());
+        timer.reset();
+        timer.start();
+    };
+
+    timer.start();
+
     GenerationContext::LoopInfoMapTy loopInfoMap;
     std::vector<std::unique_ptr<llvm::DominatorTree>> dominators;
     std::vector<std::unique_ptr<llvm::LoopInfo>> loops;
@@ -80,6 +97,7 @@ bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
     assert(memoryModel != nullptr && "Unknown memory model setting!");
     
     memoryModel->initialize(module);
+    recordPhase("memory_model");
 
     if (mSettings.debugDumpMemorySSA) {
         for (auto& function : module.functions()) {
@@ -93,9 +111,53 @@ bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
     }
 
     mSystem = translateModuleToAutomata(
-        module, mSettings, loopInfoMap, mContext, *memoryModel, mVariables, mTraceInfo
+        module, mSettings, loopInfoMap, mContext, *memoryModel, mVariables, mTraceInfo, &mTimings
     );
 
+    // The translation records its own phases.
+    timer.reset();
+    timer.start();
+
+    // Traces and test harnesses need the values of all variables mapped to an
+    // LLVM value, thus variables are only removed if neither is requested.
+    bool needsAllValues = mSettings.trace || !mSettings.testHarnessFile.empty();
+
+    if (mSettings.coneOfInfluence && !needsAllValues) {
+        TransformConeOfInfluence(*mSystem);
+        recordPhase("cone_of_influence");
+    }
+
+    if (mSettings.deadAssignments && !needsAllValues) {
+        for (Cfa& cfa : *mSystem) {
+            TransformDeadAssignmentElimination(&cfa);
+        }
+        recordPhase("dead_assignments");
+    }
+
+    if (mSettings.largeBlockEncoding) {
+        // Block entry locations are needed to reconstruct LLVM-level traces,
+        // helper and block exit locations may be merged freely.
+        std::function<bool(Location*)> keep = nullptr;
+        if (mSettings.trace) {
+            keep = [this](Location* loc) {
+                auto info = mTraceInfo.getBlockFromLocation(loc);
+                return info.block != nullptr && info.kind == CfaToLLVMTrace::Location_Entry;
+            };
+        }
+
+        for (Cfa& cfa : *mSystem) {
+            TransformLargeBlockEncoding(&cfa, keep);
+        }
+        recordPhase("large_block_encoding");
+    }
+
+    // Each automaton has its own trace information, thus merged automata
+    // would lose theirs.
+    if (mSettings.dedupAutomata && !needsAllValues) {
+        TransformAutomataDeduplication(*mSystem);
+        recordPhase("dedup_automata");
+    }
+
     if (mSettings.loops == LoopRepresentation::Cycle) {
         // Transform the main automaton into a cyclic CFA if requested.
         // Note: This yields an invalid CFA, which will not be recognizable by
@@ -104,6 +166,21 @@ bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
 
         // TODO: We should translate automata other than the main in this case.
         TransformRecursiveToCyclic(mSystem->getMainAutomaton());
+        recordPhase("recursive_to_cyclic");
+
+        // The accelerated transitions skip the intermediate states of the
+        // loops, which are needed by the traces.
+        if (mSettings.loopAcceleration && !needsAllValues) {
+            TransformLoopAcceleration(mSystem->getMainAutomaton());
+            recordPhase("loop_acceleration");
+        }
+    }
+
+    // Analyzing the final automata yields the most precise intervals, as
+    // loops are cycles of the main automaton in the cyclic representation.
+    if (mSettings.intervalSimplification) {
+        TransformIntervalSimplification(*mSystem, mSettings.intervalInvariants);
+        recordPhase("interval_simplification");
     }
 
     return false;
@@ -166,14 +243,234 @@ public:
     }
 };
 
+/// Size metrics of a single automaton.
+struct CfaStatistics
+{
+    std::string Name;
+    uint64_t Locations = 0;
+    uint64_t ErrorLocations = 0;
+    uint64_t Edges = 0;
+    uint64_t Inputs = 0;
+    uint64_t Locals = 0;
+    uint64_t Outputs = 0;
+    uint64_t Calls = 0;
+    uint64_t Callees = 0;
+    uint64_t ExprSize = 0;
+    uint64_t MaxExprSize = 0;
+    uint64_t EncodeTime = 0;
+};
+
+/// Returns the number of distinct expression nodes on a transition.
+static uint64_t getTransitionExprSize(Transition* edge)
+{
+    llvm::SmallVector<Expr*, 16> worklist;
+    worklist.push_back(edge->getGuard().get());
+
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        for (const VariableAssignment& va : *assign) {
+            worklist.push_back(va.getValue().get());
+        }
+    } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+        for (const VariableAssignment& va : call->inputs()) {
+            worklist.push_back(va.getValue().get());
+        }
+        for (const VariableAssignment& va : call->outputs()) {
+            worklist.push_back(va.getValue().get());
+        }
+    }
+
+    llvm::DenseSet<Expr*> visited;
+    while (!worklist.empty()) {
+        Expr* expr = worklist.pop_back_val();
+        if (!visited.insert(expr).second) {
+            continue;
+        }
+
+        if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+            for (const ExprPtr& op : nn->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+
+    return visited.size();
+}
+
+class CfaStatisticsPass : public llvm::ModulePass
+{
+    struct Metric
+    {
+        const char* Name;
+        uint64_t CfaStatistics::* Field;
+        /// True if the automata should be ranked by this metric.
+        bool Ranked;
+    };
+
+public:
+    static char ID;
+
+    explicit CfaStatisticsPass(unsigned topN)
+        : ModulePass(ID), mTopN(topN)
+    {}
+
+    void getAnalysisUsage(llvm::AnalysisUsage& au) const override
+    {
+        au.addRequired<ModuleToAutomataPass>();
+        au.setPreservesAll();
+    }
+
+    bool runOnModule(llvm::Module& module) override
+    {
+        auto& moduleToCfa = getAnalysis<ModuleToAutomataPass>();
+        AutomataSystem& system = moduleToCfa.getSystem();
+        const CfaTranslationTimings& timings = moduleToCfa.getTimings();
+
+        std::vector<CfaStatistics> stats;
+        for (Cfa& cfa : system) {
+            stats.push_back(computeStatistics(cfa, timings));
+        }
+
+        llvm::json::Array phases;
+        uint64_t totalTime = 0;
+        for (auto& [phase, time] : timings.Phases) {
+            phases.push_back(llvm::json::Object{
+                { "name", phase }, { "time_us", static_cast<int64_t>(time.count()) }
+            });
+            totalTime += time.count();
+        }
+
+        // Only the metrics indicating a translation blowup are ranked.
+        const Metric metrics[] = {
+            { "locations", &CfaStatistics::Locations, true },
+            { "error_locations", &CfaStatistics::ErrorLocations, false },
+            { "edges", &CfaStatistics::Edges, true },
+            { "inputs", &CfaStatistics::Inputs, false },
+            { "locals", &CfaStatistics::Locals, false },
+            { "outputs", &CfaStatistics::Outputs, false },
+            { "calls", &CfaStatistics::Calls, true },
+            { "callees", &CfaStatistics::Callees, false },
+            { "expr_size", &CfaStatistics::ExprSize, true },
+            { "max_expr_size", &CfaStatistics::MaxExprSize, true },
+            { "encode_time_us", &CfaStatistics::EncodeTime, true },
+        };
+
+        llvm::json::Array procedures;
+        for (const CfaStatistics& stat : stats) {
+            llvm::json::Object procedure{{ "name", stat.Name }};
+            for (const Metric& metric : metrics) {
+                procedure[metric.Name] = static_cast<int64_t>(stat.*metric.Field);
+            }
+            procedures.push_back(std::move(procedure));
+        }
+
+        llvm::json::Object totals;
+        llvm::json::Object ranking;
+        for (const Metric& metric : metrics) {
+            uint64_t total = 0;
+            for (const CfaStatistics& stat : stats) {
+                total += stat.*metric.Field;
+            }
+            totals[metric.Name] = static_cast<int64_t>(total);
+
+            if (metric.Ranked) {
+                ranking[metric.Name] = this->rank(stats, metric.Field);
+            }
+        }
+
+        llvm::json::Object root{
+            { "automata", static_cast<int64_t>(stats.size()) },
+            { "translation_time_us", static_cast<int64_t>(totalTime) },
+            { "phases", std::move(phases) },
+            { "totals", std::move(totals) },
+            { "procedures", std::move(procedures) },
+            { "ranking", std::move(ranking) }
+        };
+
+        llvm::outs() << llvm::formatv("{0:2}", llvm::json::Value(std::move(root))) << "\n";
+
+        return false;
+    }
+
+private:
+    /// Returns the names and values of the first \p mTopN automata
+    /// in decreasing order of \p field.
+    llvm::json::Array rank(const std::vector<CfaStatistics>& stats, uint64_t CfaStatistics::* field) const
+    {
+        std::vector<const CfaStatistics*> sorted;
+        for (const CfaStatistics& stat : stats) {
+            sorted.push_back(&stat);
+        }
+
+        std::stable_sort(sorted.begin(), sorted.end(), [field](auto lhs, auto rhs) {
+            return lhs->*field > rhs->*field;
+        });
+        if (sorted.size() > mTopN) {
+            sorted.resize(mTopN);
+        }
+
+        llvm::json::Array top;
+        for (const CfaStatistics* stat : sorted) {
+            top.push_back(llvm::json::Object{
+                { "name", stat->Name }, { "value", static_cast<int64_t>(stat->*field) }
+            });
+        }
+
+        return top;
+    }
+
+    static CfaStatistics computeStatistics(Cfa& cfa, const CfaTranslationTimings& timings)
+    {
+        CfaStatistics stat;
+        stat.Name = cfa.getName().str();
+        stat.Locations = cfa.getNumLocations();
+        stat.Inputs = cfa.getNumInputs();
+        stat.Locals = cfa.getNumLocals();
+        stat.Outputs = cfa.getNumOutputs();
+        stat.EncodeTime = timings.Encoding.lookup(cfa.getName()).count();
+
+        for (auto& loc : cfa.nodes()) {
+            stat.ErrorLocations += loc->isError();
+        }
+
+        llvm::DenseSet<Cfa*> callees;
+        for (auto& edge : cfa.edges()) {
+            if (edge->getSource() == nullptr) {
+                continue;
+            }
+
+            ++stat.Edges;
+            if (auto call = llvm::dyn_cast<CallTransition>(edge.get())) {
+                ++stat.Calls;
+                callees.insert(call->getCalledAutomaton());
+            }
+
+            uint64_t size = getTransitionExprSize(edge.get());
+            stat.ExprSize += size;
+            stat.MaxExprSize = std::max(stat.MaxExprSize, size);
+        }
+        stat.Callees = callees.size();
+
+        return stat;
+    }
+
+private:
+    unsigned mTopN;
+};
+
 } // end anonymous namespace
 
 char PrintCfaPass::ID;
 char ViewCfaPass::ID;
+char CfaStatisticsPass::ID;
 
 llvm::Pass* gazer::createCfaPrinterPass() { return new PrintCfaPass(); }
 llvm::Pass* gazer::createCfaViewerPass()  { return new ViewCfaPass();  }
 
+llvm::Pass* gazer::createCfaStatisticsPass(unsigned topN)
+{
+    return new CfaStatisticsPass(topN);
+}
+
 // Traceability support
 //-----------------------------------------------------------------------------
 
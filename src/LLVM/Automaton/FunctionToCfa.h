@@ -276,7 +276,8 @@ public:
 
     std::unique_ptr<AutomataSystem> generate(
         llvm::DenseMap<llvm::Value*, Variable*>& variables,
-        CfaToLLVMTrace& cfa2llvm
+        CfaToLLVMTrace& cfa2llvm,
+        CfaTranslationTimings* timings = nullptr
     );
 
 protected:
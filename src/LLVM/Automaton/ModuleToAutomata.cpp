@@ -28,6 +28,7 @@
 #include "gazer/LLVM/Instrumentation/Check.h"
 #include "gazer/Core/Expr/ExprUtils.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
+#include "gazer/Support/Stopwatch.h"
 
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Instructions.h>
@@ -243,10 +244,24 @@ ModuleToCfa::ModuleToCfa(
 
 std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
     llvm::DenseMap<llvm::Value*, Variable*>& variables,
-    CfaToLLVMTrace& cfaToLlvmTrace
+    CfaToLLVMTrace& cfaToLlvmTrace,
+    CfaTranslationTimings* timings
 ) {
+    Stopwatch<CfaTranslationTimings::Duration> timer;
+    auto recordPhase = [&timer, timings](const char* phase) {
+        timer.stop();
+        if (timings != nullptr) {
+            timings->Phases.emplace_back(phase, timer.elapsed());
+        }
+        timer.reset();
+        timer.start();
+    };
+
+    timer.start();
+
     // Create all automata and interfaces.
     this->createAutomata();
+    recordPhase("declare");
 
     // Encode all loops and functions
     for (auto& [source, genInfo] : mGenCtx.procedures()) {
@@ -259,8 +274,16 @@ std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
         );
 
         // Do the actual encoding.
+        Stopwatch<CfaTranslationTimings::Duration> encodeTimer;
+        encodeTimer.start();
         blocksToCfa.encode();
+        encodeTimer.stop();
+
+        if (timings != nullptr) {
+            timings->Encoding[genInfo.Automaton->getName()] = encodeTimer.elapsed();
+        }
     }
+    recordPhase("encode");
 
     // CFAs must be connected graphs. Remove unreachable components now.
     for (auto& cfa : *mSystem) {
@@ -271,6 +294,7 @@ std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
         }
         cfa.removeUnreachableLocations();
     }
+    recordPhase("cleanup");
 
     // If there is a procedure called 'main', set it as the entry automaton.
     Cfa* main = mSystem->getAutomatonByName("main");
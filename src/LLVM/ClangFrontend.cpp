@@ -21,11 +21,30 @@
 #include <llvm/Support/Program.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/ThreadPool.h>
 
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/CommandLine.h>
 #include <llvm/IRReader/IRReader.h>
 
+#ifdef GAZER_HAVE_CLANG_LIBRARIES
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/CodeGen/CodeGenAction.h>
+#include <clang/Driver/Compilation.h>
+#include <clang/Driver/Driver.h>
+#include <clang/Driver/Tool.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <llvm/Support/Host.h>
+#endif
+
 using namespace llvm;
 
 namespace gazer
@@ -51,40 +70,176 @@ namespace
         cl::desc("Enable the specified warning"),
         cl::cat(gazer::ClangFrontendCategory)
     );
+    cl::opt<bool> ClangSubprocess("clang-subprocess",
+        cl::desc("Compile and link the inputs by running clang and llvm-link processes"),
+        cl::cat(gazer::ClangFrontendCategory)
+    );
+    cl::opt<unsigned> Jobs("j",
+        cl::desc("Number of input files compiled concurrently (0: number of cores)"),
+        cl::value_desc("N"),
+        cl::init(1),
+        cl::cat(gazer::ClangFrontendCategory)
+    );
 }
 
-static bool executeClang(llvm::StringRef clang, llvm::StringRef input, llvm::StringRef output)
+/// Runs \p task for each index in [0, count), using at most \p jobs threads.
+static void runConcurrently(size_t count, unsigned jobs, llvm::function_ref<void(size_t)> task)
 {
-    // Build our clang configuration
-    std::vector<llvm::StringRef> clangArgs = {
-        clang,
+    if (jobs <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    llvm::ThreadPool pool(std::min<size_t>(jobs, count));
+    for (size_t i = 0; i < count; ++i) {
+        pool.async([task, i] { task(i); });
+    }
+    pool.wait();
+}
+
+static unsigned getNumJobs()
+{
+    return Jobs == 0 ? llvm::hardware_concurrency() : Jobs.getValue();
+}
+
+namespace
+{
+
+/// A uniquely named temporary directory, which is removed along with its
+/// contents when the owning object goes out of scope.
+class TemporaryDirectory
+{
+public:
+    TemporaryDirectory() = default;
+
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    std::error_code create(llvm::StringRef prefix)
+    {
+        std::error_code errorCode = llvm::sys::fs::createUniqueDirectory(prefix, mPath);
+        if (errorCode) {
+            mPath.clear();
+        }
+
+        return errorCode;
+    }
+
+    llvm::StringRef getPath() const { return mPath; }
+
+    ~TemporaryDirectory()
+    {
+        if (!mPath.empty()) {
+            llvm::sys::fs::remove_directories(mPath);
+        }
+    }
+
+private:
+    llvm::SmallString<128> mPath;
+};
+
+} // end anonymous namespace
+
+/// Returns the clang command line shared by all compilation modes.
+static std::vector<std::string> getClangArguments(llvm::StringRef clang)
+{
+    std::vector<std::string> clangArgs = {
+        clang.str(),
         "-g",
         // In the newer (>=5.0) versions of clang, -O0 marks functions
         // with a 'not optimizable' flag, which can break the functionality
         // of gazer. Here we request optimizations with -O1 and turn them off
         // immediately by disabling all LLVM passes.
         "-O1", "-Xclang", "-disable-llvm-passes",
-        "-c", "-emit-llvm",
     };
 
     // Add -I and -D options correctly
-    std::vector<std::string> prefixedStrings;
     for (auto& include : Includes) {
-        prefixedStrings.push_back("-I" + include);
+        clangArgs.push_back("-I" + include);
     }
     for (auto& define : Defines) {
-        prefixedStrings.push_back("-D" + define);
+        clangArgs.push_back("-D" + define);
     }
     for (auto& warning : Warnings) {
-        prefixedStrings.push_back("-W" + warning);
+        clangArgs.push_back("-W" + warning);
     }
 
-    clangArgs.insert(clangArgs.end(), prefixedStrings.begin(), prefixedStrings.end());
+    return clangArgs;
+}
+
+#ifdef GAZER_HAVE_CLANG_LIBRARIES
+
+/// Compiles \p input into a module using the clang libraries.
+/// Diagnostics are written to \p diagOS.
+static std::unique_ptr<llvm::Module> compileInProcess(
+    llvm::StringRef clang, llvm::StringRef input, llvm::LLVMContext& llvmContext, llvm::raw_ostream& diagOS)
+{
+    // The driver translates our command line into a frontend invocation, so
+    // the target defaults and the builtin headers are the same as for the
+    // clang binary at the given path.
+    std::vector<std::string> clangArgs = getClangArguments(clang);
+    clangArgs.insert(clangArgs.end(), { "-fsyntax-only", input.str() });
+
+    std::vector<const char*> driverArgs;
+    for (const std::string& arg : clangArgs) {
+        driverArgs.push_back(arg.c_str());
+    }
+
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diagOpts = new clang::DiagnosticOptions();
+    auto diagPrinter = new clang::TextDiagnosticPrinter(diagOS, &*diagOpts);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diagIds(new clang::DiagnosticIDs());
+    clang::DiagnosticsEngine diags(diagIds, &*diagOpts, diagPrinter);
+
+    clang::driver::Driver driver(clang, llvm::sys::getDefaultTargetTriple(), diags);
+    std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(driverArgs));
+    if (compilation == nullptr || compilation->containsError()) {
+        return nullptr;
+    }
+
+    const clang::driver::JobList& jobs = compilation->getJobs();
+    if (jobs.size() != 1 || !llvm::isa<clang::driver::Command>(*jobs.begin())) {
+        diagOS << "ERROR: unexpected clang driver jobs for input file '" << input << "'.\n";
+        return nullptr;
+    }
+
+    const clang::driver::Command& command = llvm::cast<clang::driver::Command>(*jobs.begin());
+    const llvm::opt::ArgStringList& frontendArgs = command.getArguments();
+
+    auto invocation = std::make_shared<clang::CompilerInvocation>();
+    if (!clang::CompilerInvocation::CreateFromArgs(
+        *invocation, frontendArgs.data(), frontendArgs.data() + frontendArgs.size(), diags
+    )) {
+        return nullptr;
+    }
 
-    clangArgs.insert(clangArgs.end(), {
-        input, "-o", output
+    clang::CompilerInstance compiler;
+    compiler.setInvocation(std::move(invocation));
+    compiler.createDiagnostics(new clang::TextDiagnosticPrinter(diagOS, &compiler.getDiagnosticOpts()));
+    if (!compiler.hasDiagnostics()) {
+        return nullptr;
+    }
+
+    clang::EmitLLVMOnlyAction action(&llvmContext);
+    if (!compiler.ExecuteAction(action)) {
+        return nullptr;
+    }
+
+    return action.takeModule();
+}
+
+#endif
+
+static bool executeClang(llvm::StringRef clang, llvm::StringRef input, llvm::StringRef output)
+{
+    std::vector<std::string> clangArgStrings = getClangArguments(clang);
+    clangArgStrings.insert(clangArgStrings.end(), {
+        "-c", "-emit-llvm", input.str(), "-o", output.str()
     });
 
+    std::vector<llvm::StringRef> clangArgs(clangArgStrings.begin(), clangArgStrings.end());
+
     std::string clangErrors;
 
     int returnCode = llvm::sys::ExecuteAndWait(
@@ -144,14 +299,17 @@ static bool executeLinker(llvm::StringRef linker, const std::vector<std::string>
     return true;
 }
 
-auto gazer::ClangCompileAndLink(llvm::ArrayRef<std::string> files, llvm::LLVMContext& llvmContext)
-    -> std::unique_ptr<llvm::Module>
-{
 #define CHECK_ERROR(ERRORCODE, MSG) if (ERRORCODE) {                            \
     llvm::errs() << MSG << "\n";                                                \
     llvm::errs() << (ERRORCODE).message() << "\n";                              \
     return nullptr;                                                             \
 }
+
+/// Compiles and links the inputs using clang and llvm-link processes,
+/// communicating through temporary bitcode files.
+static std::unique_ptr<llvm::Module> compileAndLinkWithSubprocesses(
+    llvm::ArrayRef<std::string> files, llvm::LLVMContext& llvmContext)
+{
     std::error_code errorCode;
     llvm::SMDiagnostic err;
 
@@ -162,12 +320,13 @@ auto gazer::ClangCompileAndLink(llvm::ArrayRef<std::string> files, llvm::LLVMCon
     auto llvm_link = llvm::sys::findProgramByName("llvm-link");
     CHECK_ERROR(llvm_link.getError(), "Could not find llvm-link.");
 
-    // Create a temporary working directory
-    llvm::SmallString<128> workingDir;
-    errorCode = llvm::sys::fs::createUniqueDirectory("gazer_workdir_", workingDir);
+    // Create a temporary working directory, removed on every exit path.
+    TemporaryDirectory workingDir;
+    errorCode = workingDir.create("gazer_workdir_");
     CHECK_ERROR(errorCode, "Could not create temporary working directory.");
 
     std::vector<std::string> bitcodeFiles;
+    std::vector<size_t> sources;
 
     for (llvm::StringRef inputFile : files) {
         if (inputFile.endswith_lower(".bc") || inputFile.endswith_lower(".ll")) {
@@ -181,27 +340,34 @@ auto gazer::ClangCompileAndLink(llvm::ArrayRef<std::string> files, llvm::LLVMCon
             return nullptr;
         }
 
-        llvm::SmallString<128> inputPath = inputFile;
-        llvm::sys::fs::make_absolute(inputPath);
-
-        // Construct the output file path
-        llvm::SmallString<128> outputPath = workingDir;
-        llvm::sys::path::append(outputPath, llvm::sys::path::filename(inputPath));
+        // Construct the output file path. Sources with the same name in
+        // different directories must not overwrite each other's output.
+        llvm::SmallString<128> outputPath = workingDir.getPath();
+        llvm::sys::path::append(outputPath,
+            std::to_string(sources.size()) + "_" + llvm::sys::path::filename(inputFile).str());
         llvm::sys::path::replace_extension(outputPath, "bc");
 
-        // Call clang
-        bool clangSuccess = executeClang(*clang, inputPath, outputPath);
-        if (!clangSuccess) {
-            // TODO: Clean-up the working directory?
-            llvm::errs() << "Failed to compile input file '" << inputFile << "'.\n";
+        sources.push_back(bitcodeFiles.size());
+        bitcodeFiles.push_back(outputPath.str());
+    }
+
+    // Call clang for each source file, possibly concurrently.
+    std::vector<char> clangSuccess(files.size(), false);
+    runConcurrently(sources.size(), getNumJobs(), [&](size_t i) {
+        llvm::SmallString<128> inputPath(files[sources[i]]);
+        llvm::sys::fs::make_absolute(inputPath);
+        clangSuccess[i] = executeClang(*clang, inputPath, bitcodeFiles[sources[i]]);
+    });
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (!clangSuccess[i]) {
+            llvm::errs() << "Failed to compile input file '" << files[sources[i]] << "'.\n";
             return nullptr;
         }
-
-        bitcodeFiles.push_back(outputPath.str());
     }
 
     // Run llvm-link
-    llvm::SmallString<128> resultFile = workingDir;
+    llvm::SmallString<128> resultFile = workingDir.getPath();
     llvm::sys::path::append(resultFile, "gazer_llvm_output.bc");
     bool linkerSuccess = executeLinker(*llvm_link, bitcodeFiles, resultFile);
 
@@ -217,4 +383,144 @@ auto gazer::ClangCompileAndLink(llvm::ArrayRef<std::string> files, llvm::LLVMCon
     }
 
     return module;
-}
\ No newline at end of file
+}
+
+/// Compiles the C inputs in-process if the clang libraries are available,
+/// and links all modules in memory.
+static std::unique_ptr<llvm::Module> compileAndLinkInMemory(
+    llvm::ArrayRef<std::string> files, llvm::LLVMContext& llvmContext)
+{
+    std::error_code errorCode;
+    llvm::SMDiagnostic err;
+
+    for (llvm::StringRef inputFile : files) {
+        if (!inputFile.endswith_lower(".c") && !inputFile.endswith_lower(".bc")
+            && !inputFile.endswith_lower(".ll")
+        ) {
+            llvm::errs() << "Cannot compile source file " << inputFile << ".\n"
+            << "Supported extensions are: .c, .bc, .ll\n";
+            return nullptr;
+        }
+    }
+
+    std::vector<size_t> sources;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (llvm::StringRef(files[i]).endswith_lower(".c")) {
+            sources.push_back(i);
+        }
+    }
+
+    // The clang binary is still used to locate the builtin headers, and
+    // compiles the inputs if the clang libraries are not available.
+    llvm::ErrorOr<std::string> clang = std::string();
+    if (!sources.empty()) {
+        clang = llvm::sys::findProgramByName("clang");
+        CHECK_ERROR(clang.getError(), "Could not find clang.");
+    }
+
+#ifndef GAZER_HAVE_CLANG_LIBRARIES
+    TemporaryDirectory workingDir;
+    if (!sources.empty()) {
+        errorCode = workingDir.create("gazer_workdir_");
+        CHECK_ERROR(errorCode, "Could not create temporary working directory.");
+    }
+#endif
+
+    // Compile the source files, possibly concurrently. Concurrent compilations
+    // produce bitcode, which is parsed into the common context afterwards.
+    unsigned numJobs = getNumJobs();
+    bool concurrent = numJobs > 1 && sources.size() > 1;
+    std::vector<std::string> bitcodes(sources.size());
+    std::vector<std::string> diagnostics(sources.size());
+    std::vector<std::unique_ptr<llvm::Module>> modules(files.size());
+
+    runConcurrently(sources.size(), numJobs, [&](size_t i) {
+        llvm::SmallString<128> inputPath(files[sources[i]]);
+        llvm::sys::fs::make_absolute(inputPath);
+
+#ifdef GAZER_HAVE_CLANG_LIBRARIES
+        llvm::raw_string_ostream diagOS(diagnostics[i]);
+
+        if (!concurrent) {
+            // Without concurrency, the module may be built in the common context.
+            modules[sources[i]] = compileInProcess(*clang, inputPath, llvmContext, diagOS);
+            return;
+        }
+
+        // LLVM contexts are not thread-safe, each compilation needs its own.
+        llvm::LLVMContext localContext;
+        auto module = compileInProcess(*clang, inputPath, localContext, diagOS);
+        if (module != nullptr) {
+            llvm::raw_string_ostream bitcodeOS(bitcodes[i]);
+            llvm::WriteBitcodeToFile(*module, bitcodeOS);
+        }
+#else
+        llvm::SmallString<128> outputPath = workingDir.getPath();
+        llvm::sys::path::append(outputPath,
+            std::to_string(i) + "_" + llvm::sys::path::filename(inputPath).str());
+        llvm::sys::path::replace_extension(outputPath, "bc");
+
+        if (executeClang(*clang, inputPath, outputPath)) {
+            auto buffer = llvm::MemoryBuffer::getFile(outputPath);
+            if (buffer) {
+                bitcodes[i] = (*buffer)->getBuffer().str();
+            }
+        }
+#endif
+    });
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        // Diagnostics are printed in the order of the inputs.
+        llvm::errs() << diagnostics[i];
+
+        llvm::StringRef inputFile = files[sources[i]];
+        if (modules[sources[i]] == nullptr && !bitcodes[i].empty()) {
+            auto module = llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(bitcodes[i], inputFile), llvmContext
+            );
+            if (module) {
+                modules[sources[i]] = std::move(*module);
+            } else {
+                llvm::errs() << llvm::toString(module.takeError()) << "\n";
+            }
+        }
+
+        if (modules[sources[i]] == nullptr) {
+            llvm::errs() << "Failed to compile input file '" << inputFile << "'.\n";
+            return nullptr;
+        }
+    }
+
+    auto result = std::make_unique<llvm::Module>("gazer_llvm_output", llvmContext);
+    llvm::Linker linker(*result);
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        llvm::StringRef inputFile = files[i];
+        if (modules[i] == nullptr) {
+            modules[i] = llvm::parseIRFile(inputFile, err, llvmContext);
+            if (modules[i] == nullptr) {
+                err.print(nullptr, llvm::errs());
+                return nullptr;
+            }
+        }
+
+        if (linker.linkInModule(std::move(modules[i]))) {
+            llvm::errs() << "ERROR: failed to link input file '" << inputFile << "'.\n";
+            return nullptr;
+        }
+    }
+
+    return result;
+}
+
+#undef CHECK_ERROR
+
+auto gazer::ClangCompileAndLink(llvm::ArrayRef<std::string> files, llvm::LLVMContext& llvmContext)
+    -> std::unique_ptr<llvm::Module>
+{
+    if (ClangSubprocess) {
+        return compileAndLinkWithSubprocesses(files, llvmContext);
+    }
+
+    return compileAndLinkInMemory(files, llvmContext);
+}
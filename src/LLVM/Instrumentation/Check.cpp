@@ -159,3 +159,14 @@ std::string CheckRegistry::messageForCode(unsigned ec) const
 
     return rso.str();
 }
+
+std::vector<unsigned> CheckRegistry::getErrorCodes() const
+{
+    std::vector<unsigned> result;
+    for (auto& [ec, violation] : mCheckMap) {
+        result.push_back(ec);
+    }
+    llvm::sort(result);
+
+    return result;
+}
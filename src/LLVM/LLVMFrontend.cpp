@@ -42,6 +42,15 @@
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+
+#include <chrono>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace gazer;
 using namespace llvm;
@@ -64,8 +73,9 @@ namespace
         RunVerificationBackendPass(
             const CheckRegistry& checks,
             VerificationAlgorithm& algorithm,
-            const LLVMFrontendSettings& settings
-        ) : ModulePass(ID), mChecks(checks), mAlgorithm(algorithm), mSettings(settings)
+            const LLVMFrontendSettings& settings,
+            std::unique_ptr<VerificationResult>& result
+        ) : ModulePass(ID), mChecks(checks), mAlgorithm(algorithm), mSettings(settings), mResult(result)
         {}
 
         void getAnalysisUsage(llvm::AnalysisUsage& au) const override
@@ -84,12 +94,123 @@ namespace
         const CheckRegistry& mChecks;
         VerificationAlgorithm& mAlgorithm;
         const LLVMFrontendSettings& mSettings;
-        std::unique_ptr<VerificationResult> mResult;
+        std::unique_ptr<VerificationResult>& mResult;
     };
 
+    /// Writes the translated automata system into the automata cache.
+    /// The cache entry is created by the frontend before running the
+    /// pipeline, as it is keyed on the unmodified input module.
+    class StoreAutomataCachePass : public llvm::ModulePass
+    {
+    public:
+        static char ID;
+
+        StoreAutomataCachePass(const CheckRegistry& checks, std::unique_ptr<AutomataCache>& cache)
+            : ModulePass(ID), mChecks(checks), mCache(cache)
+        {}
+
+        void getAnalysisUsage(llvm::AnalysisUsage& au) const override
+        {
+            au.addRequired<ModuleToAutomataPass>();
+            au.setPreservesAll();
+        }
+
+        bool runOnModule(llvm::Module& module) override;
+
+        llvm::StringRef getPassName() const override {
+            return "Store automata cache";
+        }
+
+    private:
+        const CheckRegistry& mChecks;
+        std::unique_ptr<AutomataCache>& mCache;
+    };
+
+    /// Trace builder of cached runs, in which the mapping between the
+    /// automata and the LLVM module is not available.
+    class NoTraceBuilder : public CfaTraceBuilder
+    {
+    public:
+        std::unique_ptr<Trace> build(
+            std::vector<Location*>& states,
+            std::vector<std::vector<VariableAssignment>>& actions
+        ) override {
+            return nullptr;
+        }
+    };
+
+    void printVerificationResult(
+        VerificationResult& result,
+        llvm::function_ref<std::string(unsigned)> messageForCode,
+        const LLVMFrontendSettings& settings,
+        llvm::Module& module
+    ) {
+        switch (result.getStatus()) {
+            case VerificationResult::Fail: {
+                auto fail = llvm::cast<FailResult>(&result);
+
+                llvm::outs() << "Verification FAILED.\n";
+
+                // Some algorithms may report multiple violated checks in a single run.
+                for (const FailResult::Violation& violation : fail->violations()) {
+                    std::string msg = messageForCode(violation.errorCode);
+                    llvm::outs() << "  " << msg << "\n";
+
+                    if (settings.trace) {
+                        auto writer = trace::CreateTextWriter(llvm::outs(), true);
+                        llvm::outs() << "Error trace:\n";
+                        llvm::outs() << "------------\n";
+                        if (violation.trace != nullptr) {
+                            writer->write(*violation.trace);
+                        } else {
+                            llvm::outs() << "Error trace is unavailable.\n";
+                        }
+                    }
+                }
+
+                if (!settings.testHarnessFile.empty() && fail->hasTrace()) {
+                    llvm::outs() << "Generating test harness.\n";
+                    auto test = GenerateTestHarnessModuleFromTrace(
+                        fail->getTrace(), 
+                        module.getContext(),
+                        module
+                    );
+
+                    llvm::StringRef filename(settings.testHarnessFile);
+                    std::error_code osError;
+                    llvm::raw_fd_ostream testOS(filename, osError, llvm::sys::fs::OpenFlags::OF_None);
+
+                    if (filename.endswith("ll")) {
+                        testOS << *test;
+                    } else {
+                        llvm::WriteBitcodeToFile(*test, testOS);
+                    }
+                }
+                break;
+            }
+            case VerificationResult::Success:
+                llvm::outs() << "Verification SUCCESSFUL.\n";
+                break;
+            case VerificationResult::Timeout:
+                llvm::outs() << "Verification TIMEOUT.\n";
+                break;
+            case VerificationResult::BoundReached:
+                llvm::outs() << "Verification BOUND REACHED.\n";
+                break;
+            case VerificationResult::InternalError:
+                llvm::outs() << "Verification INTERNAL ERROR.\n";
+                llvm::outs() << "  " << result.getMessage() << "\n";
+                break;
+            case VerificationResult::Unknown:
+                llvm::outs() << "Verification UNKNOWN.\n";
+                break;
+        }
+    }
+
 } // end anonymous namespace
 
 char RunVerificationBackendPass::ID;
+char StoreAutomataCachePass::ID;
 
 LLVMFrontend::LLVMFrontend(
     std::unique_ptr<llvm::Module> module,
@@ -131,39 +252,48 @@ void LLVMFrontend::registerVerificationPipeline()
     mPassManager.add(gazer::createMarkFunctionEntriesPass());
     registerInlining();
 
+    // If checks are verified separately, the rest of the pipeline is
+    // executed by the check workers on their own slice of the module.
+    llvm::legacy::PassManager& pm = isSplitChecksEnabled() ? mCheckPassManager : mPassManager;
+
     // Unify function exit nodes
-    mPassManager.add(llvm::createUnifyFunctionExitNodesPass());
+    pm.add(llvm::createUnifyFunctionExitNodesPass());
 
     // Run assertion lifting.
     if (mSettings.liftAsserts) {
-        mPassManager.add(new llvm::CallGraphWrapperPass());
-        mPassManager.add(gazer::createLiftErrorCallsPass());
+        pm.add(new llvm::CallGraphWrapperPass());
+        pm.add(gazer::createLiftErrorCallsPass());
 
         // Assertion lifting creates a lot of dead code. Run a lightweight DCE pass 
         // and a subsequent CFG simplification to clean up.
-        mPassManager.add(llvm::createDeadCodeEliminationPass());
-        mPassManager.add(llvm::createCFGSimplificationPass());
+        pm.add(llvm::createDeadCodeEliminationPass());
+        pm.add(llvm::createCFGSimplificationPass());
 
         // FIXME: Run program slicing here if requested.
     }
 
     // Execute late optimization passes.
-    registerLateOptimizations();
+    registerLateOptimizations(pm);
 
     // Do an instruction namer pass.
-    mPassManager.add(llvm::createInstructionNamerPass());
+    pm.add(llvm::createInstructionNamerPass());
 
     // Display the final LLVM CFG now.
     if (ShowFinalCFG) {
-        mPassManager.add(llvm::createCFGPrinterLegacyPassPass());
+        pm.add(llvm::createCFGPrinterLegacyPassPass());
     }
 
     // Perform module-to-automata translation.
-    mPassManager.add(new gazer::ModuleToAutomataPass(mContext, mSettings));
+    pm.add(new gazer::ModuleToAutomataPass(mContext, mSettings));
+
+    // Store the translated system before the backend may modify it.
+    if (isCacheEnabled()) {
+        pm.add(new StoreAutomataCachePass(mChecks, mCache));
+    }
 
     // Execute the verifier backend if there is one.
     if (mBackendAlgorithm != nullptr) {
-        mPassManager.add(new RunVerificationBackendPass(mChecks, *mBackendAlgorithm, mSettings));
+        pm.add(new RunVerificationBackendPass(mChecks, *mBackendAlgorithm, mSettings, mResult));
     }
 }
 
@@ -176,62 +306,25 @@ bool RunVerificationBackendPass::runOnModule(llvm::Module& module)
     LLVMTraceBuilder traceBuilder{system.getContext(), cfaToLlvmTrace};
 
     mResult = mAlgorithm.check(system, traceBuilder);
-    switch (mResult->getStatus()) {
-        case VerificationResult::Fail: {
-            auto fail = llvm::cast<FailResult>(mResult.get());
-            unsigned ec = fail->getErrorID();
-            std::string msg = mChecks.messageForCode(ec);
-
-            llvm::outs() << "Verification FAILED.\n";
-            llvm::outs() << "  " << msg << "\n";
-
-            if (mSettings.trace) {
-                auto writer = trace::CreateTextWriter(llvm::outs(), true);
-                llvm::outs() << "Error trace:\n";
-                llvm::outs() << "------------\n";
-                if (fail->hasTrace()) {
-                    writer->write(fail->getTrace());
-                } else {
-                    llvm::outs() << "Error trace is unavailable.\n";
-                }
-            }
+    printVerificationResult(*mResult, [this](unsigned ec) {
+        return mChecks.messageForCode(ec);
+    }, mSettings, module);
 
-            if (!mSettings.testHarnessFile.empty() && fail->hasTrace()) {
-                llvm::outs() << "Generating test harness.\n";
-                auto test = GenerateTestHarnessModuleFromTrace(
-                    fail->getTrace(), 
-                    module.getContext(),
-                    module
-                );
+    return false;
+}
 
-                llvm::StringRef filename(mSettings.testHarnessFile);
-                std::error_code osError;
-                llvm::raw_fd_ostream testOS(filename, osError, llvm::sys::fs::OpenFlags::OF_None);
+bool StoreAutomataCachePass::runOnModule(llvm::Module& module)
+{
+    if (mCache == nullptr) {
+        return false;
+    }
 
-                if (filename.endswith("ll")) {
-                    testOS << *test;
-                } else {
-                    llvm::WriteBitcodeToFile(*test, testOS);
-                }
-            }
-            break;
-        }
-        case VerificationResult::Success:
-            llvm::outs() << "Verification SUCCESSFUL.\n";
-            break;
-        case VerificationResult::Timeout:
-            llvm::outs() << "Verification TIMEOUT.\n";
-            break;
-        case VerificationResult::BoundReached:
-            llvm::outs() << "Verification BOUND REACHED.\n";
-            break;
-        case VerificationResult::InternalError:
-            llvm::outs() << "Verification INTERNAL ERROR.\n";
-            llvm::outs() << "  " << mResult->getMessage() << "\n";
-            break;
-        case VerificationResult::Unknown:
-            llvm::outs() << "Verification UNKNOWN.\n";
-            break;
+    auto& moduleToCfa = getAnalysis<ModuleToAutomataPass>();
+    if (!mCache->store(moduleToCfa.getSystem(), mChecks)) {
+        llvm::errs().changeColor(llvm::raw_ostream::YELLOW, true);
+        llvm::errs() << "warning: ";
+        llvm::errs().resetColor();
+        llvm::errs() << "could not write automata cache entry " << mCache->getPath() << "\n";
     }
 
     return false;
@@ -278,7 +371,245 @@ void LLVMFrontend::registerPass(llvm::Pass* pass)
 
 void LLVMFrontend::run()
 {
+    if (isCacheEnabled()) {
+        mCache = std::make_unique<AutomataCache>(mSettings.cfaCacheDirectory, *mModule, mSettings);
+        if (this->runFromCache()) {
+            return;
+        }
+    }
+
     mPassManager.run(*mModule);
+
+    if (isSplitChecksEnabled()) {
+        this->runCheckWorkers();
+    }
+}
+
+bool LLVMFrontend::runFromCache()
+{
+    llvm::DenseMap<unsigned, std::string> messages;
+    mCachedSystem = mCache->load(mContext, messages);
+    if (mCachedSystem == nullptr) {
+        return false;
+    }
+
+    NoTraceBuilder traceBuilder;
+    mResult = mBackendAlgorithm->check(*mCachedSystem, traceBuilder);
+    printVerificationResult(*mResult, [&messages](unsigned ec) -> std::string {
+        auto it = messages.find(ec);
+        return it != messages.end() ? it->second : "Unknown failure.\n";
+    }, mSettings, *mModule);
+
+    return true;
+}
+
+namespace
+{
+
+struct CheckJob
+{
+    unsigned errorCode;
+    llvm::SmallString<128> logFile;
+    llvm::SmallString<128> harnessFile;
+    VerificationResult::Status status = VerificationResult::InternalError;
+};
+
+} // end anonymous namespace
+
+void LLVMFrontend::runCheckWorkers()
+{
+    // Collect the error codes which are still present after the common part of the pipeline.
+    std::vector<unsigned> errorCodes;
+    if (llvm::Function* errorFn = mModule->getFunction(CheckRegistry::ErrorFunctionName)) {
+        for (llvm::User* user : errorFn->users()) {
+            auto call = llvm::dyn_cast<llvm::CallInst>(user);
+            if (call == nullptr) {
+                continue;
+            }
+
+            if (auto ec = llvm::dyn_cast<llvm::ConstantInt>(call->getArgOperand(0))) {
+                errorCodes.push_back(ec->getZExtValue());
+            }
+        }
+    }
+
+    llvm::sort(errorCodes);
+    errorCodes.erase(std::unique(errorCodes.begin(), errorCodes.end()), errorCodes.end());
+
+    if (errorCodes.empty()) {
+        llvm::outs() << "Verification SUCCESSFUL.\n";
+        mResult = VerificationResult::CreateSuccess();
+        return;
+    }
+
+    unsigned maxWorkers = mSettings.checkWorkers;
+    if (maxWorkers == 0) {
+        maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<CheckJob> jobs;
+    for (unsigned ec : errorCodes) {
+        jobs.push_back({ec, {}});
+    }
+
+    // Make sure that nothing buffered before the fork gets written twice.
+    llvm::outs().flush();
+    llvm::errs().flush();
+
+    llvm::DenseMap<pid_t, size_t> running;
+    auto waitForWorker = [&running, &jobs]() {
+        // Only reap our own workers: other parts of the process (e.g. the
+        // compiler driver) may have children of their own.
+        while (!running.empty()) {
+            for (auto it = running.begin(), ie = running.end(); it != ie; ++it) {
+                int wstatus;
+                pid_t pid = ::waitpid(it->first, &wstatus, WNOHANG);
+                if (pid == 0) {
+                    continue;
+                }
+
+                CheckJob& job = jobs[it->second];
+                if (pid > 0 && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) <= VerificationResult::InternalError) {
+                    job.status = static_cast<VerificationResult::Status>(WEXITSTATUS(wstatus));
+                } else {
+                    job.status = VerificationResult::InternalError;
+                }
+                running.erase(it);
+                return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        return false;
+    };
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        CheckJob& job = jobs[i];
+
+        int fd;
+        if (auto ec = llvm::sys::fs::createTemporaryFile("gazer-check", "log", fd, job.logFile)) {
+            llvm::errs() << "error: could not create log file for check " << job.errorCode
+                << ": " << ec.message() << "\n";
+            continue;
+        }
+
+        if (!mSettings.testHarnessFile.empty()) {
+            // Each worker writes its own harness, the one of a failing check is kept.
+            llvm::StringRef ext = llvm::sys::path::extension(mSettings.testHarnessFile);
+            if (auto ec = llvm::sys::fs::createTemporaryFile(
+                "gazer-harness", ext.empty() ? "bc" : ext.drop_front(), job.harnessFile
+            )) {
+                llvm::errs() << "error: could not create test harness file for check " << job.errorCode
+                    << ": " << ec.message() << "\n";
+                job.harnessFile.clear();
+            }
+        }
+
+        while (running.size() >= maxWorkers && waitForWorker()) {
+            // Wait for a free worker slot.
+        }
+
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            // The worker process: redirect its output into the log file, slice
+            // the module with respect to its own check and verify the slice.
+            // The log contains the counterexample trace if it was requested.
+            ::dup2(fd, STDOUT_FILENO);
+            ::close(fd);
+            mSettings.testHarnessFile = job.harnessFile.str();
+
+            llvm::legacy::PassManager slicePM;
+            slicePM.add(gazer::createCheckSlicerPass(job.errorCode));
+            slicePM.add(new gazer::UndefToNondetCallPass());
+            slicePM.run(*mModule);
+
+            mCheckPassManager.run(*mModule);
+            llvm::outs().flush();
+
+            auto status = mResult != nullptr ? mResult->getStatus() : VerificationResult::InternalError;
+            ::_exit(static_cast<int>(status));
+        }
+
+        ::close(fd);
+        if (pid < 0) {
+            llvm::errs() << "error: could not start worker for check " << job.errorCode << "\n";
+            continue;
+        }
+
+        running[pid] = i;
+    }
+
+    while (!running.empty() && waitForWorker()) {
+        // Wait for the remaining workers.
+    }
+
+    // Print the logs of the individual checks and merge their results.
+    std::vector<FailResult::Violation> violations;
+    bool hasError = false, hasUnknown = false, hasTimeout = false, hasBoundReached = false;
+
+    bool hasHarness = false;
+
+    for (CheckJob& job : jobs) {
+        llvm::outs() << "=== Check " << job.errorCode << ": " << mChecks.messageForCode(job.errorCode) << "\n";
+        if (!job.logFile.empty()) {
+            if (auto buffer = llvm::MemoryBuffer::getFile(job.logFile)) {
+                llvm::outs() << (*buffer)->getBuffer();
+            }
+            llvm::sys::fs::remove(job.logFile);
+        }
+
+        if (!job.harnessFile.empty()) {
+            // Keep the harness of the first failing check which produced one.
+            uint64_t size = 0;
+            if (!hasHarness && job.status == VerificationResult::Fail
+                && !llvm::sys::fs::file_size(job.harnessFile, size) && size != 0
+            ) {
+                if (auto ec = llvm::sys::fs::copy_file(job.harnessFile, mSettings.testHarnessFile)) {
+                    llvm::errs() << "error: could not write test harness: " << ec.message() << "\n";
+                } else {
+                    hasHarness = true;
+                }
+            }
+            llvm::sys::fs::remove(job.harnessFile);
+        }
+
+        switch (job.status) {
+            case VerificationResult::Fail:
+                // The trace of the worker was printed into its log already.
+                violations.push_back({job.errorCode, nullptr});
+                break;
+            case VerificationResult::InternalError: hasError = true; break;
+            case VerificationResult::Unknown: hasUnknown = true; break;
+            case VerificationResult::Timeout: hasTimeout = true; break;
+            case VerificationResult::BoundReached: hasBoundReached = true; break;
+            case VerificationResult::Success: break;
+        }
+    }
+
+    llvm::outs() << "=== Summary\n";
+    if (!violations.empty()) {
+        llvm::outs() << "Verification FAILED.\n";
+        for (auto& violation : violations) {
+            llvm::outs() << "  " << mChecks.messageForCode(violation.errorCode) << "\n";
+        }
+        mResult = std::make_unique<FailResult>(std::move(violations));
+    } else if (hasError) {
+        llvm::outs() << "Verification INTERNAL ERROR.\n";
+        mResult = VerificationResult::CreateInternalError("One or more check workers failed.");
+    } else if (hasTimeout) {
+        llvm::outs() << "Verification TIMEOUT.\n";
+        mResult = VerificationResult::CreateTimeout();
+    } else if (hasUnknown) {
+        llvm::outs() << "Verification UNKNOWN.\n";
+        mResult = VerificationResult::CreateUnknown();
+    } else if (hasBoundReached) {
+        llvm::outs() << "Verification BOUND REACHED.\n";
+        mResult = VerificationResult::CreateBoundReached();
+    } else {
+        llvm::outs() << "Verification SUCCESSFUL.\n";
+        mResult = VerificationResult::CreateSuccess();
+    }
 }
 
 void LLVMFrontend::registerEarlyOptimizations()
@@ -293,24 +624,24 @@ void LLVMFrontend::registerEarlyOptimizations()
     }
 }
 
-void LLVMFrontend::registerLateOptimizations()
+void LLVMFrontend::registerLateOptimizations(llvm::legacy::PassManager& pm)
 {
     if (mSettings.optimize) {
-        mPassManager.add(llvm::createFloat2IntPass());
+        pm.add(llvm::createFloat2IntPass());
 
         // IndVarSimplify seems to produce a lot of overhead for certain programs,
         // disable it for the time being.
-        //mPassManager.add(llvm::createIndVarSimplifyPass());
-        mPassManager.add(llvm::createLICMPass());
+        //pm.add(llvm::createIndVarSimplifyPass());
+        pm.add(llvm::createLICMPass());
     }
 
-    mPassManager.add(llvm::createGlobalOptimizerPass());
-    mPassManager.add(llvm::createGlobalDCEPass());
+    pm.add(llvm::createGlobalOptimizerPass());
+    pm.add(llvm::createGlobalDCEPass());
 
     // Currently loop simplify must be applied for ModuleToAutomata
     // to work properly as it relies on loop preheaders being available.
-    mPassManager.add(llvm::createCFGSimplificationPass());
-    mPassManager.add(llvm::createLoopSimplifyPass());
+    pm.add(llvm::createCFGSimplificationPass());
+    pm.add(llvm::createLoopSimplifyPass());
 }
 
 auto LLVMFrontend::FromInputFile(
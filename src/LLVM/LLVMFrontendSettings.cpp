@@ -44,6 +44,21 @@ namespace
     cl::opt<bool> NoSlice(
         "no-slicing", cl::desc("Do not run program slicing pass"), cl::cat(LLVMFrontendCategory)
     );
+    cl::opt<bool> SplitChecks(
+        "split-checks", cl::desc("Verify each check on its own program slice, in separate worker processes"),
+        cl::cat(LLVMFrontendCategory)
+    );
+    cl::opt<unsigned> CheckWorkers(
+        "check-workers", cl::desc("Maximum number of parallel check workers (0: number of cores)"),
+        cl::init(0), cl::cat(LLVMFrontendCategory)
+    );
+    cl::opt<std::string> CfaCacheDirectory(
+        "cfa-cache",
+        cl::desc("Cache the translated automata in the given directory (not used with -trace or -test-harness)"),
+        cl::value_desc("directory"),
+        cl::init(""),
+        cl::cat(LLVMFrontendCategory)
+    );
 
     // LLVM IR to CFA translation options
     cl::opt<ElimVarsLevel> ElimVarsLevelOpt("elim-vars", cl::desc("Level for variable elimination:"),
@@ -62,6 +77,34 @@ namespace
         "no-simplify-expr", cl::desc("Do not simplify expressions"),
         cl::cat(IrToCfaCategory)
     );
+    cl::opt<bool> ConeOfInfluence(
+        "cfa-coi", cl::desc("Remove CFA variables which cannot influence the reachability of errors"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> DeadAssignments(
+        "elim-dead-assign", cl::desc("Remove CFA assignments whose value is never read"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> LargeBlockEncoding(
+        "lbe", cl::desc("Merge linear chains of CFA locations into single transitions"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> DedupAutomata(
+        "cfa-dedup", cl::desc("Merge structurally equivalent automata"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> LoopAcceleration(
+        "accelerate-loops", cl::desc("Accelerate simple counting loops of cyclic CFAs"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> IntervalSimplification(
+        "cfa-intervals", cl::desc("Remove CFA transitions found infeasible by interval analysis"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> IntervalInvariants(
+        "cfa-interval-invariants", cl::desc("Add the loop invariants found by interval analysis to the CFA guards"),
+        cl::cat(IrToCfaCategory)
+    );
 
     // Memory models
     cl::opt<bool> DebugDumpMemorySSA(
@@ -102,7 +145,17 @@ LLVMFrontendSettings LLVMFrontendSettings::initFromCommandLine()
     settings.optimize = !NoOptimize;
     settings.liftAsserts = !NoAssertLift;
     settings.slicing =!NoSlice;
+    settings.splitChecks = SplitChecks;
+    settings.checkWorkers = CheckWorkers;
+    settings.cfaCacheDirectory = CfaCacheDirectory;
     settings.simplifyExpr = !NoSimplifyExpr;
+    settings.coneOfInfluence = ConeOfInfluence;
+    settings.deadAssignments = DeadAssignments;
+    settings.largeBlockEncoding = LargeBlockEncoding;
+    settings.dedupAutomata = DedupAutomata;
+    settings.loopAcceleration = LoopAcceleration;
+    settings.intervalSimplification = IntervalSimplification || IntervalInvariants;
+    settings.intervalInvariants = IntervalInvariants;
 
     settings.elimVars = ElimVarsLevelOpt;
     settings.memoryModel = MemoryModelOpt;
@@ -153,7 +206,38 @@ std::string LLVMFrontendSettings::toString() const
         case FloatRepresentation::Undef:   str += "undef"; break;
     }
 
-    str += "\"}";
+    str += R"(", "memory_model": ")";
+
+    switch (memoryModel) {
+        case MemoryModelSetting::Havoc:    str += "havoc"; break;
+        case MemoryModelSetting::Flat:     str += "flat";  break;
+    }
+
+    str += "\"";
+
+    auto addFlag = [&str](const char* name, bool value) {
+        str += R"(, ")";
+        str += name;
+        str += value ? R"(": true)" : R"(": false)";
+    };
+
+    addFlag("inline_functions", inlineFunctions);
+    addFlag("inline_globals", inlineGlobals);
+    addFlag("optimize", optimize);
+    addFlag("lift_asserts", liftAsserts);
+    addFlag("slicing", slicing);
+    addFlag("simplify_expr", simplifyExpr);
+    addFlag("cone_of_influence", coneOfInfluence);
+    addFlag("dead_assignments", deadAssignments);
+    addFlag("large_block_encoding", largeBlockEncoding);
+    addFlag("dedup_automata", dedupAutomata);
+    addFlag("loop_acceleration", loopAcceleration);
+    addFlag("interval_simplification", intervalSimplification);
+    addFlag("interval_invariants", intervalInvariants);
+
+    str += R"(, "extern_func_globals": )";
+    str += std::to_string(static_cast<int>(externFuncGlobals));
+    str += "}";
 
     return str;
 }
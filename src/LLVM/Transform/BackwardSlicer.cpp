@@ -17,9 +17,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "gazer/LLVM/Transform/BackwardSlicer.h"
+#include "gazer/LLVM/Instrumentation/Check.h"
 
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/ADT/SmallPtrSet.h>
 
 using namespace gazer;
 using namespace llvm;
@@ -73,20 +77,47 @@ void BackwardSlicer::sliceBlocks(
     const llvm::DenseSet<llvm::Instruction*>& required,
     llvm::SmallVectorImpl<llvm::BasicBlock*>& preservedBlocks
 ) {
+    // Blocks which may reach a required instruction must be preserved, even if
+    // they do not contain any required instructions themselves. Otherwise we
+    // would cut off the paths leading to the slicing criteria.
+    llvm::SmallPtrSet<llvm::BasicBlock*, 32> reachesRequired;
+    llvm::SmallVector<llvm::BasicBlock*, 32> wl;
+
+    for (llvm::BasicBlock& bb : mFunction) {
+        bool hasRequired = std::any_of(bb.begin(), bb.end(), [&required](llvm::Instruction& inst) {
+            return required.count(&inst) != 0;
+        });
+
+        if (hasRequired) {
+            reachesRequired.insert(&bb);
+            wl.push_back(&bb);
+        }
+    }
+
+    while (!wl.empty()) {
+        llvm::BasicBlock* current = wl.pop_back_val();
+        for (llvm::BasicBlock* pred : llvm::predecessors(current)) {
+            if (reachesRequired.insert(pred).second) {
+                wl.push_back(pred);
+            }
+        }
+    }
+
     auto& list = mFunction.getBasicBlockList();
     auto it = list.begin(), ie = list.end();
 
     while (it != ie) {
         llvm::BasicBlock& bb = *(it++);        
-        bool shouldRemove = std::all_of(bb.begin(), bb.end(), [&required](llvm::Instruction& inst) {
-            return required.count(&inst) == 0;
-        });
-
-        if (!shouldRemove) {
+        if (reachesRequired.count(&bb) != 0) {
             preservedBlocks.push_back(&bb);
             continue;
         }
 
+        // Update successors PHI's
+        for (llvm::BasicBlock* succ : llvm::successors(&bb)) {
+            succ->removePredecessor(&bb);
+        }
+
         // Remove all instructions in this block
         for (auto j = bb.begin(); j != bb.end();) {
             llvm::Instruction& inst = *(j++);
@@ -96,11 +127,6 @@ void BackwardSlicer::sliceBlocks(
             inst.eraseFromParent();
         }
 
-        // Update successors PHI's
-        for (llvm::BasicBlock* succ : llvm::successors(&bb)) {
-            succ->removePredecessor(&bb);
-        }
-
         // Insert a new 'unreachable' instruction as the terminator
         auto unreachable = new UnreachableInst(mFunction.getContext());
         bb.getInstList().push_back(unreachable);
@@ -193,4 +219,122 @@ private:
 llvm::Pass* gazer::createBackwardSlicerPass(std::function<bool(llvm::Instruction*)> criteria)
 {
     return new BackwardSlicerPass(criteria);
+}
+
+// Check slicing
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+
+class CheckSlicerPass : public llvm::ModulePass
+{
+public:
+    static char ID;
+
+    explicit CheckSlicerPass(unsigned errorCode)
+        : ModulePass(ID), mErrorCode(errorCode)
+    {}
+
+    bool runOnModule(llvm::Module& module) override;
+
+    llvm::StringRef getPassName() const override {
+        return "Slice module to a single check";
+    }
+
+private:
+    unsigned mErrorCode;
+};
+
+} // end anonymous namespace
+
+char CheckSlicerPass::ID;
+
+bool CheckSlicerPass::runOnModule(llvm::Module& module)
+{
+    llvm::Function* errorFunction = module.getFunction(CheckRegistry::ErrorFunctionName);
+    if (errorFunction == nullptr) {
+        return false;
+    }
+
+    // Remove the error calls of other checks. As error blocks are terminated
+    // by an 'unreachable' instruction, they will become infeasible paths.
+    // Error calls with non-constant error codes are conservatively kept.
+    std::vector<llvm::CallInst*> otherErrors;
+    llvm::SmallPtrSet<llvm::Function*, 8> mayFail;
+    llvm::SmallVector<llvm::Function*, 8> wl;
+
+    for (llvm::User* user : errorFunction->users()) {
+        auto call = llvm::dyn_cast<llvm::CallInst>(user);
+        if (call == nullptr) {
+            continue;
+        }
+
+        auto code = llvm::dyn_cast<llvm::ConstantInt>(call->getArgOperand(0));
+        if (code != nullptr && code->getZExtValue() != mErrorCode) {
+            otherErrors.push_back(call);
+        } else if (mayFail.insert(call->getFunction()).second) {
+            wl.push_back(call->getFunction());
+        }
+    }
+
+    for (llvm::CallInst* call : otherErrors) {
+        call->eraseFromParent();
+    }
+
+    // Find all functions which may call a procedure containing our check.
+    while (!wl.empty()) {
+        llvm::Function* function = wl.pop_back_val();
+        for (llvm::User* user : function->users()) {
+            auto call = llvm::dyn_cast<llvm::CallInst>(user);
+            if (call != nullptr && mayFail.insert(call->getFunction()).second) {
+                wl.push_back(call->getFunction());
+            }
+        }
+    }
+
+    bool changed = !otherErrors.empty();
+    for (llvm::Function& function : module) {
+        if (function.isDeclaration() || mayFail.count(&function) == 0) {
+            // Procedures which cannot reach the check are left intact,
+            // as their side effects may still be relevant for their callers.
+            continue;
+        }
+
+        // The return values and memory effects of procedures with callers
+        // might be observed by their caller, we must keep them as well.
+        bool isObservable = !function.use_empty();
+
+        BackwardSlicer slicer(function, [&](llvm::Instruction* inst) {
+            if (auto call = llvm::dyn_cast<llvm::CallInst>(inst)) {
+                llvm::Function* callee = call->getCalledFunction();
+                if (callee == nullptr || callee == errorFunction || mayFail.count(callee) != 0) {
+                    return true;
+                }
+
+                // Assumptions and calls which do not return restrict the
+                // feasible paths, removing them would yield spurious failures.
+                if (callee->getName() == "verifier.assume" || callee->getName() == "llvm.assume"
+                    || call->doesNotReturn()
+                ) {
+                    return true;
+                }
+            }
+
+            if (isObservable) {
+                return llvm::isa<llvm::ReturnInst>(inst) || inst->mayWriteToMemory();
+            }
+
+            return false;
+        });
+
+        changed |= slicer.slice();
+    }
+
+    return changed;
+}
+
+llvm::Pass* gazer::createCheckSlicerPass(unsigned errorCode)
+{
+    return new CheckSlicerPass(errorCode);
 }
\ No newline at end of file
@@ -25,6 +25,8 @@
 
 #include <z3++.h>
 
+#include <atomic>
+
 #define DEBUG_TYPE "Z3Solver"
 
 using namespace gazer;
@@ -755,6 +757,11 @@ public:
     SolverStatus run() override;
     Valuation getModel() override;
     void reset() override;
+    void interrupt() override;
+    void clearInterrupt() override;
+
+    SolverStatus run(const ExprVector& assumptions) override;
+    ExprVector getUnsatCore() override;
 
     void push() override;
     void pop() override;
@@ -768,12 +775,20 @@ protected:
     unsigned mTmpCount = 0;
     CacheMapT mCache;
     Z3ExprTransformer mTransformer;
+    std::vector<std::pair<z3::expr, ExprPtr>> mAssumptions;
+
+    // Z3 only cancels the query running at the time of the interrupt.
+    std::atomic<bool> mInterrupted{false};
 };
 
 } // end anonymous namespace
 
 Solver::SolverStatus Z3Solver::run()
 {
+    if (mInterrupted) {
+        return SolverStatus::UNKNOWN;
+    }
+
     z3::check_result result = mSolver.check();
 
     switch (result) {
@@ -785,6 +800,50 @@ Solver::SolverStatus Z3Solver::run()
     llvm_unreachable("Unknown solver status encountered.");
 }
 
+Solver::SolverStatus Z3Solver::run(const ExprVector& assumptions)
+{
+    mAssumptions.clear();
+
+    z3::expr_vector z3Assumptions(mZ3Context);
+    for (const ExprPtr& assumption : assumptions) {
+        assert(assumption->getType().isBoolType() && "Assumptions must be boolean expressions.");
+        z3::expr z3Expr(mZ3Context, mTransformer.walk(assumption));
+        z3Assumptions.push_back(z3Expr);
+        mAssumptions.emplace_back(z3Expr, assumption);
+    }
+
+    if (mInterrupted) {
+        return SolverStatus::UNKNOWN;
+    }
+
+    z3::check_result result = mSolver.check(z3Assumptions);
+
+    switch (result) {
+        case z3::unsat: return SolverStatus::UNSAT;
+        case z3::sat: return SolverStatus::SAT;
+        case z3::unknown: return SolverStatus::UNKNOWN;
+    }
+
+    llvm_unreachable("Unknown solver status encountered.");
+}
+
+ExprVector Z3Solver::getUnsatCore()
+{
+    ExprVector core;
+    z3::expr_vector z3Core = mSolver.unsat_core();
+
+    // Z3 returns the assumption terms themselves, map them back to their original form.
+    for (unsigned i = 0; i < z3Core.size(); ++i) {
+        auto it = std::find_if(mAssumptions.begin(), mAssumptions.end(), [&](auto& entry) {
+            return z3::eq(entry.first, z3Core[i]);
+        });
+        assert(it != mAssumptions.end() && "Unsat core elements must be assumptions!");
+        core.push_back(it->second);
+    }
+
+    return core;
+}
+
 void Z3Solver::addConstraint(ExprPtr expr)
 {
     auto z3Expr = mTransformer.walk(expr);
@@ -794,9 +853,21 @@ void Z3Solver::addConstraint(ExprPtr expr)
 void Z3Solver::reset()
 {
     mCache.clear();
+    mAssumptions.clear();
     mSolver.reset();
 }
 
+void Z3Solver::interrupt()
+{
+    mInterrupted = true;
+    mZ3Context.interrupt();
+}
+
+void Z3Solver::clearInterrupt()
+{
+    mInterrupted = false;
+}
+
 void Z3Solver::push()
 {
     mCache.push();
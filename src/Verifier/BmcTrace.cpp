@@ -21,46 +21,45 @@
 
 using namespace gazer;
 
+bmc::BmcCex::BmcCex(Location* start, const Valuation& model, PredecessorMapT& preds)
+    : mStart(start), mModel(model)
+{
+    assert(start != nullptr);
+
+    // Inner scopes shadow the entries of outer ones.
+    for (auto& scope : preds.scopes()) {
+        for (auto& [loc, selector] : scope) {
+            mSelectors[loc] = &selector;
+        }
+    }
+}
+
 void bmc::cex_iterator::advance()
 {
-    auto pred = mCex.mPredecessors.get(mState.getLocation());
-    if (!pred) {
-        // No predcessor information is available, this was the end of the counterexample trace.
+    auto it = mCex.mSelectors.find(mState.getLocation());
+    if (it == mCex.mSelectors.end()) {
+        // No predecessor information is available, this was the end of the counterexample trace.
         mState = { nullptr, nullptr };
         return;
     }
 
-    Location* current = mState.getLocation();
-    //auto predLit = llvm::dyn_cast_or_null<BvLiteralExpr>(
-    //    mCex.mEval.walk(pred->second).get()
-    //);
-    auto predLit = llvm::dyn_cast_or_null<IntLiteralExpr>(
-        mCex.mEval.walk(pred->second).get()
-    );
-                            
-    assert((predLit != nullptr) && "Pred values should be evaluatable as integer literals!");
-    
-    size_t predId = predLit->getValue();//.getLimitedValue();
-    Location* source = mCex.mCfa.findLocationById(predId);
-
-    assert(source != nullptr && "Locations should be findable by their id!");
-
-    auto edge = std::find_if(
-        current->incoming_begin(),
-        current->incoming_end(),
-        [source](Transition* e) { return e->getSource() == source; }
-    );
-
-    assert(edge != current->incoming_end()
-        && "There must be an edge between a location and its direct predecessor!");
-
-    mState = { source, *edge };
+    Transition* edge = it->second->decode(mCex.mModel);
+    assert(edge->getTarget() == mState.getLocation()
+        && "The selected edge must be an incoming edge of the current location!");
+
+    mState = { edge->getSource(), edge };
 }
 
 // FIXME: Move this to BoundedModelChecker.cpp?
 std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
-{               
-    auto model = mSolver->getModel();
+{
+    auto violation = this->createViolation();
+    return VerificationResult::CreateFail(violation.errorCode, std::move(violation.trace));
+}
+
+FailResult::Violation BoundedModelCheckerImpl::createViolation()
+{
+    auto model = this->getModel(*mSolver);
     ExprEvaluator eval{model};
 
     if (mSettings.dumpSolverModel) {
@@ -72,7 +71,7 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
         std::vector<Location*> states;
         std::vector<std::vector<VariableAssignment>> actions;
 
-        bmc::BmcCex cex{mError, *mRoot, eval, mPredecessors};
+        bmc::BmcCex cex{mError, model, mPredecessors};
         for (auto state : cex) {
             Location* loc = state.getLocation();
             Transition* edge = state.getOutgoingTransition();
@@ -123,9 +122,9 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
 
     switch (errorExpr->getType().getTypeID()) {
         case Type::BvTypeID:
-            return VerificationResult::CreateFail(llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue(), std::move(trace));
+            return { static_cast<unsigned>(llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue()), std::move(trace) };
         case Type::IntTypeID:
-            return VerificationResult::CreateFail(llvm::cast<IntLiteralExpr>(errorExpr)->getValue(), std::move(trace));
+            return { static_cast<unsigned>(llvm::cast<IntLiteralExpr>(errorExpr)->getValue()), std::move(trace) };
         default:
             llvm_unreachable("Invalid error field type!");
     }
@@ -19,6 +19,7 @@
 
 #include "gazer/Core/Expr/ExprRewrite.h"
 #include "gazer/Core/Expr/ExprUtils.h"
+#include "gazer/Automaton/CfaTransforms.h"
 #include "gazer/Automaton/CfaUtils.h"
 
 #include "gazer/Support/Stopwatch.h"
@@ -29,10 +30,20 @@
 
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Debug.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
 
 #include <boost/dynamic_bitset.hpp>
 
+#include <chrono>
+#include <future>
+#include <queue>
 #include <sstream>
+#include <thread>
+
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #define DEBUG_TYPE "BoundedModelChecker"
 
@@ -47,7 +58,12 @@ std::unique_ptr<VerificationResult> BoundedModelChecker::check(AutomataSystem& s
     } else {
         builder = CreateExprBuilder(system.getContext());
     }
-    BoundedModelCheckerImpl impl{system, *builder, mSolverFactory, traceBuilder, mSettings};
+
+    if (mInliningPolicy == nullptr) {
+        mInliningPolicy = createDefaultInliningPolicy();
+    }
+
+    BoundedModelCheckerImpl impl{system, *builder, mSolverFactory, traceBuilder, *mInliningPolicy, mSettings};
 
     auto result = impl.check();
 
@@ -61,16 +77,30 @@ BoundedModelCheckerImpl::BoundedModelCheckerImpl(
     ExprBuilder& builder,
     SolverFactory& solverFactory,
     CfaTraceBuilder& traceBuilder,
+    InliningPolicy& inliningPolicy,
     BmcSettings settings
 ) : mSystem(system),
     mExprBuilder(builder),
     mSolver(solverFactory.createSolver(system.getContext())),
     mTraceBuilder(traceBuilder),
+    mInliningPolicy(inliningPolicy),
     mSettings(settings)
 {
     // TODO: Clone the main automaton instead of modifying the original.
     mRoot = mSystem.getMainAutomaton();
     assert(mRoot != nullptr && "The main automaton must exist!");
+
+    if (mSettings.procedureSummaries) {
+        mSummaries = std::make_unique<ProcedureSummaryCache>(system, builder, solverFactory);
+    }
+
+    if (mSettings.proveErrorFreedom) {
+        mErrorFreedom = std::make_unique<ErrorFreedomAnalysis>(system, builder, solverFactory);
+    }
+
+    if (mSettings.concurrentApprox) {
+        mOverSolver = solverFactory.createSolver(system.getContext());
+    }
 }
 
 void BoundedModelCheckerImpl::createTopologicalSorts()
@@ -171,6 +201,11 @@ void BoundedModelCheckerImpl::removeIrrelevantLocations()
 
 std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
 {
+    if (mErrorFreedom != nullptr && mErrorFreedom->isErrorFree(mRoot)) {
+        llvm::outs() << "The main automaton was proven error-free.\n";
+        return VerificationResult::CreateSuccess();
+    }
+
     // Initialize error field
     bool hasErrorLocation = this->initializeErrorField();
     if (!hasErrorLocation) {
@@ -203,8 +238,8 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
         [this](CallTransition* call) -> ExprPtr {
             return mCalls[call].overApprox;
         },
-        [this](Location* l, Variable* v, ExprPtr e) {
-            mPredecessors.insert(l, {v, e});
+        [this](Location* l, const PredecessorSelector& selector) {
+            mPredecessors.insert(l, selector);
         }
     );
 
@@ -238,26 +273,123 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
     Location* bottom = mError;
 
     bool skipUnderApprox = false;
+    mExhaustedBound = mSettings.eagerUnroll;
+
+    // Whether calls were inlined since dead assignments were last eliminated.
+    bool hasInlinedCalls = mSettings.eagerUnroll != 0;
     
     // Let's do some verification.
-    for (size_t bound = mSettings.eagerUnroll + 1; bound <= mSettings.maxBound; ++bound) {
+    for (size_t bound = mSettings.eagerUnroll + 1; bound <= mSettings.maxBound; bound = this->getNextBound(bound)) {
         llvm::outs() << "Iteration " << bound << "\n";
+        mStats.NumRounds++;
+        mStats.FinalBound = bound;
+        auto roundStartTime = mStats.SolverTime;
+
+        // The whole root is analyzed, thus it is only done once per bound instead of
+        // after each inlining step. Counterexample traces report the values of all variables.
+        if (hasInlinedCalls && mSettings.eliminateDeadAssignments && !mSettings.trace) {
+            auto result = TransformDeadAssignmentElimination(mRoot, [this](Variable* variable) {
+                return variable == mErrorFieldVariable;
+            });
+            mStats.NumDeadAssignments += result.NumRemovedAssignments;
+            hasInlinedCalls = false;
+        }
 
         while (true) {
             unsigned numUnhandledCallSites = 0;
             ExprPtr formula;
             Solver::SolverStatus status = Solver::UNKNOWN;
+            std::pair<Location*, Location*> lca;
+
+            // The solver holding the result of the over-approximation.
+            Solver* overSolver = mSolver.get();
+            bool overApproxDone = false;
+
+            if (!skipUnderApprox && mOverSolver != nullptr) {
+                // Both formulas are built on this thread, only the solvers run concurrently.
+                // The over-approximation is encoded first, so that the predecessor identifications
+                // of the under-approximation shadow its own ones if a counterexample is found.
+                llvm::outs() << "  Over-approximating.\n";
+                lca = this->findCommonCallAncestor(top, bottom);
+
+                // The start and target constraints must not restrict the under-approximation,
+                // which is still looking for paths between the old start and target points.
+                this->push(*mOverSolver);
+                ExprVector lcaConstraints;
+                if (lca.first != nullptr) {
+                    lcaConstraints.push_back(pathConditions.encode(top, lca.first));
+                    lcaConstraints.push_back(pathConditions.encode(lca.second, bottom));
+                } else {
+                    lca = { top, bottom };
+                }
+
+                for (const ExprPtr& expr : lcaConstraints) {
+                    mOverSolver->add(expr);
+                }
+
+                numUnhandledCallSites = this->approximateCalls(bound);
 
-            if (!skipUnderApprox) {
+                this->push(*mOverSolver);
+                formula = pathConditions.encode(lca.first, lca.second);
+                mOverSolver->add(formula);
+
+                llvm::outs() << "  Under-approximating.\n";
+                for (auto& entry : mCalls) {
+                    entry.second.overApprox = mExprBuilder.False();
+                }
+
+                this->push(*mSolver);
+                mSolver->add(pathConditions.encode(top, bottom));
+
+                Solver::SolverStatus underStatus;
+                std::tie(underStatus, status) = this->runConcurrently();
+
+                if (underStatus == Solver::SAT) {
+                    llvm::outs() << "  Under-approximated formula is SAT.\n";
+                    if (auto result = this->handleViolation(bound)) {
+                        return result;
+                    }
+
+                    this->pop(*mSolver);
+                    this->pop(*mOverSolver);
+                    this->pop(*mOverSolver);
+                    this->blockErrorCode(mViolations.back().errorCode);
+                    continue;
+                }
+
+                // Bring the under-approximating solver to the same state as the
+                // other one, as it will continue from the new start and target.
+                // The predecessor scopes are already shared with the over-approximation.
+                this->pop(*mSolver);
+                mSolver->push();
+                for (const ExprPtr& expr : lcaConstraints) {
+                    mSolver->add(expr);
+                }
+                mSolver->push();
+
+                if (lca.first != nullptr && status == Solver::UNSAT) {
+                    // A satisfiable over-approximation already implies that the start and
+                    // target points are consistent, only check them if it was not.
+                    if (this->runSolver() == Solver::UNSAT) {
+                        llvm::outs() << "    Start and target points are inconsitent, no errors are reachable.\n";
+                        return this->finishResult(VerificationResult::CreateSuccess());
+                    }
+                }
+
+                overSolver = mOverSolver.get();
+                overApproxDone = true;
+            } else if (!skipUnderApprox) {
                 llvm::outs() << "  Under-approximating.\n";
 
                 for (auto& entry : mCalls) {
                     entry.second.overApprox = mExprBuilder.False();
                 }
 
+                // Encode in the new scope, so that the predecessor identifications
+                // of the formula are dropped with it.
+                this->push();
                 formula = pathConditions.encode(top, bottom);
 
-                this->push();
                 llvm::outs() << "    Transforming formula...\n";
                 if (mSettings.dumpFormula) {
                     formula->print(llvm::errs());
@@ -273,7 +405,15 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
 
                 if (status == Solver::SAT) {
                     llvm::outs() << "  Under-approximated formula is SAT.\n";
-                    return this->createFailResult();
+                    if (auto result = this->handleViolation(bound)) {
+                        return result;
+                    }
+
+                    // Block the error code of the recorded violation and look for
+                    // other violations, re-using the current state of the solver.
+                    this->pop();
+                    this->blockErrorCode(mViolations.back().errorCode);
+                    continue;
                 }
 
                 this->pop();
@@ -281,91 +421,104 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
 
             skipUnderApprox = false;
 
-            // If the under-approximated formula was UNSAT, there is no feasible path from start
-            // to the error location which does not involve a call. Find the lowest common dominator
-            // of all calls, and set is as the start location. Similarly, we can calculate the
-            // highest common post-dominator for the error location of all calls to update the
-            // target state. These nodes are the lowest common ancestors (LCA) of the calls in
-            // the (post-)dominator trees.
-            llvm::outs() << "  Attempting to set new starting and target points...\n";
-            auto lca = this->findCommonCallAncestor(top, bottom);
-
-            this->push();
-            if (lca.first != nullptr) {
-                LLVM_DEBUG(llvm::dbgs() << "Found LCA, " << lca.first->getId() << ".\n");
-                assert(lca.second != nullptr);
-
-                mSolver->add(pathConditions.encode(top, lca.first));
-                mSolver->add(pathConditions.encode(lca.second, bottom));
-
-                // Run the solver and check whether top and bottom are consistent -- if not,
-                // we can return that the program is safe as all possible error paths will
-                // encode these program parts.
-                status = this->runSolver();
-    
-                if (status == Solver::UNSAT) {
-                    llvm::outs() << "    Start and target points are inconsitent, no errors are reachable.\n";
-                    return VerificationResult::CreateSuccess();
-                }
-
-            } else {
-                LLVM_DEBUG(llvm::dbgs() << "No calls present, LCA is " << top->getId() << ".\n");
-                lca = { top, bottom };
-            }
-
-            // Now try to over-approximate.
-            llvm::outs() << "  Over-approximating.\n";
+            if (!overApproxDone) {
+                // If the under-approximated formula was UNSAT, there is no feasible path from start
+                // to the error location which does not involve a call. Find the lowest common dominator
+                // of all calls, and set is as the start location. Similarly, we can calculate the
+                // highest common post-dominator for the error location of all calls to update the
+                // target state. These nodes are the lowest common ancestors (LCA) of the calls in
+                // the (post-)dominator trees.
+                llvm::outs() << "  Attempting to set new starting and target points...\n";
+                lca = this->findCommonCallAncestor(top, bottom);
 
-            mOpenCalls.clear();
-            for (auto& callPair : mCalls) {
-                CallTransition* call = callPair.first;
-                CallInfo& info = callPair.second;
+                this->push();
+                if (lca.first != nullptr) {
+                    LLVM_DEBUG(llvm::dbgs() << "Found LCA, " << lca.first->getId() << ".\n");
+                    assert(lca.second != nullptr);
+
+                    this->addToAllSolvers(pathConditions.encode(top, lca.first));
+                    this->addToAllSolvers(pathConditions.encode(lca.second, bottom));
+
+                    // Run the solver and check whether top and bottom are consistent -- if not,
+                    // we can return that the program is safe as all possible error paths will
+                    // encode these program parts.
+                    status = this->runSolver();
+        
+                    if (status == Solver::UNSAT) {
+                        llvm::outs() << "    Start and target points are inconsitent, no errors are reachable.\n";
+                        return this->finishResult(VerificationResult::CreateSuccess());
+                    }
 
-                if (info.getCost() > bound) {
-                    LLVM_DEBUG(
-                        llvm::dbgs() << "  Skipping " << *call
-                        << ": inline cost is greater than bound (" <<
-                        info.getCost() << " > " << bound << ").\n"
-                    );
-                    info.overApprox = mExprBuilder.False();
-                    ++numUnhandledCallSites;
-                    continue;
+                } else {
+                    LLVM_DEBUG(llvm::dbgs() << "No calls present, LCA is " << top->getId() << ".\n");
+                    lca = { top, bottom };
                 }
 
-                info.overApprox = mExprBuilder.True();
-                mOpenCalls.insert(call);
-            }
+                // Now try to over-approximate.
+                llvm::outs() << "  Over-approximating.\n";
+                numUnhandledCallSites = this->approximateCalls(bound);
 
-            this->push();
-
-            llvm::outs() << "    Calculating verification condition...\n";
-            formula = pathConditions.encode(lca.first, lca.second);
-            if (mSettings.dumpFormula) {
-                formula->print(llvm::errs());
-            }
+                this->push();
 
-            llvm::outs() << "    Transforming formula...\n";
-            mSolver->add(formula);
+                llvm::outs() << "    Calculating verification condition...\n";
+                formula = pathConditions.encode(lca.first, lca.second);
+                if (mSettings.dumpFormula) {
+                    formula->print(llvm::errs());
+                }
 
-            if (mSettings.dumpSolver) {
-                mSolver->dump(llvm::errs());
-            }
+                llvm::outs() << "    Transforming formula...\n";
+                mSolver->add(formula);
 
-            status = this->runSolver();
+                if (mSettings.dumpSolver) {
+                    mSolver->dump(llvm::errs());
+                }
 
+                status = this->runSolver();
+            }
             if (status == Solver::SAT) {
                 llvm::outs() << "      Over-approximated formula is SAT.\n";
                 llvm::outs() << "      Checking counterexample...\n";
 
                 // We have a counterexample, but it may be spurious.
-                auto model = mSolver->getModel();
+                auto model = this->getModel(*overSolver);
+
+                llvm::SmallVector<CallTransition*, 16> callsInCex;
+                this->findOpenCallsInCex(model, callsInCex);
+
+                for (CallTransition* call : callsInCex) {
+                    mCexCounts[call->getCalledAutomaton()]++;
+                }
 
-                llvm::SmallVector<CallTransition*, 16> callsToInline;
-                this->findOpenCallsInCex(model, callsToInline);
+                // Calls with the highest priority are inlined first. Calls uncovered
+                // by inlining are ranked along with the ones found in the counterexample.
+                using ScheduledCall = std::pair<double, CallTransition*>;
+                auto compare = [](const ScheduledCall& lhs, const ScheduledCall& rhs) {
+                    return lhs.first < rhs.first;
+                };
+                std::priority_queue<ScheduledCall, std::vector<ScheduledCall>, decltype(compare)>
+                    callsToInline(compare);
+
+                auto schedule = [this, &callsToInline](CallTransition* call) {
+                    double priority = mInliningPolicy.getPriority(this->createInliningCandidate(call));
+                    callsToInline.emplace(priority, call);
+                };
+
+                for (CallTransition* call : callsInCex) {
+                    schedule(call);
+                }
 
                 llvm::outs() << "    Inlining calls...\n";
+                unsigned numInlined = 0;
                 while (!callsToInline.empty()) {
-                    CallTransition* call = callsToInline.pop_back_val();
+                    if (mSettings.inlineTopK != 0 && numInlined == mSettings.inlineTopK) {
+                        // The remaining calls stay open, they will be inlined in a later
+                        // iteration if they occur in a counterexample again.
+                        llvm::outs() << "      Deferring " << callsToInline.size() << " call(s).\n";
+                        break;
+                    }
+
+                    CallTransition* call = callsToInline.top().second;
+                    callsToInline.pop();
                     llvm::outs() << "      Inlining " << call->getSource()->getId() << " --> "
                         << call->getTarget()->getId() << " "
                         << call->getCalledAutomaton()->getName() << "\n";
@@ -377,15 +530,17 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
                     );
                     mCalls.erase(call);
                     mOpenCalls.erase(call);
+                    ++numInlined;
 
                     for (CallTransition* newCall : newCalls) {
                         if (mCalls[newCall].getCost() <= bound) {
-                            callsToInline.push_back(newCall);
+                            schedule(newCall);
                         }
                     }
                 }
 
                 mRoot->clearDisconnectedElements();
+                hasInlinedCalls = true;
 
                 mStats.NumEndLocs = mRoot->getNumLocations();
                 mStats.NumEndLocals = mRoot->getNumLocals();
@@ -404,7 +559,7 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
                     mStats.NumEndLocs = mRoot->getNumLocations();
                     mStats.NumEndLocals = mRoot->getNumLocals();
 
-                    return VerificationResult::CreateSuccess();
+                    return this->finishResult(VerificationResult::CreateSuccess());
                 } else if (bound == mSettings.maxBound) {
                     // The maximum bound was reached.
                     llvm::outs() << "Maximum bound is reached.\n";
@@ -412,10 +567,13 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
                     mStats.NumEndLocs = mRoot->getNumLocations();
                     mStats.NumEndLocals = mRoot->getNumLocals();
 
-                    return VerificationResult::CreateBoundReached();
+                    return this->finishResult(VerificationResult::CreateBoundReached());
                 } else {
                     // Try with an increased bound.
                     llvm::outs() << "    Open call sites still present. Increasing bound.\n";
+                    mExhaustedBound = bound;
+                    mLastRoundTime = mStats.SolverTime - roundStartTime;
+                    mLastNumUnhandledCalls = numUnhandledCallSites;
                     this->pop();
                     top = lca.first;
                     bottom = lca.second;
@@ -427,12 +585,262 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::check()
                     break;
                 }
             } else {
-                llvm_unreachable("Unknown solver status.");
+                // The solver gave up on the over-approximation, we cannot tell
+                // whether its counterexamples are spurious.
+                llvm::outs() << "  Over-approximated formula is UNKNOWN.\n";
+                return this->finishResult(VerificationResult::CreateUnknown());
             }
         }
     }
 
-    return VerificationResult::CreateBoundReached();
+    return this->finishResult(VerificationResult::CreateBoundReached());
+}
+
+unsigned BoundedModelCheckerImpl::approximateCalls(size_t bound)
+{
+    unsigned numUnhandledCallSites = 0;
+
+    mOpenCalls.clear();
+    for (auto& callPair : mCalls) {
+        CallTransition* call = callPair.first;
+        CallInfo& info = callPair.second;
+
+        if (info.getCost() > bound) {
+            LLVM_DEBUG(
+                llvm::dbgs() << "  Skipping " << *call
+                << ": inline cost is greater than bound (" <<
+                info.getCost() << " > " << bound << ").\n"
+            );
+            info.overApprox = mExprBuilder.False();
+            ++numUnhandledCallSites;
+            continue;
+        }
+
+        info.overApprox = mSummaries != nullptr
+            ? mSummaries->getSummaryForCall(call)
+            : mExprBuilder.True();
+        mOpenCalls.insert(call);
+    }
+
+    return numUnhandledCallSites;
+}
+
+std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::handleViolation(size_t bound)
+{
+    if (bound > mExhaustedBound + 1) {
+        // We may have skipped over smaller bounds with a counterexample.
+        this->findMinimalCexBound(bound);
+    } else {
+        mStats.CexBound = bound;
+    }
+
+    if (!mSettings.allErrors) {
+        return this->createFailResult();
+    }
+
+    auto violation = this->createViolation();
+    llvm::outs() << "    Found violation with error code " << violation.errorCode << ".\n";
+    mViolations.push_back(std::move(violation));
+
+    return nullptr;
+}
+
+std::pair<Solver::SolverStatus, Solver::SolverStatus> BoundedModelCheckerImpl::runConcurrently()
+{
+    llvm::outs() << "    Running solvers concurrently...\n";
+    mCubeModel.reset();
+    mTimer.start();
+
+    // Only the solvers are touched by the worker thread, each of them owns
+    // a separate solver context.
+    auto overResult = std::async(std::launch::async, [this]() {
+        return mOverSolver->run();
+    });
+
+    auto underStatus = mSolver->run();
+
+    if (underStatus == Solver::SAT) {
+        // The over-approximation is not needed anymore. The interrupt may arrive before
+        // the query is started, so repeat it until the worker finishes.
+        while (overResult.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+            mOverSolver->interrupt();
+        }
+    }
+
+    // Retrieving the result joins the worker thread, no other threads are
+    // running after this point, thus later queries may be forked safely.
+    auto overStatus = overResult.get();
+    mTimer.stop();
+
+    // Make sure that the interrupt does not cancel the queries of later iterations.
+    mOverSolver->clearInterrupt();
+
+    llvm::outs() << "      Elapsed time: ";
+    mTimer.format(llvm::outs(), "s");
+    llvm::outs() << "\n";
+    mStats.SolverTime += mTimer.elapsed();
+    mStats.NumConcurrentQueries++;
+    if (underStatus == Solver::SAT && overStatus == Solver::UNKNOWN) {
+        mStats.NumCancelledQueries++;
+    }
+
+    return { underStatus, overStatus };
+}
+
+size_t BoundedModelCheckerImpl::getNextBound(size_t bound)
+{
+    size_t step = 1;
+    switch (mSettings.boundStrategy) {
+        case BoundStrategy::Linear:
+            break;
+        case BoundStrategy::Geometric:
+            step = bound;
+            break;
+        case BoundStrategy::Adaptive:
+            if (mLastRoundTime < std::chrono::milliseconds(mSettings.adaptiveRoundTime)) {
+                // Every open call needs at least one more level of inlining, take
+                // a step proportional to their number, at most doubling the bound.
+                step = std::max<size_t>(1, std::min<size_t>(bound, mLastNumUnhandledCalls));
+            }
+            break;
+    }
+
+    if (bound < mSettings.maxBound && bound + step > mSettings.maxBound) {
+        // Make sure that the maximum bound is checked as well.
+        return mSettings.maxBound;
+    }
+
+    return bound + step;
+}
+
+Variable* BoundedModelCheckerImpl::getDepthGate(unsigned cost)
+{
+    while (mDepthGates.size() <= cost) {
+        mDepthGates.push_back(mSystem.getContext().createVariable(
+            "__gazer_bmc_depth" + std::to_string(mDepthGates.size()), BoolType::Get(mSystem.getContext())
+        ));
+    }
+
+    return mDepthGates[cost];
+}
+
+void BoundedModelCheckerImpl::findMinimalCexBound(size_t bound)
+{
+    llvm::outs() << "  Searching for a minimal counterexample between bounds "
+        << mExhaustedBound + 1 << " and " << bound << ".\n";
+
+    // Disables every call inlined with a cost larger than the given bound.
+    auto createAssumptions = [this](size_t limit) {
+        ExprVector assumptions;
+        for (size_t i = limit + 1; i < mDepthGates.size(); ++i) {
+            assumptions.push_back(mExprBuilder.Not(mDepthGates[i]->getRefExpr()));
+        }
+        return assumptions;
+    };
+
+    size_t lo = mExhaustedBound + 1;
+    size_t hi = bound;
+    size_t lastSat = bound;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        mStats.NumBackoffQueries++;
+
+        if (this->runSolver(createAssumptions(mid)) == Solver::SAT) {
+            hi = mid;
+            lastSat = mid;
+        } else {
+            lo = mid + 1;
+            lastSat = 0;
+        }
+    }
+
+    if (lastSat != hi) {
+        // Restore the model of the minimal counterexample.
+        mStats.NumBackoffQueries++;
+        auto status = this->runSolver(createAssumptions(hi));
+        assert(status == Solver::SAT && "The minimal bound must have a counterexample!");
+        (void) status;
+    }
+
+    llvm::outs() << "    Minimal counterexample bound is " << hi << ".\n";
+    mStats.CexBound = hi;
+}
+
+void BoundedModelCheckerImpl::blockErrorCode(unsigned code)
+{
+    ExprRef<LiteralExpr> codeLit;
+    Type& errorFieldType = mErrorFieldVariable->getType();
+    switch (errorFieldType.getTypeID()) {
+        case Type::BvTypeID:
+            codeLit = mExprBuilder.BvLit(code, llvm::cast<BvType>(errorFieldType).getWidth());
+            break;
+        case Type::IntTypeID:
+            codeLit = mExprBuilder.IntLit(code);
+            break;
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+
+    mBlockedErrorCodes.push_back(codeLit);
+
+    // The paths into the error location may already be asserted as a part of the
+    // constraints of earlier start and target points, which are never retracted.
+    this->addToAllSolvers(mExprBuilder.NotEq(mErrorFieldVariable->getRefExpr(), codeLit));
+
+    std::vector<Transition*> errorEdges(mError->incoming_begin(), mError->incoming_end());
+    for (Transition* edge : errorEdges) {
+        auto assign = llvm::cast<AssignTransition>(edge);
+        auto errorAssign = std::find_if(assign->begin(), assign->end(), [this](auto& va) {
+            return va.getVariable() == mErrorFieldVariable;
+        });
+        assert(errorAssign != assign->end() && "Error transitions must assign the error field!");
+
+        ExprPtr guard = mExprBuilder.And(
+            assign->getGuard(), mExprBuilder.NotEq(errorAssign->getValue(), codeLit)
+        );
+
+        // Replace the transition with a guarded one. If the guard is trivially
+        // false, the transition can be simply removed.
+        auto guardLit = llvm::dyn_cast<BoolLiteralExpr>(guard.get());
+        if (guardLit == nullptr || guardLit->getValue()) {
+            std::vector<VariableAssignment> assigns(assign->begin(), assign->end());
+            mRoot->createAssignTransition(assign->getSource(), mError, guard, assigns);
+        }
+
+        mRoot->disconnectEdge(assign);
+    }
+}
+
+ExprPtr BoundedModelCheckerImpl::createErrorGuard(const ExprPtr& guard, const ExprPtr& errorExpr)
+{
+    if (mBlockedErrorCodes.empty()) {
+        return guard;
+    }
+
+    ExprVector ops = { guard };
+    for (auto& code : mBlockedErrorCodes) {
+        ops.push_back(mExprBuilder.NotEq(errorExpr, code));
+    }
+
+    return mExprBuilder.And(ops);
+}
+
+auto BoundedModelCheckerImpl::finishResult(std::unique_ptr<VerificationResult> result)
+    -> std::unique_ptr<VerificationResult>
+{
+    if (mViolations.empty()) {
+        return result;
+    }
+
+    llvm::outs() << "Found " << mViolations.size() << " violated check(s), ";
+    if (result->isSuccess()) {
+        llvm::outs() << "remaining checks are safe.\n";
+    } else {
+        llvm::outs() << "remaining checks are not violated up to the bound.\n";
+    }
+
+    return std::make_unique<FailResult>(std::move(mViolations));
 }
 
 auto BoundedModelCheckerImpl::createLocNumberFunc()
@@ -468,8 +876,7 @@ auto BoundedModelCheckerImpl::findCommonCallAncestor(Location* fwd, Location* bw
 
 void BoundedModelCheckerImpl::findOpenCallsInCex(Valuation& model, llvm::SmallVectorImpl<CallTransition*>& callsInCex)
 {
-    ExprEvaluator eval{model};
-    auto cex = bmc::BmcCex{mError, *mRoot, eval, mPredecessors};
+    auto cex = bmc::BmcCex{mError, model, mPredecessors};
 
     for (auto state : cex) {
         auto call = llvm::dyn_cast_or_null<CallTransition>(state.getOutgoingTransition());
@@ -483,6 +890,65 @@ void BoundedModelCheckerImpl::findOpenCallsInCex(Valuation& model, llvm::SmallVe
     }
 }
 
+InliningCandidate BoundedModelCheckerImpl::createInliningCandidate(CallTransition* call)
+{
+    Cfa* callee = call->getCalledAutomaton();
+
+    InliningCandidate candidate;
+    candidate.call = call;
+    candidate.calleeSize = callee->getNumLocations();
+    candidate.recursionDepth = mCalls[call].getCost();
+    candidate.cexCount = mCexCounts.lookup(callee);
+    candidate.estimatedGrowth = this->estimateGrowth(callee);
+
+    return candidate;
+}
+
+size_t BoundedModelCheckerImpl::estimateGrowth(Cfa* cfa)
+{
+    auto it = mGrowthEstimates.find(cfa);
+    if (it != mGrowthEstimates.end()) {
+        return it->second;
+    }
+
+    // Each transition contributes its guard, each assignment an equality. Nested
+    // calls are counted twice, as they will most likely become open calls.
+    size_t growth = 0;
+    for (auto& edge : cfa->edges()) {
+        growth++;
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge.get())) {
+            growth += assign->getNumAssignments();
+        } else {
+            growth += 2;
+        }
+    }
+
+    mGrowthEstimates[cfa] = growth;
+    return growth;
+}
+
+namespace
+{
+
+class DefaultInliningPolicy : public InliningPolicy
+{
+public:
+    double getPriority(const InliningCandidate& candidate) override
+    {
+        double cost = static_cast<double>(candidate.calleeSize + candidate.estimatedGrowth)
+            * candidate.recursionDepth;
+
+        return (1.0 + candidate.cexCount) / (1.0 + cost);
+    }
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<InliningPolicy> gazer::createDefaultInliningPolicy()
+{
+    return std::make_unique<DefaultInliningPolicy>();
+}
+
 void BoundedModelCheckerImpl::inlineCallIntoRoot(
     CallTransition* call,
     llvm::DenseMap<Variable*, Variable*>& vmap,
@@ -552,15 +1018,19 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
 //        rewrite[output] = call->getOutputArgument(i).getVariable()->getRefExpr();
 //    }
 
+    // The error locations of error-free callees need not be connected to the goal.
+    bool calleeErrorFree = mErrorFreedom != nullptr && mErrorFreedom->isErrorFree(callee);
+
     // Insert the locations
     for (auto& origLoc : callee->nodes()) {
         auto newLoc = mRoot->createLocation();
         locToLocMap[origLoc.get()] = newLoc;
         mInlinedLocations[newLoc] = origLoc.get();
 
-        if (origLoc->isError()) {
-            mRoot->createAssignTransition(newLoc, mError, mExprBuilder.True(), {
-                { mErrorFieldVariable, callee->getErrorFieldExpr(origLoc.get()) }
+        if (origLoc->isError() && !calleeErrorFree) {
+            ExprPtr errorExpr = callee->getErrorFieldExpr(origLoc.get());
+            mRoot->createAssignTransition(newLoc, mError, this->createErrorGuard(mExprBuilder.True(), errorExpr), {
+                { mErrorFieldVariable, errorExpr }
             });
         }
     }
@@ -653,8 +1123,13 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
     //     inputAssigns.push_back(inputAssignment);
     // }
 
+    ExprPtr entryGuard = call->getGuard();
+    if (mSettings.boundStrategy != BoundStrategy::Linear && info.getCost() > mSettings.eagerUnroll) {
+        entryGuard = mExprBuilder.And(entryGuard, this->getDepthGate(info.getCost())->getRefExpr());
+    }
+
     mRoot->createAssignTransition(
-        before, locToLocMap[callee->getEntry()], call->getGuard(), inputAssigns
+        before, locToLocMap[callee->getEntry()], entryGuard, inputAssigns
     );
 
     mRoot->createAssignTransition(
@@ -685,11 +1160,323 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
     mRoot->disconnectEdge(call);
 }
 
-Solver::SolverStatus BoundedModelCheckerImpl::runSolver()
+/// Returns true if this process is known to have a single thread, thus it may be forked safely.
+static bool isSingleThreaded()
+{
+    std::error_code ec;
+    llvm::sys::fs::directory_iterator it("/proc/self/task", ec), ie;
+    if (ec) {
+        // There is no way to tell on this platform. The verifier itself joins
+        // all of its threads before it may fork.
+        return true;
+    }
+
+    unsigned numThreads = 0;
+    for (; it != ie && !ec; it.increment(ec)) {
+        ++numThreads;
+    }
+
+    return !ec && numThreads == 1;
+}
+
+/// Writes \p model to \p os, one variable per line: its value as an unsigned
+/// integer (the IEEE bits of floats), followed by the name of the variable.
+static void writeModel(llvm::raw_ostream& os, const Valuation& model)
+{
+    for (auto& [variable, literal] : model) {
+        llvm::APInt value;
+        if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(literal.get())) {
+            value = llvm::APInt(1, boolLit->getValue());
+        } else if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(literal.get())) {
+            value = llvm::APInt(64, intLit->getValue(), /*isSigned=*/true);
+        } else if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(literal.get())) {
+            value = bvLit->getValue();
+        } else if (auto fltLit = llvm::dyn_cast<FloatLiteralExpr>(literal.get())) {
+            value = fltLit->getValue().bitcastToAPInt();
+        } else {
+            // The solvers do not put other literals into their models.
+            continue;
+        }
+
+        llvm::SmallString<32> str;
+        value.toString(str, 10, /*Signed=*/false);
+        os << str << " " << variable->getName() << "\n";
+    }
+}
+
+/// Reads a model written by writeModel. Returns an empty optional if the
+/// file could not be read or it refers to unknown variables.
+static std::optional<Valuation> readModel(GazerContext& context, llvm::StringRef filename)
+{
+    auto buffer = llvm::MemoryBuffer::getFile(filename);
+    if (!buffer) {
+        return std::nullopt;
+    }
+
+    auto builder = Valuation::CreateBuilder();
+    llvm::SmallVector<llvm::StringRef, 64> lines;
+    (*buffer)->getBuffer().split(lines, '\n', -1, /*KeepEmpty=*/false);
+
+    for (llvm::StringRef line : lines) {
+        auto [valueStr, name] = line.split(' ');
+        Variable* variable = context.getVariable(name);
+        llvm::APInt value;
+        if (variable == nullptr || valueStr.getAsInteger(10, value)) {
+            return std::nullopt;
+        }
+
+        Type& type = variable->getType();
+        ExprRef<LiteralExpr> literal;
+        if (type.isBoolType()) {
+            literal = BoolLiteralExpr::Get(context, value.getBoolValue());
+        } else if (type.isIntType()) {
+            literal = IntLiteralExpr::Get(context, value.zextOrTrunc(64).getSExtValue());
+        } else if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+            literal = BvLiteralExpr::Get(*bvTy, value.zextOrTrunc(bvTy->getWidth()));
+        } else if (auto fltTy = llvm::dyn_cast<FloatType>(&type)) {
+            literal = FloatLiteralExpr::Get(*fltTy, llvm::APFloat(
+                fltTy->getLLVMSemantics(), value.zextOrTrunc(fltTy->getWidth())
+            ));
+        } else {
+            return std::nullopt;
+        }
+
+        builder.put(variable, literal);
+    }
+
+    return builder.build();
+}
+
+Valuation BoundedModelCheckerImpl::getModel(Solver& solver)
+{
+    if (&solver == mSolver.get() && mCubeModel) {
+        return *mCubeModel;
+    }
+
+    return solver.getModel();
+}
+
+Solver::SolverStatus BoundedModelCheckerImpl::runSolver(const ExprVector& assumptions)
 {
+    mCubeModel.reset();
+    if (mSettings.cubeDepth != 0 && assumptions.empty() && isSingleThreaded()) {
+        ExprVector branches = this->findCubeBranches();
+        if (!branches.empty()) {
+            return this->runCubes(branches);
+        }
+    }
+
     llvm::outs() << "    Running solver...\n";
     mTimer.start();
-    auto status = mSolver->run();
+    auto status = assumptions.empty() ? mSolver->run() : mSolver->run(assumptions);
+    mTimer.stop();
+
+    llvm::outs() << "      Elapsed time: ";
+    mTimer.format(llvm::outs(), "s");
+    llvm::outs() << "\n";
+    mStats.SolverTime += mTimer.elapsed();
+
+    return status;
+}
+
+static llvm::StringRef getBoundStrategyName(BoundStrategy strategy)
+{
+    switch (strategy) {
+        case BoundStrategy::Linear: return "linear";
+        case BoundStrategy::Geometric: return "geometric";
+        case BoundStrategy::Adaptive: return "adaptive";
+    }
+
+    llvm_unreachable("Unknown bound strategy!");
+}
+
+ExprVector BoundedModelCheckerImpl::findCubeBranches()
+{
+    // The current scope holds the predecessor identifications of the formula
+    // which was encoded last. Selectors closer to the start of the formula
+    // split the set of paths into more balanced parts.
+    std::vector<std::pair<size_t, const PredecessorSelector*>> selectors;
+    for (auto it = mPredecessors.current_begin(), ie = mPredecessors.current_end(); it != ie; ++it) {
+        if (!it->second.variables.empty()) {
+            selectors.emplace_back(mLocNumbers[it->first], &it->second);
+        }
+    }
+
+    std::sort(selectors.begin(), selectors.end(), [](auto& lhs, auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    // Split on the selector variables themselves: each one-hot bit, or each
+    // used bit of a binary selector, halves the set of predecessors.
+    ExprVector branches;
+    llvm::DenseSet<Variable*> visited;
+    for (auto& [idx, selector] : selectors) {
+        for (Variable* variable : selector->variables) {
+            if (!visited.insert(variable).second) {
+                continue;
+            }
+
+            if (variable->getType().isBoolType()) {
+                branches.push_back(variable->getRefExpr());
+            } else {
+                unsigned width = llvm::Log2_64_Ceil(selector->edges.size());
+                for (unsigned i = width; i > 0 && branches.size() < mSettings.cubeDepth; --i) {
+                    branches.push_back(mExprBuilder.Eq(
+                        mExprBuilder.Extract(variable->getRefExpr(), i - 1, 1),
+                        mExprBuilder.BvLit(1, 1)
+                    ));
+                }
+            }
+
+            if (branches.size() == mSettings.cubeDepth) {
+                return branches;
+            }
+        }
+    }
+
+    return branches;
+}
+
+Solver::SolverStatus BoundedModelCheckerImpl::runCubes(const ExprVector& branches)
+{
+    size_t numCubes = size_t(1) << branches.size();
+
+    std::vector<ExprVector> cubes(numCubes);
+    for (size_t i = 0; i < numCubes; ++i) {
+        for (size_t j = 0; j < branches.size(); ++j) {
+            cubes[i].push_back((i & (size_t(1) << j)) != 0 ? branches[j] : mExprBuilder.Not(branches[j]));
+        }
+    }
+
+    unsigned maxWorkers = mSettings.cubeWorkers;
+    if (maxWorkers == 0) {
+        maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    llvm::outs() << "    Running solver on " << numCubes << " cubes...\n";
+    mTimer.start();
+
+    // Make sure that nothing buffered before the fork gets written twice.
+    llvm::outs().flush();
+    llvm::errs().flush();
+
+    llvm::DenseMap<pid_t, size_t> running;
+    std::vector<Solver::SolverStatus> results(numCubes, Solver::UNKNOWN);
+    std::vector<llvm::SmallString<128>> modelFiles(numCubes);
+
+    auto waitForWorker = [&running, &results]() {
+        // Only reap our own workers: other parts of the process may have
+        // children of their own.
+        while (!running.empty()) {
+            for (auto it = running.begin(), ie = running.end(); it != ie; ++it) {
+                int wstatus;
+                pid_t pid = ::waitpid(it->first, &wstatus, WNOHANG);
+                if (pid == 0) {
+                    continue;
+                }
+
+                if (pid > 0 && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) <= Solver::UNKNOWN) {
+                    results[it->second] = static_cast<Solver::SolverStatus>(WEXITSTATUS(wstatus));
+                }
+                running.erase(it);
+                return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        return false;
+    };
+
+    // The first satisfiable cube, or numCubes if there is none.
+    size_t satCube = numCubes;
+    auto findSatCube = [&results, &satCube]() {
+        auto it = std::find(results.begin(), results.end(), Solver::SAT);
+        satCube = std::distance(results.begin(), it);
+        return it != results.end();
+    };
+
+    for (size_t i = 0; i < numCubes && !findSatCube(); ++i) {
+        while (running.size() >= maxWorkers && waitForWorker()) {
+            // Wait for a free worker slot.
+        }
+
+        if (findSatCube()) {
+            break;
+        }
+
+        if (auto ec = llvm::sys::fs::createTemporaryFile("gazer-cube", "model", modelFiles[i])) {
+            llvm::errs() << "error: could not create cube model file: " << ec.message() << "\n";
+            continue;
+        }
+
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            // The worker inherits the current state of the solver, it only needs its own cube.
+            auto status = mSolver->run(cubes[i]);
+            if (status == Solver::SAT) {
+                std::error_code ec;
+                llvm::raw_fd_ostream os(modelFiles[i], ec);
+                if (ec) {
+                    ::_exit(static_cast<int>(Solver::UNKNOWN));
+                }
+
+                writeModel(os, mSolver->getModel());
+                os.close();
+                if (os.has_error()) {
+                    os.clear_error();
+                    ::_exit(static_cast<int>(Solver::UNKNOWN));
+                }
+            }
+            ::_exit(static_cast<int>(status));
+        }
+
+        if (pid < 0) {
+            llvm::errs() << "error: could not start cube worker.\n";
+            continue;
+        }
+
+        running[pid] = i;
+    }
+
+    while (!running.empty() && !findSatCube() && waitForWorker()) {
+        // Wait for the remaining workers, until one of them finds a model.
+    }
+
+    // Stop the workers which are not needed anymore.
+    for (auto& [pid, idx] : running) {
+        ::kill(pid, SIGKILL);
+    }
+    while (!running.empty() && waitForWorker()) {
+        // Reap the stopped workers.
+    }
+
+    mStats.NumSplitQueries++;
+    mStats.NumCubes += numCubes;
+
+    Solver::SolverStatus status;
+    if (findSatCube()) {
+        status = Solver::SAT;
+        mCubeModel = readModel(mExprBuilder.getContext(), modelFiles[satCube]);
+        if (!mCubeModel) {
+            // This should not happen, but the model may still be obtained in this process.
+            llvm::outs() << "      Could not read the model of the satisfiable cube, solving it again.\n";
+            status = mSolver->run(cubes[satCube]);
+        }
+    } else if (std::all_of(results.begin(), results.end(), [](auto r) { return r == Solver::UNSAT; })) {
+        status = Solver::UNSAT;
+    } else {
+        // Some of the workers did not finish, solve the whole formula here.
+        llvm::outs() << "      Some cubes could not be solved, falling back to a single query.\n";
+        status = mSolver->run();
+    }
+
+    for (auto& file : modelFiles) {
+        if (!file.empty()) {
+            llvm::sys::fs::remove(file);
+        }
+    }
+
     mTimer.stop();
 
     llvm::outs() << "      Elapsed time: ";
@@ -711,6 +1498,32 @@ void BoundedModelCheckerImpl::printStats(llvm::raw_ostream& os)
     os << "Number of locations on finish: " << mStats.NumEndLocs << "\n";
     os << "Number of variables on start: " << mStats.NumBeginLocals << "\n";
     os << "Number of variables on finish: " << mStats.NumEndLocals << "\n";
+    os << "Bound strategy: " << getBoundStrategyName(mSettings.boundStrategy) << "\n";
+    os << "Number of bound iterations: " << mStats.NumRounds << "\n";
+    os << "Final bound: " << mStats.FinalBound << "\n";
+    if (mStats.CexBound != 0) {
+        os << "Counterexample bound: " << mStats.CexBound << "\n";
+    }
+    os << "Number of backoff queries: " << mStats.NumBackoffQueries << "\n";
+    if (mSettings.eliminateDeadAssignments) {
+        os << "Number of dead assignments: " << mStats.NumDeadAssignments << "\n";
+    }
+    if (mSettings.cubeDepth != 0) {
+        os << "Number of split queries: " << mStats.NumSplitQueries << "\n";
+        os << "Number of cubes: " << mStats.NumCubes << "\n";
+    }
+    if (mOverSolver != nullptr) {
+        os << "Number of concurrent queries: " << mStats.NumConcurrentQueries << "\n";
+        os << "Number of cancelled over-approximations: " << mStats.NumCancelledQueries << "\n";
+    }
+    if (mErrorFreedom != nullptr) {
+        os << "Number of error-free procedures: " << mErrorFreedom->getNumErrorFree() << "\n";
+    }
+    if (mSummaries != nullptr) {
+        os << "Number of summarized procedures: " << mSummaries->getNumSummarized() << "\n";
+        os << "Number of summary candidates: " << mSummaries->getNumCandidates() << "\n";
+        os << "Number of summary lemmas: " << mSummaries->getNumLemmas() << "\n";
+    }
     os << "------------------------------\n";
     if (mSettings.printSolverStats) {
         mSolver->printStats(os);
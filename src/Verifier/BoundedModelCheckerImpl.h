@@ -19,10 +19,13 @@
 #define GAZER_SRC_VERIFIER_BOUNDEDMODELCHECKERIMPL_H
 
 #include "gazer/Verifier/BoundedModelChecker.h"
+#include "gazer/Verifier/ErrorFreedom.h"
+#include "gazer/Verifier/ProcedureSummary.h"
 #include "gazer/Core/Expr/ExprEvaluator.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
 #include "gazer/Core/Solver/Solver.h"
 #include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaUtils.h"
 #include "gazer/Trace/Trace.h"
 
 #include "gazer/Support/Stopwatch.h"
@@ -33,13 +36,14 @@
 #include <llvm/ADT/DenseSet.h>
 
 #include <chrono>
+#include <optional>
 
 namespace gazer
 {
 
 namespace bmc
 {
-    using PredecessorMapT = ScopedCache<Location*, std::pair<Variable*, ExprPtr>>;
+    using PredecessorMapT = ScopedCache<Location*, PredecessorSelector>;
 
     class CexState
     {
@@ -90,24 +94,24 @@ namespace bmc
         CexState mState;
     };
 
+    /// A counterexample trace, decoded backwards from a model.
+    ///
+    /// The scopes of the predecessor map are flattened once on construction,
+    /// thus each step of the trace is decoded in constant time by looking up
+    /// the selector variables of a location in the model.
     class BmcCex
     {
         friend class cex_iterator;
     public:
-        BmcCex(Location* start, Cfa& cfa, ExprEvaluator& eval, PredecessorMapT& preds)
-            : mCfa(cfa), mStart(start), mEval(eval), mPredecessors(preds)
-        {
-            assert(start != nullptr);
-        }
+        BmcCex(Location* start, const Valuation& model, PredecessorMapT& preds);
 
         cex_iterator begin() { return cex_iterator(*this, {mStart, nullptr});  }
         cex_iterator end()   { return cex_iterator(*this, {nullptr, nullptr}); }
 
     private:
-        Cfa& mCfa;
         Location* mStart;
-        ExprEvaluator& mEval;
-        PredecessorMapT& mPredecessors;
+        const Valuation& mModel;
+        llvm::DenseMap<Location*, const PredecessorSelector*> mSelectors;
     };
 }
 
@@ -131,6 +135,15 @@ public:
         unsigned NumEndLocs = 0;
         unsigned NumBeginLocals = 0;
         unsigned NumEndLocals = 0;
+        unsigned NumRounds = 0;
+        unsigned NumBackoffQueries = 0;
+        size_t FinalBound = 0;
+        size_t CexBound = 0;
+        unsigned NumConcurrentQueries = 0;
+        unsigned NumCancelledQueries = 0;
+        unsigned NumSplitQueries = 0;
+        unsigned NumCubes = 0;
+        unsigned NumDeadAssignments = 0;
     };
 
     BoundedModelCheckerImpl(
@@ -138,6 +151,7 @@ public:
         ExprBuilder& builder,
         SolverFactory& solverFactory,
         TraceBuilder<Location*, std::vector<VariableAssignment>>& traceBuilder,
+        InliningPolicy& inliningPolicy,
         BmcSettings settings
     );
 
@@ -165,25 +179,110 @@ private:
 
     void findOpenCallsInCex(Valuation& model, llvm::SmallVectorImpl<CallTransition*>& callsInCex);
 
+    InliningCandidate createInliningCandidate(CallTransition* call);
+
+    /// Sets the over-approximation of each call which may be inlined within \p bound.
+    /// Returns the number of calls which exceed the bound.
+    unsigned approximateCalls(size_t bound);
+
+    /// Records a violation found by the under-approximation. Returns the final
+    /// result if the search should stop, nullptr otherwise.
+    std::unique_ptr<VerificationResult> handleViolation(size_t bound);
+
+    /// Runs the under- and over-approximating solvers concurrently. Returns their results,
+    /// in this order. The over-approximation is cancelled if the under-approximation is SAT.
+    std::pair<Solver::SolverStatus, Solver::SolverStatus> runConcurrently();
+
+    /// Estimates the number of terms the body of \p cfa adds to the verification condition.
+    size_t estimateGrowth(Cfa* cfa);
+
     std::unique_ptr<VerificationResult> createFailResult();
 
+    /// Extracts the error code and the counterexample trace from the current solver model.
+    FailResult::Violation createViolation();
+
+    /// Blocks all error transitions which may set the error field to \p code,
+    /// thus excluding the corresponding check from further searches.
+    void blockErrorCode(unsigned code);
+
+    /// Returns \p guard extended with the constraints of previously blocked error codes.
+    ExprPtr createErrorGuard(const ExprPtr& guard, const ExprPtr& errorExpr);
+
+    /// Merges the violations found so far into the final result of the algorithm.
+    std::unique_ptr<VerificationResult> finishResult(std::unique_ptr<VerificationResult> result);
+
     void push() {
         mSolver->push();
+        if (mOverSolver != nullptr) {
+            mOverSolver->push();
+        }
         mPredecessors.push();
     }
 
     void pop() {
         mPredecessors.pop();
+        if (mOverSolver != nullptr) {
+            mOverSolver->pop();
+        }
         mSolver->pop();
     }
 
-    Solver::SolverStatus runSolver();
+    /// Opens a scope in the given solver only, along with the predecessor
+    /// identifications encoded into it.
+    void push(Solver& solver) {
+        solver.push();
+        mPredecessors.push();
+    }
+
+    void pop(Solver& solver) {
+        mPredecessors.pop();
+        solver.pop();
+    }
+
+    /// Adds a constraint which must hold for both the under- and over-approximation.
+    void addToAllSolvers(const ExprPtr& expr) {
+        mSolver->add(expr);
+        if (mOverSolver != nullptr) {
+            mOverSolver->add(expr);
+        }
+    }
+
+    Solver::SolverStatus runSolver(const ExprVector& assumptions = {});
+
+    /// Returns the model of the last satisfiable query of \p solver. Models found
+    /// by cube workers are returned in place of the model of the solver.
+    Valuation getModel(Solver& solver);
+
+    /// Returns conditions over the path selector variables closest to the start
+    /// of the most recently encoded formula, at most cubeDepth of them.
+    ExprVector findCubeBranches();
+
+    /// Solves the current formula by splitting it into cubes over \p branches,
+    /// each solved by a forked worker process. Workers write the model of a
+    /// satisfiable cube into a file, which is read back by this process.
+    /// Must only be called while this process has no other threads.
+    Solver::SolverStatus runCubes(const ExprVector& branches);
+
+    /// Returns the bound of the iteration following the one with \p bound.
+    size_t getNextBound(size_t bound);
+
+    /// Returns the gate variable guarding the calls inlined with \p cost.
+    Variable* getDepthGate(unsigned cost);
+
+    /// Finds the smallest bound between the last exhausted bound and \p bound
+    /// which still has a counterexample. The solver must be in a SAT state,
+    /// and will contain the model of the minimal counterexample on return.
+    void findMinimalCexBound(size_t bound);
 
 private:
     AutomataSystem& mSystem;
     ExprBuilder& mExprBuilder;
     std::unique_ptr<Solver> mSolver;
+
+    /// A separate solver for the over-approximation, if the two queries are run concurrently.
+    std::unique_ptr<Solver> mOverSolver;
     TraceBuilder<Location*, std::vector<VariableAssignment>>& mTraceBuilder;
+    InliningPolicy& mInliningPolicy;
     BmcSettings mSettings;
 
     Cfa* mRoot;
@@ -196,6 +295,14 @@ private:
     std::unordered_map<CallTransition*, CallInfo> mCalls;
     std::unordered_map<Cfa*, std::vector<Location*>> mTopoSortMap;
 
+    /// The number of over-approximated counterexamples each automaton was called in.
+    llvm::DenseMap<Cfa*, unsigned> mCexCounts;
+    llvm::DenseMap<Cfa*, size_t> mGrowthEstimates;
+
+    /// Summaries used to over-approximate open calls, if enabled.
+    std::unique_ptr<ProcedureSummaryCache> mSummaries;
+    std::unique_ptr<ErrorFreedomAnalysis> mErrorFreedom;
+
     bmc::PredecessorMapT mPredecessors;
 
     llvm::DenseMap<Location*, Location*> mInlinedLocations;
@@ -203,9 +310,24 @@ private:
 
     size_t mTmp = 0;
 
+    /// The largest bound which was proven to have no counterexamples.
+    size_t mExhaustedBound = 0;
+    std::chrono::milliseconds mLastRoundTime{0};
+    unsigned mLastNumUnhandledCalls = 0;
+
+    /// Calls inlined with a given cost are guarded by the corresponding gate
+    /// variable, so that the backoff phase may disable them using assumptions.
+    std::vector<Variable*> mDepthGates;
+
     Stats mStats;
     Stopwatch<> mTimer;
     Variable* mErrorFieldVariable = nullptr;
+
+    /// The model of the satisfiable cube of the last query, if it was split.
+    std::optional<Valuation> mCubeModel;
+
+    std::vector<ExprRef<LiteralExpr>> mBlockedErrorCodes;
+    std::vector<FailResult::Violation> mViolations;
 };
 
 std::unique_ptr<Trace> buildBmcTrace(
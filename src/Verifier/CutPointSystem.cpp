@@ -0,0 +1,580 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "CutPointSystem.h"
+
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+
+#include <llvm/ADT/DenseSet.h>
+
+using namespace gazer;
+
+bool CutPointSystem::findCutPoints()
+{
+    llvm::DenseSet<Location*> visited;
+    llvm::DenseSet<Location*> onStack;
+    llvm::DenseSet<Location*> loopHeads;
+
+    // Iterative DFS from the entry: transitions into a location on the DFS stack
+    // are back-edges. Their targets are the loop heads.
+    std::vector<std::pair<Location*, size_t>> stack;
+    std::vector<Location*> discovered;
+
+    Location* entry = mCfa.getEntry();
+    stack.emplace_back(entry, 0);
+    visited.insert(entry);
+    onStack.insert(entry);
+    discovered.push_back(entry);
+
+    while (!stack.empty()) {
+        Location* loc = stack.back().first;
+        size_t idx = stack.back().second++;
+
+        // Error locations are the final states of the transition system.
+        if (loc->isError() || idx >= loc->getNumOutgoing()) {
+            onStack.erase(loc);
+            stack.pop_back();
+            continue;
+        }
+
+        Transition* edge = *std::next(loc->outgoing_begin(), idx);
+        if (edge->isCall()) {
+            return false;
+        }
+
+        mReachableEdges.push_back(edge);
+
+        Location* target = edge->getTarget();
+        if (onStack.count(target) != 0) {
+            loopHeads.insert(target);
+        } else if (visited.insert(target).second) {
+            onStack.insert(target);
+            stack.emplace_back(target, 0);
+            discovered.push_back(target);
+        }
+    }
+
+    // Use the DFS discovery order to keep the numbering deterministic.
+    for (Location* loc : discovered) {
+        if (loc == entry || loopHeads.count(loc) != 0) {
+            mPcValues[loc] = mCutPoints.size();
+            mCutPoints.push_back(loc);
+        }
+    }
+
+    for (auto& error : mCfa.errors()) {
+        if (visited.count(error.first) != 0) {
+            mErrors.push_back(error.first);
+        }
+    }
+
+    // The iteration order of the error map is not deterministic.
+    std::sort(mErrors.begin(), mErrors.end(), [](Location* a, Location* b) {
+        return a->getId() < b->getId();
+    });
+
+    for (size_t i = 0; i < mErrors.size(); ++i) {
+        mPcValues[mErrors[i]] = mCutPoints.size() + i;
+    }
+
+    return true;
+}
+
+bool CutPointSystem::split()
+{
+    auto& ctx = mCfa.getParent().getContext();
+
+    for (Variable& input : mCfa.inputs()) {
+        mVariables.push_back(&input);
+    }
+    for (Variable& local : mCfa.locals()) {
+        mVariables.push_back(&local);
+    }
+
+    // Loop-carried variables are assigned on the transitions entering a cut point.
+    // In SSA form, they may not be assigned anywhere else.
+    llvm::DenseMap<Location*, llvm::SmallVector<Variable*, 4>> carriedVariables;
+    llvm::DenseSet<Variable*> carried;
+    for (Transition* edge : mReachableEdges) {
+        if (!this->isCutPoint(edge->getTarget())) {
+            continue;
+        }
+
+        auto& vars = carriedVariables[edge->getTarget()];
+        for (const VariableAssignment& assign : *llvm::cast<AssignTransition>(edge)) {
+            carried.insert(assign.getVariable());
+            if (std::find(vars.begin(), vars.end(), assign.getVariable()) == vars.end()) {
+                vars.push_back(assign.getVariable());
+            }
+        }
+    }
+
+    for (Transition* edge : mReachableEdges) {
+        if (this->isCutPoint(edge->getTarget())) {
+            continue;
+        }
+
+        for (const VariableAssignment& assign : *llvm::cast<AssignTransition>(edge)) {
+            if (carried.count(assign.getVariable()) != 0) {
+                return false;
+            }
+        }
+    }
+
+    VariableExprRewrite preRewrite(mExprBuilder);
+    for (Variable* variable : mVariables) {
+        Variable* pre = ctx.createVariable(variable->getName() + "_pre", variable->getType());
+        mPreVariables[variable] = pre;
+        if (carried.count(variable) != 0) {
+            preRewrite[variable] = pre->getRefExpr();
+        }
+    }
+
+    // The program counter is a bit-vector wide enough to hold every cut point
+    // and error location value, so it does not introduce integer arithmetic
+    // into bit-vector formulas.
+    mPcWidth = llvm::Log2_64_Ceil(mCutPoints.size() + mErrors.size() + 1);
+    auto& pcTy = BvType::Get(ctx, mPcWidth);
+    mPc = ctx.createVariable("__gazer_pc", pcTy);
+    mPcPre = ctx.createVariable("__gazer_pc_pre", pcTy);
+
+    // Re-create the reachable transitions of the automaton in the loop-free form.
+    std::vector<Transition*> oldEdges;
+    for (auto& edge : mCfa.edges()) {
+        oldEdges.push_back(edge.get());
+    }
+
+    for (Transition* edge : mReachableEdges) {
+        auto assign = llvm::cast<AssignTransition>(edge);
+        Location* target = edge->getTarget();
+
+        std::vector<VariableAssignment> assigns;
+        for (const VariableAssignment& va : *assign) {
+            assigns.emplace_back(va.getVariable(), preRewrite.walk(va.getValue()));
+        }
+
+        auto carriedIt = carriedVariables.find(target);
+        if (carriedIt != carriedVariables.end()) {
+            // Make every loop-carried variable explicitly assigned on each entering transition,
+            // so that X := X assignments omitted on some back-edges are not lost.
+            for (Variable* variable : carriedIt->second) {
+                bool isAssigned = std::any_of(assign->begin(), assign->end(), [variable](auto& va) {
+                    return va.getVariable() == variable;
+                });
+
+                if (!isAssigned) {
+                    assigns.emplace_back(variable, mPreVariables[variable]->getRefExpr());
+                }
+            }
+
+            Location*& end = mCutPointEnds[target];
+            if (end == nullptr) {
+                end = mCfa.createLocation();
+            }
+            target = end;
+        }
+
+        mCfa.createAssignTransition(
+            edge->getSource(), target, preRewrite.walk(edge->getGuard()), assigns
+        );
+    }
+
+    for (Transition* edge : oldEdges) {
+        mCfa.disconnectEdge(edge);
+    }
+    mCfa.clearDisconnectedElements();
+
+    // Calculate a topological sort of the loop-free automaton. As the start
+    // locations of cut points have no incoming transitions, we need a DFS
+    // forest rooted at each of them.
+    llvm::DenseSet<Location*> visited;
+    for (Location* cut : mCutPoints) {
+        if (!visited.insert(cut).second) {
+            continue;
+        }
+
+        std::vector<std::pair<Location*, size_t>> stack;
+        stack.emplace_back(cut, 0);
+
+        while (!stack.empty()) {
+            Location* loc = stack.back().first;
+            size_t idx = stack.back().second++;
+
+            if (idx >= loc->getNumOutgoing()) {
+                mTopo.push_back(loc);
+                stack.pop_back();
+                continue;
+            }
+
+            Location* target = (*std::next(loc->outgoing_begin(), idx))->getTarget();
+            if (visited.insert(target).second) {
+                stack.emplace_back(target, 0);
+            }
+        }
+    }
+
+    std::reverse(mTopo.begin(), mTopo.end());
+    for (size_t i = 0; i < mTopo.size(); ++i) {
+        mLocNumbers[mTopo[i]] = i;
+    }
+
+    return true;
+}
+
+ExprPtr CutPointSystem::encodeTransitionRelation()
+{
+    PathConditionCalculator pathConditions(
+        mTopo,
+        mExprBuilder,
+        [this](Location* loc) {
+            auto it = mLocNumbers.find(loc);
+            assert(it != mLocNumbers.end() && "All locations must be present in the location map!");
+            return it->second;
+        },
+        [](CallTransition* call) -> ExprPtr {
+            llvm_unreachable("Call transitions are not supported in a cut point system!");
+        }
+    );
+
+    // The possible segment targets, along with their program counter values.
+    std::vector<std::pair<Location*, unsigned>> targets;
+    for (Location* cut : mCutPoints) {
+        if (Location* end = mCutPointEnds.lookup(cut)) {
+            targets.emplace_back(end, mPcValues[cut]);
+        }
+    }
+    for (Location* error : mErrors) {
+        targets.emplace_back(error, mPcValues[error]);
+    }
+
+    ExprVector segments;
+    for (Location* cut : mCutPoints) {
+        // Find the locations reachable from this cut point.
+        llvm::DenseSet<Location*> forward;
+        std::vector<Location*> wl = { cut };
+        forward.insert(cut);
+        while (!wl.empty()) {
+            Location* loc = wl.back();
+            wl.pop_back();
+            for (Transition* edge : loc->outgoing()) {
+                if (forward.insert(edge->getTarget()).second) {
+                    wl.push_back(edge->getTarget());
+                }
+            }
+        }
+
+        for (auto& [target, pcValue] : targets) {
+            if (forward.count(target) == 0) {
+                continue;
+            }
+
+            // Collect the variables which may be assigned on a path between cut and target.
+            llvm::DenseSet<Location*> backward;
+            llvm::DenseSet<Variable*> assigned;
+            wl = { target };
+            backward.insert(target);
+            while (!wl.empty()) {
+                Location* loc = wl.back();
+                wl.pop_back();
+                for (Transition* edge : loc->incoming()) {
+                    if (forward.count(edge->getSource()) == 0) {
+                        continue;
+                    }
+
+                    for (const VariableAssignment& va : *llvm::cast<AssignTransition>(edge)) {
+                        assigned.insert(va.getVariable());
+                    }
+
+                    if (backward.insert(edge->getSource()).second) {
+                        wl.push_back(edge->getSource());
+                    }
+                }
+            }
+
+            ExprVector conjuncts = {
+                this->createPcEquals(mPcPre, mPcValues[cut]),
+                this->createPcEquals(mPc, pcValue),
+                pathConditions.encode(cut, target)
+            };
+
+            // Variables which are not assigned on the segment keep their values.
+            for (Variable* variable : mVariables) {
+                if (assigned.count(variable) == 0) {
+                    conjuncts.push_back(mExprBuilder.Eq(
+                        variable->getRefExpr(), mPreVariables[variable]->getRefExpr()
+                    ));
+                }
+            }
+
+            segments.push_back(this->conjunction(conjuncts));
+            mNumSegments++;
+        }
+    }
+
+    return this->disjunction(segments);
+}
+
+ExprPtr CutPointSystem::createPcEquals(Variable* pc, unsigned value)
+{
+    return mExprBuilder.Eq(pc->getRefExpr(), mExprBuilder.BvLit(value, mPcWidth));
+}
+
+ExprPtr CutPointSystem::createIsError(Variable* pc)
+{
+    // Error locations are numbered after the cut points.
+    return mExprBuilder.BvUGtEq(pc->getRefExpr(), mExprBuilder.BvLit(this->getFirstErrorPc(), mPcWidth));
+}
+
+std::optional<unsigned> CutPointSystem::evaluatePc(Variable* pc, Valuation& model)
+{
+    ExprEvaluator eval{model};
+    auto pcLit = llvm::dyn_cast_or_null<BvLiteralExpr>(eval.walk(pc->getRefExpr()).get());
+    if (pcLit == nullptr || pcLit->getValue().getZExtValue() >= mCutPoints.size() + mErrors.size()) {
+        return std::nullopt;
+    }
+
+    return pcLit->getValue().getZExtValue();
+}
+
+CutPointSystem::Frame CutPointSystem::createFrame(const std::string& suffix)
+{
+    auto& ctx = mCfa.getParent().getContext();
+
+    Frame frame;
+    frame.pc = ctx.createVariable(mPc->getName() + suffix, mPc->getType());
+    for (Variable* variable : mVariables) {
+        frame.vars[variable] = ctx.createVariable(variable->getName() + suffix, variable->getType());
+    }
+
+    return frame;
+}
+
+ExprPtr CutPointSystem::instantiate(const ExprPtr& expr, const Frame& pre, const Frame& post)
+{
+    VariableExprRewrite rewrite(mExprBuilder);
+    rewrite[mPcPre] = pre.pc->getRefExpr();
+    rewrite[mPc] = post.pc->getRefExpr();
+    for (Variable* variable : mVariables) {
+        rewrite[mPreVariables[variable]] = pre.vars.lookup(variable)->getRefExpr();
+        rewrite[variable] = post.vars.lookup(variable)->getRefExpr();
+    }
+
+    return rewrite.walk(expr);
+}
+
+ExprPtr CutPointSystem::instantiateState(const ExprPtr& expr, const Frame& frame)
+{
+    VariableExprRewrite rewrite(mExprBuilder);
+    for (Variable* variable : mVariables) {
+        rewrite[variable] = frame.vars.lookup(variable)->getRefExpr();
+    }
+
+    return rewrite.walk(expr);
+}
+
+/// Returns an arbitrary value of a given type. Variables missing from a model
+/// may take any value, we use these for them.
+static ExprRef<LiteralExpr> getDefaultValue(Type& type)
+{
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::False(llvm::cast<BoolType>(type));
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), 0);
+        case Type::BvTypeID: {
+            auto& bvTy = llvm::cast<BvType>(type);
+            return BvLiteralExpr::Get(bvTy, llvm::APInt(bvTy.getWidth(), 0));
+        }
+        case Type::FloatTypeID: {
+            auto& fltTy = llvm::cast<FloatType>(type);
+            return FloatLiteralExpr::Get(fltTy, llvm::APFloat::getZero(fltTy.getLLVMSemantics()));
+        }
+        case Type::RealTypeID:
+            return RealLiteralExpr::Get(llvm::cast<RealType>(type), 0, 1);
+        case Type::ArrayTypeID: {
+            auto& arrTy = llvm::cast<ArrayType>(type);
+            auto elem = getDefaultValue(arrTy.getElementType());
+            return elem != nullptr ? ArrayLiteralExpr::Get(arrTy, {}, elem) : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+bool CutPointSystem::decodePath(
+    llvm::ArrayRef<Frame> frames,
+    Valuation& model,
+    std::vector<Location*>& states,
+    std::vector<std::vector<VariableAssignment>>& actions)
+{
+    assert(!frames.empty() && "A path must contain at least one state!");
+
+    std::vector<Location*> locations;
+    for (const Frame& frame : frames) {
+        std::optional<unsigned> pc = this->evaluatePc(frame.pc, model);
+        if (!pc) {
+            return false;
+        }
+        locations.push_back(this->getLocationForPc(*pc));
+    }
+
+    if (locations.front() != mCfa.getEntry()) {
+        return false;
+    }
+    states.push_back(locations.front());
+
+    for (size_t i = 0; i + 1 < frames.size(); ++i) {
+        // Segments end in the 'end' copy of their target cut point.
+        Location* target = locations[i + 1];
+        if (this->isCutPoint(target)) {
+            target = mCutPointEnds.lookup(target);
+            if (target == nullptr) {
+                return false;
+            }
+        }
+
+        // The 'pre' copies denote the values in the source state. The values of
+        // the variables in the target state are either given by the model, or
+        // calculated along the path.
+        Valuation state;
+        Valuation known;
+        for (Variable* variable : mVariables) {
+            auto pre = model.find(frames[i].vars.lookup(variable));
+            auto post = model.find(frames[i + 1].vars.lookup(variable));
+
+            ExprRef<LiteralExpr> preValue = pre != model.end() ? pre->second : getDefaultValue(variable->getType());
+            if (preValue == nullptr) {
+                return false;
+            }
+            state[mPreVariables[variable]] = preValue;
+
+            if (post != model.end()) {
+                known[variable] = post->second;
+                state[variable] = post->second;
+            } else {
+                state[variable] = preValue;
+            }
+        }
+
+        if (!this->decodeSegment(locations[i], target, state, known, states, actions)) {
+            return false;
+        }
+
+        // Show the cut point instead of its 'end' copy.
+        states.back() = locations[i + 1];
+    }
+
+    return true;
+}
+
+bool CutPointSystem::decodeSegment(
+    Location* loc,
+    Location* target,
+    Valuation& state,
+    Valuation& known,
+    std::vector<Location*>& states,
+    std::vector<std::vector<VariableAssignment>>& actions)
+{
+    if (loc == target) {
+        return true;
+    }
+
+    for (Transition* edge : loc->outgoing()) {
+        ExprEvaluator eval{state};
+        auto guard = llvm::dyn_cast_or_null<BoolLiteralExpr>(eval.walk(edge->getGuard()).get());
+        if (guard == nullptr || !guard->getValue()) {
+            continue;
+        }
+
+        // The assignments of a transition are evaluated over its source state.
+        Valuation next = state;
+        std::vector<VariableAssignment> action;
+        bool consistent = true;
+        for (const VariableAssignment& assign : *llvm::cast<AssignTransition>(edge)) {
+            Variable* variable = assign.getVariable();
+            auto it = known.find(variable);
+
+            ExprRef<LiteralExpr> value;
+            if (llvm::isa<UndefExpr>(assign.getValue())) {
+                value = it != known.end() ? it->second : getDefaultValue(variable->getType());
+            } else {
+                value = eval.walk(assign.getValue());
+            }
+
+            if (value == nullptr || (it != known.end() && it->second != value)) {
+                consistent = false;
+                break;
+            }
+
+            next[variable] = value;
+            action.emplace_back(variable, value);
+        }
+
+        if (!consistent) {
+            continue;
+        }
+
+        states.push_back(edge->getTarget());
+        actions.push_back(std::move(action));
+
+        if (this->decodeSegment(edge->getTarget(), target, next, known, states, actions)) {
+            return true;
+        }
+
+        states.pop_back();
+        actions.pop_back();
+    }
+
+    return false;
+}
+
+unsigned CutPointSystem::extractErrorCode(
+    Location* error, Valuation& model, const std::function<ExprPtr(const ExprPtr&)>& state)
+{
+    ExprEvaluator eval{model};
+    ExprRef<LiteralExpr> errorExpr = eval.walk(state(mCfa.getErrorFieldExpr(error)));
+    assert(errorExpr != nullptr && "The error field must be present in the model as a literal expression!");
+
+    switch (errorExpr->getType().getTypeID()) {
+        case Type::BvTypeID:
+            return llvm::cast<BvLiteralExpr>(errorExpr)->getValue().getLimitedValue();
+        case Type::IntTypeID:
+            return llvm::cast<IntLiteralExpr>(errorExpr)->getValue();
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+}
+
+ExprPtr CutPointSystem::conjunction(const ExprVector& ops)
+{
+    if (ops.empty()) {
+        return mExprBuilder.True();
+    }
+
+    return ops.size() == 1 ? ops[0] : mExprBuilder.And(ops);
+}
+
+ExprPtr CutPointSystem::disjunction(const ExprVector& ops)
+{
+    if (ops.empty()) {
+        return mExprBuilder.False();
+    }
+
+    return ops.size() == 1 ? ops[0] : mExprBuilder.Or(ops);
+}
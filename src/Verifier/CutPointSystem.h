@@ -0,0 +1,195 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// A transition system view of a cyclic automaton, shared by the unbounded
+// engines (k-induction, PDR).
+//
+// A state of this system is a valuation of the program counter (the index
+// of a cut point or an error location) and all variables of the automaton.
+// A transition is a loop-free path from a cut point to another cut point or
+// to an error location.
+//
+// To make segments loop-free, each cut point with incoming transitions is
+// split into two: the original location keeps the outgoing transitions,
+// while a new 'end' location receives all incoming ones. Each segment is
+// then encoded using the path condition calculator, with two copies of the
+// variables: one denoting the values at the source cut point ('pre') and
+// one denoting the values at the target. As the automaton is in SSA form,
+// only variables assigned on the transitions entering a cut point (the
+// loop-carried ones) need to be read from the 'pre' copy.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_SRC_VERIFIER_CUTPOINTSYSTEM_H
+#define GAZER_SRC_VERIFIER_CUTPOINTSYSTEM_H
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Valuation.h"
+
+#include <llvm/ADT/DenseMap.h>
+
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace gazer
+{
+
+class CutPointSystem
+{
+public:
+    /// The copies of the program counter and the variables which denote a
+    /// single state in an unrolling of the transition system.
+    struct Frame
+    {
+        Variable* pc;
+        llvm::DenseMap<Variable*, Variable*> vars;
+    };
+
+public:
+    CutPointSystem(Cfa& cfa, ExprBuilder& builder)
+        : mCfa(cfa), mExprBuilder(builder)
+    {}
+
+    /// Finds the cut points and the reachable error locations of the automaton.
+    /// Returns false if the automaton cannot be handled (e.g. it contains calls).
+    bool findCutPoints();
+
+    /// Splits each cut point into a start and an end location, yielding a
+    /// loop-free automaton. Returns false if the automaton is not in SSA form.
+    /// This modifies the underlying automaton.
+    bool split();
+
+    /// Calculates the transition relation over the 'pre' and current variable copies.
+    ExprPtr encodeTransitionRelation();
+
+    Cfa& getAutomaton() const { return mCfa; }
+
+    llvm::ArrayRef<Location*> cutPoints() const { return mCutPoints; }
+    llvm::ArrayRef<Location*> errors() const { return mErrors; }
+    llvm::ArrayRef<Variable*> variables() const { return mVariables; }
+
+    Variable* getPreVariable(Variable* variable) const { return mPreVariables.lookup(variable); }
+
+    Variable* getPc() const { return mPc; }
+    Variable* getPcPre() const { return mPcPre; }
+
+    /// Returns the program counter value of a cut point or a reachable error location.
+    unsigned getPcValue(Location* loc) const
+    {
+        auto it = mPcValues.find(loc);
+        assert(it != mPcValues.end() && "Only cut points and errors have a program counter value!");
+        return it->second;
+    }
+
+    bool isCutPoint(Location* loc) const
+    {
+        auto it = mPcValues.find(loc);
+        return it != mPcValues.end() && it->second < mCutPoints.size();
+    }
+
+    /// Program counter values greater or equal to this are error locations.
+    unsigned getFirstErrorPc() const { return mCutPoints.size(); }
+
+    /// Returns the location which belongs to a given program counter value.
+    Location* getLocationForPc(unsigned pc) const
+    {
+        assert(pc < mCutPoints.size() + mErrors.size() && "Invalid program counter value!");
+        return pc < mCutPoints.size() ? mCutPoints[pc] : mErrors[pc - mCutPoints.size()];
+    }
+
+    /// Returns the formula stating that a copy \p pc of the program counter equals \p value.
+    ExprPtr createPcEquals(Variable* pc, unsigned value);
+
+    /// Returns the formula stating that a copy \p pc of the program counter is in an error location.
+    ExprPtr createIsError(Variable* pc);
+
+    /// Returns the value of a copy \p pc of the program counter in \p model,
+    /// or an empty optional if it is not a valid program counter value.
+    std::optional<unsigned> evaluatePc(Variable* pc, Valuation& model);
+
+    /// Returns the error code of an error location, evaluated over a state given by \p model.
+    /// The \p state function maps each variable of the automaton to its copy in the model.
+    unsigned extractErrorCode(
+        Location* error, Valuation& model, const std::function<ExprPtr(const ExprPtr&)>& state
+    );
+
+    /// Creates a new copy of the program counter and the variables, named using \p suffix.
+    Frame createFrame(const std::string& suffix);
+
+    /// Instantiates a formula over the 'pre' and current copies for a transition between two frames.
+    ExprPtr instantiate(const ExprPtr& expr, const Frame& pre, const Frame& post);
+
+    /// Instantiates a state formula over the variables of the automaton in a given frame.
+    ExprPtr instantiateState(const ExprPtr& expr, const Frame& frame);
+
+    /// Reconstructs the path of the original automaton which is denoted by the
+    /// consecutive \p frames of an unrolling in \p model. The first frame must be
+    /// in the entry location. The visited locations and the values assigned by the
+    /// transitions are written into \p states and \p actions, as expected by the
+    /// trace builders. Returns false if some segment could not be decoded.
+    bool decodePath(
+        llvm::ArrayRef<Frame> frames,
+        Valuation& model,
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions
+    );
+
+    unsigned getNumSegments() const { return mNumSegments; }
+
+    ExprPtr conjunction(const ExprVector& ops);
+    ExprPtr disjunction(const ExprVector& ops);
+
+private:
+    /// Finds a path from \p loc to \p target on which the guards hold and the
+    /// assignments agree with the values of \p known. The values of the variables
+    /// missing from \p known are calculated along the path in \p state.
+    bool decodeSegment(
+        Location* loc,
+        Location* target,
+        Valuation& state,
+        Valuation& known,
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions
+    );
+
+private:
+    Cfa& mCfa;
+    ExprBuilder& mExprBuilder;
+
+    std::vector<Variable*> mVariables;
+    llvm::DenseMap<Variable*, Variable*> mPreVariables;
+    Variable* mPc = nullptr;
+    Variable* mPcPre = nullptr;
+    unsigned mPcWidth = 0;
+
+    std::vector<Location*> mCutPoints;
+    std::vector<Location*> mErrors;
+    llvm::DenseMap<Location*, unsigned> mPcValues;
+    llvm::DenseMap<Location*, Location*> mCutPointEnds;
+    std::vector<Transition*> mReachableEdges;
+
+    std::vector<Location*> mTopo;
+    llvm::DenseMap<Location*, size_t> mLocNumbers;
+
+    unsigned mNumSegments = 0;
+};
+
+} // end namespace gazer
+
+#endif
@@ -0,0 +1,149 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Recursive procedures are handled by a greatest fixpoint over their strongly
+// connected component in the call graph: each member is assumed error-free,
+// and the ones which fail the check under this assumption are dropped until
+// the rest are consistent. By induction on the depth of the call stack, the
+// remaining procedures cannot reach an error location.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/ErrorFreedom.h"
+#include "gazer/Automaton/CallGraph.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Solver/Solver.h"
+
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/Support/Debug.h>
+
+#define DEBUG_TYPE "ErrorFreedom"
+
+using namespace gazer;
+
+bool ErrorFreedomAnalysis::isErrorFree(Cfa* cfa)
+{
+    if (!mCalculated) {
+        this->calculate();
+    }
+
+    return mErrorFree.count(cfa) != 0;
+}
+
+void ErrorFreedomAnalysis::calculate()
+{
+    mCalculated = true;
+
+    Cfa* main = mSystem.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    CallGraph cg(mSystem);
+
+    // The SCCs are visited in a reverse topological order, thus callees
+    // are always handled before their callers.
+    for (auto it = llvm::scc_begin(cg.lookupNode(main)); !it.isAtEnd(); ++it) {
+        const std::vector<CallGraph::Node*>& scc = *it;
+        for (CallGraph::Node* node : scc) {
+            mErrorFree.insert(node->getCfa());
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (CallGraph::Node* node : scc) {
+                Cfa* cfa = node->getCfa();
+                if (mErrorFree.count(cfa) != 0 && !this->check(cfa)) {
+                    LLVM_DEBUG(llvm::dbgs() << "Could not prove " << cfa->getName() << " error-free.\n");
+                    mErrorFree.erase(cfa);
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+bool ErrorFreedomAnalysis::check(Cfa* cfa)
+{
+    mNumChecked++;
+
+    for (auto& edge : cfa->edges()) {
+        auto call = llvm::dyn_cast<CallTransition>(edge.get());
+        if (call != nullptr && mErrorFree.count(call->getCalledAutomaton()) == 0) {
+            return false;
+        }
+    }
+
+    llvm::SmallVector<Location*, 4> errors;
+    for (auto& loc : cfa->nodes()) {
+        if (loc->isError()) {
+            errors.push_back(loc.get());
+        }
+    }
+
+    if (errors.empty()) {
+        return true;
+    }
+
+    std::vector<Location*> topo;
+    if (!createTopologicalSort(cfa, topo)) {
+        // Proofs for cyclic automata would require loop invariants.
+        return false;
+    }
+
+    llvm::DenseMap<Location*, size_t> locNumbers;
+    for (size_t i = 0; i < topo.size(); ++i) {
+        locNumbers[topo[i]] = i;
+    }
+
+    // The error locations of the callees are unreachable, thus a call
+    // may only return with arbitrary values in its outputs.
+    PathConditionCalculator pathConditions(
+        topo,
+        mExprBuilder,
+        [&locNumbers](Location* loc) {
+            auto it = locNumbers.find(loc);
+            assert(it != locNumbers.end() && "All locations must be present in the location map!");
+            return it->second;
+        },
+        [this](CallTransition*) {
+            return mExprBuilder.True();
+        }
+    );
+
+    auto solver = mSolverFactory.createSolver(mSystem.getContext());
+    size_t entryIdx = locNumbers[cfa->getEntry()];
+
+    for (Location* error : errors) {
+        if (locNumbers[error] < entryIdx) {
+            // Locations placed before the entry are not reachable from it.
+            continue;
+        }
+
+        solver->push();
+        solver->add(pathConditions.encode(cfa->getEntry(), error));
+        auto status = solver->run();
+        solver->pop();
+
+        if (status != Solver::UNSAT) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,874 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// States are stored in a single arena, each taking the same number of 64-bit
+// words. The first 32 bits hold the index of the location; each variable then
+// takes a bit marking whether it has a value yet, followed by the bits of its
+// value. The hash set of visited states only holds the indices of the states
+// in the arena, along with the predecessor of each state and the transition
+// leading to it, which are used to reconstruct counterexamples.
+//
+// A variable read before being assigned may take any value. Such values are
+// chosen when the variable is first read, and are kept afterwards. Undefined
+// values assigned on transitions are enumerated the same way.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/ExplicitState.h"
+#include "CutPointSystem.h"
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <deque>
+#include <unordered_set>
+
+using namespace gazer;
+
+namespace
+{
+
+constexpr uint32_t NoParent = ~0u;
+constexpr unsigned LocationBits = 32;
+constexpr unsigned MaxValueWidth = 64;
+
+uint64_t readBits(const uint64_t* words, unsigned offset, unsigned width)
+{
+    unsigned idx = offset / 64;
+    unsigned shift = offset % 64;
+
+    uint64_t value = words[idx] >> shift;
+    if (shift + width > 64) {
+        value |= words[idx + 1] << (64 - shift);
+    }
+
+    return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+}
+
+void writeBits(uint64_t* words, unsigned offset, unsigned width, uint64_t value)
+{
+    uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+    unsigned idx = offset / 64;
+    unsigned shift = offset % 64;
+
+    value &= mask;
+    words[idx] = (words[idx] & ~(mask << shift)) | (value << shift);
+    if (shift + width > 64) {
+        unsigned written = 64 - shift;
+        words[idx + 1] = (words[idx + 1] & ~(mask >> written)) | (value >> written);
+    }
+}
+
+/// The visited states, stored contiguously.
+class StateSpace
+{
+    struct StateHash
+    {
+        const StateSpace* space;
+
+        size_t operator()(uint32_t idx) const
+        {
+            const uint64_t* state = space->get(idx);
+            return llvm::hash_combine_range(state, state + space->mNumWords);
+        }
+    };
+
+    struct StateEqual
+    {
+        const StateSpace* space;
+
+        bool operator()(uint32_t lhs, uint32_t rhs) const
+        {
+            return std::equal(space->get(lhs), space->get(lhs) + space->mNumWords, space->get(rhs));
+        }
+    };
+
+public:
+    explicit StateSpace(unsigned numWords)
+        : mNumWords(numWords), mIndex(0, StateHash{this}, StateEqual{this})
+    {}
+
+    StateSpace(const StateSpace&) = delete;
+    StateSpace& operator=(const StateSpace&) = delete;
+
+    /// Inserts \p state with the given predecessor information.
+    /// \return The index of the state and whether it was not visited before.
+    std::pair<uint32_t, bool> insert(const std::vector<uint64_t>& state, uint32_t parent, uint32_t edge)
+    {
+        assert(state.size() == mNumWords);
+        uint32_t idx = mParents.size();
+        mWords.insert(mWords.end(), state.begin(), state.end());
+
+        auto result = mIndex.insert(idx);
+        if (!result.second) {
+            mWords.resize(mWords.size() - mNumWords);
+            return { *result.first, false };
+        }
+
+        mParents.push_back(parent);
+        mEdges.push_back(edge);
+
+        return { idx, true };
+    }
+
+    const uint64_t* get(uint32_t idx) const { return &mWords[static_cast<size_t>(idx) * mNumWords]; }
+    uint32_t getParent(uint32_t idx) const { return mParents[idx]; }
+    uint32_t getEdge(uint32_t idx) const { return mEdges[idx]; }
+
+    size_t size() const { return mParents.size(); }
+
+    /// An estimate of the memory needed for a single state.
+    size_t getBytesPerState() const
+    {
+        // Words, predecessor info, and roughly a hash node and bucket.
+        return mNumWords * sizeof(uint64_t) + 2 * sizeof(uint32_t) + 4 * sizeof(void*);
+    }
+
+private:
+    unsigned mNumWords;
+    std::vector<uint64_t> mWords;
+    std::vector<uint32_t> mParents;
+    std::vector<uint32_t> mEdges;
+    std::unordered_set<uint32_t, StateHash, StateEqual> mIndex;
+};
+
+class ExplicitStateImpl
+{
+    /// The position of a variable within the state vector.
+    struct Slot
+    {
+        unsigned offset;
+        unsigned width;
+    };
+
+    struct EdgeInfo
+    {
+        /// The variables which must have a value before taking the transition.
+        std::vector<Variable*> reads;
+        /// True if this transition enters a cut point.
+        bool entersCutPoint = false;
+    };
+
+    class StateEvaluator : public ExprEvaluatorBase
+    {
+    public:
+        StateEvaluator(ExplicitStateImpl& impl, const uint64_t* pre, const uint64_t* current, bool readCarriedFromPre)
+            : mImpl(impl), mPre(pre), mCurrent(current), mReadCarriedFromPre(readCarriedFromPre)
+        {}
+
+    protected:
+        ExprRef<LiteralExpr> getVariableValue(const Variable& variable) override
+        {
+            auto var = const_cast<Variable*>(&variable);
+            bool fromPre = mReadCarriedFromPre && mImpl.mCarried.count(var) != 0;
+
+            return mImpl.getValue(fromPre ? mPre : mCurrent, var);
+        }
+
+    private:
+        ExplicitStateImpl& mImpl;
+        const uint64_t* mPre;
+        const uint64_t* mCurrent;
+        bool mReadCarriedFromPre;
+    };
+
+    struct Stats
+    {
+        std::chrono::milliseconds SearchTime{0};
+        unsigned NumStates = 0;
+        unsigned NumTransitions = 0;
+        unsigned NumStateWords = 0;
+    };
+
+public:
+    ExplicitStateImpl(Cfa& cfa, CfaTraceBuilder& traceBuilder, ExplicitStateSettings settings)
+        : mCfa(cfa), mContext(cfa.getParent().getContext()),
+        mTraceBuilder(traceBuilder), mSettings(settings)
+    {}
+
+    /// Returns nullptr if the automaton could not be checked.
+    std::unique_ptr<VerificationResult> check();
+
+    void printStats(llvm::raw_ostream& os);
+
+private:
+    bool initialize();
+    bool collectVariables(const ExprPtr& root);
+    void addVariable(Variable* variable);
+    void collectReads(const ExprPtr& expr, llvm::DenseSet<Variable*>& reads);
+
+    /// Calculates the successors of the state \p idx through \p edge.
+    /// Returns false if the search must be aborted.
+    bool expand(uint32_t idx, unsigned edge);
+    bool addSuccessor(const std::vector<uint64_t>& state, uint32_t parent, unsigned edge);
+
+    /// Returns the number of values of a nondeterministic variable,
+    /// or zero if the values cannot be enumerated.
+    uint64_t getDomainSize(Variable* variable) const;
+
+    bool isDefined(const uint64_t* state, Variable* variable) const
+    {
+        return readBits(state, mSlots[mVariableIds.lookup(variable)].offset - 1, 1) != 0;
+    }
+
+    unsigned getLocation(const uint64_t* state) const
+    {
+        return static_cast<unsigned>(readBits(state, 0, LocationBits));
+    }
+
+    ExprRef<LiteralExpr> getValue(const uint64_t* state, Variable* variable);
+    void setRawValue(uint64_t* state, Variable* variable, uint64_t value);
+    void setValue(uint64_t* state, Variable* variable, const ExprRef<LiteralExpr>& value);
+
+    unsigned getErrorCode(uint32_t idx);
+    std::unique_ptr<Trace> buildTrace(uint32_t idx);
+    unsigned getPathLength(uint32_t idx) const;
+
+private:
+    Cfa& mCfa;
+    GazerContext& mContext;
+    CfaTraceBuilder& mTraceBuilder;
+    ExplicitStateSettings mSettings;
+
+    std::vector<Location*> mLocations;
+    llvm::DenseMap<Location*, unsigned> mLocationIds;
+    llvm::DenseSet<Location*> mCutPoints;
+
+    std::vector<Variable*> mVariables;
+    llvm::DenseMap<Variable*, unsigned> mVariableIds;
+    std::vector<Slot> mSlots;
+    llvm::DenseSet<Variable*> mCarried;
+
+    std::vector<Transition*> mEdges;
+    llvm::DenseMap<Transition*, unsigned> mEdgeIds;
+    std::vector<EdgeInfo> mEdgeInfos;
+    llvm::DenseSet<Expr*> mVisitedExprs;
+
+    std::unique_ptr<StateSpace> mStates;
+    size_t mMaxStates = 0;
+    std::deque<uint32_t> mWorklist;
+    uint32_t mErrorState = NoParent;
+
+    Stats mStats;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<VerificationResult> ExplicitStateChecker::check(
+    AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+{
+    Cfa* main = system.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    ExplicitStateImpl impl{*main, traceBuilder, mSettings};
+
+    auto result = impl.check();
+
+    impl.printStats(llvm::outs());
+
+    if (result != nullptr) {
+        return result;
+    }
+
+    if (mFallback != nullptr) {
+        llvm::outs() << "Falling back to the symbolic engine.\n";
+        return mFallback->check(system, traceBuilder);
+    }
+
+    return VerificationResult::CreateUnknown();
+}
+
+std::unique_ptr<VerificationResult> ExplicitStateImpl::check()
+{
+    if (!this->initialize()) {
+        return nullptr;
+    }
+
+    mStates = std::make_unique<StateSpace>(mStats.NumStateWords);
+    mMaxStates = std::min<size_t>(
+        (static_cast<size_t>(mSettings.memoryLimit) << 20) / mStates->getBytesPerState(),
+        NoParent
+    );
+
+    Stopwatch<> timer;
+    timer.start();
+
+    std::vector<uint64_t> initial(mStats.NumStateWords, 0);
+    writeBits(initial.data(), 0, LocationBits, mLocationIds[mCfa.getEntry()]);
+    this->addSuccessor(initial, NoParent, 0);
+
+    bool completed = true;
+    while (completed && !mWorklist.empty() && mErrorState == NoParent) {
+        uint32_t idx;
+        if (mSettings.searchOrder == SearchOrder::BreadthFirst) {
+            idx = mWorklist.front();
+            mWorklist.pop_front();
+        } else {
+            idx = mWorklist.back();
+            mWorklist.pop_back();
+        }
+
+        Location* loc = mLocations[this->getLocation(mStates->get(idx))];
+        for (Transition* edge : loc->outgoing()) {
+            completed = this->expand(idx, mEdgeIds[edge]);
+            if (!completed || mErrorState != NoParent) {
+                break;
+            }
+        }
+    }
+
+    timer.stop();
+    mStats.SearchTime = timer.elapsed();
+
+    if (mErrorState != NoParent) {
+        llvm::outs() << "  Found a counterexample of length " << this->getPathLength(mErrorState) << ".\n";
+        unsigned ec = this->getErrorCode(mErrorState);
+        return VerificationResult::CreateFail(ec, this->buildTrace(mErrorState));
+    }
+
+    if (!completed) {
+        return nullptr;
+    }
+
+    llvm::outs() << "  Explored all " << mStats.NumStates << " reachable states.\n";
+    return VerificationResult::CreateSuccess();
+}
+
+static bool isSupportedType(Type& type)
+{
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+        case Type::IntTypeID:
+            return true;
+        case Type::BvTypeID:
+            return llvm::cast<BvType>(type).getWidth() <= MaxValueWidth;
+        default:
+            return false;
+    }
+}
+
+bool ExplicitStateImpl::initialize()
+{
+    auto builder = CreateExprBuilder(mContext);
+    CutPointSystem cutPointSystem(mCfa, *builder);
+    if (!cutPointSystem.findCutPoints()) {
+        llvm::outs() << "Explicit-state checking requires a cyclic main automaton without calls."
+            " Try enabling function inlining and the cyclic loop representation.\n";
+        return false;
+    }
+
+    for (Location* cutPoint : cutPointSystem.cutPoints()) {
+        mCutPoints.insert(cutPoint);
+    }
+
+    for (auto& loc : mCfa.nodes()) {
+        mLocationIds[loc.get()] = mLocations.size();
+        mLocations.push_back(loc.get());
+    }
+
+    for (Variable& input : mCfa.inputs()) {
+        this->addVariable(&input);
+    }
+    for (Variable& local : mCfa.locals()) {
+        this->addVariable(&local);
+    }
+
+    for (auto& edge : mCfa.edges()) {
+        // Calls are only allowed in unreachable parts of the automaton,
+        // as checked by the cut point search.
+        auto assign = llvm::dyn_cast<AssignTransition>(edge.get());
+        if (edge->getSource() == nullptr || assign == nullptr) {
+            continue;
+        }
+
+        bool supported = this->collectVariables(assign->getGuard());
+        for (const VariableAssignment& va : *assign) {
+            if (va.getValue()->getKind() != Expr::Undef) {
+                supported = supported && this->collectVariables(va.getValue());
+            } else if (this->getDomainSize(va.getVariable()) == 0) {
+                llvm::outs() << "Cannot enumerate the nondeterministic values of '"
+                    << va.getVariable()->getName() << "'.\n";
+                return false;
+            }
+        }
+
+        if (!supported) {
+            llvm::outs() << "Explicit-state checking does not support the expressions of transition ";
+            assign->print(llvm::outs());
+            llvm::outs() << "\n";
+            return false;
+        }
+
+        EdgeInfo& info = mEdgeInfos.emplace_back();
+        info.entersCutPoint = mCutPoints.count(assign->getTarget()) != 0;
+
+        mEdgeIds[assign] = mEdges.size();
+        mEdges.push_back(assign);
+
+        if (info.entersCutPoint) {
+            for (const VariableAssignment& va : *assign) {
+                mCarried.insert(va.getVariable());
+            }
+        }
+    }
+
+    for (auto& [location, errorExpr] : mCfa.errors()) {
+        if (!this->collectVariables(errorExpr)) {
+            llvm::outs() << "Explicit-state checking does not support the error code of location "
+                << location->getId() << ".\n";
+            return false;
+        }
+    }
+
+    for (Variable* variable : mVariables) {
+        if (!isSupportedType(variable->getType())) {
+            llvm::outs() << "Explicit-state checking does not support the type of '"
+                << variable->getName() << "'.\n";
+            return false;
+        }
+    }
+
+    // Find the variables which must have a value before taking a transition:
+    // those read by the guard, and those read by an assignment before being
+    // assigned on the same transition. Loop-carried variables are read from
+    // the state before the transitions entering a cut point.
+    for (size_t i = 0; i < mEdges.size(); ++i) {
+        EdgeInfo& info = mEdgeInfos[i];
+        llvm::DenseSet<Variable*> reads;
+        llvm::DenseSet<Variable*> assigned;
+
+        this->collectReads(mEdges[i]->getGuard(), reads);
+        for (const VariableAssignment& va : *llvm::cast<AssignTransition>(mEdges[i])) {
+            if (va.getValue()->getKind() != Expr::Undef) {
+                llvm::DenseSet<Variable*> valueReads;
+                this->collectReads(va.getValue(), valueReads);
+                for (Variable* variable : valueReads) {
+                    if (assigned.count(variable) == 0
+                        || (info.entersCutPoint && mCarried.count(variable) != 0)) {
+                        reads.insert(variable);
+                    }
+                }
+            }
+            assigned.insert(va.getVariable());
+        }
+
+        info.reads.assign(reads.begin(), reads.end());
+        std::sort(info.reads.begin(), info.reads.end(), [this](Variable* a, Variable* b) {
+            return mVariableIds[a] < mVariableIds[b];
+        });
+    }
+
+    // Calculate the layout of the state vector.
+    unsigned offset = LocationBits;
+    for (Variable* variable : mVariables) {
+        Type& type = variable->getType();
+        unsigned width = type.isBoolType() ? 1
+            : type.isBvType() ? llvm::cast<BvType>(type).getWidth()
+            : MaxValueWidth;
+
+        // The first bit marks whether the variable has a value.
+        mSlots.push_back({ offset + 1, width });
+        offset += width + 1;
+    }
+
+    mStats.NumStateWords = (offset + 63) / 64;
+
+    return true;
+}
+
+void ExplicitStateImpl::addVariable(Variable* variable)
+{
+    if (mVariableIds.count(variable) == 0) {
+        mVariableIds[variable] = mVariables.size();
+        mVariables.push_back(variable);
+    }
+}
+
+bool ExplicitStateImpl::collectVariables(const ExprPtr& root)
+{
+    llvm::SmallVector<Expr*, 16> worklist;
+    worklist.push_back(root.get());
+
+    while (!worklist.empty()) {
+        Expr* expr = worklist.pop_back_val();
+        if (!mVisitedExprs.insert(expr).second) {
+            continue;
+        }
+
+        if (!isSupportedType(expr->getType())) {
+            return false;
+        }
+
+        switch (expr->getKind()) {
+            case Expr::Literal:
+                break;
+            case Expr::VarRef:
+                this->addVariable(&llvm::cast<VarRefExpr>(expr)->getVariable());
+                break;
+            case Expr::BvSDiv:
+            case Expr::BvUDiv:
+            case Expr::BvSRem:
+            case Expr::BvURem: {
+                // Division by zero is undefined in the evaluator.
+                auto divisor = llvm::dyn_cast<BvLiteralExpr>(llvm::cast<NonNullaryExpr>(expr)->getOperand(1));
+                if (divisor == nullptr || divisor->getValue().isNullValue()) {
+                    return false;
+                }
+                break;
+            }
+            case Expr::LShr:
+            case Expr::AShr: {
+                auto amount = llvm::dyn_cast<BvLiteralExpr>(llvm::cast<NonNullaryExpr>(expr)->getOperand(1));
+                if (amount == nullptr || amount->getValue().uge(amount->getType().getWidth())) {
+                    return false;
+                }
+                break;
+            }
+            case Expr::Not:
+            case Expr::ZExt:
+            case Expr::SExt:
+            case Expr::Extract:
+            case Expr::Add:
+            case Expr::Sub:
+            case Expr::Mul:
+            case Expr::Shl:
+            case Expr::BvAnd:
+            case Expr::BvOr:
+            case Expr::BvXor:
+            case Expr::And:
+            case Expr::Or:
+            case Expr::Xor:
+            case Expr::Imply:
+            case Expr::Eq:
+            case Expr::NotEq:
+            case Expr::Lt:
+            case Expr::LtEq:
+            case Expr::Gt:
+            case Expr::GtEq:
+            case Expr::BvSLt:
+            case Expr::BvSLtEq:
+            case Expr::BvSGt:
+            case Expr::BvSGtEq:
+            case Expr::BvULt:
+            case Expr::BvULtEq:
+            case Expr::BvUGt:
+            case Expr::BvUGtEq:
+            case Expr::Select:
+                break;
+            default:
+                return false;
+        }
+
+        if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+            for (const ExprPtr& op : nn->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+
+    return true;
+}
+
+void ExplicitStateImpl::collectReads(const ExprPtr& root, llvm::DenseSet<Variable*>& reads)
+{
+    llvm::DenseSet<Expr*> visited;
+    llvm::SmallVector<Expr*, 16> worklist;
+    worklist.push_back(root.get());
+
+    while (!worklist.empty()) {
+        Expr* expr = worklist.pop_back_val();
+        if (!visited.insert(expr).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+            reads.insert(&varRef->getVariable());
+        } else if (auto nn = llvm::dyn_cast<NonNullaryExpr>(expr)) {
+            for (const ExprPtr& op : nn->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+}
+
+uint64_t ExplicitStateImpl::getDomainSize(Variable* variable) const
+{
+    Type& type = variable->getType();
+    if (type.isBoolType()) {
+        return 2;
+    }
+
+    if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+        if (bvTy->getWidth() <= mSettings.maxNondetWidth && bvTy->getWidth() < MaxValueWidth) {
+            return uint64_t(1) << bvTy->getWidth();
+        }
+    }
+
+    return 0;
+}
+
+/// Steps \p values to the next combination of the domains of \p variables.
+/// Returns false after the last combination.
+template<class DomainFn>
+static bool nextCombination(
+    llvm::ArrayRef<Variable*> variables, llvm::MutableArrayRef<uint64_t> values, DomainFn domainSize)
+{
+    for (size_t i = variables.size(); i > 0; --i) {
+        if (++values[i - 1] < domainSize(variables[i - 1])) {
+            return true;
+        }
+        values[i - 1] = 0;
+    }
+
+    return false;
+}
+
+bool ExplicitStateImpl::expand(uint32_t idx, unsigned edgeId)
+{
+    auto edge = llvm::cast<AssignTransition>(mEdges[edgeId]);
+    const EdgeInfo& info = mEdgeInfos[edgeId];
+    auto domainSize = [this](Variable* variable) { return this->getDomainSize(variable); };
+
+    // The arena may grow while adding the successors, thus the state is copied.
+    const uint64_t* source = mStates->get(idx);
+    std::vector<uint64_t> pre(source, source + mStats.NumStateWords);
+
+    // Variables read without a value may take any value of their domain.
+    llvm::SmallVector<Variable*, 4> choices;
+    for (Variable* variable : info.reads) {
+        if (!this->isDefined(pre.data(), variable)) {
+            if (this->getDomainSize(variable) == 0) {
+                llvm::outs() << "  Cannot enumerate the nondeterministic values of '"
+                    << variable->getName() << "'.\n";
+                return false;
+            }
+            choices.push_back(variable);
+        }
+    }
+
+    llvm::SmallVector<Variable*, 4> havocs;
+    for (const VariableAssignment& va : *edge) {
+        if (va.getValue()->getKind() == Expr::Undef) {
+            havocs.push_back(va.getVariable());
+        }
+    }
+
+    llvm::SmallVector<uint64_t, 4> choiceValues(choices.size(), 0);
+    llvm::SmallVector<uint64_t, 4> havocValues(havocs.size(), 0);
+
+    do {
+        for (size_t i = 0; i < choices.size(); ++i) {
+            this->setRawValue(pre.data(), choices[i], choiceValues[i]);
+        }
+
+        StateEvaluator guardEval(*this, pre.data(), pre.data(), false);
+        if (!llvm::cast<BoolLiteralExpr>(guardEval.walk(edge->getGuard()))->getValue()) {
+            continue;
+        }
+
+        do {
+            std::vector<uint64_t> next = pre;
+            StateEvaluator eval(*this, pre.data(), next.data(), info.entersCutPoint);
+
+            size_t havocIdx = 0;
+            for (const VariableAssignment& va : *edge) {
+                if (va.getValue()->getKind() == Expr::Undef) {
+                    this->setRawValue(next.data(), va.getVariable(), havocValues[havocIdx++]);
+                } else {
+                    this->setValue(next.data(), va.getVariable(), eval.walk(va.getValue()));
+                }
+            }
+
+            writeBits(next.data(), 0, LocationBits, mLocationIds[edge->getTarget()]);
+            if (!this->addSuccessor(next, idx, edgeId)) {
+                return false;
+            }
+
+            if (mErrorState != NoParent) {
+                return true;
+            }
+        } while (nextCombination(havocs, havocValues, domainSize));
+    } while (nextCombination(choices, choiceValues, domainSize));
+
+    return true;
+}
+
+bool ExplicitStateImpl::addSuccessor(const std::vector<uint64_t>& state, uint32_t parent, unsigned edge)
+{
+    auto [idx, inserted] = mStates->insert(state, parent, edge);
+    if (parent != NoParent) {
+        ++mStats.NumTransitions;
+    }
+
+    if (!inserted) {
+        return true;
+    }
+
+    if (mStates->size() > mMaxStates) {
+        llvm::outs() << "  The visited states exceed the memory limit of " << mSettings.memoryLimit << " MB.\n";
+        return false;
+    }
+
+    ++mStats.NumStates;
+    if (mLocations[this->getLocation(state.data())]->isError()) {
+        mErrorState = idx;
+        return true;
+    }
+
+    mWorklist.push_back(idx);
+    return true;
+}
+
+ExprRef<LiteralExpr> ExplicitStateImpl::getValue(const uint64_t* state, Variable* variable)
+{
+    assert(this->isDefined(state, variable) && "Reading a variable without a value!");
+
+    const Slot& slot = mSlots[mVariableIds[variable]];
+    uint64_t raw = readBits(state, slot.offset, slot.width);
+
+    Type& type = variable->getType();
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::Get(llvm::cast<BoolType>(type), raw != 0);
+        case Type::BvTypeID:
+            return BvLiteralExpr::Get(llvm::cast<BvType>(type), llvm::APInt(slot.width, raw));
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), static_cast<int64_t>(raw));
+        default:
+            break;
+    }
+
+    llvm_unreachable("Unsupported variable type in explicit-state checking!");
+}
+
+void ExplicitStateImpl::setRawValue(uint64_t* state, Variable* variable, uint64_t value)
+{
+    const Slot& slot = mSlots[mVariableIds[variable]];
+    writeBits(state, slot.offset - 1, 1, 1);
+    writeBits(state, slot.offset, slot.width, value);
+}
+
+void ExplicitStateImpl::setValue(uint64_t* state, Variable* variable, const ExprRef<LiteralExpr>& value)
+{
+    switch (value->getType().getTypeID()) {
+        case Type::BoolTypeID:
+            this->setRawValue(state, variable, llvm::cast<BoolLiteralExpr>(value)->getValue());
+            return;
+        case Type::BvTypeID:
+            this->setRawValue(state, variable, llvm::cast<BvLiteralExpr>(value)->getValue().getZExtValue());
+            return;
+        case Type::IntTypeID:
+            this->setRawValue(state, variable, static_cast<uint64_t>(llvm::cast<IntLiteralExpr>(value)->getValue()));
+            return;
+        default:
+            break;
+    }
+
+    llvm_unreachable("Unsupported variable type in explicit-state checking!");
+}
+
+unsigned ExplicitStateImpl::getErrorCode(uint32_t idx)
+{
+    std::vector<uint64_t> state(mStates->get(idx), mStates->get(idx) + mStats.NumStateWords);
+    ExprPtr errorExpr = mCfa.getErrorFieldExpr(mLocations[this->getLocation(state.data())]);
+
+    // Any value of the variables without one yields a valid error code.
+    llvm::DenseSet<Variable*> reads;
+    this->collectReads(errorExpr, reads);
+    for (Variable* variable : reads) {
+        if (!this->isDefined(state.data(), variable)) {
+            this->setRawValue(state.data(), variable, 0);
+        }
+    }
+
+    StateEvaluator eval(*this, state.data(), state.data(), false);
+    auto ec = eval.walk(errorExpr);
+
+    switch (ec->getType().getTypeID()) {
+        case Type::BvTypeID:
+            return static_cast<unsigned>(llvm::cast<BvLiteralExpr>(ec)->getValue().getLimitedValue());
+        case Type::IntTypeID:
+            return static_cast<unsigned>(llvm::cast<IntLiteralExpr>(ec)->getValue());
+        default:
+            llvm_unreachable("Invalid error field type!");
+    }
+}
+
+unsigned ExplicitStateImpl::getPathLength(uint32_t idx) const
+{
+    unsigned length = 0;
+    for (uint32_t current = mStates->getParent(idx); current != NoParent; current = mStates->getParent(current)) {
+        ++length;
+    }
+
+    return length;
+}
+
+std::unique_ptr<Trace> ExplicitStateImpl::buildTrace(uint32_t idx)
+{
+    if (!mSettings.trace) {
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+
+    for (uint32_t current = idx; current != NoParent; current = mStates->getParent(current)) {
+        const uint64_t* state = mStates->get(current);
+        states.push_back(mLocations[this->getLocation(state)]);
+
+        if (mStates->getParent(current) == NoParent) {
+            break;
+        }
+
+        // The values assigned by the transition are the ones in its target state.
+        std::vector<VariableAssignment> action;
+        for (const VariableAssignment& va : *llvm::cast<AssignTransition>(mEdges[mStates->getEdge(current)])) {
+            action.emplace_back(va.getVariable(), this->getValue(state, va.getVariable()));
+        }
+        actions.push_back(std::move(action));
+    }
+
+    std::reverse(states.begin(), states.end());
+    std::reverse(actions.begin(), actions.end());
+
+    return mTraceBuilder.build(states, actions);
+}
+
+void ExplicitStateImpl::printStats(llvm::raw_ostream& os)
+{
+    if (mStates == nullptr) {
+        return;
+    }
+
+    os << "--------- Statistics ---------\n";
+    os << "Search time: ";
+    llvm::format_provider<std::chrono::milliseconds>::format(mStats.SearchTime, os, "s");
+    os << "\n";
+    os << "Number of states: " << mStats.NumStates << "\n";
+    os << "Number of transitions: " << mStats.NumTransitions << "\n";
+    os << "State size: " << mStats.NumStateWords * sizeof(uint64_t) << " bytes\n";
+    os << "------------------------------\n";
+    os << "\n";
+}
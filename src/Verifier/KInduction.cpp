@@ -0,0 +1,441 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The k-induction engine unrolls the cut point transition system of the
+// cyclic main automaton (see CutPointSystem.h). The base case checks that no
+// error state is reachable in 'bound' steps from the entry, while the
+// inductive step checks that 'bound' consecutive safe states are always
+// followed by a safe state.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/KInduction.h"
+#include "CutPointSystem.h"
+
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/Debug.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+
+#define DEBUG_TYPE "KInduction"
+
+using namespace gazer;
+
+namespace
+{
+
+class KInductionImpl
+{
+    using Frame = CutPointSystem::Frame;
+
+    struct Stats
+    {
+        std::chrono::milliseconds SolverTime{0};
+        unsigned NumCutPoints = 0;
+        unsigned NumSegments = 0;
+        unsigned NumCandidates = 0;
+        unsigned NumInvariants = 0;
+    };
+
+public:
+    KInductionImpl(
+        Cfa& cfa,
+        ExprBuilder& builder,
+        SolverFactory& solverFactory,
+        CfaTraceBuilder& traceBuilder,
+        KInductionSettings settings,
+        const KInductionChecker::InvariantGenerator& invariants
+    ) : mCfa(cfa),
+        mExprBuilder(builder),
+        mSolver(solverFactory.createSolver(cfa.getParent().getContext())),
+        mTraceBuilder(traceBuilder),
+        mSettings(settings),
+        mInvariantGenerator(invariants),
+        mSystem(cfa, builder)
+    {}
+
+    std::unique_ptr<VerificationResult> check();
+
+    void printStats(llvm::raw_ostream& os);
+
+private:
+    /// Discards the candidate invariants which are not inductive.
+    void filterInvariants();
+
+    void createFrame();
+
+    /// Instantiates a transition formula between frame \p frame and its successor.
+    ExprPtr instantiate(const ExprPtr& expr, unsigned frame);
+
+    /// Instantiates a state formula over the variables of the automaton in \p frame.
+    ExprPtr instantiateState(const ExprPtr& expr, unsigned frame);
+
+    ExprPtr createBadState(unsigned frame);
+    ExprPtr createInvariant(unsigned frame);
+    ExprPtr createDistinctStates(unsigned first, unsigned second);
+
+    unsigned extractErrorCode(unsigned frame);
+
+    /// Builds the counterexample trace of a satisfiable base case of length \p bound.
+    std::unique_ptr<Trace> buildTrace(unsigned bound);
+
+    Solver::SolverStatus runSolver();
+
+private:
+    Cfa& mCfa;
+    ExprBuilder& mExprBuilder;
+    std::unique_ptr<Solver> mSolver;
+    CfaTraceBuilder& mTraceBuilder;
+    KInductionSettings mSettings;
+    const KInductionChecker::InvariantGenerator& mInvariantGenerator;
+
+    CutPointSystem mSystem;
+
+    ExprPtr mTransitionRelation;
+    llvm::DenseMap<Location*, ExprVector> mInvariants;
+    std::vector<Frame> mFrames;
+
+    Stats mStats;
+    Stopwatch<> mTimer;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<VerificationResult> KInductionChecker::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+{
+    std::unique_ptr<ExprBuilder> builder;
+
+    if (mSettings.simplifyExpr) {
+        builder = CreateFoldingExprBuilder(system.getContext());
+    } else {
+        builder = CreateExprBuilder(system.getContext());
+    }
+
+    Cfa* main = system.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    KInductionImpl impl{*main, *builder, mSolverFactory, traceBuilder, mSettings, mInvariants};
+
+    auto result = impl.check();
+
+    impl.printStats(llvm::outs());
+
+    return result;
+}
+
+std::unique_ptr<VerificationResult> KInductionImpl::check()
+{
+    if (!mSystem.findCutPoints()) {
+        llvm::errs() << "K-induction requires a cyclic main automaton without calls."
+            " Try enabling function inlining and the cyclic loop representation.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    if (mSystem.errors().empty()) {
+        llvm::outs() << "No error location is reachable.\n";
+        return VerificationResult::CreateSuccess();
+    }
+
+    // Candidate invariants must be queried while the automaton is intact.
+    if (mInvariantGenerator != nullptr) {
+        for (Location* loc : mSystem.cutPoints()) {
+            if (loc == mCfa.getEntry()) {
+                continue;
+            }
+
+            ExprVector candidates = mInvariantGenerator(loc);
+            if (!candidates.empty()) {
+                mStats.NumCandidates += candidates.size();
+                mInvariants[loc] = std::move(candidates);
+            }
+        }
+    }
+
+    if (!mSystem.split()) {
+        llvm::errs() << "K-induction requires an automaton in SSA form.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    mTransitionRelation = mSystem.encodeTransitionRelation();
+    mStats.NumCutPoints = mSystem.cutPoints().size();
+    mStats.NumSegments = mSystem.getNumSegments();
+
+    // Frame 0 is the (arbitrary) first state of the inductive step,
+    // which is the initial state in the base case.
+    this->createFrame();
+    this->createFrame();
+    mSolver->add(this->instantiate(mTransitionRelation, 0));
+
+    if (!mInvariants.empty()) {
+        this->filterInvariants();
+        if (!mInvariants.empty()) {
+            mSolver->add(this->createInvariant(0));
+            mSolver->add(this->createInvariant(1));
+        }
+    }
+
+    ExprPtr init = mSystem.createPcEquals(mFrames[0].pc, mSystem.getPcValue(mCfa.getEntry()));
+
+    for (unsigned bound = 1; bound <= mSettings.maxBound; ++bound) {
+        llvm::outs() << "Bound " << bound << "\n";
+
+        // Base case: there is no counterexample of length 'bound'. Shorter paths were
+        // checked in previous iterations, thus the intermediate states are already
+        // asserted to be safe.
+        llvm::outs() << "  Checking base case...\n";
+        mSolver->push();
+        mSolver->add(init);
+        mSolver->add(this->createBadState(bound));
+        if (mSettings.dumpFormula) {
+            this->createBadState(bound)->print(llvm::errs());
+        }
+
+        auto status = this->runSolver();
+        if (status == Solver::SAT) {
+            llvm::outs() << "  Base case is SAT, found a counterexample of length " << bound << ".\n";
+            unsigned ec = this->extractErrorCode(bound);
+            return VerificationResult::CreateFail(ec, this->buildTrace(bound));
+        }
+        mSolver->pop();
+
+        if (status == Solver::UNKNOWN) {
+            llvm::outs() << "  Solver returned UNKNOWN.\n";
+            return VerificationResult::CreateUnknown();
+        }
+
+        // Inductive step: each path of 'bound' safe states is followed by a safe state.
+        llvm::outs() << "  Checking inductive step...\n";
+        mSolver->push();
+        mSolver->add(this->createBadState(bound));
+
+        status = this->runSolver();
+        mSolver->pop();
+
+        if (status == Solver::UNSAT) {
+            llvm::outs() << "  Inductive step is UNSAT, the property is " << bound << "-inductive.\n";
+            return VerificationResult::CreateSuccess();
+        }
+
+        if (status == Solver::UNKNOWN) {
+            llvm::outs() << "  Solver returned UNKNOWN.\n";
+            return VerificationResult::CreateUnknown();
+        }
+
+        // Extend the unwinding by a new frame.
+        mSolver->add(mExprBuilder.Not(this->createBadState(bound)));
+        this->createFrame();
+        mSolver->add(this->instantiate(mTransitionRelation, bound));
+
+        if (!mInvariants.empty()) {
+            mSolver->add(this->createInvariant(bound + 1));
+        }
+
+        if (mSettings.simplePath) {
+            for (unsigned i = 0; i <= bound; ++i) {
+                mSolver->add(this->createDistinctStates(i, bound + 1));
+            }
+        }
+    }
+
+    return VerificationResult::CreateBoundReached();
+}
+
+void KInductionImpl::filterInvariants()
+{
+    // Houdini-style filtering: check whether the conjunction of the candidates
+    // is inductive with respect to a single step, and drop the candidates which
+    // fail in the counterexample until the remaining set is inductive.
+    // Frame 0 may be the entry location, thus this also checks initiation.
+    llvm::outs() << "Checking " << mStats.NumCandidates << " candidate invariant(s)...\n";
+    while (!mInvariants.empty()) {
+        mSolver->push();
+        mSolver->add(this->createInvariant(0));
+        mSolver->add(mExprBuilder.Not(this->createInvariant(1)));
+
+        auto status = this->runSolver();
+        if (status != Solver::SAT) {
+            mSolver->pop();
+            if (status == Solver::UNKNOWN) {
+                mInvariants.clear();
+            }
+            break;
+        }
+
+        Valuation model = mSolver->getModel();
+        mSolver->pop();
+
+        ExprEvaluator eval{model};
+        std::optional<unsigned> pc = mSystem.evaluatePc(mFrames[1].pc, model);
+        assert(pc && "The program counter must be present in the model!");
+
+        // The program counter selects the loop head whose candidates failed.
+        Location* head = mSystem.getLocationForPc(*pc);
+        ExprVector& candidates = mInvariants[head];
+        size_t numCandidates = candidates.size();
+
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const ExprPtr& candidate) {
+            auto value = llvm::dyn_cast_or_null<BoolLiteralExpr>(
+                eval.walk(this->instantiateState(candidate, 1)).get()
+            );
+            return value != nullptr && !value->getValue();
+        }), candidates.end());
+
+        if (candidates.size() == numCandidates) {
+            // None of the candidates could be evaluated to false, drop all of them to make progress.
+            candidates.clear();
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "Dropped " << numCandidates - candidates.size()
+            << " candidate(s) of location " << head->getId() << ".\n");
+
+        if (candidates.empty()) {
+            mInvariants.erase(head);
+        }
+    }
+
+    for (auto& [head, candidates] : mInvariants) {
+        mStats.NumInvariants += candidates.size();
+    }
+
+    llvm::outs() << "  " << mStats.NumInvariants << " candidate invariant(s) are inductive.\n";
+}
+
+void KInductionImpl::createFrame()
+{
+    mFrames.push_back(mSystem.createFrame("_k" + std::to_string(mFrames.size())));
+}
+
+ExprPtr KInductionImpl::instantiate(const ExprPtr& expr, unsigned frame)
+{
+    assert(frame + 1 < mFrames.size() && "Both frames of a transition must exist!");
+    return mSystem.instantiate(expr, mFrames[frame], mFrames[frame + 1]);
+}
+
+ExprPtr KInductionImpl::instantiateState(const ExprPtr& expr, unsigned frame)
+{
+    return mSystem.instantiateState(expr, mFrames[frame]);
+}
+
+ExprPtr KInductionImpl::createBadState(unsigned frame)
+{
+    return mSystem.createIsError(mFrames[frame].pc);
+}
+
+ExprPtr KInductionImpl::createInvariant(unsigned frame)
+{
+    ExprVector conjuncts;
+    for (auto& [head, candidates] : mInvariants) {
+        ExprVector instances;
+        for (const ExprPtr& candidate : candidates) {
+            instances.push_back(this->instantiateState(candidate, frame));
+        }
+
+        conjuncts.push_back(mExprBuilder.Imply(
+            mSystem.createPcEquals(mFrames[frame].pc, mSystem.getPcValue(head)),
+            mSystem.conjunction(instances)
+        ));
+    }
+
+    return mSystem.conjunction(conjuncts);
+}
+
+ExprPtr KInductionImpl::createDistinctStates(unsigned first, unsigned second)
+{
+    ExprVector disjuncts = {
+        mExprBuilder.NotEq(mFrames[first].pc->getRefExpr(), mFrames[second].pc->getRefExpr())
+    };
+
+    for (Variable* variable : mSystem.variables()) {
+        disjuncts.push_back(mExprBuilder.NotEq(
+            mFrames[first].vars[variable]->getRefExpr(),
+            mFrames[second].vars[variable]->getRefExpr()
+        ));
+    }
+
+    return mSystem.disjunction(disjuncts);
+}
+
+unsigned KInductionImpl::extractErrorCode(unsigned frame)
+{
+    Valuation model = mSolver->getModel();
+
+    std::optional<unsigned> pc = mSystem.evaluatePc(mFrames[frame].pc, model);
+    assert(pc && "The program counter must be present in the model!");
+
+    Location* error = mSystem.getLocationForPc(*pc);
+    return mSystem.extractErrorCode(error, model, [this, frame](const ExprPtr& expr) {
+        return this->instantiateState(expr, frame);
+    });
+}
+
+std::unique_ptr<Trace> KInductionImpl::buildTrace(unsigned bound)
+{
+    if (!mSettings.trace) {
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    // In the base case, the frames 0..bound form a path from the entry.
+    Valuation model = mSolver->getModel();
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+
+    auto frames = llvm::makeArrayRef(mFrames).take_front(bound + 1);
+    if (!mSystem.decodePath(frames, model, states, actions)) {
+        llvm::errs() << "Could not reconstruct the counterexample trace.\n";
+        return nullptr;
+    }
+
+    return mTraceBuilder.build(states, actions);
+}
+
+Solver::SolverStatus KInductionImpl::runSolver()
+{
+    llvm::outs() << "    Running solver...\n";
+    mTimer.start();
+    auto status = mSolver->run();
+    mTimer.stop();
+
+    llvm::outs() << "      Elapsed time: ";
+    mTimer.format(llvm::outs(), "s");
+    llvm::outs() << "\n";
+    mStats.SolverTime += mTimer.elapsed();
+
+    return status;
+}
+
+void KInductionImpl::printStats(llvm::raw_ostream& os)
+{
+    os << "--------- Statistics ---------\n";
+    os << "Total solver time: ";
+    llvm::format_provider<std::chrono::milliseconds>::format(mStats.SolverTime, os, "s");
+    os << "\n";
+    os << "Number of cut points: " << mStats.NumCutPoints << "\n";
+    os << "Number of segments: " << mStats.NumSegments << "\n";
+    os << "Number of candidate invariants: " << mStats.NumCandidates << "\n";
+    os << "Number of inductive invariants: " << mStats.NumInvariants << "\n";
+    os << "------------------------------\n";
+    if (mSettings.printSolverStats) {
+        mSolver->printStats(os);
+    }
+    os << "\n";
+}
@@ -0,0 +1,643 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// An IC3/PDR implementation over the cut point transition system of the
+// cyclic main automaton (see CutPointSystem.h).
+//
+// The transition relation is encoded over the 'pre' and the current copies
+// of the variables, thus states of a frame are asserted over the 'pre'
+// copy, while the cubes we try to block are assumed over the current one.
+// Frame F_0 contains the initial states: every valuation in the entry
+// location. Each frame F_i (i > 0) is a set of lemmas, where a lemma is the
+// negation of a cube (a program counter value and a conjunction of literals)
+// which was proven to be unreachable within i steps. A single solver instance
+// is used for all queries, the lemmas of frame i are guarded by an activation
+// variable, which is passed to the solver as an assumption. As F_i contains
+// F_{i+1}, each lemma is only stored in the last frame it is known to hold.
+//
+// Cubes are generalized using the unsat cores of the relative induction
+// queries, and optionally by trying to drop their literals one by one.
+// Integer values are represented by a pair of inequalities in cubes, so that
+// generalization may yield bounds instead of single values.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/Pdr.h"
+#include "CutPointSystem.h"
+
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/Support/Debug.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <queue>
+
+#define DEBUG_TYPE "Pdr"
+
+using namespace gazer;
+
+namespace
+{
+
+/// A set of states in a single cut point.
+struct Cube
+{
+    unsigned pc = 0;
+
+    /// Literals over the variables of the automaton.
+    ExprVector literals;
+};
+
+struct ProofObligation
+{
+    Cube cube;
+    unsigned level;
+
+    /// The error code of the violation this obligation leads to.
+    unsigned errorCode;
+
+    /// The number of transitions between the cube and the error location.
+    unsigned depth;
+
+    /// The program counter value of the error location.
+    unsigned errorPc;
+
+    /// The index of the obligation whose cube is reachable from this one in a
+    /// single step, or NoSuccessor for the obligation found in the last frame.
+    size_t successor = NoSuccessor;
+
+    static constexpr size_t NoSuccessor = ~static_cast<size_t>(0);
+};
+
+class PdrImpl
+{
+    struct Stats
+    {
+        std::chrono::milliseconds SolverTime{0};
+        unsigned NumCutPoints = 0;
+        unsigned NumSegments = 0;
+        unsigned NumFrames = 0;
+        unsigned NumQueries = 0;
+        unsigned NumObligations = 0;
+        unsigned NumLemmas = 0;
+        unsigned NumPropagated = 0;
+    };
+
+public:
+    PdrImpl(
+        Cfa& cfa,
+        ExprBuilder& builder,
+        SolverFactory& solverFactory,
+        CfaTraceBuilder& traceBuilder,
+        PdrSettings settings
+    ) : mCfa(cfa),
+        mExprBuilder(builder),
+        mSolver(solverFactory.createSolver(cfa.getParent().getContext())),
+        mTraceBuilder(traceBuilder),
+        mSettings(settings),
+        mSystem(cfa, builder),
+        mPreRewrite(builder)
+    {}
+
+    std::unique_ptr<VerificationResult> check();
+
+    void printStats(llvm::raw_ostream& os);
+
+private:
+    /// Appends a new, empty frame to the frame sequence.
+    void createFrame();
+
+    /// Returns the assumptions which enable the lemmas of frame \p level.
+    ExprVector getFrameAssumptions(unsigned level);
+
+    /// Looks for a state in frame \p level which has an error location as its successor.
+    Solver::SolverStatus findBadCube(unsigned level, ProofObligation& obligation);
+
+    /// Blocks a proof obligation in the last frame, along with all of its predecessors.
+    /// Returns SAT if the obligation is reachable from the initial states, the
+    /// chain of obligations from the entry location to \p root is written to \p cex.
+    Solver::SolverStatus block(ProofObligation root, std::vector<ProofObligation>& cex);
+
+    /// Builds a concrete counterexample trace along a chain of obligations.
+    std::unique_ptr<Trace> buildTrace(const std::vector<ProofObligation>& cex);
+
+    /// Checks whether the states of \p cube have no predecessor in frame \p level
+    /// (outside of the cube). If this holds and \p core is not null, it is set
+    /// to a subset of the cube which is also inductive relative to the frame.
+    /// Otherwise, if \p pred is not null, it is set to a predecessor state.
+    Solver::SolverStatus isRelativeInductive(const Cube& cube, unsigned level, Cube* core, Cube* pred);
+
+    /// Generalizes a cube which is inductive relative to frame \p level.
+    Cube generalize(const Cube& cube, unsigned level);
+
+    void addLemma(const Cube& cube, unsigned level);
+
+    /// Pushes the lemmas of each frame forward if they hold in the next frame.
+    /// Returns the index of a frame which became equal to its successor, 0 otherwise.
+    unsigned propagate();
+
+    /// Extracts the 'pre' state of a model as a cube.
+    Cube extractCube(Valuation& model);
+
+    ExprPtr createCubeExpr(const Cube& cube, Variable* pc);
+
+    void printInvariant(unsigned level, llvm::raw_ostream& os);
+
+    Solver::SolverStatus runSolver(const ExprVector& assumptions);
+
+private:
+    Cfa& mCfa;
+    ExprBuilder& mExprBuilder;
+    std::unique_ptr<Solver> mSolver;
+    CfaTraceBuilder& mTraceBuilder;
+    PdrSettings mSettings;
+
+    CutPointSystem mSystem;
+    VariableExprRewrite mPreRewrite;
+    ExprPtr mTransitionRelation;
+
+    /// The activation variables of the frames.
+    std::vector<Variable*> mActivations;
+
+    /// The lemmas which hold in frame i, but are not known to hold in frame i + 1.
+    std::vector<std::vector<Cube>> mLemmas;
+
+    Stats mStats;
+    Stopwatch<> mTimer;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<VerificationResult> PdrChecker::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+{
+    std::unique_ptr<ExprBuilder> builder;
+
+    if (mSettings.simplifyExpr) {
+        builder = CreateFoldingExprBuilder(system.getContext());
+    } else {
+        builder = CreateExprBuilder(system.getContext());
+    }
+
+    Cfa* main = system.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    PdrImpl impl{*main, *builder, mSolverFactory, traceBuilder, mSettings};
+
+    auto result = impl.check();
+
+    impl.printStats(llvm::outs());
+
+    return result;
+}
+
+std::unique_ptr<VerificationResult> PdrImpl::check()
+{
+    if (!mSystem.findCutPoints()) {
+        llvm::errs() << "PDR requires a cyclic main automaton without calls."
+            " Try enabling function inlining and the cyclic loop representation.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    if (mSystem.errors().empty()) {
+        llvm::outs() << "No error location is reachable.\n";
+        return VerificationResult::CreateSuccess();
+    }
+
+    if (!mSystem.split()) {
+        llvm::errs() << "PDR requires an automaton in SSA form.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    mTransitionRelation = mSystem.encodeTransitionRelation();
+    mSolver->add(mTransitionRelation);
+    mStats.NumCutPoints = mSystem.cutPoints().size();
+    mStats.NumSegments = mSystem.getNumSegments();
+
+    for (Variable* variable : mSystem.variables()) {
+        mPreRewrite[variable] = mSystem.getPreVariable(variable)->getRefExpr();
+    }
+    mPreRewrite[mSystem.getPc()] = mSystem.getPcPre()->getRefExpr();
+
+    this->createFrame();
+    this->createFrame();
+
+    for (unsigned level = 1; level <= mSettings.maxFrames; ++level) {
+        llvm::outs() << "Frame " << level << "\n";
+
+        // Block all states of the last frame which have an error successor.
+        while (true) {
+            ProofObligation obligation;
+            auto status = this->findBadCube(level, obligation);
+            if (status == Solver::UNSAT) {
+                break;
+            }
+
+            if (status == Solver::SAT) {
+                std::vector<ProofObligation> cex;
+                status = this->block(obligation, cex);
+
+                if (status == Solver::SAT) {
+                    llvm::outs() << "  Found a counterexample of length " << cex.front().depth << ".\n";
+                    return VerificationResult::CreateFail(cex.front().errorCode, this->buildTrace(cex));
+                }
+            }
+
+            if (status == Solver::UNKNOWN) {
+                llvm::outs() << "  Solver returned UNKNOWN.\n";
+                return VerificationResult::CreateUnknown();
+            }
+        }
+
+        this->createFrame();
+
+        unsigned fixpoint = this->propagate();
+        if (fixpoint != 0) {
+            llvm::outs() << "  Frame " << fixpoint << " is inductive, the program is safe.\n";
+            if (mSettings.dumpInvariant) {
+                this->printInvariant(fixpoint, llvm::outs());
+            }
+            return VerificationResult::CreateSuccess();
+        }
+    }
+
+    return VerificationResult::CreateBoundReached();
+}
+
+void PdrImpl::createFrame()
+{
+    auto& ctx = mCfa.getParent().getContext();
+    unsigned idx = mActivations.size();
+
+    Variable* activation = ctx.createVariable(
+        "__gazer_pdr_frame" + std::to_string(idx), BoolType::Get(ctx)
+    );
+    mActivations.push_back(activation);
+    mLemmas.emplace_back();
+
+    if (idx == 0) {
+        // The initial frame contains all states in the entry location.
+        mSolver->add(mExprBuilder.Imply(
+            activation->getRefExpr(),
+            mSystem.createPcEquals(mSystem.getPcPre(), mSystem.getPcValue(mCfa.getEntry()))
+        ));
+    } else {
+        mStats.NumFrames++;
+    }
+}
+
+ExprVector PdrImpl::getFrameAssumptions(unsigned level)
+{
+    if (level == 0) {
+        return { mActivations[0]->getRefExpr() };
+    }
+
+    ExprVector assumptions;
+    for (unsigned i = level; i < mActivations.size(); ++i) {
+        assumptions.push_back(mActivations[i]->getRefExpr());
+    }
+
+    return assumptions;
+}
+
+Solver::SolverStatus PdrImpl::findBadCube(unsigned level, ProofObligation& obligation)
+{
+    ExprVector assumptions = this->getFrameAssumptions(level);
+    assumptions.push_back(mSystem.createIsError(mSystem.getPc()));
+
+    auto status = this->runSolver(assumptions);
+    if (status != Solver::SAT) {
+        return status;
+    }
+
+    Valuation model = mSolver->getModel();
+
+    std::optional<unsigned> pc = mSystem.evaluatePc(mSystem.getPc(), model);
+    assert(pc && "The program counter must be present in the model!");
+
+    Location* error = mSystem.getLocationForPc(*pc);
+
+    obligation.cube = this->extractCube(model);
+    obligation.level = level;
+    obligation.errorCode = mSystem.extractErrorCode(error, model, [](const ExprPtr& expr) {
+        return expr;
+    });
+    obligation.depth = 1;
+    obligation.errorPc = *pc;
+    mStats.NumObligations++;
+
+    return status;
+}
+
+Solver::SolverStatus PdrImpl::block(ProofObligation root, std::vector<ProofObligation>& cex)
+{
+    unsigned top = mActivations.size() - 1;
+    unsigned entryPc = mSystem.getPcValue(mCfa.getEntry());
+
+    // Obligations in lower frames are handled first, newer ones first
+    // among obligations of the same frame.
+    std::vector<ProofObligation> obligations = { std::move(root) };
+    auto compare = [&obligations](size_t lhs, size_t rhs) {
+        if (obligations[lhs].level != obligations[rhs].level) {
+            return obligations[lhs].level > obligations[rhs].level;
+        }
+
+        return lhs < rhs;
+    };
+
+    std::priority_queue<size_t, std::vector<size_t>, decltype(compare)> queue(compare);
+    queue.push(0);
+
+    while (!queue.empty()) {
+        ProofObligation obligation = obligations[queue.top()];
+
+        // Every state of the entry location is an initial state.
+        if (obligation.cube.pc == entryPc) {
+            cex.push_back(obligation);
+            for (size_t i = obligation.successor; i != ProofObligation::NoSuccessor; i = obligations[i].successor) {
+                cex.push_back(obligations[i]);
+            }
+            return Solver::SAT;
+        }
+
+        assert(obligation.level > 0 && "The initial frame only contains entry states!");
+
+        Cube core;
+        Cube pred;
+        auto status = this->isRelativeInductive(obligation.cube, obligation.level - 1, &core, &pred);
+        if (status == Solver::UNKNOWN) {
+            return status;
+        }
+
+        if (status == Solver::SAT) {
+            obligations.push_back({
+                std::move(pred), obligation.level - 1, obligation.errorCode, obligation.depth + 1,
+                obligation.errorPc, queue.top()
+            });
+            queue.push(obligations.size() - 1);
+            mStats.NumObligations++;
+            continue;
+        }
+
+        queue.pop();
+        this->addLemma(this->generalize(core, obligation.level), obligation.level);
+
+        // The cube may still be reachable in later frames.
+        if (obligation.level < top) {
+            obligation.level++;
+            obligations.push_back(std::move(obligation));
+            queue.push(obligations.size() - 1);
+        }
+    }
+
+    return Solver::UNSAT;
+}
+
+std::unique_ptr<Trace> PdrImpl::buildTrace(const std::vector<ProofObligation>& cex)
+{
+    if (!mSettings.trace) {
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    // The cubes of the obligations may leave some variables unconstrained, thus
+    // we look for a concrete path by unrolling the transition relation along
+    // the chain, constraining each state to the cube of its obligation.
+    std::vector<CutPointSystem::Frame> frames;
+    for (size_t i = 0; i <= cex.size(); ++i) {
+        frames.push_back(mSystem.createFrame("_cex" + std::to_string(i)));
+    }
+
+    mSolver->push();
+    for (size_t i = 0; i < cex.size(); ++i) {
+        mSolver->add(mSystem.instantiate(mTransitionRelation, frames[i], frames[i + 1]));
+        mSolver->add(mSystem.createPcEquals(frames[i].pc, cex[i].cube.pc));
+        for (const ExprPtr& literal : cex[i].cube.literals) {
+            mSolver->add(mSystem.instantiateState(literal, frames[i]));
+        }
+    }
+    mSolver->add(mSystem.createPcEquals(frames.back().pc, cex.back().errorPc));
+
+    std::unique_ptr<Trace> trace = nullptr;
+    if (this->runSolver({}) == Solver::SAT) {
+        Valuation model = mSolver->getModel();
+        std::vector<Location*> states;
+        std::vector<std::vector<VariableAssignment>> actions;
+
+        if (mSystem.decodePath(frames, model, states, actions)) {
+            trace = mTraceBuilder.build(states, actions);
+        }
+    }
+    mSolver->pop();
+
+    if (trace == nullptr) {
+        llvm::errs() << "Could not reconstruct the counterexample trace.\n";
+    }
+
+    return trace;
+}
+
+Solver::SolverStatus PdrImpl::isRelativeInductive(const Cube& cube, unsigned level, Cube* core, Cube* pred)
+{
+    mSolver->push();
+    mSolver->add(mExprBuilder.Not(mPreRewrite.walk(this->createCubeExpr(cube, mSystem.getPc()))));
+
+    ExprVector assumptions = this->getFrameAssumptions(level);
+    assumptions.push_back(mSystem.createPcEquals(mSystem.getPc(), cube.pc));
+    assumptions.insert(assumptions.end(), cube.literals.begin(), cube.literals.end());
+
+    auto status = this->runSolver(assumptions);
+
+    if (status == Solver::UNSAT && core != nullptr) {
+        ExprVector unsatCore = mSolver->getUnsatCore();
+        core->pc = cube.pc;
+        core->literals.clear();
+        for (const ExprPtr& literal : cube.literals) {
+            if (std::find(unsatCore.begin(), unsatCore.end(), literal) != unsatCore.end()) {
+                core->literals.push_back(literal);
+            }
+        }
+    } else if (status == Solver::SAT && pred != nullptr) {
+        Valuation model = mSolver->getModel();
+        *pred = this->extractCube(model);
+    }
+
+    mSolver->pop();
+
+    return status;
+}
+
+Cube PdrImpl::generalize(const Cube& cube, unsigned level)
+{
+    Cube result = cube;
+    if (!mSettings.dropLiterals) {
+        return result;
+    }
+
+    // The program counter is never dropped, thus the generalized cube is
+    // never in the entry location and cannot contain initial states.
+    for (size_t i = 0; i < result.literals.size();) {
+        Cube candidate = result;
+        candidate.literals.erase(candidate.literals.begin() + i);
+
+        Cube core;
+        if (this->isRelativeInductive(candidate, level - 1, &core, nullptr) == Solver::UNSAT) {
+            result = std::move(core);
+        } else {
+            ++i;
+        }
+    }
+
+    return result;
+}
+
+void PdrImpl::addLemma(const Cube& cube, unsigned level)
+{
+    LLVM_DEBUG(
+        llvm::dbgs() << "Adding lemma to frame " << level << ": ";
+        mExprBuilder.Not(this->createCubeExpr(cube, mSystem.getPc()))->print(llvm::dbgs());
+        llvm::dbgs() << "\n";
+    );
+
+    mSolver->add(mExprBuilder.Imply(
+        mActivations[level]->getRefExpr(),
+        mExprBuilder.Not(mPreRewrite.walk(this->createCubeExpr(cube, mSystem.getPc())))
+    ));
+    mLemmas[level].push_back(cube);
+    mStats.NumLemmas++;
+}
+
+unsigned PdrImpl::propagate()
+{
+    unsigned top = mActivations.size() - 1;
+
+    for (unsigned level = 1; level < top; ++level) {
+        std::vector<Cube> lemmas = std::move(mLemmas[level]);
+        mLemmas[level].clear();
+
+        for (Cube& lemma : lemmas) {
+            // As the lemma is part of the frame, this is just F_i & T & c'.
+            if (this->isRelativeInductive(lemma, level, nullptr, nullptr) == Solver::UNSAT) {
+                this->addLemma(lemma, level + 1);
+                mStats.NumPropagated++;
+            } else {
+                mLemmas[level].push_back(std::move(lemma));
+            }
+        }
+
+        if (mLemmas[level].empty()) {
+            return level;
+        }
+    }
+
+    return 0;
+}
+
+Cube PdrImpl::extractCube(Valuation& model)
+{
+    std::optional<unsigned> pc = mSystem.evaluatePc(mSystem.getPcPre(), model);
+    assert(pc && "The program counter must be present in the model!");
+
+    Cube cube;
+    cube.pc = *pc;
+
+    for (Variable* variable : mSystem.variables()) {
+        auto it = model.find(mSystem.getPreVariable(variable));
+        if (it == model.end()) {
+            // The value of this variable does not matter.
+            continue;
+        }
+
+        ExprPtr ref = variable->getRefExpr();
+        ExprPtr value = it->second;
+
+        switch (variable->getType().getTypeID()) {
+            case Type::BoolTypeID:
+                cube.literals.push_back(
+                    llvm::cast<BoolLiteralExpr>(value)->getValue() ? ref : mExprBuilder.Not(ref)
+                );
+                break;
+            case Type::IntTypeID:
+                cube.literals.push_back(mExprBuilder.GtEq(ref, value));
+                cube.literals.push_back(mExprBuilder.LtEq(ref, value));
+                break;
+            case Type::BvTypeID:
+                cube.literals.push_back(mExprBuilder.BvSGtEq(ref, value));
+                cube.literals.push_back(mExprBuilder.BvSLtEq(ref, value));
+                break;
+            default:
+                cube.literals.push_back(mExprBuilder.Eq(ref, value));
+                break;
+        }
+    }
+
+    return cube;
+}
+
+ExprPtr PdrImpl::createCubeExpr(const Cube& cube, Variable* pc)
+{
+    ExprVector conjuncts = { mSystem.createPcEquals(pc, cube.pc) };
+    conjuncts.insert(conjuncts.end(), cube.literals.begin(), cube.literals.end());
+
+    return mSystem.conjunction(conjuncts);
+}
+
+void PdrImpl::printInvariant(unsigned level, llvm::raw_ostream& os)
+{
+    os << "Inductive invariant:\n";
+    for (unsigned i = level + 1; i < mLemmas.size(); ++i) {
+        for (const Cube& lemma : mLemmas[i]) {
+            os << "  at location " << mSystem.getLocationForPc(lemma.pc)->getId() << ": ";
+            mExprBuilder.Not(mSystem.conjunction(lemma.literals))->print(os);
+            os << "\n";
+        }
+    }
+}
+
+Solver::SolverStatus PdrImpl::runSolver(const ExprVector& assumptions)
+{
+    mTimer.start();
+    auto status = mSolver->run(assumptions);
+    mTimer.stop();
+
+    mStats.SolverTime += mTimer.elapsed();
+    mStats.NumQueries++;
+
+    return status;
+}
+
+void PdrImpl::printStats(llvm::raw_ostream& os)
+{
+    os << "--------- Statistics ---------\n";
+    os << "Total solver time: ";
+    llvm::format_provider<std::chrono::milliseconds>::format(mStats.SolverTime, os, "s");
+    os << "\n";
+    os << "Number of cut points: " << mStats.NumCutPoints << "\n";
+    os << "Number of segments: " << mStats.NumSegments << "\n";
+    os << "Number of frames: " << mStats.NumFrames << "\n";
+    os << "Number of solver queries: " << mStats.NumQueries << "\n";
+    os << "Number of proof obligations: " << mStats.NumObligations << "\n";
+    os << "Number of lemmas: " << mStats.NumLemmas << "\n";
+    os << "Number of propagated lemmas: " << mStats.NumPropagated << "\n";
+    os << "------------------------------\n";
+    if (mSettings.printSolverStats) {
+        mSolver->printStats(os);
+    }
+    os << "\n";
+}
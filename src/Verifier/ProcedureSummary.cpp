@@ -0,0 +1,283 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The summaries are only valid for executions which reach the exit location
+// of a procedure. As errors are propagated to the callers through the error
+// field outputs, this is exactly what the over-approximation of a call needs.
+//
+// The fixpoint is sound for recursive procedures (including the recursive
+// loop representation): if the candidates of every procedure hold for its
+// body while assuming them for each call inside it, then by induction on the
+// depth of the call stack, they hold for every terminating execution.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/ProcedureSummary.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Solver/Solver.h"
+
+#include <llvm/Support/Debug.h>
+
+#define DEBUG_TYPE "ProcedureSummary"
+
+using namespace gazer;
+
+ExprPtr ProcedureSummaryCache::getSummary(Cfa* cfa)
+{
+    if (!mCalculated) {
+        this->calculate();
+    }
+
+    if (mNoReturn.count(cfa) != 0) {
+        return mExprBuilder.False();
+    }
+
+    auto it = mCandidates.find(cfa);
+    if (it == mCandidates.end()) {
+        return mExprBuilder.True();
+    }
+
+    return this->conjunction(it->second);
+}
+
+ExprPtr ProcedureSummaryCache::getSummaryForCall(CallTransition* call)
+{
+    Cfa* callee = call->getCalledAutomaton();
+    ExprPtr summary = this->getSummary(callee);
+
+    if (llvm::isa<BoolLiteralExpr>(summary)) {
+        return summary;
+    }
+
+    VariableExprRewrite rewrite(mExprBuilder);
+    for (Variable& input : callee->inputs()) {
+        if (callee->isOutput(&input)) {
+            continue;
+        }
+
+        auto arg = call->getInputArgument(input);
+        assert(arg.has_value() && "Each callee input must have an argument in a call transition!");
+        rewrite[&input] = arg->getValue();
+    }
+
+    for (Variable& output : callee->outputs()) {
+        auto arg = call->getOutputArgument(output);
+        assert(arg.has_value() && "Every callee output should be assigned in a call transition!");
+        rewrite[&output] = arg->getVariable()->getRefExpr();
+    }
+
+    return rewrite.walk(summary);
+}
+
+void ProcedureSummaryCache::calculate()
+{
+    mCalculated = true;
+
+    Cfa* main = mSystem.getMainAutomaton();
+    for (Cfa& cfa : mSystem) {
+        if (&cfa == main) {
+            continue;
+        }
+
+        std::vector<Location*> topo;
+        if (!createTopologicalSort(&cfa, topo)) {
+            // Summaries of cyclic automata would require loop invariants.
+            LLVM_DEBUG(llvm::dbgs() << "Skipping cyclic automaton " << cfa.getName() << ".\n");
+            continue;
+        }
+
+        auto entryIt = std::find(topo.begin(), topo.end(), cfa.getEntry());
+        if (std::find(entryIt, topo.end(), cfa.getExit()) == topo.end()) {
+            // The exit location is placed before the entry, thus it is not
+            // reachable: the procedure never returns, only errors are possible.
+            mNoReturn.insert(&cfa);
+            continue;
+        }
+
+        ExprVector candidates = this->createCandidates(&cfa);
+        mNumCandidates += candidates.size();
+
+        mTopoSorts[&cfa] = std::move(topo);
+        mProcedures.push_back(&cfa);
+        if (!candidates.empty()) {
+            mCandidates[&cfa] = std::move(candidates);
+        }
+    }
+
+    auto solver = mSolverFactory.createSolver(mSystem.getContext());
+
+    // Drop the candidates which do not hold for the body of their procedure,
+    // until the remaining ones are consistent with each other.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (Cfa* cfa : mProcedures) {
+            auto it = mCandidates.find(cfa);
+            if (it == mCandidates.end()) {
+                continue;
+            }
+
+            ExprVector& candidates = it->second;
+
+            solver->push();
+            solver->add(this->encodeBody(cfa));
+            solver->add(mExprBuilder.Not(this->conjunction(candidates)));
+
+            auto status = solver->run();
+            if (status == Solver::UNSAT) {
+                solver->pop();
+                continue;
+            }
+
+            changed = true;
+            size_t numCandidates = candidates.size();
+
+            if (status == Solver::SAT) {
+                Valuation model = solver->getModel();
+                ExprEvaluator eval{model};
+
+                candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&eval](auto& candidate) {
+                    auto value = llvm::dyn_cast_or_null<BoolLiteralExpr>(eval.walk(candidate).get());
+                    return value != nullptr && !value->getValue();
+                }), candidates.end());
+            }
+
+            if (candidates.size() == numCandidates) {
+                // The model did not refute any of the candidates, drop all of them to make progress.
+                candidates.clear();
+            }
+
+            solver->pop();
+
+            LLVM_DEBUG(llvm::dbgs() << "Dropped " << numCandidates - candidates.size()
+                << " candidate(s) of " << cfa->getName() << ".\n");
+
+            if (candidates.empty()) {
+                mCandidates.erase(cfa);
+            }
+        }
+    }
+
+    mNumSummarized = mNoReturn.size() + mCandidates.size();
+    for (auto& [cfa, candidates] : mCandidates) {
+        mNumLemmas += candidates.size();
+    }
+}
+
+ExprVector ProcedureSummaryCache::createCandidates(Cfa* cfa)
+{
+    ExprVector candidates;
+
+    llvm::SmallVector<Variable*, 8> inputs;
+    for (Variable& input : cfa->inputs()) {
+        if (!cfa->isOutput(&input)) {
+            inputs.push_back(&input);
+        }
+    }
+
+    for (Variable& output : cfa->outputs()) {
+        if (cfa->isInput(&output)) {
+            // The value of such variables is ambiguous in a relation.
+            continue;
+        }
+
+        Type& type = output.getType();
+        ExprPtr ref = output.getRefExpr();
+
+        // Relations between an output and a given value.
+        auto relate = [this, &type, &ref, &candidates](const ExprPtr& value) {
+            switch (type.getTypeID()) {
+                case Type::BoolTypeID:
+                    candidates.push_back(mExprBuilder.Eq(ref, value));
+                    break;
+                case Type::IntTypeID:
+                    candidates.push_back(mExprBuilder.Eq(ref, value));
+                    candidates.push_back(mExprBuilder.GtEq(ref, value));
+                    candidates.push_back(mExprBuilder.LtEq(ref, value));
+                    break;
+                case Type::BvTypeID:
+                    candidates.push_back(mExprBuilder.Eq(ref, value));
+                    candidates.push_back(mExprBuilder.BvSGtEq(ref, value));
+                    candidates.push_back(mExprBuilder.BvSLtEq(ref, value));
+                    break;
+                default:
+                    break;
+            }
+        };
+
+        switch (type.getTypeID()) {
+            case Type::BoolTypeID:
+                candidates.push_back(ref);
+                candidates.push_back(mExprBuilder.Not(ref));
+                break;
+            case Type::IntTypeID:
+                relate(mExprBuilder.IntLit(0));
+                break;
+            case Type::BvTypeID:
+                relate(mExprBuilder.BvLit(0, llvm::cast<BvType>(type).getWidth()));
+                break;
+            default:
+                continue;
+        }
+
+        for (Variable* input : inputs) {
+            if (input->getType() == type) {
+                relate(input->getRefExpr());
+            }
+        }
+    }
+
+    return candidates;
+}
+
+ExprPtr ProcedureSummaryCache::encodeBody(Cfa* cfa)
+{
+    auto& topo = mTopoSorts[cfa];
+
+    llvm::DenseMap<Location*, size_t> locNumbers;
+    for (size_t i = 0; i < topo.size(); ++i) {
+        locNumbers[topo[i]] = i;
+    }
+
+    PathConditionCalculator pathConditions(
+        topo,
+        mExprBuilder,
+        [&locNumbers](Location* loc) {
+            auto it = locNumbers.find(loc);
+            assert(it != locNumbers.end() && "All locations must be present in the location map!");
+            return it->second;
+        },
+        [this](CallTransition* call) {
+            return this->getSummaryForCall(call);
+        }
+    );
+
+    return pathConditions.encode(cfa->getEntry(), cfa->getExit());
+}
+
+ExprPtr ProcedureSummaryCache::conjunction(const ExprVector& ops)
+{
+    if (ops.empty()) {
+        return mExprBuilder.True();
+    }
+
+    return ops.size() == 1 ? ops[0] : mExprBuilder.And(ops);
+}
@@ -0,0 +1,277 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+// The unrolling is incremental: the formula of frame k is the formula of
+// frame k - 1 extended with a single instance of the transition relation.
+// Bad states of earlier frames are asserted to be unreachable, as those
+// were already checked in previous iterations.
+//
+// If the states of a frame are unreachable altogether, every execution
+// terminates (or fails) within the current bound, thus the program is safe.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/UnrollingBmc.h"
+#include "CutPointSystem.h"
+
+#include "gazer/Core/Solver/Solver.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+
+using namespace gazer;
+
+namespace
+{
+
+class UnrollingImpl
+{
+    struct Stats
+    {
+        std::chrono::milliseconds SolverTime{0};
+        unsigned NumCutPoints = 0;
+        unsigned NumSegments = 0;
+        unsigned NumFrames = 0;
+    };
+
+public:
+    UnrollingImpl(
+        Cfa& cfa,
+        ExprBuilder& builder,
+        SolverFactory& solverFactory,
+        CfaTraceBuilder& traceBuilder,
+        UnrollingSettings settings
+    ) : mCfa(cfa),
+        mExprBuilder(builder),
+        mSolver(solverFactory.createSolver(cfa.getParent().getContext())),
+        mTraceBuilder(traceBuilder),
+        mSettings(settings),
+        mSystem(cfa, builder)
+    {}
+
+    std::unique_ptr<VerificationResult> check();
+
+    void printStats(llvm::raw_ostream& os);
+
+private:
+    void createFrame();
+
+    /// Instantiates the transition relation between frame \p frame and its successor.
+    ExprPtr instantiate(unsigned frame);
+
+    ExprPtr createBadState(unsigned frame);
+
+    unsigned extractErrorCode(unsigned frame);
+
+    /// Builds the counterexample trace of a satisfiable query in frame \p bound.
+    std::unique_ptr<Trace> buildTrace(unsigned bound);
+
+    Solver::SolverStatus runSolver();
+
+private:
+    Cfa& mCfa;
+    ExprBuilder& mExprBuilder;
+    std::unique_ptr<Solver> mSolver;
+    CfaTraceBuilder& mTraceBuilder;
+    UnrollingSettings mSettings;
+
+    CutPointSystem mSystem;
+
+    ExprPtr mTransitionRelation;
+    std::vector<CutPointSystem::Frame> mFrames;
+
+    Stats mStats;
+    Stopwatch<> mTimer;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<VerificationResult> UnrollingChecker::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
+{
+    std::unique_ptr<ExprBuilder> builder;
+
+    if (mSettings.simplifyExpr) {
+        builder = CreateFoldingExprBuilder(system.getContext());
+    } else {
+        builder = CreateExprBuilder(system.getContext());
+    }
+
+    Cfa* main = system.getMainAutomaton();
+    assert(main != nullptr && "The main automaton must exist!");
+
+    UnrollingImpl impl{*main, *builder, mSolverFactory, traceBuilder, mSettings};
+
+    auto result = impl.check();
+
+    impl.printStats(llvm::outs());
+
+    return result;
+}
+
+std::unique_ptr<VerificationResult> UnrollingImpl::check()
+{
+    if (!mSystem.findCutPoints()) {
+        llvm::errs() << "Transition relation unrolling requires a cyclic main automaton without calls."
+            " Try enabling function inlining and the cyclic loop representation.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    if (mSystem.errors().empty()) {
+        llvm::outs() << "No error location is reachable.\n";
+        return VerificationResult::CreateSuccess();
+    }
+
+    if (!mSystem.split()) {
+        llvm::errs() << "Transition relation unrolling requires an automaton in SSA form.\n";
+        return VerificationResult::CreateUnknown();
+    }
+
+    mTransitionRelation = mSystem.encodeTransitionRelation();
+    mStats.NumCutPoints = mSystem.cutPoints().size();
+    mStats.NumSegments = mSystem.getNumSegments();
+
+    if (mSettings.dumpFormula) {
+        mTransitionRelation->print(llvm::errs());
+    }
+
+    this->createFrame();
+    mSolver->add(mSystem.createPcEquals(mFrames[0].pc, mSystem.getPcValue(mCfa.getEntry())));
+
+    for (unsigned bound = 1; bound <= mSettings.maxBound; ++bound) {
+        llvm::outs() << "Bound " << bound << "\n";
+
+        this->createFrame();
+        mSolver->add(this->instantiate(bound - 1));
+
+        llvm::outs() << "  Checking frame " << bound << "...\n";
+        mSolver->push();
+        mSolver->add(this->createBadState(bound));
+
+        auto status = this->runSolver();
+        if (status == Solver::SAT) {
+            llvm::outs() << "  Found a counterexample of length " << bound << ".\n";
+            unsigned ec = this->extractErrorCode(bound);
+            return VerificationResult::CreateFail(ec, this->buildTrace(bound));
+        }
+        mSolver->pop();
+
+        if (status == Solver::UNKNOWN) {
+            llvm::outs() << "  Solver returned UNKNOWN.\n";
+            return VerificationResult::CreateUnknown();
+        }
+
+        // Error states end the execution, there is no need to consider their successors.
+        mSolver->add(mExprBuilder.Not(this->createBadState(bound)));
+
+        llvm::outs() << "  Checking whether the unwinding is complete...\n";
+        status = this->runSolver();
+        if (status == Solver::UNSAT) {
+            llvm::outs() << "  No executions are longer than " << bound - 1 << " step(s).\n";
+            return VerificationResult::CreateSuccess();
+        }
+
+        if (status == Solver::UNKNOWN) {
+            llvm::outs() << "  Solver returned UNKNOWN.\n";
+            return VerificationResult::CreateUnknown();
+        }
+    }
+
+    return VerificationResult::CreateBoundReached();
+}
+
+void UnrollingImpl::createFrame()
+{
+    mFrames.push_back(mSystem.createFrame("_t" + std::to_string(mFrames.size())));
+    mStats.NumFrames++;
+}
+
+ExprPtr UnrollingImpl::instantiate(unsigned frame)
+{
+    assert(frame + 1 < mFrames.size() && "Both frames of a transition must exist!");
+    return mSystem.instantiate(mTransitionRelation, mFrames[frame], mFrames[frame + 1]);
+}
+
+ExprPtr UnrollingImpl::createBadState(unsigned frame)
+{
+    return mSystem.createIsError(mFrames[frame].pc);
+}
+
+unsigned UnrollingImpl::extractErrorCode(unsigned frame)
+{
+    Valuation model = mSolver->getModel();
+
+    std::optional<unsigned> pc = mSystem.evaluatePc(mFrames[frame].pc, model);
+    assert(pc && "The program counter must be present in the model!");
+
+    Location* error = mSystem.getLocationForPc(*pc);
+    return mSystem.extractErrorCode(error, model, [this, frame](const ExprPtr& expr) {
+        return mSystem.instantiateState(expr, mFrames[frame]);
+    });
+}
+
+std::unique_ptr<Trace> UnrollingImpl::buildTrace(unsigned bound)
+{
+    if (!mSettings.trace) {
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    // The frames 0..bound form a path from the entry.
+    Valuation model = mSolver->getModel();
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+
+    auto frames = llvm::makeArrayRef(mFrames).take_front(bound + 1);
+    if (!mSystem.decodePath(frames, model, states, actions)) {
+        llvm::errs() << "Could not reconstruct the counterexample trace.\n";
+        return nullptr;
+    }
+
+    return mTraceBuilder.build(states, actions);
+}
+
+Solver::SolverStatus UnrollingImpl::runSolver()
+{
+    llvm::outs() << "    Running solver...\n";
+    mTimer.start();
+    auto status = mSolver->run();
+    mTimer.stop();
+
+    llvm::outs() << "      Elapsed time: ";
+    mTimer.format(llvm::outs(), "s");
+    llvm::outs() << "\n";
+    mStats.SolverTime += mTimer.elapsed();
+
+    return status;
+}
+
+void UnrollingImpl::printStats(llvm::raw_ostream& os)
+{
+    os << "--------- Statistics ---------\n";
+    os << "Total solver time: ";
+    llvm::format_provider<std::chrono::milliseconds>::format(mStats.SolverTime, os, "s");
+    os << "\n";
+    os << "Number of cut points: " << mStats.NumCutPoints << "\n";
+    os << "Number of segments: " << mStats.NumSegments << "\n";
+    os << "Number of time frames: " << mStats.NumFrames << "\n";
+    os << "------------------------------\n";
+    if (mSettings.printSolverStats) {
+        mSolver->printStats(os);
+    }
+    os << "\n";
+}
@@ -0,0 +1,31 @@
+; RUN: %cfa -memory=havoc -cfa-stats -cfa-stats-top=1 "%s" | FileCheck "%s"
+
+; CHECK: "automata": 2,
+; CHECK: "phases": [
+; CHECK: "name": "declare",
+; CHECK: "name": "encode",
+; CHECK: "procedures": [
+; CHECK: "ranking": {
+; CHECK: "calls": [
+; CHECK-NEXT: {
+; CHECK-NEXT: "name": "main{{.*}}",
+; CHECK-NEXT: "value": 1
+; CHECK-NEXT: }
+; CHECK-NEXT: ],
+; CHECK: "totals": {
+; CHECK: "translation_time_us":
+
+declare i32 @__VERIFIER_nondet_int()
+
+define i32 @main() {
+entry:
+    %limit = call i32 @__VERIFIER_nondet_int()
+    br label %loop.header
+loop.header:
+    %i = phi i32 [ 0, %entry ], [ %i1, %loop.header ]
+    %i1 = add nsw i32 %i, 1
+    %cond = icmp slt i32 %i1, %limit
+    br i1 %cond, label %loop.header, label %loop.end
+loop.end:
+    ret i32 0
+}
@@ -0,0 +1,6 @@
+// An input file which does not compile.
+
+int broken(void)
+{
+    return undeclared_variable;
+}
@@ -0,0 +1,6 @@
+// Definitions linked into the tests compiling multiple input files.
+
+int decrement(int x)
+{
+    return x - 1;
+}
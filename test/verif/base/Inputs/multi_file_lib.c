@@ -0,0 +1,6 @@
+// Definitions linked into the tests compiling multiple input files.
+
+int increment(int x)
+{
+    return x + 1;
+}
@@ -0,0 +1,28 @@
+// RUN: %bmc -bound 10 -cfa-coi "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int unused_sum = 0;
+
+int step(int x, int y)
+{
+    unused_sum = unused_sum + y;
+    return x + 1;
+}
+
+int main(void)
+{
+    int x = 0;
+    int n = __VERIFIER_nondet_int();
+
+    for (int i = 0; i < n; ++i) {
+        x = step(x, i * 3);
+    }
+
+    assert(x != 5);
+
+    return 0;
+}
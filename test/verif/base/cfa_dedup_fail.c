@@ -0,0 +1,37 @@
+// RUN: %bmc -bound 10 -cfa-dedup -no-inline "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int sum_a(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i) {
+        s = s + 2;
+    }
+    return s;
+}
+
+int sum_b(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i) {
+        s = s + 2;
+    }
+    return s;
+}
+
+int main(void)
+{
+    int n = __VERIFIER_nondet_int();
+    int m = __VERIFIER_nondet_int();
+
+    int a = sum_a(n);
+    int b = sum_b(m);
+
+    assert(a + b != 6);
+
+    return 0;
+}
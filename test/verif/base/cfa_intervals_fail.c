@@ -0,0 +1,30 @@
+// RUN: %bmc -bound 10 -cfa-intervals "%s" | FileCheck "%s"
+// RUN: %bmc -bound 10 -cfa-interval-invariants "%s" | FileCheck "%s"
+// RUN: %bmc -engine unroll -cfa-intervals "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int sum = 0;
+
+    if (x < 0 || x > 5) {
+        x = 5;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        sum = sum + x;
+        if (sum > 100) {
+            // Unreachable, removed by the analysis.
+            sum = 0;
+        }
+    }
+
+    assert(sum != 15);
+
+    return 0;
+}
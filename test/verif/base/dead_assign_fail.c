@@ -0,0 +1,28 @@
+// RUN: %bmc -bound 10 -elim-dead-assign "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int counter(int n, int* steps)
+{
+    int c = 0;
+    for (int i = 0; i < n; ++i) {
+        c = c + 2;
+        *steps = *steps + 1;
+    }
+
+    return c;
+}
+
+int main(void)
+{
+    int steps = 0;
+    int n = __VERIFIER_nondet_int();
+    int c = counter(n, &steps);
+
+    assert(c != 6);
+
+    return 0;
+}
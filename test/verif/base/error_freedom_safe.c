@@ -0,0 +1,22 @@
+// RUN: %bmc -bound 1 -prove-error-freedom "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int sum = 0;
+
+    for (int i = 0; i < a; ++i) {
+        sum = sum + i;
+    }
+
+    if (a > 5) {
+        assert(a > 3);
+    }
+
+    return sum;
+}
@@ -0,0 +1,19 @@
+// RUN: %bmc -engine explicit "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern unsigned char __VERIFIER_nondet_uchar(void);
+
+int main(void)
+{
+    unsigned char i = 0;
+    unsigned char n = __VERIFIER_nondet_uchar();
+    while (i < n) {
+        ++i;
+    }
+
+    assert(i != 200);
+
+    return 0;
+}
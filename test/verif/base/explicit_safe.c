@@ -0,0 +1,22 @@
+// RUN: %bmc -engine explicit "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern _Bool __VERIFIER_nondet_bool(void);
+
+int main(void)
+{
+    unsigned char i = 0;
+    unsigned char j = 0;
+    while (i < 100) {
+        if (__VERIFIER_nondet_bool()) {
+            ++j;
+        }
+        ++i;
+    }
+
+    assert(j <= 100);
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+// RUN: %bmc -bound 1 "%s" "%S/Inputs/multi_file_lib.c" "%S/Inputs/jobs_lib.c" | FileCheck "%s"
+// RUN: %bmc -bound 1 -j 2 "%s" "%S/Inputs/multi_file_lib.c" "%S/Inputs/jobs_lib.c" | FileCheck "%s"
+// RUN: %bmc -bound 1 -j 0 "%s" "%S/Inputs/multi_file_lib.c" "%S/Inputs/jobs_lib.c" | FileCheck "%s"
+// RUN: %bmc -bound 1 -j 2 -clang-subprocess "%s" "%S/Inputs/multi_file_lib.c" "%S/Inputs/jobs_lib.c" | FileCheck "%s"
+
+// A failing compilation must fail the whole run, even if it is concurrent.
+// RUN: not %bmc -bound 1 -j 2 "%s" "%S/Inputs/multi_file_lib.c" "%S/Inputs/compile_error.c" 2>&1 | FileCheck -check-prefix=ERROR "%s"
+// RUN: not %bmc -bound 1 -j 2 -clang-subprocess "%s" "%S/Inputs/multi_file_lib.c" "%S/Inputs/compile_error.c" 2>&1 | FileCheck -check-prefix=ERROR "%s"
+
+// CHECK: Verification SUCCESSFUL
+// ERROR: Failed to compile input file '{{.*}}compile_error.c'.
+// ERROR-NOT: Verification
+
+// The verdict only holds if the definitions of all inputs are linked.
+#include <assert.h>
+
+int increment(int x);
+int decrement(int x);
+
+int main(void)
+{
+    int a = increment(1);
+    int b = decrement(1);
+    assert(a == 2 && b == 0);
+
+    return 0;
+}
@@ -0,0 +1,16 @@
+// RUN: %bmc -engine kind "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+int main(void)
+{
+    int i = 0;
+    while (i < 10) {
+        ++i;
+    }
+
+    assert(i == 10);
+
+    return 0;
+}
@@ -0,0 +1,33 @@
+// RUN: %bmc -bound 10 -lbe "%s" | FileCheck "%s"
+// RUN: %bmc -bound 10 -lbe -trace "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = __VERIFIER_nondet_int();
+    int c = 0;
+
+    if (x > 0) {
+        c = c + 1;
+    } else {
+        c = c - 1;
+    }
+
+    int d = c * 2;
+    if (y < 0) {
+        d = d + y;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        d = d + 1;
+    }
+
+    assert(d != 5);
+
+    return 0;
+}
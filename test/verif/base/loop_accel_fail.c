@@ -0,0 +1,20 @@
+// RUN: %bmc -engine unroll -accelerate-loops "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int n = __VERIFIER_nondet_int();
+    int x = 0;
+
+    for (int i = 0; i < n; ++i) {
+        x = x + 2;
+    }
+
+    assert(x != 2000);
+
+    return 0;
+}
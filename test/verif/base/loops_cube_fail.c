@@ -0,0 +1,31 @@
+// RUN: %bmc -bound 10 -cube-depth 2 -cube-workers 2 "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    int y = __VERIFIER_nondet_int();
+    int c = 0;
+
+    if (x > 0) {
+        c = c + 1;
+    } else {
+        c = c - 1;
+    }
+
+    for (int i = 0; i < y; ++i) {
+        if (i % 2 == 0) {
+            c = c + 2;
+        } else {
+            c = c - 1;
+        }
+    }
+
+    assert(c != 4);
+
+    return 0;
+}
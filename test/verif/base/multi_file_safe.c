@@ -0,0 +1,23 @@
+// RUN: %bmc -bound 1 "%s" "%S/Inputs/multi_file_lib.c" | FileCheck "%s"
+// RUN: %bmc -bound 1 -clang-subprocess "%s" "%S/Inputs/multi_file_lib.c" | FileCheck "%s"
+
+// The temporary working directory must be removed after compilation.
+// RUN: rm -rf %t.tmp && mkdir %t.tmp
+// RUN: env TMPDIR=%t.tmp %bmc -bound 1 -clang-subprocess "%s" "%S/Inputs/multi_file_lib.c" | FileCheck "%s"
+// RUN: not ls %t.tmp/gazer_workdir_*
+
+// CHECK: Verification SUCCESSFUL
+
+// Without the second input, increment() would be an undefined external
+// function returning a nondeterministic value, failing the assertion.
+#include <assert.h>
+
+int increment(int x);
+
+int main(void)
+{
+    int a = increment(1);
+    assert(a == 2);
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+// RUN: %bmc -bound 1 -all-errors "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+// CHECK-DAG: Assertion failure
+// CHECK-DAG: Divison by zero
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = __VERIFIER_nondet_int();
+
+    if (a > 0) {
+        assert(b != 0);
+    }
+
+    return a / b;
+}
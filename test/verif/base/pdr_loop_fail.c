@@ -0,0 +1,19 @@
+// RUN: %bmc -engine pdr "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+    int n = __VERIFIER_nondet_int();
+    while (i < n) {
+        ++i;
+    }
+
+    assert(i != 5);
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+// RUN: %bmc -engine pdr "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+int main(void)
+{
+    int i = 0;
+    int j = 0;
+    while (i < 10) {
+        ++i;
+        ++j;
+    }
+
+    assert(j <= 10);
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+// RUN: %bmc -bound 1 -split-checks -check-workers 2 "%s" | FileCheck "%s"
+// RUN: %bmc -bound 1 -split-checks -check-workers 2 -trace "%s" | FileCheck --check-prefix=TRACE "%s"
+
+// CHECK: === Summary
+// CHECK-NEXT: Verification FAILED
+// CHECK-DAG: Assertion failure
+// CHECK-DAG: Divison by zero
+
+// TRACE: === Check
+// TRACE: Error trace:
+// TRACE: === Summary
+// TRACE-NEXT: Verification FAILED
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int a = __VERIFIER_nondet_int();
+    int b = __VERIFIER_nondet_int();
+
+    if (a > 0) {
+        assert(b != 0);
+    }
+
+    return a / b;
+}
@@ -0,0 +1,19 @@
+// RUN: %bmc -bound 1 -summaries "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+#include <assert.h>
+
+extern int __VERIFIER_nondet_int(void);
+
+int main(void)
+{
+    int i = 0;
+    int n = __VERIFIER_nondet_int();
+    while (i < n) {
+        ++i;
+    }
+
+    assert(i >= 0);
+
+    return 0;
+}
@@ -22,6 +22,10 @@
 
 #include "gazer/Z3Solver/Z3Solver.h"
 #include "gazer/Verifier/BoundedModelChecker.h"
+#include "gazer/Verifier/ExplicitState.h"
+#include "gazer/Verifier/KInduction.h"
+#include "gazer/Verifier/Pdr.h"
+#include "gazer/Verifier/UnrollingBmc.h"
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Verifier.h>
@@ -51,10 +55,78 @@ namespace
 
     cl::OptionCategory BmcAlgorithmCategory("Bounded model checker algorithm settings");
 
+    enum class EngineKind { Bmc, KInduction, Pdr, Unroll, Explicit };
+
+    cl::opt<EngineKind> Engine("engine", cl::desc("Verification engine"),
+        cl::values(
+            clEnumValN(EngineKind::Bmc, "bmc", "Bounded model checking"),
+            clEnumValN(EngineKind::KInduction, "kind", "K-induction on the cyclic representation"),
+            clEnumValN(EngineKind::Pdr, "pdr", "Property-directed reachability (IC3) on the cyclic representation"),
+            clEnumValN(EngineKind::Unroll, "unroll", "Transition relation unrolling on the cyclic representation"),
+            clEnumValN(EngineKind::Explicit, "explicit",
+                "Explicit-state reachability on the cyclic representation, falling back to unrolling")
+        ),
+        cl::init(EngineKind::Bmc),
+        cl::cat(BmcAlgorithmCategory)
+    );
+
     cl::opt<unsigned> MaxBound("bound", cl::desc("Maximum iterations for the bounded model checker"),
         cl::init(100), cl::cat(BmcAlgorithmCategory));
     cl::opt<unsigned> EagerUnroll("eager-unroll", cl::desc("Eager unrolling bound"), cl::init(0),
         cl::cat(BmcAlgorithmCategory));
+    cl::opt<BoundStrategy> BoundGrowth("bound-strategy", cl::desc("Bound growth strategy"),
+        cl::values(
+            clEnumValN(BoundStrategy::Linear, "linear", "Increase the bound by one in each iteration"),
+            clEnumValN(BoundStrategy::Geometric, "geometric", "Double the bound in each iteration"),
+            clEnumValN(BoundStrategy::Adaptive, "adaptive",
+                "Choose the step based on the solver time and the number of open calls")
+        ),
+        cl::init(BoundStrategy::Linear),
+        cl::cat(BmcAlgorithmCategory)
+    );
+    cl::opt<unsigned> AdaptiveRoundTime("adaptive-round-time",
+        cl::desc("Iterations faster than this (in milliseconds) take a larger step with -bound-strategy=adaptive"),
+        cl::init(1000), cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> InlineTopK("inline-top-k",
+        cl::desc("Maximum number of calls to inline in a single iteration (0: unlimited)"),
+        cl::init(0), cl::cat(BmcAlgorithmCategory));
+
+    cl::opt<bool> ConcurrentApprox("concurrent-approx",
+        cl::desc("Solve the under- and over-approximation of each iteration concurrently"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> CubeDepth("cube-depth",
+        cl::desc("Split each solver query into 2^N cubes over path selectors (0: disabled)"),
+        cl::init(0), cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> CubeWorkers("cube-workers",
+        cl::desc("Maximum number of parallel cube worker processes (0: number of cores)"),
+        cl::init(0), cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> AllErrors("all-errors",
+        cl::desc("Report every violated check instead of stopping at the first one"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> ProcedureSummaries("summaries",
+        cl::desc("Over-approximate calls using inferred procedure summaries"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> ProveErrorFreedom("prove-error-freedom",
+        cl::desc("Prove procedures error-free bottom-up before running BMC"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> NoSimplePath("no-simple-path",
+        cl::desc("Do not require distinct states in the inductive step of k-induction"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> PdrNoDropLiterals("pdr-no-drop-literals",
+        cl::desc("Only use unsat cores to generalize blocked cubes in PDR"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> DumpInvariant("dump-invariant",
+        cl::desc("Print the inductive invariant found by PDR"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<bool> ExplicitDfs("explicit-dfs",
+        cl::desc("Use depth-first search in the explicit-state engine"),
+        cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> ExplicitNondetWidth("explicit-nondet-width",
+        cl::desc("Widest bit-vector whose nondeterministic values are enumerated by the explicit-state engine"),
+        cl::init(8), cl::cat(BmcAlgorithmCategory));
+    cl::opt<unsigned> ExplicitMemoryLimit("explicit-memory-limit",
+        cl::desc("Memory limit for the states visited by the explicit-state engine, in megabytes"),
+        cl::init(1024), cl::cat(BmcAlgorithmCategory));
 
     cl::opt<bool> DumpCfa("debug-dump-cfa", cl::desc("Dump the generated CFA after each inlining step"),
         cl::cat(BmcAlgorithmCategory));
@@ -72,6 +144,10 @@ namespace
 }
 
 static BmcSettings initBmcSettingsFromCommandLine();
+static KInductionSettings initKInductionSettingsFromCommandLine();
+static PdrSettings initPdrSettingsFromCommandLine();
+static UnrollingSettings initUnrollingSettingsFromCommandLine();
+static ExplicitStateSettings initExplicitStateSettingsFromCommandLine();
 
 int main(int argc, char* argv[])
 {
@@ -95,6 +171,12 @@ int main(int argc, char* argv[])
     llvm::LLVMContext llvmContext;
 
     auto settings = LLVMFrontendSettings::initFromCommandLine();
+    if (Engine == EngineKind::KInduction || Engine == EngineKind::Pdr
+        || Engine == EngineKind::Unroll || Engine == EngineKind::Explicit
+    ) {
+        // K-induction, PDR, unrolling and explicit-state search work on the cyclic form of the main automaton.
+        settings.loops = LoopRepresentation::Cycle;
+    }
 
     // Run the clang frontend
     auto module = ClangCompileAndLink(InputFilenames, llvmContext);
@@ -112,11 +194,43 @@ int main(int argc, char* argv[])
 
     Z3SolverFactory solverFactory;
 
-    auto bmcSettings = initBmcSettingsFromCommandLine();
-    bmcSettings.simplifyExpr = settings.simplifyExpr;
-    bmcSettings.trace = settings.trace;
+    if (Engine == EngineKind::KInduction) {
+        auto kindSettings = initKInductionSettingsFromCommandLine();
+        kindSettings.simplifyExpr = settings.simplifyExpr;
+        kindSettings.trace = settings.trace;
+
+        frontend->setBackendAlgorithm(new KInductionChecker(solverFactory, kindSettings));
+    } else if (Engine == EngineKind::Pdr) {
+        auto pdrSettings = initPdrSettingsFromCommandLine();
+        pdrSettings.simplifyExpr = settings.simplifyExpr;
+        pdrSettings.trace = settings.trace;
+
+        frontend->setBackendAlgorithm(new PdrChecker(solverFactory, pdrSettings));
+    } else if (Engine == EngineKind::Unroll) {
+        auto unrollSettings = initUnrollingSettingsFromCommandLine();
+        unrollSettings.simplifyExpr = settings.simplifyExpr;
+        unrollSettings.trace = settings.trace;
+
+        frontend->setBackendAlgorithm(new UnrollingChecker(solverFactory, unrollSettings));
+    } else if (Engine == EngineKind::Explicit) {
+        auto explicitSettings = initExplicitStateSettingsFromCommandLine();
+        explicitSettings.trace = settings.trace;
+
+        auto unrollSettings = initUnrollingSettingsFromCommandLine();
+        unrollSettings.simplifyExpr = settings.simplifyExpr;
+        unrollSettings.trace = settings.trace;
 
-    frontend->setBackendAlgorithm(new BoundedModelChecker(solverFactory, bmcSettings));
+        frontend->setBackendAlgorithm(new ExplicitStateChecker(
+            explicitSettings, std::make_unique<UnrollingChecker>(solverFactory, unrollSettings)
+        ));
+    } else {
+        auto bmcSettings = initBmcSettingsFromCommandLine();
+        bmcSettings.simplifyExpr = settings.simplifyExpr;
+        bmcSettings.trace = settings.trace;
+        bmcSettings.eliminateDeadAssignments = settings.deadAssignments;
+
+        frontend->setBackendAlgorithm(new BoundedModelChecker(solverFactory, bmcSettings));
+    }
     frontend->registerVerificationPipeline();
 
     frontend->run();
@@ -137,6 +251,60 @@ BmcSettings initBmcSettingsFromCommandLine()
 
     settings.maxBound = MaxBound;
     settings.eagerUnroll = EagerUnroll;
+    settings.boundStrategy = BoundGrowth;
+    settings.adaptiveRoundTime = AdaptiveRoundTime;
+    settings.allErrors = AllErrors;
+    settings.procedureSummaries = ProcedureSummaries;
+    settings.proveErrorFreedom = ProveErrorFreedom;
+    settings.inlineTopK = InlineTopK;
+    settings.concurrentApprox = ConcurrentApprox;
+    settings.cubeDepth = CubeDepth;
+    settings.cubeWorkers = CubeWorkers;
+
+    return settings;
+}
+
+KInductionSettings initKInductionSettingsFromCommandLine()
+{
+    KInductionSettings settings;
+    settings.dumpFormula = DumpFormula;
+    settings.printSolverStats = PrintSolverStats;
+
+    settings.maxBound = MaxBound;
+    settings.simplePath = !NoSimplePath;
+
+    return settings;
+}
+
+PdrSettings initPdrSettingsFromCommandLine()
+{
+    PdrSettings settings;
+    settings.dumpInvariant = DumpInvariant;
+    settings.printSolverStats = PrintSolverStats;
+
+    settings.maxFrames = MaxBound;
+    settings.dropLiterals = !PdrNoDropLiterals;
+
+    return settings;
+}
+
+UnrollingSettings initUnrollingSettingsFromCommandLine()
+{
+    UnrollingSettings settings;
+    settings.dumpFormula = DumpFormula;
+    settings.printSolverStats = PrintSolverStats;
+
+    settings.maxBound = MaxBound;
+
+    return settings;
+}
+
+ExplicitStateSettings initExplicitStateSettingsFromCommandLine()
+{
+    ExplicitStateSettings settings;
+    settings.searchOrder = ExplicitDfs ? SearchOrder::DepthFirst : SearchOrder::BreadthFirst;
+    settings.maxNondetWidth = ExplicitNondetWidth;
+    settings.memoryLimit = ExplicitMemoryLimit;
 
     return settings;
 }
@@ -40,6 +40,8 @@ namespace
     cl::opt<bool> ViewCfa("view", cl::desc("View the CFA in the system's GraphViz viewier."));
     cl::opt<bool> CyclicCfa("cyclic", cl::desc("Represent LoopRep as cycles instead of recursive calls."));
     cl::opt<bool> RunPipeline("run-pipeline", cl::desc("Run the early stages of the verification pipeline, such as instrumentation."));
+    cl::opt<bool> PrintStats("cfa-stats", cl::desc("Print the size of each automaton and the translation times as JSON instead of the CFA."));
+    cl::opt<unsigned> StatsTop("cfa-stats-top", cl::desc("Number of automata listed in each ranking of the statistics."), cl::init(10));
 }
 
 int main(int argc, char* argv[])
@@ -72,7 +74,12 @@ int main(int argc, char* argv[])
         frontend->registerVerificationPipeline();
     } else {
         frontend->registerPass(new gazer::ModuleToAutomataPass(context, settings));
-        frontend->registerPass(gazer::createCfaPrinterPass());
+        if (!PrintStats) {
+            frontend->registerPass(gazer::createCfaPrinterPass());
+        }
+    }
+    if (PrintStats) {
+        frontend->registerPass(gazer::createCfaStatisticsPass(StatsTop));
     }
     if (ViewCfa) {
         frontend->registerPass(gazer::createCfaViewerPass());
@@ -0,0 +1,225 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class AutomataDeduplicationTest : public AutomataSystemTest
+{
+protected:
+    /// Creates an automaton returning abs(x) + offset.
+    Cfa* createAbs(const std::string& name, const std::string& varName, int offset = 0)
+    {
+        auto& intTy = IntType::Get(context);
+
+        Cfa* cfa = system.createCfa(name);
+        Variable* x = cfa->createInput(varName, intTy);
+        Variable* r = cfa->createLocal(varName + "_r", intTy);
+        cfa->addOutput(r);
+
+        Location* l1 = cfa->createLocation();
+        cfa->createAssignTransition(cfa->getEntry(), l1, builder->GtEq(x->getRefExpr(), builder->IntLit(0)), {
+            { r, builder->Add(x->getRefExpr(), builder->IntLit(offset)) }
+        });
+        cfa->createAssignTransition(cfa->getEntry(), l1, builder->Lt(x->getRefExpr(), builder->IntLit(0)), {
+            { r, builder->Add(builder->Sub(builder->IntLit(0), x->getRefExpr()), builder->IntLit(offset)) }
+        });
+        cfa->createAssignTransition(l1, cfa->getExit());
+
+        return cfa;
+    }
+
+    /// Creates an automaton calling \p callee with its input and returning the result.
+    Cfa* createWrapper(const std::string& name, Cfa* callee)
+    {
+        auto& intTy = IntType::Get(context);
+
+        Cfa* cfa = system.createCfa(name);
+        Variable* y = cfa->createInput(name + "_y", intTy);
+        Variable* s = cfa->createLocal(name + "_s", intTy);
+        cfa->addOutput(s);
+
+        cfa->createCallTransition(cfa->getEntry(), cfa->getExit(), callee, {
+            { callee->getInput(0), y->getRefExpr() }
+        }, {
+            { s, callee->getOutput(0)->getRefExpr() }
+        });
+
+        return cfa;
+    }
+
+    /// Creates a main automaton calling each of \p callees on a nondeterministic value.
+    Cfa* createMain(llvm::ArrayRef<Cfa*> callees)
+    {
+        auto& intTy = IntType::Get(context);
+
+        Cfa* main = system.createCfa("main");
+        system.setMainAutomaton(main);
+
+        Variable* n = main->createLocal("n", intTy);
+        Location* current = main->getEntry();
+        for (Cfa* callee : callees) {
+            Variable* result = main->createLocal("res_" + callee->getName().str(), intTy);
+            Location* next = main->createLocation();
+            main->createCallTransition(current, next, callee, {
+                { callee->getInput(0), n->getRefExpr() }
+            }, {
+                { result, callee->getOutput(0)->getRefExpr() }
+            });
+            current = next;
+        }
+        main->createAssignTransition(current, main->getExit());
+
+        return main;
+    }
+
+    static std::vector<CallTransition*> getCalls(Cfa* cfa)
+    {
+        std::vector<CallTransition*> calls;
+        for (auto& edge : cfa->edges()) {
+            if (auto call = llvm::dyn_cast<CallTransition>(edge.get())) {
+                calls.push_back(call);
+            }
+        }
+
+        return calls;
+    }
+};
+
+TEST_F(AutomataDeduplicationTest, MergeRenamedClones)
+{
+    Cfa* f1 = createAbs("f1", "a");
+    Cfa* f2 = createAbs("f2", "b");
+    Cfa* f3 = createAbs("f3", "c", 1);
+    Cfa* main = createMain({ f1, f2, f3 });
+
+    auto result = TransformAutomataDeduplication(system);
+
+    EXPECT_EQ(1, result.NumMergedAutomata);
+    EXPECT_EQ(1, result.NumRedirectedCalls);
+    EXPECT_EQ(3, system.getNumAutomata());
+    EXPECT_EQ(nullptr, system.getAutomatonByName("f2"));
+    EXPECT_EQ(main, system.getMainAutomaton());
+
+    auto calls = getCalls(main);
+    ASSERT_EQ(3, calls.size());
+    EXPECT_EQ(f1, calls[0]->getCalledAutomaton());
+    EXPECT_EQ(f1, calls[1]->getCalledAutomaton());
+    EXPECT_EQ(f3, calls[2]->getCalledAutomaton());
+
+    // The arguments of the redirected call must be bound to the new callee.
+    EXPECT_EQ(f1->getInput(0), calls[1]->input_begin()->getVariable());
+    EXPECT_EQ(f1->getOutput(0)->getRefExpr(), calls[1]->output_begin()->getValue());
+    EXPECT_EQ(main->findLocalByName("res_f2"), calls[1]->output_begin()->getVariable());
+}
+
+TEST_F(AutomataDeduplicationTest, KeepAutomataWithDifferentInterfaces)
+{
+    Cfa* f1 = createAbs("f1", "a");
+    Cfa* f2 = createAbs("f2", "b");
+
+    // Same structure, but the local is unused and of a different type.
+    f2->createLocal("tmp", BvType::Get(context, 32));
+    createMain({ f1, f2 });
+
+    auto result = TransformAutomataDeduplication(system);
+
+    EXPECT_EQ(0, result.NumMergedAutomata);
+    EXPECT_EQ(3, system.getNumAutomata());
+}
+
+TEST_F(AutomataDeduplicationTest, MergeCallersOfMergedAutomata)
+{
+    Cfa* f1 = createAbs("f1", "a");
+    Cfa* f2 = createAbs("f2", "b");
+    Cfa* g1 = createWrapper("g1", f1);
+    Cfa* g2 = createWrapper("g2", f2);
+    Cfa* main = createMain({ g1, g2 });
+
+    auto result = TransformAutomataDeduplication(system);
+
+    EXPECT_EQ(2, result.NumMergedAutomata);
+    EXPECT_EQ(3, system.getNumAutomata());
+
+    auto calls = getCalls(main);
+    ASSERT_EQ(2, calls.size());
+    EXPECT_EQ(g1, calls[0]->getCalledAutomaton());
+    EXPECT_EQ(g1, calls[1]->getCalledAutomaton());
+    EXPECT_EQ(f1, getCalls(g1)[0]->getCalledAutomaton());
+}
+
+TEST_F(AutomataDeduplicationTest, MergeSelfRecursiveAutomata)
+{
+    auto& intTy = IntType::Get(context);
+
+    // Two copies of a loop procedure: i := i + 1 while i < 10.
+    std::vector<Cfa*> loops;
+    for (const char* name : { "loop1", "loop2" }) {
+        Cfa* loop = system.createCfa(name);
+        Variable* i = loop->createInput(std::string(name) + "_i", intTy);
+        Variable* iOut = loop->createLocal(std::string(name) + "_out", intTy);
+        loop->addOutput(iOut);
+
+        Location* body = loop->createLocation();
+        loop->createAssignTransition(loop->getEntry(), loop->getExit(), builder->GtEq(i->getRefExpr(), builder->IntLit(10)), {
+            { iOut, i->getRefExpr() }
+        });
+        loop->createCallTransition(loop->getEntry(), body, builder->Lt(i->getRefExpr(), builder->IntLit(10)), loop, {
+            { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+        }, {
+            { iOut, iOut->getRefExpr() }
+        });
+        loop->createAssignTransition(body, loop->getExit());
+        loops.push_back(loop);
+    }
+
+    Cfa* main = createMain(loops);
+    auto result = TransformAutomataDeduplication(system);
+
+    EXPECT_EQ(1, result.NumMergedAutomata);
+    EXPECT_EQ(2, system.getNumAutomata());
+    EXPECT_EQ(loops[0], getCalls(main)[1]->getCalledAutomaton());
+    EXPECT_EQ(loops[0], getCalls(loops[0])[0]->getCalledAutomaton());
+}
+
+TEST_F(AutomataDeduplicationTest, KeepDifferentErrorCodes)
+{
+    std::vector<Cfa*> callees;
+    for (unsigned i = 0; i < 2; ++i) {
+        Cfa* cfa = createAbs("fail" + std::to_string(i), "x" + std::to_string(i));
+        Location* err = cfa->createErrorLocation();
+        cfa->addErrorCode(err, builder->BvLit(i + 2, 16));
+        cfa->createAssignTransition(cfa->getEntry(), err, builder->Eq(cfa->getInput(0)->getRefExpr(), builder->IntLit(5)));
+        callees.push_back(cfa);
+    }
+    createMain(callees);
+
+    auto result = TransformAutomataDeduplication(system);
+
+    EXPECT_EQ(0, result.NumMergedAutomata);
+    EXPECT_EQ(3, system.getNumAutomata());
+}
+
+} // end anonymous namespace
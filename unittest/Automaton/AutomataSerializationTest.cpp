@@ -0,0 +1,263 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/AutomataSerialization.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class AutomataSerializationTest : public AutomataSystemTest
+{
+protected:
+    std::string serialize(AutomataSystem& sys)
+    {
+        std::string buffer;
+        llvm::raw_string_ostream os(buffer);
+        WriteAutomataSystem(sys, os);
+
+        return os.str();
+    }
+
+    static std::string print(const AutomataSystem& sys)
+    {
+        std::string buffer;
+        llvm::raw_string_ostream os(buffer);
+        sys.print(os);
+
+        return os.str();
+    }
+};
+
+TEST_F(AutomataSerializationTest, RoundTrip)
+{
+    auto& bv32Ty = BvType::Get(context, 32);
+    auto& fltTy = FloatType::Get(context, FloatType::Single);
+
+    Cfa* callee = system.createCfa("f");
+    Variable* a = callee->createInput("a", bv32Ty);
+    Variable* r = callee->createLocal("r", bv32Ty);
+    Variable* fl = callee->createLocal("fl", fltTy);
+    callee->addOutput(r);
+
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), builder->True(), {
+        { r, builder->Select(
+            builder->BvSLt(a->getRefExpr(), builder->BvLit(0, 32)),
+            builder->ZExt(builder->Extract(a->getRefExpr(), 0, 8), bv32Ty),
+            builder->Undef(bv32Ty)
+        ) },
+        { fl, builder->FAdd(
+            builder->FloatLit(llvm::APFloat(1.5f)), builder->SignedToFp(a->getRefExpr(), fltTy, llvm::APFloat::rmTowardZero),
+            llvm::APFloat::rmNearestTiesToEven
+        ) }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32Ty);
+    Variable* i = main->createLocal("i", IntType::Get(context));
+
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, builder->BvLit(2, 16));
+
+    main->createCallTransition(main->getEntry(), l1, builder->True(), callee, {
+        { a, builder->BvLit(0xFFFFFFFF, 32) }
+    }, {
+        { x, r->getRefExpr() }
+    });
+    main->createAssignTransition(l1, err, builder->And({
+        builder->Eq(x->getRefExpr(), builder->BvLit(5, 32)),
+        builder->Eq(i->getRefExpr(), builder->IntLit(-3)),
+        builder->BvULt(builder->Add(x->getRefExpr(), builder->BvLit(1, 32)), builder->BvLit(6, 32))
+    }), {
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+    });
+    main->createAssignTransition(l1, main->getExit(), builder->NotEq(x->getRefExpr(), builder->BvLit(5, 32)));
+    system.setMainAutomaton(main);
+
+    std::string buffer = serialize(system);
+
+    GazerContext newContext;
+    auto loaded = ReadAutomataSystem(buffer, newContext);
+
+    ASSERT_NE(nullptr, loaded);
+    EXPECT_EQ(2, loaded->getNumAutomata());
+    EXPECT_EQ(loaded->getAutomatonByName("main"), loaded->getMainAutomaton());
+    EXPECT_EQ(print(system), print(*loaded));
+
+    Cfa* newCallee = loaded->getAutomatonByName("f");
+    ASSERT_NE(nullptr, newCallee);
+    EXPECT_EQ(1, newCallee->getNumInputs());
+    EXPECT_EQ(1, newCallee->getNumOutputs());
+    EXPECT_EQ(newCallee->findLocalByName("r"), newCallee->getOutput(0));
+    EXPECT_EQ(1, loaded->getMainAutomaton()->getNumErrors());
+
+    // Writing the loaded system again must give the same bytes.
+    EXPECT_EQ(buffer, serialize(*loaded));
+}
+
+TEST_F(AutomataSerializationTest, ArrayLiteralRoundTrip)
+{
+    auto& bv32Ty = BvType::Get(context, 32);
+    auto& arrTy = ArrayType::Get(bv32Ty, BvType::Get(context, 8));
+
+    Cfa* main = system.createCfa("main");
+    Variable* mem = main->createLocal("mem", arrTy);
+
+    ArrayLiteralExpr::Builder arrayBuilder(arrTy);
+    arrayBuilder.addValue(builder->BvLit(1, 32), builder->BvLit(42, 8));
+    arrayBuilder.addValue(builder->BvLit(2, 32), builder->BvLit(43, 8));
+    arrayBuilder.setDefault(builder->BvLit(0, 8));
+
+    main->createAssignTransition(main->getEntry(), main->getExit(), builder->True(), {
+        { mem, arrayBuilder.build() }
+    });
+    system.setMainAutomaton(main);
+
+    std::string buffer = serialize(system);
+
+    GazerContext newContext;
+    auto newBuilder = CreateExprBuilder(newContext);
+    auto loaded = ReadAutomataSystem(buffer, newContext);
+    ASSERT_NE(nullptr, loaded);
+
+    Cfa* newMain = loaded->getMainAutomaton();
+    ASSERT_EQ(1, newMain->getNumTransitions());
+
+    auto assign = llvm::cast<AssignTransition>(newMain->edge_begin()->get());
+    ASSERT_EQ(1, assign->getNumAssignments());
+    EXPECT_EQ(newMain->findLocalByName("mem"), assign->begin()->getVariable());
+
+    auto literal = llvm::dyn_cast<ArrayLiteralExpr>(assign->begin()->getValue().get());
+    ASSERT_NE(nullptr, literal);
+    EXPECT_EQ(2, literal->getMap().size());
+    EXPECT_EQ(newBuilder->BvLit(42, 8), (*literal)[newBuilder->BvLit(1, 32)]);
+    EXPECT_EQ(newBuilder->BvLit(0, 8), literal->getDefault());
+}
+
+TEST_F(AutomataSerializationTest, SharedSubexpressionsAreWrittenOnce)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createInput("x", BvType::Get(context, 32));
+    Variable* y = main->createLocal("y", BvType::Get(context, 32));
+
+    // The tree of this expression has 2^64 nodes, but only 65 shared ones.
+    ExprPtr expr = x->getRefExpr();
+    for (unsigned i = 0; i < 64; ++i) {
+        expr = builder->Add(expr, expr);
+    }
+
+    main->createAssignTransition(main->getEntry(), main->getExit(), builder->True(), {
+        { y, expr }
+    });
+    system.setMainAutomaton(main);
+
+    std::string buffer = serialize(system);
+    EXPECT_LT(buffer.size(), 512);
+
+    GazerContext newContext;
+    auto loaded = ReadAutomataSystem(buffer, newContext);
+    ASSERT_NE(nullptr, loaded);
+    EXPECT_EQ(buffer, serialize(*loaded));
+}
+
+TEST_F(AutomataSerializationTest, RejectMalformedInput)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createInput("x", BvType::Get(context, 32));
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, builder->BvLit(2, 16));
+    main->createAssignTransition(main->getEntry(), err, builder->BvSGt(x->getRefExpr(), builder->BvLit(1, 32)));
+    main->createAssignTransition(main->getEntry(), main->getExit(), builder->BvSLtEq(x->getRefExpr(), builder->BvLit(1, 32)));
+    system.setMainAutomaton(main);
+
+    std::string buffer = serialize(system);
+
+    // Every truncated prefix must be rejected.
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        GazerContext newContext;
+        EXPECT_EQ(nullptr, ReadAutomataSystem(llvm::StringRef(buffer).take_front(i), newContext));
+    }
+
+    GazerContext newContext;
+    EXPECT_EQ(nullptr, ReadAutomataSystem(buffer + "x", newContext));
+    EXPECT_EQ(nullptr, ReadAutomataSystem("GZAS\x7F", newContext));
+}
+
+TEST_F(AutomataSerializationTest, RejectIllTypedOperands)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* z = main->createInput("z", BvType::Get(context, 17));
+    Variable* x = main->createLocal("x", BvType::Get(context, 32));
+    main->createAssignTransition(main->getEntry(), main->getExit(), builder->True(), {
+        { x, builder->ZExt(z->getRefExpr(), BvType::Get(context, 32)) }
+    });
+    system.setMainAutomaton(main);
+
+    std::string buffer = serialize(system);
+
+    // Widen the type of 'z' to 32 bits, turning the extension into an invalid one.
+    std::string bv17 = { static_cast<char>(Type::BvTypeID), 17 };
+    size_t pos = buffer.find(bv17);
+    ASSERT_NE(std::string::npos, pos);
+    buffer[pos + 1] = 32;
+
+    GazerContext newContext;
+    EXPECT_EQ(nullptr, ReadAutomataSystem(buffer, newContext));
+}
+
+TEST_F(AutomataSerializationTest, RejectCallInterfaceMismatch)
+{
+    auto& bv32Ty = BvType::Get(context, 32);
+
+    Cfa* callee = system.createCfa("f");
+    Variable* a = callee->createInput("a", bv32Ty);
+    Variable* r = callee->createLocal("r", bv32Ty);
+    callee->addOutput(r);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), builder->True(), {
+        { r, a->getRefExpr() }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", bv32Ty);
+    main->createCallTransition(main->getEntry(), main->getExit(), builder->True(), callee, {
+        { a, builder->BvLit(1, 32) }
+    }, {
+        { x, r->getRefExpr() }
+    });
+    system.setMainAutomaton(main);
+
+    std::string buffer = serialize(system);
+
+    // Declare 'a' as a local of the callee, so the call passes an extra input.
+    std::string interface("\x01" "f" "\x01\x00" "\x01\x01" "\x01\x01", 8);
+    size_t pos = buffer.find(interface);
+    ASSERT_NE(std::string::npos, pos);
+    buffer.replace(pos, interface.size(), std::string("\x01" "f" "\x00" "\x02\x00\x01" "\x01\x01", 8));
+
+    GazerContext newContext;
+    EXPECT_EQ(nullptr, ReadAutomataSystem(buffer, newContext));
+}
+
+} // end anonymous namespace
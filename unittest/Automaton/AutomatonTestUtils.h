@@ -0,0 +1,58 @@
+//==- AutomatonTestUtils.h - Shared fixtures of the automaton tests -*- C++ -*-==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_UNITTEST_AUTOMATON_AUTOMATONTESTUTILS_H
+#define GAZER_UNITTEST_AUTOMATON_AUTOMATONTESTUTILS_H
+
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <gtest/gtest.h>
+
+namespace gazer::test
+{
+
+/// Owns an empty automata system and an expression builder.
+class AutomataSystemTest : public ::testing::Test
+{
+protected:
+    AutomataSystemTest()
+        : system(context), builder(CreateExprBuilder(context))
+    {}
+
+protected:
+    GazerContext context;
+    AutomataSystem system;
+    std::unique_ptr<ExprBuilder> builder;
+};
+
+/// Starts each test with an empty automaton.
+class SingleCfaTest : public AutomataSystemTest
+{
+protected:
+    void SetUp() override
+    {
+        cfa = system.createCfa("Test");
+    }
+
+protected:
+    Cfa* cfa = nullptr;
+};
+
+} // end namespace gazer::test
+
+#endif
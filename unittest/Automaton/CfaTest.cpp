@@ -82,3 +82,63 @@ TEST(Cfa, CanCreateCfa)
     ASSERT_EQ(loc2, edge1->getTarget());
     ASSERT_EQ(loc3, edge2->getTarget());
 }
+
+TEST(Cfa, DisconnectEdgesPreservesOrder)
+{
+    GazerContext context;
+    AutomataSystem system(context);
+
+    auto cfa = system.createCfa("Test");
+    Location* entry = cfa->getEntry();
+    Location* loc = cfa->createLocation();
+
+    std::vector<Transition*> edges;
+    for (unsigned i = 0; i < 4; ++i) {
+        edges.push_back(cfa->createAssignTransition(entry, loc));
+    }
+
+    cfa->disconnectEdge(edges[1]);
+    cfa->disconnectEdge(edges[2]);
+
+    ASSERT_EQ(2, entry->getNumOutgoing());
+    ASSERT_EQ(2, loc->getNumIncoming());
+    EXPECT_EQ(edges[0], entry->outgoing_begin()[0]);
+    EXPECT_EQ(edges[3], entry->outgoing_begin()[1]);
+    EXPECT_EQ(edges[3], loc->incoming_begin()[1]);
+
+    // Removal must still work after the positions of the edges were renumbered.
+    cfa->disconnectEdge(edges[3]);
+    ASSERT_EQ(1, loc->getNumIncoming());
+    EXPECT_EQ(edges[0], *loc->incoming_begin());
+
+    cfa->clearDisconnectedElements();
+    EXPECT_EQ(1, cfa->getNumTransitions());
+}
+
+TEST(Cfa, VariableQueries)
+{
+    GazerContext context;
+    AutomataSystem system(context);
+
+    auto cfa = system.createCfa("Test");
+    Variable* in1 = cfa->createInput("in1", BoolType::Get(context));
+    Variable* in2 = cfa->createInput("in2", BoolType::Get(context));
+    Variable* tmp = cfa->createLocal("tmp", BoolType::Get(context));
+    Variable* out = cfa->createLocal("out", BoolType::Get(context));
+    cfa->addOutput(out);
+
+    EXPECT_EQ(0, cfa->getInputNumber(in1));
+    EXPECT_EQ(1, cfa->getInputNumber(in2));
+    EXPECT_EQ(0, cfa->getOutputNumber(out));
+    EXPECT_TRUE(cfa->isOutput(out));
+    EXPECT_FALSE(cfa->isOutput(in1));
+
+    EXPECT_EQ(in2, cfa->findInputByName("in2"));
+    EXPECT_EQ(nullptr, cfa->findInputByName("tmp"));
+    EXPECT_EQ(tmp, cfa->findLocalByName("tmp"));
+    EXPECT_EQ(out, cfa->findOutputByName("out"));
+
+    cfa->removeLocalsIf([tmp](Variable* v) { return v == tmp; });
+    EXPECT_EQ(nullptr, cfa->findLocalByName("tmp"));
+    EXPECT_EQ(out, cfa->findLocalByName("out"));
+}
@@ -0,0 +1,152 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class PathConditionCalculatorTest : public SingleCfaTest
+{
+protected:
+    void SetUp() override
+    {
+        SingleCfaTest::SetUp();
+
+        // entry -> {a1, a2, a3} -> mid -> {b1, ..., b5} -> exit
+        std::vector<Location*> firstLayer, secondLayer;
+        topo.push_back(cfa->getEntry());
+        for (unsigned i = 0; i < 3; ++i) {
+            firstLayer.push_back(cfa->createLocation());
+            topo.push_back(firstLayer.back());
+        }
+
+        mid = cfa->createLocation();
+        topo.push_back(mid);
+
+        for (unsigned i = 0; i < 5; ++i) {
+            secondLayer.push_back(cfa->createLocation());
+            topo.push_back(secondLayer.back());
+        }
+        topo.push_back(cfa->getExit());
+
+        for (Location* loc : firstLayer) {
+            cfa->createAssignTransition(cfa->getEntry(), loc, builder->True());
+            cfa->createAssignTransition(loc, mid, builder->True());
+        }
+
+        for (Location* loc : secondLayer) {
+            cfa->createAssignTransition(mid, loc, builder->True());
+            cfa->createAssignTransition(loc, cfa->getExit(), builder->True());
+        }
+    }
+
+    PathConditionCalculator createCalculator()
+    {
+        return PathConditionCalculator(
+            topo, *builder,
+            [this](Location* loc) {
+                return std::distance(topo.begin(), std::find(topo.begin(), topo.end(), loc));
+            },
+            [this](CallTransition* call) { return builder->True(); },
+            [this](Location* loc, const PredecessorSelector& selector) {
+                preds[loc] = selector.expr;
+                selectors[loc] = selector;
+            }
+        );
+    }
+
+protected:
+    Location* mid = nullptr;
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, ExprPtr> preds;
+    llvm::DenseMap<Location*, PredecessorSelector> selectors;
+};
+
+TEST_F(PathConditionCalculatorTest, SelectorsAreReusedAcrossEncodes)
+{
+    auto pathConditions = createCalculator();
+    pathConditions.encode(cfa->getEntry(), cfa->getExit());
+
+    // Three predecessors are encoded using two one-hot boolean selectors,
+    // five predecessors are encoded using a single 3-bit wide bit-vector.
+    Variable* oneHot0 = context.getVariable("__gazer_pred_0");
+    Variable* oneHot1 = context.getVariable("__gazer_pred_1");
+    Variable* binary = context.getVariable("__gazer_pred_2");
+
+    ASSERT_NE(oneHot0, nullptr);
+    ASSERT_NE(oneHot1, nullptr);
+    ASSERT_NE(binary, nullptr);
+    EXPECT_TRUE(oneHot0->getType().isBoolType());
+    EXPECT_TRUE(oneHot1->getType().isBoolType());
+    EXPECT_EQ(binary->getType(), BvType::Get(context, 3));
+
+    // Encoding again should not introduce any new variables.
+    pathConditions.encode(cfa->getEntry(), cfa->getExit());
+    pathConditions.encode(mid, cfa->getExit());
+    EXPECT_EQ(context.getVariable("__gazer_pred_3"), nullptr);
+}
+
+TEST_F(PathConditionCalculatorTest, SelectorsCanBeDecoded)
+{
+    auto pathConditions = createCalculator();
+    pathConditions.encode(cfa->getEntry(), cfa->getExit());
+
+    auto vb = Valuation::CreateBuilder();
+    vb.put(context.getVariable("__gazer_pred_0"), BoolLiteralExpr::False(context));
+    vb.put(context.getVariable("__gazer_pred_1"), BoolLiteralExpr::True(context));
+    vb.put(context.getVariable("__gazer_pred_2"), builder->BvLit(3, 3));
+
+    ExprEvaluator eval{vb.build()};
+
+    auto midPred = llvm::dyn_cast_or_null<IntLiteralExpr>(eval.walk(preds[mid]).get());
+    ASSERT_NE(midPred, nullptr);
+    EXPECT_EQ(midPred->getValue(), mid->incoming_begin()[1]->getSource()->getId());
+
+    Location* exit = cfa->getExit();
+    auto exitPred = llvm::dyn_cast_or_null<IntLiteralExpr>(eval.walk(preds[exit]).get());
+    ASSERT_NE(exitPred, nullptr);
+    EXPECT_EQ(exitPred->getValue(), exit->incoming_begin()[3]->getSource()->getId());
+}
+
+TEST_F(PathConditionCalculatorTest, SelectorsCanBeDecodedWithoutEvaluation)
+{
+    auto pathConditions = createCalculator();
+    pathConditions.encode(cfa->getEntry(), cfa->getExit());
+
+    auto vb = Valuation::CreateBuilder();
+    vb.put(context.getVariable("__gazer_pred_0"), BoolLiteralExpr::False(context));
+    vb.put(context.getVariable("__gazer_pred_1"), BoolLiteralExpr::True(context));
+    vb.put(context.getVariable("__gazer_pred_2"), builder->BvLit(3, 3));
+    Valuation model = vb.build();
+
+    EXPECT_EQ(selectors[mid].decode(model), mid->incoming_begin()[1]);
+    EXPECT_EQ(selectors[cfa->getExit()].decode(model), cfa->getExit()->incoming_begin()[3]);
+
+    // If none of the one-hot bits are set, the last predecessor is selected.
+    auto empty = Valuation::CreateBuilder().build();
+    EXPECT_EQ(selectors[mid].decode(empty), mid->incoming_begin()[2]);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,141 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+using ConeOfInfluenceTest = AutomataSystemTest;
+
+TEST_F(ConeOfInfluenceTest, RemoveIrrelevantAssignments)
+{
+    auto& intTy = IntType::Get(context);
+
+    Cfa* main = system.createCfa("main");
+    system.setMainAutomaton(main);
+
+    Variable* a = main->createLocal("a", intTy);
+    Variable* b = main->createLocal("b", intTy);
+    Variable* c = main->createLocal("c", intTy);
+
+    Location* l1 = main->createLocation();
+    Location* err = main->createErrorLocation();
+
+    // a := b + 1, c := a * 2 ; b is needed by a, which is needed by the error check.
+    main->createAssignTransition(main->getEntry(), l1, builder->True(), {
+        { b, builder->IntLit(5) },
+        { a, builder->Add(b->getRefExpr(), builder->IntLit(1)) },
+        { c, builder->Mul(a->getRefExpr(), builder->IntLit(2)) }
+    });
+    main->createAssignTransition(l1, err, builder->Gt(a->getRefExpr(), builder->IntLit(0)));
+    main->createAssignTransition(l1, main->getExit(), builder->Not(builder->Gt(a->getRefExpr(), builder->IntLit(0))));
+    main->addErrorCode(err, builder->BvLit(1, 16));
+
+    auto result = TransformConeOfInfluence(system);
+
+    EXPECT_EQ(1, result.NumRemovedAssignments);
+    EXPECT_EQ(1, result.NumRemovedVariables);
+    EXPECT_EQ(2, main->getNumLocals());
+    EXPECT_EQ(nullptr, main->findLocalByName("c"));
+
+    auto edge = llvm::cast<AssignTransition>(*main->getEntry()->outgoing_begin());
+    ASSERT_EQ(2, edge->getNumAssignments());
+    EXPECT_EQ(b, edge->begin()->getVariable());
+    EXPECT_EQ(a, std::next(edge->begin())->getVariable());
+}
+
+TEST_F(ConeOfInfluenceTest, SliceProcedureInterfaces)
+{
+    auto& intTy = IntType::Get(context);
+
+    Cfa* main = system.createCfa("main");
+    system.setMainAutomaton(main);
+
+    Cfa* callee = system.createCfa("f");
+    Variable* in1 = callee->createInput("in1", intTy);
+    Variable* in2 = callee->createInput("in2", intTy);
+    Variable* out1 = callee->createLocal("out1", intTy);
+    Variable* out2 = callee->createLocal("out2", intTy);
+    Variable* tmp = callee->createLocal("tmp", intTy);
+    callee->addOutput(out1);
+    callee->addOutput(out2);
+
+    // out1 := in1, tmp := in2 * 2, out2 := tmp
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), builder->True(), {
+        { out1, in1->getRefExpr() },
+        { tmp, builder->Mul(in2->getRefExpr(), builder->IntLit(2)) },
+        { out2, tmp->getRefExpr() }
+    });
+
+    Variable* a = main->createLocal("a", intTy);
+    Variable* b = main->createLocal("b", intTy);
+    Variable* r = main->createLocal("r", intTy);
+    Variable* s = main->createLocal("s", intTy);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+    Location* err = main->createErrorLocation();
+
+    main->createAssignTransition(main->getEntry(), l1, builder->True(), {
+        { a, builder->IntLit(1) },
+        { b, builder->IntLit(2) }
+    });
+    main->createCallTransition(l1, l2, builder->True(), callee, {
+        { in1, a->getRefExpr() },
+        { in2, b->getRefExpr() }
+    }, {
+        { r, out1->getRefExpr() },
+        { s, out2->getRefExpr() }
+    });
+    main->createAssignTransition(l2, err, builder->Gt(r->getRefExpr(), builder->IntLit(0)));
+    main->createAssignTransition(l2, main->getExit(), builder->Not(builder->Gt(r->getRefExpr(), builder->IntLit(0))));
+    main->addErrorCode(err, builder->BvLit(1, 16));
+
+    auto result = TransformConeOfInfluence(system);
+
+    // Removed: b := 2, tmp := ..., out2 := ..., in2 := b, s <= out2
+    EXPECT_EQ(5, result.NumRemovedAssignments);
+    // Removed: in2, out2, tmp, b, s
+    EXPECT_EQ(5, result.NumRemovedVariables);
+
+    ASSERT_EQ(1, callee->getNumInputs());
+    EXPECT_EQ(in1, callee->getInput(0));
+    EXPECT_EQ(0, callee->getInputNumber(in1));
+    ASSERT_EQ(1, callee->getNumOutputs());
+    EXPECT_EQ(out1, callee->getOutput(0));
+    EXPECT_FALSE(callee->isOutput(out2));
+    EXPECT_EQ(1, callee->getNumLocals());
+
+    EXPECT_EQ(2, main->getNumLocals());
+    EXPECT_EQ(nullptr, main->findLocalByName("b"));
+    EXPECT_EQ(nullptr, main->findLocalByName("s"));
+
+    auto call = llvm::cast<CallTransition>(*l1->outgoing_begin());
+    ASSERT_EQ(1, call->getNumInputs());
+    EXPECT_EQ(a->getRefExpr(), call->getInputArgument(*in1)->getValue());
+    ASSERT_EQ(1, call->getNumOutputs());
+    EXPECT_EQ(r, call->getOutputArgument(*out1)->getVariable());
+}
+
+} // end anonymous namespace
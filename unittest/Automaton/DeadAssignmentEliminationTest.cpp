@@ -0,0 +1,140 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class DeadAssignmentEliminationTest : public SingleCfaTest
+{
+protected:
+    void SetUp() override
+    {
+        SingleCfaTest::SetUp();
+
+        x = cfa->createInput("x", IntType::Get(context));
+    }
+
+    Variable* createLocal(const std::string& name)
+    {
+        return cfa->createLocal(name, IntType::Get(context));
+    }
+
+    static std::vector<Variable*> getAssignedVariables(Transition* edge)
+    {
+        std::vector<Variable*> result;
+        for (const VariableAssignment& assignment : *llvm::cast<AssignTransition>(edge)) {
+            result.push_back(assignment.getVariable());
+        }
+        return result;
+    }
+
+protected:
+    Variable* x = nullptr;
+};
+
+TEST_F(DeadAssignmentEliminationTest, RemoveUnreadAssignments)
+{
+    Variable* a = createLocal("a");
+    Variable* b = createLocal("b");
+    Variable* c = createLocal("c");
+    Variable* d = createLocal("d");
+
+    Location* l1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+
+    // d is only read by b, which is never read: both of them are dead.
+    auto edge = cfa->createAssignTransition(cfa->getEntry(), l1, builder->True(), {
+        { a, x->getRefExpr() },
+        { d, builder->Add(x->getRefExpr(), builder->IntLit(2)) },
+        { b, builder->Add(d->getRefExpr(), builder->IntLit(1)) },
+        { c, builder->IntLit(5) }
+    });
+    cfa->createAssignTransition(l1, err, builder->Gt(a->getRefExpr(), builder->IntLit(0)));
+    cfa->createAssignTransition(l1, cfa->getExit(), builder->Not(builder->Gt(a->getRefExpr(), builder->IntLit(0))));
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    auto result = TransformDeadAssignmentElimination(cfa);
+
+    EXPECT_EQ(3, result.NumRemovedAssignments);
+    EXPECT_EQ(3, result.NumRemovedVariables);
+    EXPECT_EQ(std::vector<Variable*>({ a }), getAssignedVariables(edge));
+    EXPECT_EQ(1, cfa->getNumLocals());
+}
+
+TEST_F(DeadAssignmentEliminationTest, OverwrittenAssignmentsAreDead)
+{
+    Variable* i = createLocal("i");
+
+    Location* l1 = cfa->createLocation();
+    Location* l2 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+
+    auto first = cfa->createAssignTransition(cfa->getEntry(), l1, builder->True(), {
+        { i, builder->IntLit(0) }
+    });
+    auto second = cfa->createAssignTransition(l1, l2, builder->True(), {
+        { i, x->getRefExpr() }
+    });
+    // The increment reads i, thus the value assigned by 'second' is live.
+    auto increment = cfa->createAssignTransition(l2, l2, builder->Lt(i->getRefExpr(), builder->IntLit(10)), {
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(l2, err, builder->Eq(i->getRefExpr(), builder->IntLit(10)));
+    cfa->createAssignTransition(l2, cfa->getExit(), builder->Gt(i->getRefExpr(), builder->IntLit(10)));
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    auto result = TransformDeadAssignmentElimination(cfa);
+
+    EXPECT_EQ(1, result.NumRemovedAssignments);
+    EXPECT_EQ(0, result.NumRemovedVariables);
+    EXPECT_EQ(0, first->getNumAssignments());
+    EXPECT_EQ(1, second->getNumAssignments());
+    EXPECT_EQ(1, increment->getNumAssignments());
+}
+
+TEST_F(DeadAssignmentEliminationTest, OutputsAndKeptVariablesAreLive)
+{
+    Variable* out = createLocal("out");
+    Variable* kept = createLocal("kept");
+    createLocal("unused");
+    cfa->addOutput(out);
+
+    auto edge = cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), builder->True(), {
+        { out, x->getRefExpr() },
+        { kept, builder->IntLit(1) }
+    });
+
+    auto result = TransformDeadAssignmentElimination(cfa, [kept](Variable* variable) {
+        return variable == kept;
+    });
+
+    EXPECT_EQ(0, result.NumRemovedAssignments);
+    EXPECT_EQ(1, result.NumRemovedVariables);
+    EXPECT_EQ(std::vector<Variable*>({ out, kept }), getAssignedVariables(edge));
+    EXPECT_EQ(nullptr, cfa->findLocalByName("unused"));
+    EXPECT_NE(nullptr, cfa->findLocalByName("kept"));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,256 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/IntervalAnalysis.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+using IntervalAnalysisTest = SingleCfaTest;
+
+TEST_F(IntervalAnalysisTest, RemoveInfeasibleTransitions)
+{
+    Variable* x = cfa->createInput("x", IntType::Get(context));
+    Variable* i = cfa->createLocal("i", IntType::Get(context));
+
+    Location* l1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    cfa->createAssignTransition(cfa->getEntry(), l1, builder->True(), {
+        { i, builder->Add(builder->IntLit(5), builder->IntLit(2)) }
+    });
+    cfa->createAssignTransition(l1, err, builder->Gt(i->getRefExpr(), builder->IntLit(10)));
+    auto toExit = cfa->createAssignTransition(
+        l1, cfa->getExit(), builder->LtEq(i->getRefExpr(), builder->IntLit(10))
+    );
+    // Depends on the input, thus it must be kept as it is.
+    auto guarded = cfa->createAssignTransition(
+        cfa->getEntry(), l1, builder->Lt(x->getRefExpr(), builder->IntLit(0)), {
+            { i, builder->IntLit(0) }
+        }
+    );
+
+    auto result = TransformIntervalSimplification(system);
+
+    EXPECT_EQ(1, result.NumRemovedTransitions);
+    EXPECT_EQ(1, result.NumRemovedLocations);
+    EXPECT_EQ(1, result.NumSimplifiedGuards);
+    EXPECT_EQ(0, cfa->getNumErrors());
+    EXPECT_EQ(builder->True(), toExit->getGuard());
+    EXPECT_EQ(builder->Lt(x->getRefExpr(), builder->IntLit(0)), guarded->getGuard());
+}
+
+TEST_F(IntervalAnalysisTest, WidenLoopHeads)
+{
+    Variable* i = cfa->createLocal("i", IntType::Get(context));
+
+    Location* loop = cfa->createLocation();
+    Location* l2 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    // for (i = 0; i < 10; ++i) {} assert(i == 10);
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->IntLit(0) }
+    });
+    cfa->createAssignTransition(loop, loop, builder->Lt(i->getRefExpr(), builder->IntLit(10)), {
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(loop, l2, builder->GtEq(i->getRefExpr(), builder->IntLit(10)));
+    auto toError = cfa->createAssignTransition(l2, err, builder->NotEq(i->getRefExpr(), builder->IntLit(10)));
+    cfa->createAssignTransition(l2, cfa->getExit(), builder->Eq(i->getRefExpr(), builder->IntLit(10)));
+
+    IntervalAnalysis analysis(system);
+
+    EXPECT_TRUE(analysis.isLoopHead(loop));
+    EXPECT_FALSE(analysis.isLoopHead(l2));
+    EXPECT_EQ(Interval(0, 10), analysis.getState(loop).get(i));
+    EXPECT_EQ(Interval::Constant(10), analysis.getState(l2).get(i));
+    EXPECT_FALSE(analysis.isFeasible(toError));
+    EXPECT_FALSE(analysis.isReachable(err));
+
+    auto invariant = analysis.getInvariant(loop, *builder);
+    EXPECT_EQ(
+        builder->And(
+            builder->GtEq(i->getRefExpr(), builder->IntLit(0)),
+            builder->LtEq(i->getRefExpr(), builder->IntLit(10))
+        ),
+        invariant
+    );
+}
+
+TEST_F(IntervalAnalysisTest, ParallelAssignments)
+{
+    Variable* i = cfa->createLocal("i", IntType::Get(context));
+    Variable* a = cfa->createLocal("a", IntType::Get(context));
+    Variable* b = cfa->createLocal("b", IntType::Get(context));
+
+    Location* loop = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    // The values are swapped in each iteration, b is 0 after the first one.
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->IntLit(0) },
+        { a, builder->IntLit(0) },
+        { b, builder->IntLit(1) }
+    });
+    cfa->createAssignTransition(loop, loop, builder->Lt(i->getRefExpr(), builder->IntLit(10)), {
+        { a, b->getRefExpr() },
+        { b, a->getRefExpr() },
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+    });
+    auto toError = cfa->createAssignTransition(loop, err, builder->Eq(b->getRefExpr(), builder->IntLit(0)));
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->NotEq(b->getRefExpr(), builder->IntLit(0)));
+
+    IntervalAnalysis analysis(system);
+
+    EXPECT_EQ(Interval(0, 1), analysis.getState(loop).get(a));
+    EXPECT_EQ(Interval(0, 1), analysis.getState(loop).get(b));
+    EXPECT_TRUE(analysis.isFeasible(toError));
+    EXPECT_TRUE(analysis.isReachable(err));
+}
+
+TEST_F(IntervalAnalysisTest, DependentAssignments)
+{
+    Variable* x = cfa->createInput("x", IntType::Get(context));
+    Variable* a = cfa->createLocal("a", IntType::Get(context));
+    Variable* cmp = cfa->createLocal("cmp", BoolType::Get(context));
+
+    Location* l1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    // The second assignment reads the value assigned by the first one.
+    auto inRange = builder->And(
+        builder->GtEq(x->getRefExpr(), builder->IntLit(0)),
+        builder->LtEq(x->getRefExpr(), builder->IntLit(2))
+    );
+    cfa->createAssignTransition(cfa->getEntry(), l1, inRange, {
+        { a, builder->Add(x->getRefExpr(), builder->IntLit(1)) },
+        { cmp, builder->Lt(a->getRefExpr(), builder->IntLit(5)) }
+    });
+    auto toError = cfa->createAssignTransition(l1, err, builder->Not(cmp->getRefExpr()));
+    cfa->createAssignTransition(l1, cfa->getExit(), cmp->getRefExpr());
+
+    IntervalAnalysis analysis(system);
+
+    EXPECT_EQ(Interval(1, 3), analysis.getState(l1).get(a));
+    EXPECT_EQ(Interval::Constant(1), analysis.getState(l1).get(cmp));
+    EXPECT_FALSE(analysis.isFeasible(toError));
+    EXPECT_FALSE(analysis.isReachable(err));
+}
+
+TEST_F(IntervalAnalysisTest, BitVectorArithmeticWrapsAround)
+{
+    auto& bv8Ty = BvType::Get(context, 8);
+    Variable* x = cfa->createLocal("x", bv8Ty);
+    Variable* y = cfa->createLocal("y", bv8Ty);
+
+    Location* l1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    cfa->createAssignTransition(cfa->getEntry(), l1, builder->True(), {
+        { x, builder->BvLit(200, 8) },
+        { y, builder->Add(builder->BvLit(127, 8), builder->BvLit(1, 8)) }
+    });
+    auto overflow = cfa->createAssignTransition(l1, err, builder->BvSLt(y->getRefExpr(), builder->BvLit(0, 8)));
+    auto unsignedCmp = cfa->createAssignTransition(l1, cfa->getExit(), builder->BvUGt(x->getRefExpr(), builder->BvLit(100, 8)));
+
+    IntervalAnalysis analysis(system);
+
+    // 200 is represented by its signed value.
+    EXPECT_EQ(Interval::Constant(-56), analysis.getState(l1).get(x));
+    EXPECT_EQ(Interval(-128, 127), analysis.getState(l1).get(y));
+    EXPECT_TRUE(analysis.isFeasible(overflow));
+    EXPECT_TRUE(analysis.isGuardValid(unsignedCmp));
+}
+
+TEST_F(IntervalAnalysisTest, UseCalleeSummaries)
+{
+    auto& intTy = IntType::Get(context);
+
+    Cfa* callee = system.createCfa("f");
+    Variable* in = callee->createInput("in", intTy);
+    Variable* out = callee->createLocal("out", intTy);
+    callee->addOutput(out);
+
+    // out := in < 0 ? 0 : 3
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), builder->True(), {
+        { out, builder->Select(
+            builder->Lt(in->getRefExpr(), builder->IntLit(0)), builder->IntLit(0), builder->IntLit(3)
+        ) }
+    });
+
+    Variable* r = cfa->createLocal("r", intTy);
+    Location* l1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    cfa->createCallTransition(cfa->getEntry(), l1, builder->True(), callee, {
+        { in, builder->IntLit(1) }
+    }, {
+        { r, out->getRefExpr() }
+    });
+    auto toError = cfa->createAssignTransition(l1, err, builder->Gt(r->getRefExpr(), builder->IntLit(5)));
+    cfa->createAssignTransition(l1, cfa->getExit(), builder->LtEq(r->getRefExpr(), builder->IntLit(5)));
+
+    IntervalAnalysis analysis(system);
+
+    EXPECT_EQ(Interval(0, 3), analysis.getState(l1).get(r));
+    EXPECT_FALSE(analysis.isFeasible(toError));
+}
+
+TEST_F(IntervalAnalysisTest, AddLoopInvariants)
+{
+    auto& bv32Ty = BvType::Get(context, 32);
+    Variable* n = cfa->createInput("n", bv32Ty);
+    Variable* i = cfa->createLocal("i", bv32Ty);
+
+    Location* loop = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->BvLit(0, 32) }
+    });
+    auto body = cfa->createAssignTransition(loop, loop, builder->BvSLt(i->getRefExpr(), n->getRefExpr()), {
+        { i, builder->Add(i->getRefExpr(), builder->BvLit(1, 32)) }
+    });
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->BvSGtEq(i->getRefExpr(), n->getRefExpr()));
+
+    auto result = TransformIntervalSimplification(system, true);
+
+    EXPECT_EQ(0, result.NumRemovedTransitions);
+    EXPECT_EQ(1, result.NumInvariants);
+    EXPECT_EQ(
+        builder->And(
+            builder->BvSGtEq(i->getRefExpr(), builder->BvLit(0, 32)),
+            builder->BvSLt(i->getRefExpr(), n->getRefExpr())
+        ),
+        body->getGuard()
+    );
+}
+
+} // end anonymous namespace
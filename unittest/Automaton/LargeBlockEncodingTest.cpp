@@ -0,0 +1,175 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class LargeBlockEncodingTest : public SingleCfaTest
+{
+protected:
+    void SetUp() override
+    {
+        SingleCfaTest::SetUp();
+
+        x = cfa->createInput("x", IntType::Get(context));
+        y = cfa->createLocal("y", IntType::Get(context));
+        z = cfa->createLocal("z", IntType::Get(context));
+        cfa->addOutput(z);
+    }
+
+    AssignTransition* getSingleEdge()
+    {
+        EXPECT_EQ(1, cfa->getNumTransitions());
+        return llvm::cast<AssignTransition>(cfa->edge_begin()->get());
+    }
+
+protected:
+    Variable* x = nullptr;
+    Variable* y = nullptr;
+    Variable* z = nullptr;
+};
+
+TEST_F(LargeBlockEncodingTest, MergeLinearChain)
+{
+    // entry -(y := x + 1)-> l1 -[y > 0](z := y)-> l2 -> exit
+    Location* l1 = cfa->createLocation();
+    Location* l2 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), l1, builder->True(), {
+        { y, builder->Add(x->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(l1, l2, builder->Gt(y->getRefExpr(), builder->IntLit(0)), {
+        { z, y->getRefExpr() }
+    });
+    cfa->createAssignTransition(l2, cfa->getExit(), builder->True());
+
+    auto result = TransformLargeBlockEncoding(cfa);
+
+    EXPECT_EQ(2, result.NumMergedLocations);
+    EXPECT_EQ(2, cfa->getNumLocations());
+
+    AssignTransition* edge = getSingleEdge();
+    EXPECT_EQ(cfa->getEntry(), edge->getSource());
+    EXPECT_EQ(cfa->getExit(), edge->getTarget());
+
+    // All assignments are kept, and the guard refers to the values before the transition.
+    ASSERT_EQ(2, edge->getNumAssignments());
+    EXPECT_EQ(y, edge->begin()->getVariable());
+    EXPECT_EQ(z, std::next(edge->begin())->getVariable());
+    EXPECT_EQ(
+        builder->Gt(builder->Add(x->getRefExpr(), builder->IntLit(1)), builder->IntLit(0)),
+        edge->getGuard()
+    );
+}
+
+TEST_F(LargeBlockEncodingTest, KeptLocationsAreNotMerged)
+{
+    Location* l1 = cfa->createLocation();
+    Location* l2 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), l1, builder->True());
+    cfa->createAssignTransition(l1, l2, builder->True());
+    cfa->createAssignTransition(l2, cfa->getExit(), builder->True());
+
+    auto result = TransformLargeBlockEncoding(cfa, [l1](Location* loc) { return loc == l1; });
+
+    EXPECT_EQ(1, result.NumMergedLocations);
+    EXPECT_EQ(3, cfa->getNumLocations());
+    EXPECT_EQ(2, cfa->getNumTransitions());
+    EXPECT_EQ(1, l1->getNumIncoming());
+    EXPECT_EQ(cfa->getExit(), (*l1->outgoing_begin())->getTarget());
+}
+
+TEST_F(LargeBlockEncodingTest, FoldDiamond)
+{
+    // entry -[x > 0]-> l1 -(z := 1)-> join -> exit
+    // entry -[not (x > 0)]-> l2 -(y := x, z := y)-> join
+    Location* l1 = cfa->createLocation();
+    Location* l2 = cfa->createLocation();
+    Location* join = cfa->createLocation();
+
+    ExprPtr cond = builder->Gt(x->getRefExpr(), builder->IntLit(0));
+
+    cfa->createAssignTransition(cfa->getEntry(), l1, cond);
+    cfa->createAssignTransition(cfa->getEntry(), l2, builder->Not(cond));
+    cfa->createAssignTransition(l1, join, builder->True(), {
+        { z, builder->IntLit(1) }
+    });
+    cfa->createAssignTransition(l2, join, builder->True(), {
+        { y, x->getRefExpr() },
+        { z, y->getRefExpr() }
+    });
+    cfa->createAssignTransition(join, cfa->getExit(), builder->True());
+
+    auto result = TransformLargeBlockEncoding(cfa);
+
+    EXPECT_EQ(1, result.NumFoldedEdges);
+    EXPECT_EQ(2, cfa->getNumLocations());
+
+    AssignTransition* edge = getSingleEdge();
+    ASSERT_EQ(2, edge->getNumAssignments());
+
+    Valuation val;
+    for (int input : { -5, 7 }) {
+        val[x] = builder->IntLit(input);
+        val[y] = builder->IntLit(100);
+        val[z] = builder->IntLit(200);
+
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->True(), eval.walk(edge->getGuard()));
+
+        for (const VariableAssignment& assign : *edge) {
+            ExprPtr expected;
+            if (assign.getVariable() == y) {
+                expected = builder->IntLit(input > 0 ? 100 : input);
+            } else {
+                expected = builder->IntLit(input > 0 ? 1 : input);
+            }
+            EXPECT_EQ(expected, eval.walk(assign.getValue()));
+        }
+    }
+}
+
+TEST_F(LargeBlockEncodingTest, NondeterministicBranchesAreNotFolded)
+{
+    Location* l1 = cfa->createLocation();
+    Location* l2 = cfa->createLocation();
+    Location* join = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), l1, builder->Gt(x->getRefExpr(), builder->IntLit(0)));
+    cfa->createAssignTransition(cfa->getEntry(), l2, builder->Lt(x->getRefExpr(), builder->IntLit(5)));
+    cfa->createAssignTransition(l1, join, builder->True(), { { z, builder->IntLit(1) } });
+    cfa->createAssignTransition(l2, join, builder->True(), { { z, builder->IntLit(2) } });
+    cfa->createAssignTransition(join, cfa->getExit(), builder->True());
+
+    auto result = TransformLargeBlockEncoding(cfa);
+
+    EXPECT_EQ(0, result.NumFoldedEdges);
+    EXPECT_EQ(3, cfa->getNumTransitions());
+    EXPECT_EQ(2, cfa->getEntry()->getNumOutgoing());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,282 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "AutomatonTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class LoopAccelerationTest : public SingleCfaTest
+{
+protected:
+    /// Returns the transition assigning the closed-form values after the
+    /// iteration count was chosen on an outgoing transition of \p loc.
+    AssignTransition* getAcceleratedEdge(Location* loc)
+    {
+        for (Transition* edge : loc->outgoing()) {
+            Location* chosen = edge->getTarget();
+            if (chosen->getNumOutgoing() == 1 && chosen->getNumIncoming() == 1 && chosen != loc) {
+                auto accelerated = llvm::dyn_cast<AssignTransition>(*chosen->outgoing_begin());
+                if (accelerated != nullptr) {
+                    return accelerated;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    static ExprPtr getValue(AssignTransition* edge, Variable* variable)
+    {
+        for (const VariableAssignment& assign : *edge) {
+            if (assign.getVariable() == variable) {
+                return assign.getValue();
+            }
+        }
+
+        return nullptr;
+    }
+};
+
+TEST_F(LoopAccelerationTest, AccelerateCountingLoop)
+{
+    auto& intTy = IntType::Get(context);
+    Variable* n = cfa->createInput("n", intTy);
+    Variable* i = cfa->createLocal("i", intTy);
+    Variable* x = cfa->createLocal("x", intTy);
+
+    // for (i = 0; i < n; ++i) x += 3;
+    Location* loop = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->IntLit(0) },
+        { x, builder->IntLit(0) }
+    });
+    cfa->createAssignTransition(loop, loop, builder->Lt(i->getRefExpr(), n->getRefExpr()), {
+        { x, builder->Add(x->getRefExpr(), builder->IntLit(3)) },
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->GtEq(i->getRefExpr(), n->getRefExpr()));
+
+    auto result = TransformLoopAcceleration(cfa);
+
+    EXPECT_EQ(1, result.NumAcceleratedLoops);
+    EXPECT_EQ(4, cfa->getNumTransitions());
+    ASSERT_EQ(1, loop->getNumOutgoing());
+
+    AssignTransition* edge = getAcceleratedEdge(loop);
+    ASSERT_NE(nullptr, edge);
+
+    Variable* count = cfa->findLocalByName("__gazer_loop_iterations");
+    ASSERT_NE(nullptr, count);
+
+    // The values entering the loop are moved into new variables.
+    Variable* iInit = cfa->findLocalByName("i_init");
+    Variable* xInit = cfa->findLocalByName("x_init");
+    ASSERT_NE(nullptr, iInit);
+    ASSERT_NE(nullptr, xInit);
+
+    auto init = llvm::cast<AssignTransition>(*cfa->getEntry()->outgoing_begin());
+    EXPECT_EQ(builder->IntLit(0), getValue(init, iInit));
+    EXPECT_EQ(nullptr, getValue(init, i));
+
+    Valuation val;
+    val[n] = builder->IntLit(10);
+    val[iInit] = builder->IntLit(0);
+    val[xInit] = builder->IntLit(0);
+
+    for (int iterations : { 0, 5, 10 }) {
+        val[count] = builder->IntLit(iterations);
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->True(), eval.walk(edge->getGuard()));
+        EXPECT_EQ(builder->IntLit(iterations), eval.walk(getValue(edge, i)));
+        EXPECT_EQ(builder->IntLit(3 * iterations), eval.walk(getValue(edge, x)));
+    }
+
+    for (int iterations : { -1, 11 }) {
+        val[count] = builder->IntLit(iterations);
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->False(), eval.walk(edge->getGuard()));
+    }
+}
+
+TEST_F(LoopAccelerationTest, AccelerateLoopWithDerivedCondition)
+{
+    auto& intTy = IntType::Get(context);
+    Variable* n = cfa->createInput("n", intTy);
+    Variable* i = cfa->createLocal("i", intTy);
+    Variable* c = cfa->createLocal("c", BoolType::Get(context));
+
+    // entry -(i := 0)-> header -(c := i < n)-> latch -[c](i := i + 2)-> header
+    //                                          latch -[not c]-> exit
+    Location* header = cfa->createLocation();
+    Location* latch = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), header, builder->True(), {
+        { i, builder->IntLit(0) }
+    });
+    cfa->createAssignTransition(header, latch, builder->True(), {
+        { c, builder->Lt(i->getRefExpr(), n->getRefExpr()) }
+    });
+    cfa->createAssignTransition(latch, header, c->getRefExpr(), {
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(2)) }
+    });
+    cfa->createAssignTransition(latch, cfa->getExit(), builder->Not(c->getRefExpr()));
+
+    auto result = TransformLoopAcceleration(cfa);
+
+    EXPECT_EQ(1, result.NumAcceleratedLoops);
+    EXPECT_EQ(1, header->getNumIncoming());
+    ASSERT_EQ(1, latch->getNumOutgoing());
+
+    AssignTransition* edge = getAcceleratedEdge(latch);
+    ASSERT_NE(nullptr, edge);
+    Variable* count = cfa->findLocalByName("__gazer_loop_iterations");
+    ASSERT_NE(nullptr, count);
+
+    // Entering the latch for the first time with n = 5: the loop iterates for i = 0, 2, 4.
+    Variable* iInit = cfa->findLocalByName("i_init");
+    Variable* cInit = cfa->findLocalByName("c_init");
+    ASSERT_NE(nullptr, iInit);
+    ASSERT_NE(nullptr, cInit);
+
+    Valuation val;
+    val[n] = builder->IntLit(5);
+    val[iInit] = builder->IntLit(0);
+    val[cInit] = builder->True();
+
+    val[count] = builder->IntLit(3);
+    {
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->True(), eval.walk(edge->getGuard()));
+        EXPECT_EQ(builder->IntLit(6), eval.walk(getValue(edge, i)));
+        EXPECT_EQ(builder->False(), eval.walk(getValue(edge, c)));
+    }
+
+    val[count] = builder->IntLit(4);
+    {
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->False(), eval.walk(edge->getGuard()));
+    }
+}
+
+TEST_F(LoopAccelerationTest, BitVectorLoopsKeepTheCycle)
+{
+    auto& bv8Ty = BvType::Get(context, 8);
+    Variable* n = cfa->createInput("n", bv8Ty);
+    Variable* i = cfa->createLocal("i", bv8Ty);
+
+    Location* loop = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->BvLit(0, 8) }
+    });
+    cfa->createAssignTransition(loop, loop, builder->BvULt(i->getRefExpr(), n->getRefExpr()), {
+        { i, builder->Add(i->getRefExpr(), builder->BvLit(100, 8)) }
+    });
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->BvUGtEq(i->getRefExpr(), n->getRefExpr()));
+
+    auto result = TransformLoopAcceleration(cfa);
+
+    EXPECT_EQ(1, result.NumAcceleratedLoops);
+    EXPECT_EQ(3, loop->getNumOutgoing());
+    EXPECT_EQ(nullptr, cfa->findLocalByName("i_init"));
+
+    AssignTransition* edge = getAcceleratedEdge(loop);
+    ASSERT_NE(nullptr, edge);
+    Variable* count = cfa->findLocalByName("__gazer_loop_iterations");
+    ASSERT_NE(nullptr, count);
+
+    auto& countTy = llvm::cast<BvType>(count->getType());
+    EXPECT_EQ(9, countTy.getWidth());
+
+    Valuation val;
+    val[n] = builder->BvLit(250, 8);
+    val[i] = builder->BvLit(0, 8);
+
+    // The iterations for i = 0, 100, 200 do not overflow.
+    val[count] = builder->BvLit(3, 9);
+    {
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->True(), eval.walk(edge->getGuard()));
+        EXPECT_EQ(builder->BvLit(44, 8), eval.walk(getValue(edge, i)));
+    }
+
+    // The fourth iteration overflows, it may only be reached through the original cycle.
+    val[count] = builder->BvLit(4, 9);
+    {
+        ExprEvaluator eval{val};
+        EXPECT_EQ(builder->False(), eval.walk(edge->getGuard()));
+    }
+}
+
+TEST_F(LoopAccelerationTest, NonLinearLoopsAreNotAccelerated)
+{
+    auto& intTy = IntType::Get(context);
+    Variable* n = cfa->createInput("n", intTy);
+    Variable* i = cfa->createLocal("i", intTy);
+
+    Location* loop = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->IntLit(1) }
+    });
+    cfa->createAssignTransition(loop, loop, builder->Lt(i->getRefExpr(), n->getRefExpr()), {
+        { i, builder->Mul(i->getRefExpr(), builder->IntLit(2)) }
+    });
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->GtEq(i->getRefExpr(), n->getRefExpr()));
+
+    auto result = TransformLoopAcceleration(cfa);
+
+    EXPECT_EQ(0, result.NumAcceleratedLoops);
+    EXPECT_EQ(3, cfa->getNumTransitions());
+    EXPECT_EQ(nullptr, cfa->findLocalByName("__gazer_loop_iterations"));
+}
+
+TEST_F(LoopAccelerationTest, SwappingLoopsAreNotAccelerated)
+{
+    auto& intTy = IntType::Get(context);
+    Variable* n = cfa->createInput("n", intTy);
+    Variable* i = cfa->createLocal("i", intTy);
+    Variable* a = cfa->createLocal("a", intTy);
+    Variable* b = cfa->createLocal("b", intTy);
+
+    // The assignments of the loop transition are parallel, b := a reads the old value of a.
+    Location* loop = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loop, builder->True(), {
+        { i, builder->IntLit(0) },
+        { a, builder->IntLit(1) },
+        { b, builder->IntLit(2) }
+    });
+    cfa->createAssignTransition(loop, loop, builder->Lt(i->getRefExpr(), n->getRefExpr()), {
+        { a, b->getRefExpr() },
+        { b, a->getRefExpr() },
+        { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->GtEq(i->getRefExpr(), n->getRefExpr()));
+
+    auto result = TransformLoopAcceleration(cfa);
+
+    EXPECT_EQ(0, result.NumAcceleratedLoops);
+    EXPECT_EQ(3, cfa->getNumTransitions());
+    EXPECT_EQ(nullptr, cfa->findLocalByName("__gazer_loop_iterations"));
+}
+
+} // end anonymous namespace
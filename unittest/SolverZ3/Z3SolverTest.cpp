@@ -131,4 +131,48 @@ TEST(SolverZ3Test, TestArrayLiterals)
     solver->add(EqExpr::Create(a1, a2));
     auto result = solver->run();
     ASSERT_EQ(result, Solver::SAT);
-}
\ No newline at end of file
+}
+
+TEST(SolverZ3Test, TestAssumptionsAndUnsatCore)
+{
+    GazerContext ctx;
+    Z3SolverFactory factory;
+    auto solver = factory.createSolver(ctx);
+
+    auto x = ctx.createVariable("x", IntType::Get(ctx));
+    auto& intTy = IntType::Get(ctx);
+
+    // x > 5
+    solver->add(GtExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(intTy, 5)));
+
+    auto ltThree = LtExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(intTy, 3));
+    auto gtZero = GtExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(intTy, 0));
+
+    ASSERT_EQ(solver->run({ gtZero, ltThree }), Solver::UNSAT);
+
+    auto core = solver->getUnsatCore();
+    ASSERT_EQ(core.size(), 1);
+    EXPECT_EQ(core[0], ltThree);
+
+    // Assumptions do not persist between queries.
+    EXPECT_EQ(solver->run({ gtZero }), Solver::SAT);
+    EXPECT_EQ(solver->run(), Solver::SAT);
+}
+
+TEST(SolverZ3Test, TestInterruptIsClearedExplicitly)
+{
+    GazerContext ctx;
+    Z3SolverFactory factory;
+    auto solver = factory.createSolver(ctx);
+
+    auto x = ctx.createVariable("x", IntType::Get(ctx));
+    solver->add(GtExpr::Create(x->getRefExpr(), IntLiteralExpr::Get(IntType::Get(ctx), 5)));
+
+    // An interrupt which arrives between queries cancels the next one.
+    solver->interrupt();
+    EXPECT_EQ(solver->run(), Solver::UNKNOWN);
+    EXPECT_EQ(solver->run({}), Solver::UNKNOWN);
+
+    solver->clearInterrupt();
+    EXPECT_EQ(solver->run(), Solver::SAT);
+}
@@ -0,0 +1,163 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/ErrorFreedom.h"
+
+#include "VerifierTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class ErrorFreedomTest : public VerifierTest
+{
+protected:
+    /// Creates a procedure check(x) -> y, which fails if \p bad holds
+    /// for its input x and returns x otherwise.
+    Cfa* createCheck(const std::string& name, std::function<ExprPtr(ExprPtr)> bad)
+    {
+        Cfa* cfa = system.createCfa(name);
+        Variable* x = cfa->createInput("x", IntType::Get(context));
+        Variable* y = cfa->createLocal("y", IntType::Get(context));
+        cfa->addOutput(y);
+
+        Location* error = cfa->createErrorLocation();
+        cfa->addErrorCode(error, builder->BvLit(1, 16));
+        cfa->createAssignTransition(cfa->getEntry(), error, bad(x->getRefExpr()));
+        cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), builder->True(), {
+            { y, x->getRefExpr() }
+        });
+
+        return cfa;
+    }
+
+    /// Creates a call to \p callee with the argument \p arg, returning the target location.
+    Location* createCall(Cfa* caller, Location* source, Cfa* callee, ExprPtr arg, Variable* result)
+    {
+        Location* target = caller->createLocation();
+        caller->createCallTransition(
+            source, target, builder->True(), callee,
+            { { &*callee->input_begin(), arg } },
+            { { result, callee->output_begin()->getRefExpr() } }
+        );
+
+        return target;
+    }
+};
+
+TEST_F(ErrorFreedomTest, UnreachableErrorInCallee)
+{
+    // check(x): [x > 0 && x < 0] error
+    Cfa* check = createCheck("check", [this](ExprPtr x) {
+        return builder->And(builder->Gt(x, builder->IntLit(0)), builder->Lt(x, builder->IntLit(0)));
+    });
+
+    Variable* r = main->createLocal("r", IntType::Get(context));
+    Location* after = createCall(main, main->getEntry(), check, builder->IntLit(1), r);
+    main->createAssignTransition(after, main->getExit(), builder->True());
+
+    ErrorFreedomAnalysis analysis(system, *builder, solverFactory);
+    EXPECT_TRUE(analysis.isErrorFree(check));
+    EXPECT_TRUE(analysis.isErrorFree(main));
+    EXPECT_EQ(analysis.getNumErrorFree(), 2);
+}
+
+TEST_F(ErrorFreedomTest, ReachableErrorIsPropagated)
+{
+    // check(x): [x > 0] error
+    Cfa* check = createCheck("check", [this](ExprPtr x) {
+        return builder->Gt(x, builder->IntLit(0));
+    });
+
+    // safe(x): [false] error, calls nothing
+    Cfa* safe = createCheck("safe", [this](ExprPtr) {
+        return builder->False();
+    });
+
+    // main: r1 := safe(0); r2 := check(r1)
+    Variable* r1 = main->createLocal("r1", IntType::Get(context));
+    Variable* r2 = main->createLocal("r2", IntType::Get(context));
+    Location* loc = createCall(main, main->getEntry(), safe, builder->IntLit(0), r1);
+    loc = createCall(main, loc, check, r1->getRefExpr(), r2);
+    main->createAssignTransition(loc, main->getExit(), builder->True());
+
+    ErrorFreedomAnalysis analysis(system, *builder, solverFactory);
+    EXPECT_TRUE(analysis.isErrorFree(safe));
+    EXPECT_FALSE(analysis.isErrorFree(check));
+    EXPECT_FALSE(analysis.isErrorFree(main));
+}
+
+TEST_F(ErrorFreedomTest, CallOutputsAreHavoced)
+{
+    // An error-free callee does not make the errors of its caller unreachable:
+    // the value it returns is not known to the analysis.
+    Cfa* id = createCheck("id", [this](ExprPtr) {
+        return builder->False();
+    });
+
+    // main: r := id(0); [r != 0] error
+    Variable* r = main->createLocal("r", IntType::Get(context));
+    Location* after = createCall(main, main->getEntry(), id, builder->IntLit(0), r);
+    Location* error = main->createErrorLocation();
+    main->addErrorCode(error, builder->BvLit(1, 16));
+    main->createAssignTransition(after, error, builder->NotEq(r->getRefExpr(), builder->IntLit(0)));
+    main->createAssignTransition(after, main->getExit(), builder->Eq(r->getRefExpr(), builder->IntLit(0)));
+
+    ErrorFreedomAnalysis analysis(system, *builder, solverFactory);
+    EXPECT_TRUE(analysis.isErrorFree(id));
+    EXPECT_FALSE(analysis.isErrorFree(main));
+}
+
+TEST_F(ErrorFreedomTest, RecursiveProcedure)
+{
+    // loop(i) -> r:
+    //   [i < 0 && i > 0] error
+    //   [i < 10]  call loop(i + 1) -> r
+    //   [i >= 10] r := i
+    Cfa* loop = system.createCfa("loop");
+    Variable* i = loop->createInput("i", IntType::Get(context));
+    Variable* r = loop->createLocal("r", IntType::Get(context));
+    loop->addOutput(r);
+
+    Location* error = loop->createErrorLocation();
+    loop->addErrorCode(error, builder->BvLit(1, 16));
+    loop->createAssignTransition(loop->getEntry(), error, builder->And(
+        builder->Lt(i->getRefExpr(), builder->IntLit(0)),
+        builder->Gt(i->getRefExpr(), builder->IntLit(0))
+    ));
+    loop->createCallTransition(
+        loop->getEntry(), loop->getExit(), builder->Lt(i->getRefExpr(), builder->IntLit(10)), loop,
+        { { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) } },
+        { { r, r->getRefExpr() } }
+    );
+    loop->createAssignTransition(
+        loop->getEntry(), loop->getExit(), builder->GtEq(i->getRefExpr(), builder->IntLit(10)),
+        { { r, i->getRefExpr() } }
+    );
+
+    Variable* x = main->createLocal("x", IntType::Get(context));
+    Location* after = createCall(main, main->getEntry(), loop, builder->IntLit(0), x);
+    main->createAssignTransition(after, main->getExit(), builder->True());
+
+    ErrorFreedomAnalysis analysis(system, *builder, solverFactory);
+    EXPECT_TRUE(analysis.isErrorFree(loop));
+    EXPECT_TRUE(analysis.isErrorFree(main));
+}
+
+} // end anonymous namespace
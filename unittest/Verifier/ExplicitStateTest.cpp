@@ -0,0 +1,155 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/ExplicitState.h"
+#include "gazer/Verifier/UnrollingBmc.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include "VerifierTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class ExplicitStateTest : public VerifierTest
+{
+protected:
+    void SetUp() override
+    {
+        VerifierTest::SetUp();
+
+        i = main->createLocal("i", BvType::Get(context, 8));
+        n = main->createLocal("n", BvType::Get(context, 8));
+
+        // entry -> head: i := 0, n := nondet
+        // head -> head: [i < n] i := i + 1
+        // head -> exit: [i >= n]
+        head = main->createLocation();
+        error = main->createErrorLocation();
+        main->addErrorCode(error, builder->BvLit(3, 16));
+
+        main->createAssignTransition(main->getEntry(), head, builder->True(), {
+            { i, builder->BvLit(0, 8) }, { n, builder->Undef(n->getType()) }
+        });
+        main->createAssignTransition(head, head, builder->BvULt(i->getRefExpr(), n->getRefExpr()), {
+            { i, builder->Add(i->getRefExpr(), builder->BvLit(1, 8)) }
+        });
+        main->createAssignTransition(head, main->getExit(), builder->BvUGtEq(i->getRefExpr(), n->getRefExpr()));
+    }
+
+    std::unique_ptr<VerificationResult> check(
+        ExplicitStateSettings settings = {},
+        std::unique_ptr<VerificationAlgorithm> fallback = nullptr)
+    {
+        ExplicitStateChecker checker(settings, std::move(fallback));
+        return checker.check(system, traceBuilder);
+    }
+
+protected:
+    RecordingTraceBuilder traceBuilder;
+
+    Variable* i = nullptr;
+    Variable* n = nullptr;
+    Location* head = nullptr;
+    Location* error = nullptr;
+};
+
+TEST_F(ExplicitStateTest, FindErrorWithNondetBound)
+{
+    main->createAssignTransition(head, error, builder->Eq(i->getRefExpr(), builder->BvLit(200, 8)));
+
+    auto result = check();
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+    EXPECT_EQ(llvm::cast<FailResult>(result.get())->getErrorID(), 3);
+}
+
+TEST_F(ExplicitStateTest, SafeLoop)
+{
+    main->createAssignTransition(head, error, builder->BvUGt(i->getRefExpr(), n->getRefExpr()));
+
+    auto result = check();
+    EXPECT_EQ(result->getStatus(), VerificationResult::Success);
+}
+
+TEST_F(ExplicitStateTest, DepthFirstSearch)
+{
+    main->createAssignTransition(head, error, builder->Eq(i->getRefExpr(), builder->BvLit(17, 8)));
+
+    ExplicitStateSettings settings;
+    settings.searchOrder = SearchOrder::DepthFirst;
+
+    auto result = check(settings);
+    EXPECT_EQ(result->getStatus(), VerificationResult::Fail);
+}
+
+TEST_F(ExplicitStateTest, UninitializedVariablesAreEnumerated)
+{
+    // The value of an unassigned boolean is chosen when it is first read.
+    Variable* b = main->createLocal("b", BoolType::Get(context));
+    Location* branch = main->createLocation();
+    main->createAssignTransition(head, branch, builder->Eq(i->getRefExpr(), builder->BvLit(1, 8)));
+    main->createAssignTransition(branch, error, b->getRefExpr());
+
+    auto result = check();
+    EXPECT_EQ(result->getStatus(), VerificationResult::Fail);
+}
+
+TEST_F(ExplicitStateTest, ShortestCounterexampleTrace)
+{
+    main->createAssignTransition(head, error, builder->Eq(i->getRefExpr(), builder->BvLit(3, 8)));
+
+    ExplicitStateSettings settings;
+    settings.trace = true;
+
+    auto result = check(settings);
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+
+    // entry -> head, three iterations, head -> error
+    ASSERT_EQ(traceBuilder.mStates.size(), 6);
+    ASSERT_EQ(traceBuilder.mActions.size(), 5);
+    EXPECT_EQ(traceBuilder.mStates.front(), main->getEntry());
+    EXPECT_EQ(traceBuilder.mStates.back(), error);
+
+    // The values of the assignments are taken from the visited states.
+    auto& iterations = traceBuilder.mActions[3];
+    ASSERT_EQ(iterations.size(), 1);
+    EXPECT_EQ(iterations[0].getValue(), builder->BvLit(3, 8));
+}
+
+TEST_F(ExplicitStateTest, UnsupportedDomainFallsBack)
+{
+    // Nondeterministic integers cannot be enumerated.
+    Variable* k = main->createLocal("k", IntType::Get(context));
+    Location* branch = main->createLocation();
+    main->createAssignTransition(head, branch, builder->True(), {
+        { k, builder->Undef(k->getType()) }
+    });
+    main->createAssignTransition(branch, error, builder->Eq(k->getRefExpr(), builder->IntLit(42)));
+
+    auto unknown = check();
+    EXPECT_EQ(unknown->getStatus(), VerificationResult::Unknown);
+
+    UnrollingSettings unrollSettings;
+    unrollSettings.maxBound = 5;
+
+    auto result = check({}, std::make_unique<UnrollingChecker>(solverFactory, unrollSettings));
+    EXPECT_EQ(result->getStatus(), VerificationResult::Fail);
+}
+
+} // end anonymous namespace
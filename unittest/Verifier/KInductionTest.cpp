@@ -0,0 +1,123 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/KInduction.h"
+
+#include "VerifierTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class KInductionTest : public CountingLoopTest
+{
+protected:
+    std::unique_ptr<VerificationResult> check(KInductionChecker::InvariantGenerator invariants = nullptr)
+    {
+        NullTraceBuilder traceBuilder;
+        return check(traceBuilder, std::move(invariants));
+    }
+
+    std::unique_ptr<VerificationResult> check(
+        CfaTraceBuilder& traceBuilder, KInductionChecker::InvariantGenerator invariants = nullptr)
+    {
+        KInductionSettings settings;
+        settings.maxBound = 15;
+        settings.trace = true;
+
+        KInductionChecker checker(solverFactory, settings);
+        checker.setInvariantGenerator(invariants);
+
+        return checker.check(system, traceBuilder);
+    }
+};
+
+TEST_F(KInductionTest, InductiveProperty)
+{
+    createLoop(1);
+    main->createAssignTransition(head, error, builder->Gt(x->getRefExpr(), builder->IntLit(10)));
+
+    auto result = check();
+    EXPECT_EQ(result->getStatus(), VerificationResult::Success);
+}
+
+TEST_F(KInductionTest, ReachableErrorIsFoundInBaseCase)
+{
+    createLoop(1);
+    main->createAssignTransition(head, error, builder->Eq(x->getRefExpr(), builder->IntLit(5)));
+
+    auto result = check();
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+    EXPECT_EQ(llvm::cast<FailResult>(result.get())->getErrorID(), 2);
+}
+
+TEST_F(KInductionTest, CounterexampleTrace)
+{
+    createLoop(1);
+    main->createAssignTransition(head, error, builder->Eq(x->getRefExpr(), builder->IntLit(3)));
+
+    RecordingTraceBuilder traceBuilder;
+    auto result = check(traceBuilder);
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+    ASSERT_TRUE(llvm::cast<FailResult>(result.get())->hasTrace());
+
+    // entry -> head (x = 0) -> head (x = 1) -> head (x = 2) -> head (x = 3) -> error
+    std::vector<Location*> expected = { main->getEntry(), head, head, head, head, error };
+    EXPECT_EQ(traceBuilder.mStates, expected);
+    ASSERT_EQ(traceBuilder.mActions.size(), 5u);
+
+    for (int i = 1; i <= 3; ++i) {
+        auto& action = traceBuilder.mActions[i];
+        auto it = std::find_if(action.begin(), action.end(), [this](auto& assign) {
+            return assign.getVariable() == x;
+        });
+        ASSERT_NE(it, action.end());
+        EXPECT_EQ(it->getValue(), builder->IntLit(i));
+    }
+}
+
+TEST_F(KInductionTest, NonInductivePropertyReachesBound)
+{
+    // y > 20 is unreachable as y = 2x and x <= 10, but it is not k-inductive
+    // for any k, as every bad state has an arbitrarily long safe history.
+    createLoop(2);
+    main->createAssignTransition(head, error, builder->Gt(y->getRefExpr(), builder->IntLit(20)));
+
+    auto result = check();
+    EXPECT_EQ(result->getStatus(), VerificationResult::BoundReached);
+}
+
+TEST_F(KInductionTest, InvariantStrengthening)
+{
+    createLoop(2);
+    main->createAssignTransition(head, error, builder->Gt(y->getRefExpr(), builder->IntLit(20)));
+
+    auto result = check([this](Location* loc) -> ExprVector {
+        EXPECT_EQ(loc, head);
+        return {
+            builder->Eq(y->getRefExpr(), builder->Add(x->getRefExpr(), x->getRefExpr())),
+            builder->LtEq(x->getRefExpr(), builder->IntLit(10)),
+            // Not inductive, should be discarded.
+            builder->Eq(x->getRefExpr(), builder->IntLit(0))
+        };
+    });
+    EXPECT_EQ(result->getStatus(), VerificationResult::Success);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,119 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/ProcedureSummary.h"
+#include "gazer/Core/Solver/Solver.h"
+
+#include "VerifierTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class ProcedureSummaryTest : public VerifierTest
+{
+protected:
+    /// Returns true if \p expr is implied by \p summary.
+    bool implies(const ExprPtr& summary, const ExprPtr& expr)
+    {
+        auto solver = solverFactory.createSolver(context);
+        solver->add(summary);
+        solver->add(builder->Not(expr));
+
+        return solver->run() == Solver::UNSAT;
+    }
+};
+
+TEST_F(ProcedureSummaryTest, SimpleProcedure)
+{
+    // inc(x) -> y: y := x + 1
+    Cfa* inc = system.createCfa("inc");
+    Variable* x = inc->createInput("x", IntType::Get(context));
+    Variable* y = inc->createLocal("y", IntType::Get(context));
+    inc->addOutput(y);
+
+    inc->createAssignTransition(inc->getEntry(), inc->getExit(), builder->True(), {
+        { y, builder->Add(x->getRefExpr(), builder->IntLit(1)) }
+    });
+
+    ProcedureSummaryCache summaries(system, *builder, solverFactory);
+    ExprPtr summary = summaries.getSummary(inc);
+
+    EXPECT_TRUE(implies(summary, builder->GtEq(y->getRefExpr(), x->getRefExpr())));
+    EXPECT_FALSE(implies(summary, builder->Eq(y->getRefExpr(), x->getRefExpr())));
+    EXPECT_EQ(summaries.getNumSummarized(), 1);
+}
+
+TEST_F(ProcedureSummaryTest, RecursiveProcedure)
+{
+    // loop(i) -> r:
+    //   [i < 10]  call loop(i + 1) -> r
+    //   [i >= 10] r := i
+    Cfa* loop = system.createCfa("loop");
+    Variable* i = loop->createInput("i", IntType::Get(context));
+    Variable* r = loop->createLocal("r", IntType::Get(context));
+    loop->addOutput(r);
+
+    loop->createCallTransition(
+        loop->getEntry(), loop->getExit(), builder->Lt(i->getRefExpr(), builder->IntLit(10)), loop,
+        { { i, builder->Add(i->getRefExpr(), builder->IntLit(1)) } },
+        { { r, r->getRefExpr() } }
+    );
+    loop->createAssignTransition(
+        loop->getEntry(), loop->getExit(), builder->GtEq(i->getRefExpr(), builder->IntLit(10)),
+        { { r, i->getRefExpr() } }
+    );
+
+    // main: call loop(0) -> x
+    Variable* x = main->createLocal("x", IntType::Get(context));
+    Location* after = main->createLocation();
+    auto call = main->createCallTransition(
+        main->getEntry(), after, builder->True(), loop,
+        { { i, builder->IntLit(0) } },
+        { { x, r->getRefExpr() } }
+    );
+    main->createAssignTransition(after, main->getExit(), builder->True());
+
+    ProcedureSummaryCache summaries(system, *builder, solverFactory);
+
+    ExprPtr summary = summaries.getSummary(loop);
+    EXPECT_TRUE(implies(summary, builder->GtEq(r->getRefExpr(), i->getRefExpr())));
+
+    // The summary is instantiated with the arguments of the call site.
+    ExprPtr callSummary = summaries.getSummaryForCall(call);
+    EXPECT_TRUE(implies(callSummary, builder->GtEq(x->getRefExpr(), builder->IntLit(0))));
+}
+
+TEST_F(ProcedureSummaryTest, NonReturningProcedure)
+{
+    // fail(x) -> y: [x > 0] error, [false] exit
+    Cfa* fail = system.createCfa("fail");
+    Variable* x = fail->createInput("x", IntType::Get(context));
+    Variable* y = fail->createLocal("y", IntType::Get(context));
+    fail->addOutput(y);
+
+    Location* error = fail->createErrorLocation();
+    fail->addErrorCode(error, builder->IntLit(1));
+    fail->createAssignTransition(fail->getEntry(), error, builder->Gt(x->getRefExpr(), builder->IntLit(0)));
+
+    ProcedureSummaryCache summaries(system, *builder, solverFactory);
+    EXPECT_EQ(summaries.getSummary(fail), builder->False());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,148 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/UnrollingBmc.h"
+#include "gazer/Automaton/CfaTransforms.h"
+
+#include "VerifierTestUtils.h"
+
+using namespace gazer;
+using namespace gazer::test;
+
+namespace
+{
+
+class UnrollingBmcTest : public VerifierTest
+{
+protected:
+    void SetUp() override
+    {
+        VerifierTest::SetUp();
+
+        x = main->createLocal("x", IntType::Get(context));
+        n = main->createLocal("n", IntType::Get(context));
+
+        head = main->createLocation();
+        error = main->createErrorLocation();
+        main->addErrorCode(error, builder->IntLit(2));
+    }
+
+    void createLoop(ExprPtr precondition)
+    {
+        // entry -> head: [precondition] x := 0
+        // head -> head: [x < n] x := x + 1
+        // head -> exit: [x >= n]
+        main->createAssignTransition(main->getEntry(), head, precondition, {
+            { x, builder->IntLit(0) }
+        });
+        main->createAssignTransition(head, head, builder->Lt(x->getRefExpr(), n->getRefExpr()), {
+            { x, builder->Add(x->getRefExpr(), builder->IntLit(1)) }
+        });
+        main->createAssignTransition(head, main->getExit(), builder->GtEq(x->getRefExpr(), n->getRefExpr()));
+    }
+
+    std::unique_ptr<VerificationResult> check()
+    {
+        NullTraceBuilder traceBuilder;
+        return check(traceBuilder);
+    }
+
+    std::unique_ptr<VerificationResult> check(CfaTraceBuilder& traceBuilder)
+    {
+        UnrollingSettings settings;
+        settings.maxBound = 10;
+        settings.trace = true;
+
+        UnrollingChecker checker(solverFactory, settings);
+        return checker.check(system, traceBuilder);
+    }
+
+protected:
+    Variable* x = nullptr;
+    Variable* n = nullptr;
+    Location* head = nullptr;
+    Location* error = nullptr;
+};
+
+TEST_F(UnrollingBmcTest, ErrorWithinBoundIsFound)
+{
+    createLoop(builder->True());
+    main->createAssignTransition(head, error, builder->Eq(x->getRefExpr(), builder->IntLit(5)));
+
+    auto result = check();
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+    EXPECT_EQ(llvm::cast<FailResult>(result.get())->getErrorID(), 2);
+}
+
+TEST_F(UnrollingBmcTest, CounterexampleTrace)
+{
+    createLoop(builder->True());
+    main->createAssignTransition(head, error, builder->Eq(x->getRefExpr(), builder->IntLit(2)));
+
+    RecordingTraceBuilder traceBuilder;
+    auto result = check(traceBuilder);
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+    ASSERT_TRUE(llvm::cast<FailResult>(result.get())->hasTrace());
+
+    // entry -> head (x = 0) -> head (x = 1) -> head (x = 2) -> error
+    std::vector<Location*> expected = { main->getEntry(), head, head, head, error };
+    EXPECT_EQ(traceBuilder.mStates, expected);
+    ASSERT_EQ(traceBuilder.mActions.size(), 4u);
+
+    for (int i = 0; i <= 2; ++i) {
+        auto& action = traceBuilder.mActions[i];
+        auto it = std::find_if(action.begin(), action.end(), [this](auto& assign) {
+            return assign.getVariable() == x;
+        });
+        ASSERT_NE(it, action.end());
+        EXPECT_EQ(it->getValue(), builder->IntLit(i));
+    }
+}
+
+TEST_F(UnrollingBmcTest, ErrorBeyondBoundIsNotFound)
+{
+    createLoop(builder->True());
+    main->createAssignTransition(head, error, builder->Eq(x->getRefExpr(), builder->IntLit(20)));
+
+    auto result = check();
+    EXPECT_EQ(result->getStatus(), VerificationResult::BoundReached);
+}
+
+TEST_F(UnrollingBmcTest, CompleteUnwindingIsSafe)
+{
+    // The loop has at most three iterations.
+    createLoop(builder->LtEq(n->getRefExpr(), builder->IntLit(3)));
+    main->createAssignTransition(head, error, builder->Gt(x->getRefExpr(), builder->IntLit(3)));
+
+    auto result = check();
+    EXPECT_EQ(result->getStatus(), VerificationResult::Success);
+}
+
+TEST_F(UnrollingBmcTest, AcceleratedLoopErrorBeyondBoundIsFound)
+{
+    createLoop(builder->True());
+    main->createAssignTransition(head, error, builder->Eq(x->getRefExpr(), builder->IntLit(20)));
+
+    auto accelerated = TransformLoopAcceleration(main);
+    ASSERT_EQ(accelerated.NumAcceleratedLoops, 1);
+
+    auto result = check();
+    ASSERT_EQ(result->getStatus(), VerificationResult::Fail);
+    EXPECT_EQ(llvm::cast<FailResult>(result.get())->getErrorID(), 2);
+}
+
+} // end anonymous namespace
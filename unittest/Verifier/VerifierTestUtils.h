@@ -0,0 +1,125 @@
+//==- VerifierTestUtils.h - Shared helpers of the verifier tests -*- C++ -*-==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_UNITTEST_VERIFIER_VERIFIERTESTUTILS_H
+#define GAZER_UNITTEST_VERIFIER_VERIFIERTESTUTILS_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Z3Solver/Z3Solver.h"
+
+#include <gtest/gtest.h>
+
+namespace gazer::test
+{
+
+/// A trace builder for tests which do not inspect counterexamples.
+class NullTraceBuilder : public CfaTraceBuilder
+{
+public:
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions
+    ) override {
+        return nullptr;
+    }
+};
+
+/// Stores the states and actions of the last counterexample.
+class RecordingTraceBuilder : public CfaTraceBuilder
+{
+public:
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions
+    ) override {
+        mStates = states;
+        mActions = actions;
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    std::vector<Location*> mStates;
+    std::vector<std::vector<VariableAssignment>> mActions;
+};
+
+/// Starts each test with an empty main automaton.
+class VerifierTest : public ::testing::Test
+{
+protected:
+    VerifierTest()
+        : system(context), builder(CreateExprBuilder(context))
+    {}
+
+    void SetUp() override
+    {
+        main = system.createCfa("main");
+        system.setMainAutomaton(main);
+    }
+
+protected:
+    GazerContext context;
+    AutomataSystem system;
+    std::unique_ptr<ExprBuilder> builder;
+    Z3SolverFactory solverFactory;
+
+    Cfa* main = nullptr;
+};
+
+/// A counting loop for the unbounded engines, whose error transitions
+/// are added by the tests:
+///   entry -> head: x := 0, y := 0
+///   head -> head: [x < 10] x := x + 1, y := y + step
+///   head -> exit: [x >= 10]
+class CountingLoopTest : public VerifierTest
+{
+protected:
+    void SetUp() override
+    {
+        VerifierTest::SetUp();
+
+        x = main->createLocal("x", IntType::Get(context));
+        y = main->createLocal("y", IntType::Get(context));
+
+        head = main->createLocation();
+        error = main->createErrorLocation();
+        main->addErrorCode(error, builder->IntLit(2));
+
+        main->createAssignTransition(main->getEntry(), head, builder->True(), {
+            { x, builder->IntLit(0) }, { y, builder->IntLit(0) }
+        });
+    }
+
+    void createLoop(int step)
+    {
+        main->createAssignTransition(head, head, builder->Lt(x->getRefExpr(), builder->IntLit(10)), {
+            { x, builder->Add(x->getRefExpr(), builder->IntLit(1)) },
+            { y, builder->Add(y->getRefExpr(), builder->IntLit(step)) }
+        });
+        main->createAssignTransition(head, main->getExit(), builder->GtEq(x->getRefExpr(), builder->IntLit(10)));
+    }
+
+protected:
+    Variable* x = nullptr;
+    Variable* y = nullptr;
+    Location* head = nullptr;
+    Location* error = nullptr;
+};
+
+} // end namespace gazer::test
+
+#endif